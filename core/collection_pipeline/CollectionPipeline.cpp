@@ -40,6 +40,7 @@
 #include "plugin/processor/inner/ProcessorTagNative.h"
 
 DECLARE_FLAG_INT32(default_plugin_log_queue_size);
+DECLARE_FLAG_BOOL(enable_lazy_log_parsing);
 
 using namespace std;
 
@@ -83,6 +84,8 @@ bool CollectionPipeline::Init(CollectionConfig&& config) {
     mContext.SetIsFirstProcessorJsonFlag(config.mIsFirstProcessorJson);
     mContext.SetHasNativeProcessorsFlag(config.mHasNativeProcessor);
     mContext.SetIsFlushingThroughGoPipelineFlag(config.IsFlushingThroughGoPipelineExisted());
+    // processors read the same flag during init below
+    mHasLazyParsers = BOOL_FLAG(enable_lazy_log_parsing);
 
     // for special treatment below
     const InputFile* inputFile = nullptr;
@@ -416,9 +419,34 @@ void CollectionPipeline::Process(vector<PipelineEventGroup>& logGroupList, size_
     for (auto& p : mProcessorLine) {
         p->Process(logGroupList);
     }
+    if (mHasLazyParsers) {
+        // parsers must not be referenced by events once they leave the pipeline
+        for (auto& logGroup : logGroupList) {
+            MaterializeLogEvents(logGroup);
+        }
+    }
     ADD_COUNTER(mProcessorsTotalProcessTimeMs, chrono::system_clock::now() - before);
 }
 
+void CollectionPipeline::MaterializeLogEvents(PipelineEventGroup& logGroup) {
+    EventsContainer& events = logGroup.MutableEvents();
+    size_t wIdx = 0;
+    for (size_t rIdx = 0; rIdx < events.size(); ++rIdx) {
+        if (events[rIdx].Is<LogEvent>()) {
+            auto& logEvent = events[rIdx].Cast<LogEvent>();
+            logEvent.Materialize();
+            if (logEvent.IsDiscardedByParser()) {
+                continue;
+            }
+        }
+        if (wIdx != rIdx) {
+            events[wIdx] = std::move(events[rIdx]);
+        }
+        ++wIdx;
+    }
+    events.resize(wIdx);
+}
+
 bool CollectionPipeline::Send(vector<PipelineEventGroup>&& groupList) {
     for (const auto& group : groupList) {
         ADD_COUNTER(mFlushersInEventsTotal, group.GetEvents().size());
@@ -448,7 +476,30 @@ bool CollectionPipeline::Send(vector<PipelineEventGroup>&& groupList) {
     return allSucceeded;
 }
 
+void CollectionPipeline::FlushProcessors(bool force) {
+    // groups flushed by a processor still go through the processors after it
+    vector<PipelineEventGroup> groupList;
+    for (auto& p : mPipelineInnerProcessorLine) {
+        p->Process(groupList);
+        p->Flush(groupList, force);
+    }
+    for (auto& p : mProcessorLine) {
+        p->Process(groupList);
+        p->Flush(groupList, force);
+    }
+    if (groupList.empty()) {
+        return;
+    }
+    if (mHasLazyParsers) {
+        for (auto& group : groupList) {
+            MaterializeLogEvents(group);
+        }
+    }
+    Send(std::move(groupList));
+}
+
 bool CollectionPipeline::FlushBatch() {
+    FlushProcessors(true);
     bool allSucceeded = true;
     for (auto& flusher : mFlushers) {
         allSucceeded = flusher->FlushAll() && allSucceeded;
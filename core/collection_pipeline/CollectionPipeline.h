@@ -48,6 +48,8 @@ public:
     void Process(std::vector<PipelineEventGroup>& logGroupList, size_t inputIndex);
     bool Send(std::vector<PipelineEventGroup>&& groupList);
     bool FlushBatch();
+    // send the events held by processors, only those due to be sent unless force is true
+    void FlushProcessors(bool force);
     void RemoveProcessQueue() const;
     // Should add before or when item pop from ProcessorQueue, must be called in the lock of ProcessorQueue
     void AddInProcessCnt() { mInProcessCnt.fetch_add(1); }
@@ -90,6 +92,7 @@ private:
     void CopyTagParamToGoPipeline(Json::Value& root, const Json::Value* config);
     bool ShouldAddPluginToGoPipelineWithInput() const { return mInputs.empty() && mProcessorLine.empty(); }
     void WaitAllItemsInProcessFinished();
+    static void MaterializeLogEvents(PipelineEventGroup& logGroup);
 
     std::string mName;
     std::vector<std::unique_ptr<InputInstance>> mInputs;
@@ -104,6 +107,7 @@ private:
     std::optional<std::string> mSingletonInput;
     std::atomic_uint16_t mPluginID;
     std::atomic_int16_t mInProcessCnt;
+    bool mHasLazyParsers = false;
 
     mutable MetricsRecordRef mMetricsRecordRef;
     IntGaugePtr mStartTime;
@@ -131,6 +135,7 @@ private:
     friend class InputNetworkSecurityUnittest;
     friend class InputNetworkObserverUnittest;
     friend class PipelineUpdateUnittest;
+    friend class ProcessQueueManagerUnittest;
     friend class InputHostMetaUnittest;
 #endif
 };
@@ -14,6 +14,9 @@
 
 #include "collection_pipeline/batch/TimeoutFlushManager.h"
 
+#include "collection_pipeline/CollectionPipelineManager.h"
+#include "collection_pipeline/queue/ProcessQueueManager.h"
+
 using namespace std;
 
 namespace logtail {
@@ -30,10 +33,24 @@ void TimeoutFlushManager::UpdateRecord(
     }
 }
 
+void TimeoutFlushManager::UpdateProcessorRecord(const string& config, uint32_t timeoutSecs) {
+    lock_guard<mutex> lock(mTimeoutRecordsMux);
+    mProcessorTimeoutRecords[config] = make_pair(time(nullptr), timeoutSecs);
+}
+
 void TimeoutFlushManager::FlushTimeoutBatch() {
     multimap<string, pair<Flusher*, size_t>> records;
+    vector<string> processorRecords;
     {
         lock_guard<mutex> lock(mTimeoutRecordsMux);
+        for (auto it = mProcessorTimeoutRecords.begin(); it != mProcessorTimeoutRecords.end();) {
+            if (time(nullptr) - it->second.first >= it->second.second) {
+                processorRecords.emplace_back(it->first);
+                it = mProcessorTimeoutRecords.erase(it);
+            } else {
+                ++it;
+            }
+        }
         for (auto& item : mTimeoutRecords) {
             for (auto it = item.second.begin(); it != item.second.end();) {
                 if (time(nullptr) - it->second.mUpdateTime >= it->second.mTimeoutSecs) {
@@ -56,6 +73,16 @@ void TimeoutFlushManager::FlushTimeoutBatch() {
         }
         mDeletedFlushers.clear();
     }
+    for (const auto& config : processorRecords) {
+        // counted as in process, so that the pipeline waits for the flush before stopping its flushers. Once the
+        // pipeline is stopping, the windows are flushed by the pipeline itself.
+        auto pipeline = ProcessQueueManager::GetInstance()->AddPipelineInProcessCnt(config);
+        if (!pipeline) {
+            continue;
+        }
+        pipeline->FlushProcessors(false);
+        pipeline->SubInProcessCnt();
+    }
 }
 
 void TimeoutFlushManager::UnregisterFlushers(const string& config,
@@ -63,6 +90,7 @@ void TimeoutFlushManager::UnregisterFlushers(const string& config,
     {
         lock_guard<mutex> lock(mTimeoutRecordsMux);
         mTimeoutRecords.erase(config);
+        mProcessorTimeoutRecords.erase(config);
     }
     {
         lock_guard<mutex> lock(mDeletedFlushersMux);
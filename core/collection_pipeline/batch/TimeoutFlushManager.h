@@ -53,6 +53,8 @@ public:
     }
 
     void UpdateRecord(const std::string& config, size_t index, size_t key, uint32_t timeoutSecs, Flusher* f);
+    // record that processors of the pipeline hold events, which are flushed if no update comes within timeoutSecs
+    void UpdateProcessorRecord(const std::string& config, uint32_t timeoutSecs);
     void FlushTimeoutBatch();
     void UnregisterFlushers(const std::string& config, const std::vector<std::unique_ptr<FlusherInstance>>& flushers);
     void RegisterFlushers(const std::string& config, const std::vector<std::unique_ptr<FlusherInstance>>& flushers);
@@ -64,6 +66,8 @@ private:
     // visited by all processor runner threads
     mutable std::mutex mTimeoutRecordsMux;
     std::map<std::string, std::map<std::pair<size_t, size_t>, TimeoutRecord>> mTimeoutRecords;
+    // config -> (update time, timeout secs)
+    std::map<std::string, std::pair<time_t, uint32_t>> mProcessorTimeoutRecords;
 
     // visited by main thread and num 0 processor runner thread
     mutable std::mutex mDeletedFlushersMux;
@@ -47,6 +47,7 @@
 #include "collection_pipeline/plugin/creator/StaticInputCreator.h"
 #include "collection_pipeline/plugin/creator/StaticProcessorCreator.h"
 #include "logger/Logger.h"
+#include "plugin/processor/ProcessorAggregateMetricNative.h"
 #include "plugin/processor/ProcessorDesensitizeNative.h"
 #include "plugin/processor/ProcessorFilterNative.h"
 #include "plugin/processor/ProcessorParseApsaraNative.h"
@@ -54,12 +55,14 @@
 #include "plugin/processor/ProcessorParseJsonNative.h"
 #include "plugin/processor/ProcessorParseRegexNative.h"
 #include "plugin/processor/ProcessorParseTimestampNative.h"
+#include "plugin/processor/ProcessorProjectFieldsNative.h"
 #include "plugin/processor/inner/ProcessorMergeMultilineLogNative.h"
 #include "plugin/processor/inner/ProcessorParseContainerLogNative.h"
 #include "plugin/processor/inner/ProcessorPromParseMetricNative.h"
 #include "plugin/processor/inner/ProcessorPromRelabelMetricNative.h"
 #include "plugin/processor/inner/ProcessorSplitLogStringNative.h"
 #include "plugin/processor/inner/ProcessorSplitMultilineLogStringNative.h"
+#include "plugin/processor/inner/ProcessorSplitParseContainerLogNative.h"
 #include "plugin/processor/inner/ProcessorTagNative.h"
 #if defined(__linux__) && !defined(__ANDROID__) && !defined(__EXCLUDE_SPL__)
 #include "plugin/processor/ProcessorSPL.h"
@@ -165,6 +168,7 @@ void PluginRegistry::LoadStaticPlugins() {
     RegisterProcessorCreator(new StaticProcessorCreator<ProcessorSplitMultilineLogStringNative>());
     RegisterProcessorCreator(new StaticProcessorCreator<ProcessorMergeMultilineLogNative>());
     RegisterProcessorCreator(new StaticProcessorCreator<ProcessorParseContainerLogNative>());
+    RegisterProcessorCreator(new StaticProcessorCreator<ProcessorSplitParseContainerLogNative>());
     RegisterProcessorCreator(new StaticProcessorCreator<ProcessorTagNative>());
 
     RegisterProcessorCreator(new StaticProcessorCreator<ProcessorParseApsaraNative>());
@@ -174,8 +178,10 @@ void PluginRegistry::LoadStaticPlugins() {
     RegisterProcessorCreator(new StaticProcessorCreator<ProcessorParseRegexNative>());
     RegisterProcessorCreator(new StaticProcessorCreator<ProcessorParseTimestampNative>());
     RegisterProcessorCreator(new StaticProcessorCreator<ProcessorFilterNative>());
+    RegisterProcessorCreator(new StaticProcessorCreator<ProcessorProjectFieldsNative>());
     RegisterProcessorCreator(new StaticProcessorCreator<ProcessorPromParseMetricNative>());
     RegisterProcessorCreator(new StaticProcessorCreator<ProcessorPromRelabelMetricNative>());
+    RegisterProcessorCreator(new StaticProcessorCreator<ProcessorAggregateMetricNative>());
 #if defined(__linux__) && !defined(__ANDROID__) && !defined(__EXCLUDE_SPL__)
     if (BOOL_FLAG(enable_processor_spl)) {
         RegisterProcessorCreator(new StaticProcessorCreator<ProcessorSPL>());
@@ -62,4 +62,13 @@ void ProcessorInstance::Process(vector<PipelineEventGroup>& eventGroupList) {
     }
 }
 
+void ProcessorInstance::Flush(vector<PipelineEventGroup>& eventGroupList, bool force) {
+    auto size = eventGroupList.size();
+    mPlugin->Flush(eventGroupList, force);
+    for (auto i = size; i < eventGroupList.size(); ++i) {
+        ADD_COUNTER(mOutEventsTotal, eventGroupList[i].GetEvents().size());
+        ADD_COUNTER(mOutSizeBytes, eventGroupList[i].DataSize());
+    }
+}
+
 } // namespace logtail
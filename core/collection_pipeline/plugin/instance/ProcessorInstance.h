@@ -36,6 +36,7 @@ public:
 
     bool Init(const Json::Value& config, CollectionPipelineContext& context);
     void Process(std::vector<PipelineEventGroup>& logGroupList);
+    void Flush(std::vector<PipelineEventGroup>& logGroupList, bool force);
 
 private:
     std::unique_ptr<Processor> mPlugin;
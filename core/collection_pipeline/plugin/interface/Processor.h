@@ -30,6 +30,9 @@ public:
 
     virtual bool Init(const Json::Value& config) = 0;
     virtual void Process(std::vector<PipelineEventGroup>& logGroupList);
+    // For processors holding events across event groups, e.g. aggregators: append the groups that are due to be sent,
+    // or all held groups if force is true.
+    virtual void Flush(std::vector<PipelineEventGroup>& logGroupList, bool force) {}
 
 protected:
     virtual bool IsSupportedEvent(const PipelineEventPtr& e) const = 0;
@@ -45,6 +45,7 @@ public:
 
     void DisablePop() { mValidToPop = false; }
     void EnablePop() { mValidToPop = true; }
+    bool IsPopEnabled() const { return mValidToPop; }
 
     void Reset() { mDownStreamQueues.clear(); }
 
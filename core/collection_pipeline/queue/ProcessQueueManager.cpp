@@ -14,6 +14,7 @@
 
 #include "collection_pipeline/queue/ProcessQueueManager.h"
 
+#include "collection_pipeline/CollectionPipelineManager.h"
 #include "collection_pipeline/queue/BoundedProcessQueue.h"
 #include "collection_pipeline/queue/CircularProcessQueue.h"
 #include "collection_pipeline/queue/ExactlyOnceQueueManager.h"
@@ -257,6 +258,35 @@ void ProcessQueueManager::EnablePop(const string& configName) {
     }
 }
 
+shared_ptr<CollectionPipeline> ProcessQueueManager::AddPipelineInProcessCnt(const string& configName) {
+    // taken under the queue lock and only when pop is enabled, like the count of popped items, so that it is never
+    // taken after DisablePop returns and CollectionPipeline::Stop starts waiting for the items in process
+    auto addCnt = [&configName]() -> shared_ptr<CollectionPipeline> {
+        auto p = CollectionPipelineManager::GetInstance()->FindConfigByName(configName);
+        if (p) {
+            p->AddInProcessCnt();
+        }
+        return p;
+    };
+    if (QueueKeyManager::GetInstance()->HasKey(configName)) {
+        auto key = QueueKeyManager::GetInstance()->GetKey(configName);
+        lock_guard<mutex> lock(mQueueMux);
+        auto iter = mQueues.find(key);
+        if (iter == mQueues.end() || !(*iter->second.first)->IsPopEnabled()) {
+            return nullptr;
+        }
+        return addCnt();
+    }
+    auto* eoMgr = ExactlyOnceQueueManager::GetInstance();
+    lock_guard<mutex> lock(eoMgr->mProcessQueueMux);
+    for (const auto& iter : eoMgr->mProcessQueues) {
+        if (iter.second->GetConfigName() == configName && iter.second->IsPopEnabled()) {
+            return addCnt();
+        }
+    }
+    return nullptr;
+}
+
 bool ProcessQueueManager::Wait(uint64_t ms) {
     // TODO: use semaphore instead
     unique_lock<mutex> lock(mStateMux);
@@ -68,6 +68,8 @@ public:
     bool SetFeedbackInterface(QueueKey key, std::vector<FeedbackInterface*>&& feedback);
     void DisablePop(const std::string& configName, bool isPipelineRemoving);
     void EnablePop(const std::string& configName);
+    // count work not popped from the queues, e.g. processor flushes, as in process the same way as popped items
+    std::shared_ptr<CollectionPipeline> AddPipelineInProcessCnt(const std::string& configName);
 
     bool Wait(uint64_t ms);
     void Trigger();
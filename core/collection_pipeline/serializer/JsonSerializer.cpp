@@ -14,20 +14,18 @@
 
 #include "collection_pipeline/serializer/JsonSerializer.h"
 
-#include "rapidjson/stringbuffer.h"
-#include "rapidjson/writer.h"
+#include "common/JsonWriter.h"
 
 using namespace std;
 
 namespace logtail {
 
 // Helper function to serialize common fields (tags and time)
-template <typename WriterType>
-void SerializeCommonFields(const SizedMap& tags, uint64_t timestamp, WriterType& writer) {
+static void SerializeCommonFields(const SizedMap& tags, uint64_t timestamp, JsonWriter& writer) {
     // Serialize tags
     for (const auto& tag : tags.mInner) {
-        writer.Key(tag.first.to_string().c_str());
-        writer.String(tag.second.to_string().c_str());
+        writer.Key(tag.first);
+        writer.String(tag.second);
     }
     // Serialize time
     writer.Key("__time__");
@@ -50,13 +48,8 @@ bool JsonEventGroupSerializer::Serialize(BatchedEvents&& group, string& res, str
         return false;
     }
 
-    // Create reusable StringBuffer and Writer
-    rapidjson::StringBuffer jsonBuffer;
-    rapidjson::Writer<rapidjson::StringBuffer> writer(jsonBuffer);
-    auto resetBuffer = [&jsonBuffer, &writer]() {
-        jsonBuffer.Clear(); // Clear the buffer for reuse
-        writer.Reset(jsonBuffer);
-    };
+    // events are written directly into res, one json object per line
+    JsonWriter writer(res);
 
     // TODO: should support nano second
     switch (eventType) {
@@ -66,18 +59,15 @@ bool JsonEventGroupSerializer::Serialize(BatchedEvents&& group, string& res, str
                 if (e.Empty()) {
                     continue;
                 }
-                resetBuffer();
-
                 writer.StartObject();
                 SerializeCommonFields(group.mTags, e.GetTimestamp(), writer);
                 // contents
                 for (const auto& kv : e) {
-                    writer.Key(kv.first.to_string().c_str());
-                    writer.String(kv.second.to_string().c_str());
+                    writer.Key(kv.first);
+                    writer.String(kv.second);
                 }
                 writer.EndObject();
-                res.append(jsonBuffer.GetString());
-                res.append("\n");
+                res.push_back('\n');
             }
             break;
         case PipelineEvent::Type::METRIC:
@@ -87,21 +77,19 @@ bool JsonEventGroupSerializer::Serialize(BatchedEvents&& group, string& res, str
                 if (e.Is<std::monostate>()) {
                     continue;
                 }
-                resetBuffer();
-
                 writer.StartObject();
                 SerializeCommonFields(group.mTags, e.GetTimestamp(), writer);
                 // __labels__
                 writer.Key("__labels__");
                 writer.StartObject();
                 for (auto tag = e.TagsBegin(); tag != e.TagsEnd(); tag++) {
-                    writer.Key(tag->first.to_string().c_str());
-                    writer.String(tag->second.to_string().c_str());
+                    writer.Key(tag->first);
+                    writer.String(tag->second);
                 }
                 writer.EndObject();
                 // __name__
                 writer.Key("__name__");
-                writer.String(e.GetName().to_string().c_str());
+                writer.String(e.GetName());
                 // __value__
                 writer.Key("__value__");
                 if (e.Is<UntypedSingleValue>()) {
@@ -111,14 +99,13 @@ bool JsonEventGroupSerializer::Serialize(BatchedEvents&& group, string& res, str
                     for (auto value = e.GetValue<UntypedMultiDoubleValues>()->ValuesBegin();
                          value != e.GetValue<UntypedMultiDoubleValues>()->ValuesEnd();
                          value++) {
-                        writer.Key(value->first.to_string().c_str());
+                        writer.Key(value->first);
                         writer.Double(value->second.Value);
                     }
                     writer.EndObject();
                 }
                 writer.EndObject();
-                res.append(jsonBuffer.GetString());
-                res.append("\n");
+                res.push_back('\n');
             }
             break;
         case PipelineEvent::Type::RAW:
@@ -127,16 +114,13 @@ bool JsonEventGroupSerializer::Serialize(BatchedEvents&& group, string& res, str
                 if (e.GetContent().empty()) {
                     continue;
                 }
-                resetBuffer();
-
                 writer.StartObject();
                 SerializeCommonFields(group.mTags, e.GetTimestamp(), writer);
                 // content
-                writer.Key(DEFAULT_CONTENT_KEY.c_str());
-                writer.String(e.GetContent().to_string().c_str());
+                writer.Key(DEFAULT_CONTENT_KEY);
+                writer.String(e.GetContent());
                 writer.EndObject();
-                res.append(jsonBuffer.GetString());
-                res.append("\n");
+                res.push_back('\n');
             }
             break;
         default:
@@ -15,11 +15,11 @@
 #include "collection_pipeline/serializer/SLSSerializer.h"
 
 #include <array>
-
-#include "json/json.h"
+#include <charconv>
 
 #include "collection_pipeline/serializer/JsonSerializer.h"
 #include "common/Flags.h"
+#include "common/JsonWriter.h"
 #include "common/compression/CompressType.h"
 #include "constants/SpanConstants.h"
 #include "plugin/flusher/sls/FlusherSLS.h"
@@ -33,27 +33,98 @@ using namespace std;
 
 namespace logtail {
 
-std::string SerializeSpanLinksToString(const SpanEvent& event) {
+// the reusable span content buffer of a thread is released after use once it grows beyond this
+static constexpr size_t kMaxRetainedSpanContentBufferSize = 1024 * 1024;
+
+// Attributes are the union of tags and scope tags in ascending key order, where scope tags take precedence.
+void SerializeSpanAttributesToString(const SpanEvent& event, std::string& out) {
+    if (event.TagsSize() == 0 && event.ScopeTagsSize() == 0) {
+        // keep the same output as an empty Json::Value
+        out.append("null");
+        return;
+    }
+    JsonWriter writer(out);
+    writer.StartObject();
+    auto tag = event.TagsBegin();
+    auto scopeTag = event.ScopeTagsBegin();
+    while (tag != event.TagsEnd() || scopeTag != event.ScopeTagsEnd()) {
+        if (scopeTag == event.ScopeTagsEnd() || (tag != event.TagsEnd() && tag->first < scopeTag->first)) {
+            writer.Key(tag->first);
+            writer.String(tag->second);
+            ++tag;
+        } else {
+            if (tag != event.TagsEnd() && tag->first == scopeTag->first) {
+                ++tag;
+            }
+            writer.Key(scopeTag->first);
+            writer.String(scopeTag->second);
+            ++scopeTag;
+        }
+    }
+    writer.EndObject();
+}
+
+template <typename T>
+static void SerializeTagsToJson(const T& item, JsonWriter& writer) {
+    writer.Key(DEFAULT_TRACE_TAG_ATTRIBUTES);
+    writer.StartObject();
+    for (auto it = item.TagsBegin(); it != item.TagsEnd(); ++it) {
+        writer.Key(it->first);
+        writer.String(it->second);
+    }
+    writer.EndObject();
+}
+
+// keys are written in ascending order, the same as SpanLink::ToJson
+void SerializeSpanLinksToString(const SpanEvent& event, std::string& out) {
     if (event.GetLinks().empty()) {
-        return "";
+        return;
     }
-    Json::Value jsonLinks(Json::arrayValue);
+    JsonWriter writer(out);
+    writer.StartArray();
     for (const auto& link : event.GetLinks()) {
-        jsonLinks.append(link.ToJson());
+        writer.StartObject();
+        if (link.TagsSize() > 0) {
+            SerializeTagsToJson(link, writer);
+        }
+        writer.Key(DEFAULT_TRACE_TAG_SPAN_ID);
+        writer.String(link.GetSpanId());
+        writer.Key(DEFAULT_TRACE_TAG_TRACE_ID);
+        writer.String(link.GetTraceId());
+        if (!link.GetTraceState().empty()) {
+            writer.Key(DEFAULT_TRACE_TAG_TRACE_STATE);
+            writer.String(link.GetTraceState());
+        }
+        writer.EndObject();
     }
-    Json::StreamWriterBuilder writer;
-    return Json::writeString(writer, jsonLinks);
+    writer.EndArray();
 }
-std::string SerializeSpanEventsToString(const SpanEvent& event) {
+
+// keys are written in ascending order, the same as InnerEvent::ToJson
+void SerializeSpanEventsToString(const SpanEvent& event, std::string& out) {
     if (event.GetEvents().empty()) {
-        return "";
+        return;
     }
-    Json::Value jsonEvents(Json::arrayValue);
-    for (const auto& event : event.GetEvents()) {
-        jsonEvents.append(event.ToJson());
+    JsonWriter writer(out);
+    writer.StartArray();
+    for (const auto& innerEvent : event.GetEvents()) {
+        writer.StartObject();
+        if (innerEvent.TagsSize() > 0) {
+            SerializeTagsToJson(innerEvent, writer);
+        }
+        writer.Key(DEFAULT_TRACE_TAG_SPAN_EVENT_NAME);
+        writer.String(innerEvent.GetName());
+        writer.Key(DEFAULT_TRACE_TAG_TIMESTAMP);
+        writer.Int64(static_cast<int64_t>(innerEvent.GetTimestampNs()));
+        writer.EndObject();
     }
-    Json::StreamWriterBuilder writer;
-    return Json::writeString(writer, jsonEvents);
+    writer.EndArray();
+}
+
+static void AppendUint64(std::string& out, uint64_t v) {
+    char buf[24];
+    auto res = to_chars(buf, buf + sizeof(buf), v);
+    out.append(buf, res.ptr - buf);
 }
 
 template <>
@@ -99,7 +170,17 @@ bool SLSEventGroupSerializer::Serialize(BatchedEvents&& group, string& res, stri
     // caculate serialized logGroup size first, where some critical results can be cached
     vector<size_t> logSZ(group.mEvents.size());
     vector<pair<string, size_t>> metricEventContentCache(group.mEvents.size());
-    vector<array<string, 6>> spanEventContentCache(group.mEvents.size());
+    // span contents are serialized into one reusable buffer and referred to by offsets, since the buffer may grow
+    thread_local string spanContentBuffer;
+    // the buffer only grows, so that one large batch would otherwise pin its memory in every serializer thread
+    struct SpanContentBufferTrimmer {
+        ~SpanContentBufferTrimmer() {
+            if (spanContentBuffer.capacity() > kMaxRetainedSpanContentBufferSize) {
+                string().swap(spanContentBuffer);
+            }
+        }
+    } spanContentBufferTrimmer;
+    vector<array<pair<size_t, size_t>, 6>> spanContentRanges;
     size_t logGroupSZ = 0;
     switch (eventType) {
         case PipelineEvent::Type::LOG: {
@@ -148,6 +229,8 @@ bool SLSEventGroupSerializer::Serialize(BatchedEvents&& group, string& res, stri
             break;
         }
         case PipelineEvent::Type::SPAN:
+            spanContentBuffer.clear();
+            spanContentRanges.resize(group.mEvents.size());
             for (size_t i = 0; i < group.mEvents.size(); ++i) {
                 const auto& e = group.mEvents[i].Cast<SpanEvent>();
                 size_t contentSZ = 0;
@@ -160,35 +243,28 @@ bool SLSEventGroupSerializer::Serialize(BatchedEvents&& group, string& res, stri
                     += GetLogContentSize(DEFAULT_TRACE_TAG_STATUS_CODE.size(), GetStatusString(e.GetStatus()).size());
                 contentSZ += GetLogContentSize(DEFAULT_TRACE_TAG_TRACE_STATE.size(), e.GetTraceState().size());
 
+                auto& ranges = spanContentRanges[i];
+                auto appendContent = [&](size_t idx, const string& key, auto&& serialize) {
+                    size_t begin = spanContentBuffer.size();
+                    serialize();
+                    ranges[idx] = {begin, spanContentBuffer.size() - begin};
+                    contentSZ += GetLogContentSize(key.size(), ranges[idx].second);
+                };
                 // set tags and scope tags
-                Json::Value jsonVal;
-                for (auto it = e.TagsBegin(); it != e.TagsEnd(); ++it) {
-                    jsonVal[it->first.to_string()] = it->second.to_string();
-                }
-                for (auto it = e.ScopeTagsBegin(); it != e.ScopeTagsEnd(); ++it) {
-                    jsonVal[it->first.to_string()] = it->second.to_string();
-                }
-                Json::StreamWriterBuilder writer;
-                std::string attrString = Json::writeString(writer, jsonVal);
-                contentSZ += GetLogContentSize(DEFAULT_TRACE_TAG_ATTRIBUTES.size(), attrString.size());
-                spanEventContentCache[i][0] = std::move(attrString);
-                auto linkString = SerializeSpanLinksToString(e);
-                contentSZ += GetLogContentSize(DEFAULT_TRACE_TAG_LINKS.size(), linkString.size());
-                spanEventContentCache[i][1] = std::move(linkString);
-                auto eventString = SerializeSpanEventsToString(e);
-                contentSZ += GetLogContentSize(DEFAULT_TRACE_TAG_EVENTS.size(), eventString.size());
-                spanEventContentCache[i][2] = std::move(eventString);
+                appendContent(
+                    0, DEFAULT_TRACE_TAG_ATTRIBUTES, [&]() { SerializeSpanAttributesToString(e, spanContentBuffer); });
+                appendContent(1, DEFAULT_TRACE_TAG_LINKS, [&]() { SerializeSpanLinksToString(e, spanContentBuffer); });
+                appendContent(2, DEFAULT_TRACE_TAG_EVENTS, [&]() { SerializeSpanEventsToString(e, spanContentBuffer); });
 
                 // time related
-                auto startTsNs = std::to_string(e.GetStartTimeNs());
-                contentSZ += GetLogContentSize(DEFAULT_TRACE_TAG_START_TIME_NANO.size(), startTsNs.size());
-                spanEventContentCache[i][3] = std::move(startTsNs);
-                auto endTsNs = std::to_string(e.GetEndTimeNs());
-                contentSZ += GetLogContentSize(DEFAULT_TRACE_TAG_END_TIME_NANO.size(), endTsNs.size());
-                spanEventContentCache[i][4] = std::move(endTsNs);
-                auto durationNs = std::to_string(e.GetEndTimeNs() - e.GetStartTimeNs());
-                contentSZ += GetLogContentSize(DEFAULT_TRACE_TAG_DURATION.size(), durationNs.size());
-                spanEventContentCache[i][5] = std::move(durationNs);
+                appendContent(3, DEFAULT_TRACE_TAG_START_TIME_NANO, [&]() {
+                    AppendUint64(spanContentBuffer, e.GetStartTimeNs());
+                });
+                appendContent(
+                    4, DEFAULT_TRACE_TAG_END_TIME_NANO, [&]() { AppendUint64(spanContentBuffer, e.GetEndTimeNs()); });
+                appendContent(5, DEFAULT_TRACE_TAG_DURATION, [&]() {
+                    AppendUint64(spanContentBuffer, e.GetEndTimeNs() - e.GetStartTimeNs());
+                });
                 logGroupSZ += GetLogSize(contentSZ, false, logSZ[i]);
             }
             break;
@@ -276,17 +352,21 @@ bool SLSEventGroupSerializer::Serialize(BatchedEvents&& group, string& res, stri
                 // trace state
                 serializer.AddLogContent(DEFAULT_TRACE_TAG_TRACE_STATE, spanEvent.GetTraceState());
 
-                serializer.AddLogContent(DEFAULT_TRACE_TAG_ATTRIBUTES, spanEventContentCache[i][0]);
+                const auto& ranges = spanContentRanges[i];
+                auto content = [&](size_t idx) {
+                    return StringView(spanContentBuffer.data() + ranges[idx].first, ranges[idx].second);
+                };
+                serializer.AddLogContent(DEFAULT_TRACE_TAG_ATTRIBUTES, content(0));
 
-                serializer.AddLogContent(DEFAULT_TRACE_TAG_LINKS, spanEventContentCache[i][1]);
-                serializer.AddLogContent(DEFAULT_TRACE_TAG_EVENTS, spanEventContentCache[i][2]);
+                serializer.AddLogContent(DEFAULT_TRACE_TAG_LINKS, content(1));
+                serializer.AddLogContent(DEFAULT_TRACE_TAG_EVENTS, content(2));
 
                 // start_time
-                serializer.AddLogContent(DEFAULT_TRACE_TAG_START_TIME_NANO, spanEventContentCache[i][3]);
+                serializer.AddLogContent(DEFAULT_TRACE_TAG_START_TIME_NANO, content(3));
                 // end_time
-                serializer.AddLogContent(DEFAULT_TRACE_TAG_END_TIME_NANO, spanEventContentCache[i][4]);
+                serializer.AddLogContent(DEFAULT_TRACE_TAG_END_TIME_NANO, content(4));
                 // duration
-                serializer.AddLogContent(DEFAULT_TRACE_TAG_DURATION, spanEventContentCache[i][5]);
+                serializer.AddLogContent(DEFAULT_TRACE_TAG_DURATION, content(5));
             }
             break;
         case PipelineEvent::Type::RAW:
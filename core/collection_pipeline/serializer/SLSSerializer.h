@@ -20,9 +20,15 @@
 #include <vector>
 
 #include "collection_pipeline/serializer/Serializer.h"
+#include "models/SpanEvent.h"
 
 namespace logtail {
 
+// Append the json text of span attributes, links and events to out respectively.
+void SerializeSpanAttributesToString(const SpanEvent& event, std::string& out);
+void SerializeSpanLinksToString(const SpanEvent& event, std::string& out);
+void SerializeSpanEventsToString(const SpanEvent& event, std::string& out);
+
 class SLSEventGroupSerializer : public Serializer<BatchedEvents> {
 public:
     SLSEventGroupSerializer(Flusher* f) : Serializer<BatchedEvents>(f) {}
@@ -26,6 +26,8 @@ namespace logtail {
 // TODO: Same implementation in sdk module, merge them.
 void DoMd5(const uint8_t* poolIn, const uint64_t inputBytesNum, uint8_t md5[16]);
 std::string CalcMD5(const std::string& message);
+// Hash(string(@data, @size)) => 32 upper case hex chars written to @out, same as CalcMD5 but allocation free.
+void CalcMD5(const char* data, size_t size, char out[32]);
 
 bool SignatureToHash(const std::string& signature, uint64_t& sigHash, uint32_t& sigSize);
 bool CheckAndUpdateSignature(const std::string& signature, uint64_t& sigHash, uint32_t& sigSize);
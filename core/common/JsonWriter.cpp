@@ -0,0 +1,133 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/JsonWriter.h"
+
+#include <cmath>
+#include <cstring>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "rapidjson/internal/dtoa.h"
+
+using namespace std;
+
+namespace logtail {
+
+static inline bool NeedEscape(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+// Returns the position of the first byte that needs escaping, or n if there is none. Most strings contain nothing to
+// escape, so bytes are checked 16 (SSE2) or 8 (SWAR) at a time.
+static size_t FindEscape(const char* p, size_t n) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i ctrlMax = _mm_set1_epi8(0x1F);
+    for (; i + 16 <= n; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        // unsigned v <= 0x1F iff max(v, 0x1F) == 0x1F
+        __m128i ctrl = _mm_cmpeq_epi8(_mm_max_epu8(v, ctrlMax), ctrlMax);
+        __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)), ctrl);
+        int mask = _mm_movemask_epi8(hit);
+        if (mask != 0) {
+            return i + __builtin_ctz(mask);
+        }
+    }
+#else
+    constexpr uint64_t kOnes = 0x0101010101010101ULL;
+    constexpr uint64_t kHighs = 0x8080808080808080ULL;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        memcpy(&w, p + i, sizeof(w));
+        uint64_t q = w ^ (kOnes * '"');
+        uint64_t b = w ^ (kOnes * '\\');
+        // exact tests for any zero byte in q or b, and any byte less than 0x20 in w
+        uint64_t hit = ((q - kOnes) & ~q) | ((b - kOnes) & ~b) | ((w - kOnes * 0x20) & ~w);
+        if ((hit & kHighs) != 0) {
+            break;
+        }
+    }
+#endif
+    for (; i < n; ++i) {
+        if (NeedEscape(static_cast<unsigned char>(p[i]))) {
+            return i;
+        }
+    }
+    return n;
+}
+
+void AppendJsonString(string& out, StringView s) {
+    static const char kHexDigits[] = "0123456789ABCDEF";
+    out.push_back('"');
+    const char* p = s.data();
+    size_t n = s.size();
+    while (n > 0) {
+        size_t pos = FindEscape(p, n);
+        out.append(p, pos);
+        if (pos == n) {
+            break;
+        }
+        unsigned char c = static_cast<unsigned char>(p[pos]);
+        switch (c) {
+            case '"':
+                out.append("\\\"");
+                break;
+            case '\\':
+                out.append("\\\\");
+                break;
+            case '\b':
+                out.append("\\b");
+                break;
+            case '\f':
+                out.append("\\f");
+                break;
+            case '\n':
+                out.append("\\n");
+                break;
+            case '\r':
+                out.append("\\r");
+                break;
+            case '\t':
+                out.append("\\t");
+                break;
+            default: {
+                char buf[6] = {'\\', 'u', '0', '0', kHexDigits[c >> 4], kHexDigits[c & 0xF]};
+                out.append(buf, sizeof(buf));
+                break;
+            }
+        }
+        p += pos + 1;
+        n -= pos + 1;
+    }
+    out.push_back('"');
+}
+
+void JsonWriter::Double(double v) {
+    Prefix();
+    if (!std::isfinite(v)) {
+        mOut.append("null");
+        return;
+    }
+    char buf[32];
+    char* end = rapidjson::internal::dtoa(v, buf);
+    mOut.append(buf, end - buf);
+}
+
+} // namespace logtail
@@ -0,0 +1,125 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <charconv>
+#include <string>
+
+#include "common/StringView.h"
+
+namespace logtail {
+
+// Append s to out as a quoted json string. Escaping is compatible with rapidjson::Writer, i.e., only quotation mark,
+// reverse solidus and control characters are escaped.
+void AppendJsonString(std::string& out, StringView s);
+
+// Streaming writer which appends compact json text directly to a buffer owned by the caller. Unlike Json::Value or
+// rapidjson::Document, no intermediate tree is built, so the same buffer can be reused across events without any
+// allocation once it has grown large enough. Top-level values are written one after another without any separator,
+// so that the writer can be used for json lines. Nesting depth is limited to 64.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) : mOut(out) {}
+
+    void StartObject() {
+        Prefix();
+        mOut.push_back('{');
+        Push();
+    }
+    void EndObject() {
+        Pop();
+        mOut.push_back('}');
+    }
+    void StartArray() {
+        Prefix();
+        mOut.push_back('[');
+        Push();
+    }
+    void EndArray() {
+        Pop();
+        mOut.push_back(']');
+    }
+    void Key(StringView key) {
+        Prefix();
+        AppendJsonString(mOut, key);
+        mOut.push_back(':');
+        mAfterKey = true;
+    }
+    void String(StringView s) {
+        Prefix();
+        AppendJsonString(mOut, s);
+    }
+    void Int64(int64_t v) {
+        Prefix();
+        AppendInteger(v);
+    }
+    void Uint64(uint64_t v) {
+        Prefix();
+        AppendInteger(v);
+    }
+    // NaN and infinity are written as null, since they are not valid json numbers.
+    void Double(double v);
+    void Bool(bool v) {
+        Prefix();
+        mOut.append(v ? "true" : "false");
+    }
+    void Null() {
+        Prefix();
+        mOut.append("null");
+    }
+
+    std::string& GetOutput() { return mOut; }
+
+private:
+    void Prefix() {
+        if (mAfterKey) {
+            mAfterKey = false;
+            return;
+        }
+        if (mHasElement && mDepth > 0) {
+            mOut.push_back(',');
+        }
+        mHasElement = true;
+    }
+    void Push() {
+        mLevels = (mLevels << 1) | static_cast<uint64_t>(mHasElement);
+        mHasElement = false;
+        ++mDepth;
+    }
+    void Pop() {
+        mHasElement = mLevels & 1;
+        mLevels >>= 1;
+        --mDepth;
+    }
+    template <typename T>
+    void AppendInteger(T v) {
+        char buf[24];
+        auto res = std::to_chars(buf, buf + sizeof(buf), v);
+        mOut.append(buf, res.ptr - buf);
+    }
+
+    std::string& mOut;
+    // one bit per enclosing level, indicating whether the level already has an element
+    uint64_t mLevels = 0;
+    uint32_t mDepth = 0;
+    bool mHasElement = false;
+    bool mAfterKey = false;
+};
+
+} // namespace logtail
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2025 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "common/LRUCache.h"
+
+namespace logtail {
+
+// An lru11::Cache split into independently locked shards, so that lookups of different keys from many threads rarely
+// contend on the same mutex. Recency is tracked per shard, hence eviction is only approximately LRU across the whole
+// cache and the size bound is rounded up to a multiple of the shard count.
+template <typename Key, typename Value, size_t ShardBits = 4, typename Hash = std::hash<Key>>
+class ShardedLRUCache {
+    static_assert(ShardBits > 0 && ShardBits < 16, "shard bits out of range");
+
+public:
+    static constexpr size_t kShardCount = 1 << ShardBits;
+
+    explicit ShardedLRUCache(size_t maxSize = 64, size_t elasticity = 10) {
+        for (auto& shard : mShards) {
+            shard = std::make_unique<Shard>(std::max<size_t>(1, perShard(maxSize)), perShard(elasticity));
+        }
+    }
+    ShardedLRUCache(const ShardedLRUCache&) = delete;
+    ShardedLRUCache& operator=(const ShardedLRUCache&) = delete;
+
+    size_t size() const {
+        size_t total = 0;
+        for (const auto& shard : mShards) {
+            total += shard->mCache.size();
+        }
+        return total;
+    }
+    bool empty() const { return size() == 0; }
+    void clear() {
+        for (auto& shard : mShards) {
+            shard->mCache.clear();
+        }
+    }
+
+    void insert(const Key& k, Value v) { getShard(k).insert(k, std::move(v)); }
+    bool tryGetCopy(const Key& k, Value& vOut) { return getShard(k).tryGetCopy(k, vOut); }
+    bool remove(const Key& k) { return getShard(k).remove(k); }
+    bool contains(const Key& k) const { return getShard(k).contains(k); }
+
+    size_t getMaxSize() const { return mShards[0]->mCache.getMaxSize() * kShardCount; }
+
+private:
+    struct alignas(64) Shard {
+        Shard(size_t maxSize, size_t elasticity) : mCache(maxSize, elasticity) {}
+        lru11::Cache<Key, Value, std::mutex> mCache;
+    };
+
+    static size_t perShard(size_t total) { return (total + kShardCount - 1) / kShardCount; }
+    // the maps of the shards bucket keys by the same hash, so the shard is picked by the high bits of the mixed hash
+    static size_t shardIndex(const Key& k) {
+        return (static_cast<uint64_t>(Hash()(k)) * 0x9E3779B97F4A7C15ULL) >> (64 - ShardBits);
+    }
+    lru11::Cache<Key, Value, std::mutex>& getShard(const Key& k) { return mShards[shardIndex(k)]->mCache; }
+    const lru11::Cache<Key, Value, std::mutex>& getShard(const Key& k) const { return mShards[shardIndex(k)]->mCache; }
+
+    std::array<std::unique_ptr<Shard>, kShardCount> mShards;
+};
+
+} // namespace logtail
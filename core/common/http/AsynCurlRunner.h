@@ -59,6 +59,7 @@ private:
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class HttpRequestTimerEventUnittest;
+    friend class PromAsynUnittest;
 #endif
 };
 
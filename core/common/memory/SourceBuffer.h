@@ -18,6 +18,8 @@
 
 #include <list>
 #include <memory>
+#include <unordered_set>
+#include <vector>
 
 #include "common/StringView.h"
 
@@ -167,10 +169,22 @@ public:
     StringBuffer CopyString(const std::string& s) { return CopyString(s.data(), s.length()); }
     StringBuffer CopyString(StringView s) { return CopyString(s.data(), s.length()); }
 
+    // Keep object alive as long as the buffer, for views pointing into memory owned by someone else. Each object is
+    // held once no matter how many times it is retained.
+    void Retain(std::shared_ptr<const void> object) { mRetained.insert(std::move(object)); }
+
+    // Invalidate all buffers allocated before, keeping the first chunk for reuse.
+    void Reset() {
+        mAllocator.Reset();
+        mRetained.clear();
+    }
+
 private:
     BufferAllocator mAllocator;
+    std::unordered_set<std::shared_ptr<const void>> mRetained;
 
 #ifdef APSARA_UNIT_TEST_MAIN
+    friend class SourceBufferUnittest;
     friend class LogEventUnittest;
     friend class PipelineEventGroupUnittest;
 #endif
@@ -14,8 +14,15 @@
 
 #include "common/timer/Timer.h"
 
+#include <algorithm>
+
+#include "common/Flags.h"
 #include "logger/Logger.h"
 
+DEFINE_FLAG_INT32(timer_worker_thread_num,
+                  "number of threads executing expired timer events, 0 means executing them in the timer thread",
+                  0);
+
 using namespace std;
 
 namespace logtail {
@@ -32,6 +39,11 @@ void Timer::Init() {
         }
         mIsThreadRunning = true;
     }
+    // the pool is kept if the timer thread of the last run was not stopped in time
+    if (!mWorkers && INT32_FLAG(timer_worker_thread_num) > 0) {
+        mWorkers = make_unique<ThreadPool>(INT32_FLAG(timer_worker_thread_num));
+        mWorkers->Start();
+    }
     mThreadRes = async(launch::async, &Timer::Run, this);
 }
 
@@ -43,66 +55,223 @@ void Timer::Stop() {
         }
         mIsThreadRunning = false;
     }
-    mCV.notify_one();
-    if (!mThreadRes.valid()) {
-        return;
+    {
+        lock_guard<mutex> lock(mQueueMux);
+        mCV.notify_all();
+    }
+    if (mThreadRes.valid()) {
+        future_status s = mThreadRes.wait_for(chrono::seconds(1));
+        if (s == future_status::ready) {
+            LOG_INFO(sLogger, ("timer", "stopped successfully"));
+        } else {
+            LOG_WARNING(sLogger, ("timer", "forced to stopped"));
+            // the timer thread may still be dispatching events to the pool
+            return;
+        }
     }
-    future_status s = mThreadRes.wait_for(chrono::seconds(1));
-    if (s == future_status::ready) {
-        LOG_INFO(sLogger, ("timer", "stopped successfully"));
-    } else {
-        LOG_WARNING(sLogger, ("timer", "forced to stopped"));
+    if (mWorkers) {
+        mWorkers->Stop();
+        mWorkers.reset();
     }
 }
 
-void Timer::PushEvent(unique_ptr<TimerEvent>&& e) {
+uint64_t Timer::PushEvent(unique_ptr<TimerEvent>&& e) {
+    uint64_t tick = ToTick(e->GetExecTime());
     lock_guard<mutex> lock(mQueueMux);
-    if (mQueue.empty() || e->GetExecTime() < mQueue.top()->GetExecTime()) {
-        mQueue.push(std::move(e));
+    Slot tmp;
+    auto it = tmp.emplace(tmp.end());
+    it->mEvent = std::move(e);
+    it->mId = ++mNextId;
+    it->mExpireTick = max(tick, mCurrentTick + 1);
+    mEvents.emplace(it->mId, it);
+    Place(tmp, it);
+    if (it->mExpireTick < mWakeUpTick) {
+        mWakeUpTick = it->mExpireTick;
         mCV.notify_one();
-    } else {
-        mQueue.push(std::move(e));
     }
+    return it->mId;
+}
+
+bool Timer::Cancel(uint64_t id) {
+    unique_ptr<TimerEvent> e;
+    {
+        lock_guard<mutex> lock(mQueueMux);
+        auto it = mEvents.find(id);
+        if (it == mEvents.end()) {
+            return false;
+        }
+        auto nodeIt = it->second;
+        e = std::move(nodeIt->mEvent);
+        mWheels[nodeIt->mLevel][nodeIt->mSlot].erase(nodeIt);
+        mEvents.erase(it);
+    }
+    // the event is destructed out of the lock
+    return true;
+}
+
+size_t Timer::Size() const {
+    lock_guard<mutex> lock(mQueueMux);
+    return mEvents.size();
 }
 
 void Timer::Run() {
     LOG_INFO(sLogger, ("timer", "started"));
-    unique_lock<mutex> threadLock(mThreadRunningMux);
-    while (mIsThreadRunning) {
-        unique_lock<mutex> queueLock(mQueueMux);
-        if (mQueue.empty()) {
+    unique_lock<mutex> queueLock(mQueueMux);
+    while (true) {
+        {
+            lock_guard<mutex> lock(mThreadRunningMux);
+            if (!mIsThreadRunning) {
+                break;
+            }
+        }
+        vector<unique_ptr<TimerEvent>> expired;
+        auto nowTick = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - mStartTime).count();
+        Advance(static_cast<uint64_t>(max<int64_t>(nowTick, 0)), expired);
+        if (!expired.empty()) {
             queueLock.unlock();
-            mCV.wait(threadLock, [this]() { return !mIsThreadRunning || !mQueue.empty(); });
+            for (auto& e : expired) {
+                Dispatch(std::move(e));
+            }
+            queueLock.lock();
+            continue;
+        }
+        mWakeUpTick = NextTick();
+        if (mWakeUpTick == UINT64_MAX) {
+            mCV.wait(queueLock);
         } else {
-            auto now = chrono::steady_clock::now();
-            while (!mQueue.empty()) {
-                auto& e = mQueue.top();
-                if (now < e->GetExecTime()) {
-                    auto timeout = e->GetExecTime() - now + chrono::milliseconds(1);
-                    queueLock.unlock();
-                    mCV.wait_for(threadLock, timeout);
-                    break;
-                } else {
-                    auto e = std::move(const_cast<unique_ptr<TimerEvent>&>(mQueue.top()));
-                    mQueue.pop();
-                    queueLock.unlock();
-                    if (!e->IsValid()) {
-                        LOG_INFO(sLogger, ("invalid timer event", "task is cancelled"));
-                    } else {
-                        e->Execute();
-                    }
-                    queueLock.lock();
-                }
+            mCV.wait_until(queueLock, ToTimePoint(mWakeUpTick));
+        }
+    }
+}
+
+uint64_t Timer::ToTick(chrono::steady_clock::time_point t) const {
+    if (t <= mStartTime) {
+        return 0;
+    }
+    // rounded up, so that an event never expires before its exec time
+    auto us = chrono::duration_cast<chrono::microseconds>(t - mStartTime).count();
+    return (us + 999) / 1000;
+}
+
+chrono::steady_clock::time_point Timer::ToTimePoint(uint64_t tick) const {
+    return mStartTime + chrono::milliseconds(tick);
+}
+
+void Timer::Place(Slot& from, Slot::iterator it) {
+    uint64_t delta = it->mExpireTick > mCurrentTick ? it->mExpireTick - mCurrentTick : 0;
+    size_t level = 0;
+    while (level + 1 < kLevelNum && delta >= (static_cast<uint64_t>(1) << (kSlotBits * (level + 1)))) {
+        ++level;
+    }
+    it->mLevel = level;
+    it->mSlot = (it->mExpireTick >> (kSlotBits * level)) & (kSlotNum - 1);
+    auto& to = mWheels[level][it->mSlot];
+    to.splice(to.end(), from, it);
+}
+
+void Timer::Cascade(size_t level, size_t slot) {
+    // nodes may be placed back to the same slot, so the slot is emptied first
+    Slot tmp;
+    tmp.splice(tmp.end(), mWheels[level][slot]);
+    while (!tmp.empty()) {
+        Place(tmp, tmp.begin());
+    }
+}
+
+uint64_t Timer::NextTick() const {
+    uint64_t next = UINT64_MAX;
+    for (size_t level = 0; level < kLevelNum; ++level) {
+        size_t shift = kSlotBits * level;
+        uint64_t base = mCurrentTick >> shift;
+        if (((base + 1) << shift) >= next) {
+            break;
+        }
+        for (size_t i = 1; i <= kSlotNum; ++i) {
+            if (!mWheels[level][(base + i) & (kSlotNum - 1)].empty()) {
+                next = min(next, (base + i) << shift);
+                break;
+            }
+        }
+    }
+    return next;
+}
+
+void Timer::Advance(uint64_t nowTick, vector<unique_ptr<TimerEvent>>& expired) {
+    while (mCurrentTick < nowTick) {
+        // idle ticks are skipped
+        uint64_t next = mEvents.empty() ? UINT64_MAX : NextTick();
+        if (next > nowTick) {
+            mCurrentTick = nowTick;
+            return;
+        }
+        mCurrentTick = next;
+        for (size_t level = 1; level < kLevelNum; ++level) {
+            size_t shift = kSlotBits * level;
+            if ((mCurrentTick & ((static_cast<uint64_t>(1) << shift) - 1)) != 0) {
+                break;
             }
+            Cascade(level, (mCurrentTick >> shift) & (kSlotNum - 1));
+        }
+        auto& slot = mWheels[0][mCurrentTick & (kSlotNum - 1)];
+        for (auto& node : slot) {
+            mEvents.erase(node.mId);
+            expired.emplace_back(std::move(node.mEvent));
+        }
+        slot.clear();
+    }
+}
+
+void Timer::Dispatch(unique_ptr<TimerEvent>&& e) {
+    if (!mWorkers) {
+        if (!e->IsValid()) {
+            LOG_INFO(sLogger, ("invalid timer event", "task is cancelled"));
+        } else {
+            e->Execute();
         }
+        return;
     }
+    shared_ptr<TimerEvent> event = std::move(e);
+    mWorkers->Add([event]() {
+        if (!event->IsValid()) {
+            LOG_INFO(sLogger, ("invalid timer event", "task is cancelled"));
+        } else {
+            event->Execute();
+        }
+    });
 }
 
 #ifdef APSARA_UNIT_TEST_MAIN
 void Timer::Clear() {
     lock_guard<mutex> lock(mQueueMux);
-    while (!mQueue.empty()) {
-        mQueue.pop();
+    for (auto& wheel : mWheels) {
+        for (auto& slot : wheel) {
+            slot.clear();
+        }
+    }
+    mEvents.clear();
+}
+
+const TimerEvent* Timer::Top() const {
+    lock_guard<mutex> lock(mQueueMux);
+    const TimerEvent* top = nullptr;
+    for (const auto& item : mEvents) {
+        const auto* e = item.second->mEvent.get();
+        if (top == nullptr || e->GetExecTime() < top->GetExecTime()) {
+            top = e;
+        }
+    }
+    return top;
+}
+
+void Timer::Pop() {
+    const auto* top = Top();
+    lock_guard<mutex> lock(mQueueMux);
+    for (auto it = mEvents.begin(); it != mEvents.end(); ++it) {
+        if (it->second->mEvent.get() == top) {
+            mWheels[it->second->mLevel][it->second->mSlot].erase(it->second);
+            mEvents.erase(it);
+            return;
+        }
     }
 }
 #endif
@@ -16,22 +16,25 @@
 
 #pragma once
 
+#include <array>
 #include <condition_variable>
+#include <cstdint>
 #include <future>
+#include <list>
 #include <memory>
 #include <mutex>
-#include <queue>
+#include <unordered_map>
 
+#include "common/ThreadPool.h"
 #include "common/timer/TimerEvent.h"
 
 namespace logtail {
 
-struct TimerEventCompare {
-    bool operator()(const std::unique_ptr<TimerEvent>& lhs, const std::unique_ptr<TimerEvent>& rhs) const {
-        return lhs->GetExecTime() > rhs->GetExecTime();
-    }
-};
-
+// Timer keeps events in a hierarchical timing wheel of 1ms ticks. Each of the 4 levels has 256 slots, and level n
+// covers 256^(n+1) ticks, so that pushing and cancelling an event is O(1) and an event is moved down at most 3 times
+// before it expires. Events beyond the range of the last level stay there and are placed again on each cascade.
+// Expired events are executed in the timer thread unless a worker pool is configured, in which case events may run
+// concurrently and must not depend on the order of each other.
 class Timer {
 public:
     ~Timer();
@@ -45,26 +48,64 @@ public:
     }
     void Init();
     void Stop();
-    void PushEvent(std::unique_ptr<TimerEvent>&& e);
+    // Return the id of the event, which can be used to cancel it before it expires.
+    uint64_t PushEvent(std::unique_ptr<TimerEvent>&& e);
+    // Return false if the event has expired or been cancelled.
+    bool Cancel(uint64_t id);
+    size_t Size() const;
 #ifdef APSARA_UNIT_TEST_MAIN
     void Clear();
+    // the event with the earliest exec time, nullptr if empty
+    const TimerEvent* Top() const;
+    void Pop();
 #endif
 
 private:
+    static constexpr size_t kSlotBits = 8;
+    static constexpr size_t kSlotNum = 1 << kSlotBits;
+    static constexpr size_t kLevelNum = 4;
+
+    struct Node {
+        std::unique_ptr<TimerEvent> mEvent;
+        uint64_t mId = 0;
+        uint64_t mExpireTick = 0;
+        size_t mLevel = 0;
+        size_t mSlot = 0;
+    };
+    using Slot = std::list<Node>;
+
     Timer() = default;
     void Run();
+    uint64_t ToTick(std::chrono::steady_clock::time_point t) const;
+    std::chrono::steady_clock::time_point ToTimePoint(uint64_t tick) const;
+    // move the node at it in the list from to its slot according to the current tick
+    void Place(Slot& from, Slot::iterator it);
+    void Cascade(size_t level, size_t slot);
+    // the earliest tick at which a slot has to be expired or cascaded, UINT64_MAX if empty
+    uint64_t NextTick() const;
+    void Advance(uint64_t nowTick, std::vector<std::unique_ptr<TimerEvent>>& expired);
+    void Dispatch(std::unique_ptr<TimerEvent>&& e);
+
+    const std::chrono::steady_clock::time_point mStartTime = std::chrono::steady_clock::now();
 
     mutable std::mutex mQueueMux;
-    std::priority_queue<std::unique_ptr<TimerEvent>, std::vector<std::unique_ptr<TimerEvent>>, TimerEventCompare>
-        mQueue;
+    std::array<std::array<Slot, kSlotNum>, kLevelNum> mWheels;
+    std::unordered_map<uint64_t, Slot::iterator> mEvents;
+    uint64_t mCurrentTick = 0;
+    // the tick the timer thread is waiting for
+    uint64_t mWakeUpTick = UINT64_MAX;
+    uint64_t mNextId = 0;
+    std::condition_variable mCV;
 
+    // declared before mThreadRes, so that it is destructed after the timer thread has exited
+    std::unique_ptr<ThreadPool> mWorkers;
     std::future<void> mThreadRes;
     mutable std::mutex mThreadRunningMux;
     bool mIsThreadRunning = false;
-    mutable std::condition_variable mCV;
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class TimerUnittest;
+    friend class TimerBenchmark;
     friend class ScrapeSchedulerUnittest;
     friend class HostMonitorInputRunnerUnittest;
 #endif
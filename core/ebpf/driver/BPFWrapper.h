@@ -30,6 +30,7 @@ extern "C" {
 
 #include "BPFMapTraits.h"
 #include "Log.h"
+#include "RingBuffer.h"
 
 namespace logtail {
 namespace ebpf {
@@ -66,18 +67,41 @@ public:
     ~BPFWrapper() { Destroy(); }
 
     /**
-     * Init will open and load bpf object, and fill caches for maps and progs
+     * Init will open and load bpf object, and fill caches for maps and progs.
+     * Perf event arrays named in ringBufferSizes are turned into ring buffers of the given bytes before load
+     * if the kernel supports BPF_MAP_TYPE_RINGBUF. The load fails if the bpf programs still write to such a map
+     * with bpf_perf_event_output, and the object is then reloaded with perf buffers.
      */
-    int Init() {
+    int Init(const std::unordered_map<std::string, uint32_t>& ringBufferSizes = {}) {
         if (mInited) {
             return 0;
         }
         mInited = true;
-        mSkel = T::open_and_load();
+        mSkel = T::open();
         mFlag = true;
         if (!mSkel) {
             return kErrInitSkel;
         }
+        bool ringBuffers = UseRingBuffers(ringBufferSizes);
+        int err = T::load(mSkel);
+        if (err && ringBuffers) {
+            // the bpf programs may not support ring buffers, reload with perf buffers
+            ebpf_log(logtail::ebpf::eBPFLogType::NAMI_LOG_TYPE_WARN,
+                     "[BPFWrapper][Init] load with ring buffers failed: %d, fall back to perf buffers \n",
+                     err);
+            T::destroy(mSkel);
+            mSkel = T::open();
+            if (!mSkel) {
+                return kErrInitSkel;
+            }
+            err = T::load(mSkel);
+        }
+        if (err) {
+            ebpf_log(logtail::ebpf::eBPFLogType::NAMI_LOG_TYPE_WARN, "[BPFWrapper][Init] load skel failed: %d \n", err);
+            T::destroy(mSkel);
+            mSkel = nullptr;
+            return kErrInitSkel;
+        }
         bpf_map* map = nullptr;
         bpf_object__for_each_map(map, mSkel->obj) {
             const char* name = bpf_map__name(map);
@@ -371,6 +395,36 @@ public:
         return pb;
     }
 
+    bool IsRingBuffer(const std::string& name) {
+        auto it = mBpfMaps.find(name);
+        return it != mBpfMaps.end() && bpf_map__type(it->second) == BPF_MAP_TYPE_RINGBUF;
+    }
+
+    void DeleteRingBuffer(void* rb) { delete static_cast<RingBuffer*>(rb); }
+
+    /**
+     * PollRingBuffer consumes at most maxEvents records.
+     */
+    int PollRingBuffer(void* rb, int maxEvents, int timeoutMs) {
+        return static_cast<RingBuffer*>(rb)->Poll(maxEvents, timeoutMs);
+    }
+
+    void* CreateRingBuffer(const std::string& name, void* ctx, PerfBufferSampleHandler dataCb) {
+        auto it = mBpfMaps.find(name);
+        if (it == mBpfMaps.end()) {
+            return nullptr;
+        }
+        int err = 0;
+        auto rb = RingBuffer::Create(bpf_map__fd(it->second), bpf_map__max_entries(it->second), ctx, dataCb, &err);
+        if (!rb) {
+            ebpf_log(logtail::ebpf::eBPFLogType::NAMI_LOG_TYPE_WARN,
+                     "[BPFWrapper][CreateRingBuffer] failed to open ring buffer: %s \n",
+                     strerror(-err));
+            return nullptr;
+        }
+        return rb.release();
+    }
+
     int DetachAllPerfBuffers() { return 0; }
 
     /**
@@ -406,6 +460,27 @@ public:
         mInited = false;
     }
 
+    bool UseRingBuffers(const std::unordered_map<std::string, uint32_t>& ringBufferSizes) {
+        if (ringBufferSizes.empty() || libbpf_probe_bpf_map_type(BPF_MAP_TYPE_RINGBUF, nullptr) <= 0) {
+            return false;
+        }
+        bool used = false;
+        bpf_map* map = nullptr;
+        bpf_object__for_each_map(map, mSkel->obj) {
+            auto it = ringBufferSizes.find(bpf_map__name(map));
+            if (it == ringBufferSizes.end() || it->second == 0
+                || bpf_map__type(map) != BPF_MAP_TYPE_PERF_EVENT_ARRAY) {
+                continue;
+            }
+            bpf_map__set_type(map, BPF_MAP_TYPE_RINGBUF);
+            bpf_map__set_key_size(map, 0);
+            bpf_map__set_value_size(map, 0);
+            bpf_map__set_max_entries(map, it->second);
+            used = true;
+        }
+        return used;
+    }
+
     int SearchProgFd(const std::string& name) {
         auto it = mBpfProgs.find(name);
         if (it == mBpfProgs.end()) {
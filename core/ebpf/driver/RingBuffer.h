@@ -0,0 +1,191 @@
+// Copyright 2025 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <sys/epoll.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <memory>
+
+#include "ebpf/include/export.h"
+
+namespace logtail {
+namespace ebpf {
+
+// record header layout of BPF_MAP_TYPE_RINGBUF, see include/uapi/linux/bpf.h
+inline constexpr uint32_t kRingBufBusyBit = 1U << 31;
+inline constexpr uint32_t kRingBufDiscardBit = 1U << 30;
+inline constexpr uint32_t kRingBufHdrSize = 8;
+
+/**
+ * RingBufferConsumer reads records committed by bpf_ringbuf_reserve/bpf_ringbuf_submit.
+ *
+ * All cpus produce into one ring, so records are handed out in reservation order. A record that is still
+ * reserved stops the batch even if later ones are committed, which keeps the order across producers.
+ * The consumer position is published once per batch instead of once per record.
+ *
+ * The data area must be mapped twice back to back, as the kernel does, so that a record crossing the end of the
+ * ring can be read in place.
+ */
+class RingBufferConsumer {
+public:
+    RingBufferConsumer(uint64_t* consumerPos,
+                       const uint64_t* producerPos,
+                       const uint8_t* data,
+                       size_t size,
+                       void* ctx,
+                       PerfBufferSampleHandler sampleCb)
+        : mConsumerPos(consumerPos),
+          mProducerPos(producerPos),
+          mData(data),
+          mMask(size - 1),
+          mCtx(ctx),
+          mSampleCb(sampleCb) {}
+
+    /**
+     * Consume hands at most maxEvents committed records to the sample callback, returns the count.
+     */
+    int Consume(int maxEvents) {
+        uint64_t cons = __atomic_load_n(mConsumerPos, __ATOMIC_ACQUIRE);
+        const uint64_t start = cons;
+        int cnt = 0;
+        bool progress = true;
+        while (progress && cnt < maxEvents) {
+            progress = false;
+            uint64_t prod = __atomic_load_n(mProducerPos, __ATOMIC_ACQUIRE);
+            while (cons < prod && cnt < maxEvents) {
+                const uint8_t* record = mData + (cons & mMask);
+                const auto* hdr = reinterpret_cast<const uint32_t*>(record);
+                uint32_t len = __atomic_load_n(hdr, __ATOMIC_ACQUIRE);
+                if (len & kRingBufBusyBit) {
+                    break;
+                }
+                uint32_t dataLen = len & ~kRingBufDiscardBit;
+                cons += RoundUp(dataLen + kRingBufHdrSize);
+                progress = true;
+                if ((len & kRingBufDiscardBit) == 0) {
+                    // ring buffer records are not bound to a cpu
+                    mSampleCb(mCtx, -1, const_cast<uint8_t*>(record) + kRingBufHdrSize, dataLen);
+                    ++cnt;
+                }
+            }
+        }
+        if (cons != start) {
+            __atomic_store_n(mConsumerPos, cons, __ATOMIC_RELEASE);
+        }
+        return cnt;
+    }
+
+    uint64_t Pending() const {
+        return __atomic_load_n(mProducerPos, __ATOMIC_ACQUIRE) - __atomic_load_n(mConsumerPos, __ATOMIC_ACQUIRE);
+    }
+
+private:
+    static uint64_t RoundUp(uint64_t len) { return (len + 7) & ~uint64_t(7); }
+
+    uint64_t* mConsumerPos;
+    const uint64_t* mProducerPos;
+    const uint8_t* mData;
+    uint64_t mMask;
+    void* mCtx;
+    PerfBufferSampleHandler mSampleCb;
+};
+
+/**
+ * RingBuffer maps a BPF_MAP_TYPE_RINGBUF map and waits for its notifications.
+ */
+class RingBuffer {
+public:
+    static std::unique_ptr<RingBuffer>
+    Create(int mapFd, size_t size, void* ctx, PerfBufferSampleHandler sampleCb, int* err) {
+        std::unique_ptr<RingBuffer> rb(new RingBuffer(size));
+        *err = rb->Init(mapFd, ctx, sampleCb);
+        if (*err) {
+            return nullptr;
+        }
+        return rb;
+    }
+
+    ~RingBuffer() {
+        if (mConsumerPage != MAP_FAILED) {
+            munmap(mConsumerPage, mPageSize);
+        }
+        if (mProducerPage != MAP_FAILED) {
+            munmap(mProducerPage, mPageSize + 2 * mSize);
+        }
+        if (mEpollFd >= 0) {
+            close(mEpollFd);
+        }
+    }
+
+    /**
+     * Poll drains what is already committed, and only waits for a notification when the ring is empty.
+     */
+    int Poll(int maxEvents, int timeoutMs) {
+        int cnt = mConsumer->Consume(maxEvents);
+        if (cnt > 0) {
+            return cnt;
+        }
+        struct epoll_event event;
+        if (epoll_wait(mEpollFd, &event, 1, timeoutMs) < 0) {
+            return -errno;
+        }
+        return mConsumer->Consume(maxEvents);
+    }
+
+private:
+    explicit RingBuffer(size_t size) : mSize(size), mPageSize(sysconf(_SC_PAGESIZE)) {}
+
+    int Init(int mapFd, void* ctx, PerfBufferSampleHandler sampleCb) {
+        mConsumerPage = mmap(nullptr, mPageSize, PROT_READ | PROT_WRITE, MAP_SHARED, mapFd, 0);
+        if (mConsumerPage == MAP_FAILED) {
+            return -errno;
+        }
+        // the kernel maps the data pages twice after the producer page
+        mProducerPage = mmap(nullptr, mPageSize + 2 * mSize, PROT_READ, MAP_SHARED, mapFd, mPageSize);
+        if (mProducerPage == MAP_FAILED) {
+            return -errno;
+        }
+        mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (mEpollFd < 0) {
+            return -errno;
+        }
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mapFd, &event) < 0) {
+            return -errno;
+        }
+        mConsumer = std::make_unique<RingBufferConsumer>(static_cast<uint64_t*>(mConsumerPage),
+                                                         static_cast<const uint64_t*>(mProducerPage),
+                                                         static_cast<const uint8_t*>(mProducerPage) + mPageSize,
+                                                         mSize,
+                                                         ctx,
+                                                         sampleCb);
+        return 0;
+    }
+
+    size_t mSize;
+    size_t mPageSize;
+    void* mConsumerPage = MAP_FAILED;
+    void* mProducerPage = MAP_FAILED;
+    int mEpollFd = -1;
+    std::unique_ptr<RingBufferConsumer> mConsumer;
+};
+
+} // namespace ebpf
+} // namespace logtail
@@ -67,13 +67,15 @@ int bump_memlock_rlimit(void) {
 
 std::mutex gPbMtx;
 std::array<std::vector<void*>, size_t(logtail::ebpf::PluginType::MAX)> gPluginPbs;
+std::array<std::vector<void*>, size_t(logtail::ebpf::PluginType::MAX)> gPluginRbs;
 std::array<std::atomic_bool, size_t(logtail::ebpf::PluginType::MAX)> gPluginStatus = {};
 
 std::array<std::vector<std::string>, size_t(logtail::ebpf::PluginType::MAX)> gPluginCallNames;
 
-void UpdatePluginPerfBuffers(logtail::ebpf::PluginType type, std::vector<void*> pbs) {
+void UpdatePluginPerfBuffers(logtail::ebpf::PluginType type, std::vector<void*> pbs, std::vector<void*> rbs) {
     std::lock_guard lk(gPbMtx);
     gPluginPbs[int(type)] = pbs;
+    gPluginRbs[int(type)] = rbs;
 }
 
 std::shared_ptr<logtail::ebpf::BPFWrapper<security_bpf>> gWrapper = logtail::ebpf::BPFWrapper<security_bpf>::Create();
@@ -124,7 +126,21 @@ int SetupPerfBuffers(logtail::ebpf::PluginConfig* arg) {
     if (specs.size()) {
         std::vector<logtail::ebpf::PerfBufferOps> perfBuffers;
         std::vector<void*> pbs;
+        std::vector<void*> rbs;
         for (auto& spec : specs) {
+            // the map was turned into a ring buffer on load if the kernel supports it
+            if (gWrapper->IsRingBuffer(spec.mName)) {
+                void* rb = gWrapper->CreateRingBuffer(spec.mName, spec.mCtx, spec.mSampleHandler);
+                if (!rb) {
+                    ebpf_log(logtail::ebpf::eBPFLogType::NAMI_LOG_TYPE_WARN,
+                             "plugin type:%s: create ringbuffer fail, name:%s\n",
+                             magic_enum::enum_name(arg->mPluginType).data(),
+                             spec.mName.c_str());
+                    return kErrDriverInternal;
+                }
+                rbs.push_back(rb);
+                continue;
+            }
             void* pb = gWrapper->CreatePerfBuffer(spec.mName,
                                                   spec.mSize,
                                                   spec.mCtx,
@@ -140,7 +156,7 @@ int SetupPerfBuffers(logtail::ebpf::PluginConfig* arg) {
             }
             pbs.push_back(pb);
         }
-        UpdatePluginPerfBuffers(arg->mPluginType, pbs);
+        UpdatePluginPerfBuffers(arg->mPluginType, pbs, rbs);
     }
     return 0;
 }
@@ -181,7 +197,7 @@ int start_plugin(logtail::ebpf::PluginConfig* arg) {
             SetCoolBpfConfig((int32_t)TGID_FILTER, -1);
             SetCoolBpfConfig((int32_t)PORT_FILTER, -1);
             SetCoolBpfConfig((int32_t)SELF_FILTER, getpid());
-            SetCoolBpfConfig((int32_t)DATA_SAMPLING, 100);
+            SetCoolBpfConfig((int32_t)DATA_SAMPLING, config->mDataSampling);
 
             // TODO
             if (config->mEnableCidFilter) {
@@ -298,13 +314,19 @@ int start_plugin(logtail::ebpf::PluginConfig* arg) {
             break;
         }
         case logtail::ebpf::PluginType::PROCESS_SECURITY: {
-            int err = gWrapper->Init();
+            auto* config = std::get_if<logtail::ebpf::ProcessConfig>(&arg->mConfig);
+            std::unordered_map<std::string, uint32_t> ringBufferSizes;
+            if (config) {
+                for (const auto& spec : config->mPerfBufferSpec) {
+                    ringBufferSizes[spec.mName] = spec.mRingBufferSize;
+                }
+            }
+            int err = gWrapper->Init(ringBufferSizes);
             if (err) {
                 ebpf_log(
                     logtail::ebpf::eBPFLogType::NAMI_LOG_TYPE_WARN, "process security: ebpf_init fail ret:%d\n", err);
                 return err;
             }
-            // auto* config = std::get_if<logtail::ebpf::ProcessConfig>(&arg->mConfig);
             std::vector<logtail::ebpf::AttachProgOps> attachOps = {
                 logtail::ebpf::AttachProgOps("event_exit_acct_process", true),
                 logtail::ebpf::AttachProgOps("event_wake_up_new_task", true),
@@ -372,11 +394,31 @@ int poll_plugin_pbs(logtail::ebpf::PluginType type, int32_t max_events, int32_t*
     std::lock_guard lk(gPbMtx);
     // find pbs
     auto& pbs = gPluginPbs[int(type)];
-    if (pbs.empty()) {
+    auto& rbs = gPluginRbs[int(type)];
+    if (pbs.empty() && rbs.empty()) {
         ebpf_log(logtail::ebpf::eBPFLogType::NAMI_LOG_TYPE_WARN, "no pbs registered for type:%d \n", type);
         return -1;
     }
     int cnt = 0;
+    auto pollRingBuffer = [&](void* rb, int timeout) {
+        int ret = gWrapper->PollRingBuffer(rb, max_events - cnt, timeout);
+        if (ret < 0 && ret != -EINTR) {
+            ebpf_log(logtail::ebpf::eBPFLogType::NAMI_LOG_TYPE_WARN, "poll ring buffer failed ...\n");
+        } else if (ret > 0) {
+            cnt += ret;
+        }
+    };
+    // ring buffers are drained without waiting, so that the perf buffers are not delayed by an idle ring
+    for (auto& x : rbs) {
+        if (cnt >= max_events) {
+            break;
+        }
+        pollRingBuffer(x, 0);
+    }
+    // only wait when there is nothing else to wait on
+    if (cnt == 0 && pbs.empty()) {
+        pollRingBuffer(rbs.front(), timeout_ms);
+    }
     for (auto& x : pbs) {
         if (!x) {
             continue;
@@ -516,11 +558,14 @@ int update_plugin(logtail::ebpf::PluginConfig* arg) {
 
 void DeletePerfBuffers(logtail::ebpf::PluginType pluginType) {
     std::vector<void*> pbs;
+    std::vector<void*> rbs;
     {
         std::lock_guard lk(gPbMtx);
         // return;
         pbs = gPluginPbs[static_cast<int>(pluginType)];
         gPluginPbs[int(pluginType)] = {};
+        rbs = gPluginRbs[static_cast<int>(pluginType)];
+        gPluginRbs[int(pluginType)] = {};
     }
     ebpf_log(logtail::ebpf::eBPFLogType::NAMI_LOG_TYPE_INFO,
              "[BPFWrapper][stop_plugin] begin clean perfbuffer for pluginType: %d  \n",
@@ -531,6 +576,9 @@ void DeletePerfBuffers(logtail::ebpf::PluginType pluginType) {
             perf_buffer__free(perfbuffer);
         }
     }
+    for (auto* rb : rbs) {
+        gWrapper->DeleteRingBuffer(rb);
+    }
 }
 
 int stop_plugin(logtail::ebpf::PluginType pluginType) {
@@ -52,6 +52,8 @@ public:
     void* mCtx;
     PerfBufferSampleHandler mSampleHandler;
     PerfBufferLostHandler mLostHandler;
+    // bytes of the BPF_MAP_TYPE_RINGBUF used instead of per-cpu perf buffers if the kernel supports it, 0 to disable
+    uint32_t mRingBufferSize = 0;
 };
 
 
@@ -117,6 +119,9 @@ struct NetworkObserveConfig {
     bool mEnableCidFilter = false;
     int mCidOffset = -1;
 
+    // percent of data events kept in kernel, the others are dropped before they are copied to user space
+    int32_t mDataSampling = 100;
+
     std::vector<std::string> mEnableContainerIds;
     std::vector<std::string> mDisableContainerIds;
 };
@@ -25,37 +25,46 @@
 namespace logtail {
 
 ProcessCache::ProcessCache(size_t maxCacheSize, ProcParser& procParser) : mProcParser(procParser) {
-    mCache.reserve(maxCacheSize);
+    for (auto& shard : mShards) {
+        shard.mCache.reserve(maxCacheSize / kShardCount);
+    }
 }
 
 bool ProcessCache::Contains(const data_event_id& key) const {
-    std::lock_guard<std::mutex> lock(mCacheMutex);
-    return mCache.find(key) != mCache.end();
+    const auto& shard = getShard(key);
+    ReadLock lock(shard.mLock);
+    return shard.mCache.find(key) != shard.mCache.end();
 }
 
 std::shared_ptr<ProcessCacheValue> ProcessCache::Lookup(const data_event_id& key) {
-    std::lock_guard<std::mutex> lock(mCacheMutex);
-    auto it = mCache.find(key);
-    if (it != mCache.end()) {
+    auto& shard = getShard(key);
+    ReadLock lock(shard.mLock);
+    auto it = shard.mCache.find(key);
+    if (it != shard.mCache.end()) {
         return it->second;
     }
     return nullptr;
 }
 
 size_t ProcessCache::Size() const {
-    std::lock_guard<std::mutex> lock(mCacheMutex);
-    return mCache.size();
+    return mSize.load(std::memory_order_relaxed);
 }
 
 void ProcessCache::removeCache(const data_event_id& key) {
-    std::lock_guard<std::mutex> lock(mCacheMutex);
-    mCache.erase(key);
+    auto& shard = getShard(key);
+    WriteLock lock(shard.mLock);
+    if (shard.mCache.erase(key) > 0) {
+        --mSize;
+    }
 }
 
 void ProcessCache::AddCache(const data_event_id& key, std::shared_ptr<ProcessCacheValue>& value) {
     value->IncRef();
-    std::lock_guard<std::mutex> lock(mCacheMutex);
-    mCache.emplace(key, value);
+    auto& shard = getShard(key);
+    WriteLock lock(shard.mLock);
+    if (shard.mCache.emplace(key, value).second) {
+        ++mSize;
+    }
 }
 
 void ProcessCache::IncRef([[maybe_unused]] const data_event_id& key, std::shared_ptr<ProcessCacheValue>& value) {
@@ -79,8 +88,11 @@ void ProcessCache::enqueueExpiredEntry(const data_event_id& key, std::shared_ptr
 }
 
 void ProcessCache::Clear() {
-    std::lock_guard<std::mutex> lock(mCacheMutex);
-    mCache.clear();
+    for (auto& shard : mShards) {
+        WriteLock lock(shard.mLock);
+        mSize -= shard.mCache.size();
+        shard.mCache.clear();
+    }
 }
 
 void ProcessCache::ClearExpiredCache() {
@@ -129,25 +141,30 @@ void ProcessCache::ForceShrink() {
     auto minKtime = TimeKeeper::GetInstance()->KtimeNs()
         - std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::minutes(2)).count();
     std::vector<data_event_id> cacheToRemove;
-    cacheToRemove.reserve(mCache.size() - validProcs.size());
-    {
-        std::lock_guard<std::mutex> lock(mCacheMutex);
-        for (const auto& [k, v] : mCache) {
+    for (auto& shard : mShards) {
+        // lookups on other shards are not blocked while this one is scanned
+        WriteLock lock(shard.mLock);
+        for (const auto& [k, v] : shard.mCache) {
             if (validProcs.count(k.pid) == 0U && minKtime > time_t(k.time)) {
                 cacheToRemove.emplace_back(k);
             }
         }
         for (const auto& key : cacheToRemove) {
-            mCache.erase(key);
+            shard.mCache.erase(key);
             LOG_ERROR(sLogger, ("[FORCE SHRINK] pid", key.pid)("ktime", key.time));
         }
+        mSize -= cacheToRemove.size();
+        cacheToRemove.clear();
     }
     mLastForceShrinkTimeSec = TimeKeeper::GetInstance()->NowSec();
 }
 
 void ProcessCache::PrintDebugInfo() {
-    for (const auto& [key, value] : mCache) {
-        LOG_ERROR(sLogger, ("[DUMP CACHE] pid", key.pid)("ktime", key.time));
+    for (const auto& shard : mShards) {
+        ReadLock lock(shard.mLock);
+        for (const auto& [key, value] : shard.mCache) {
+            LOG_ERROR(sLogger, ("[DUMP CACHE] pid", key.pid)("ktime", key.time));
+        }
     }
     for (const auto& entry : mCacheExpireQueue) {
         LOG_ERROR(sLogger, ("[DUMP EXPIRE Q] pid", entry.key.pid)("ktime", entry.key.time));
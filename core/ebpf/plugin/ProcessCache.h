@@ -17,14 +17,19 @@
 
 #include <coolbpf/security/data_msg.h>
 
+#include <array>
+#include <atomic>
 #include <mutex>
 
+#include "common/Lock.h"
 #include "common/ProcParser.h"
 #include "ebpf/plugin/ProcessCacheValue.h"
 #include "ebpf/plugin/ProcessDataMap.h"
 
 namespace logtail {
 
+// Lookups come from every event of the security and network observer plugins, while entries are only added and
+// removed by the poller thread, so the cache is split into shards each guarded by its own read-write lock.
 class ProcessCache {
 public:
     explicit ProcessCache(size_t maxCacheSize, ProcParser& procParser);
@@ -50,6 +55,7 @@ public:
     // NOT thread-safe, only single write call, no contention with read
     void ClearExpiredCache();
 
+    // remove entries of exited processes, locking one shard at a time
     void ForceShrink();
 
     void PrintDebugInfo();
@@ -60,11 +66,28 @@ private:
     // NOT thread-safe, only single write call, no contention with read
     void enqueueExpiredEntry(const data_event_id& key, std::shared_ptr<ProcessCacheValue>& value);
 
-    ProcParser mProcParser;
+    static constexpr size_t kShardBits = 6;
+    static constexpr size_t kShardCount = 1 << kShardBits;
+
     using ExecveEventMap = std::
         unordered_map<data_event_id, std::shared_ptr<ProcessCacheValue>, ebpf::DataEventIdHash, ebpf::DataEventIdEqual>;
-    mutable std::mutex mCacheMutex;
-    ExecveEventMap mCache;
+    // aligned to keep the locks of adjacent shards out of the same cache line
+    struct alignas(64) Shard {
+        mutable ReadWriteLock mLock;
+        ExecveEventMap mCache;
+    };
+
+    // the maps of the shards bucket keys by the low bits of the same hash, so the shard is picked by the high bits of
+    // the mixed hash
+    static size_t shardIndex(const data_event_id& key) {
+        return (ebpf::DataEventIdHash()(key) * 0x9E3779B97F4A7C15ULL) >> (64 - kShardBits);
+    }
+    Shard& getShard(const data_event_id& key) { return mShards[shardIndex(key)]; }
+    const Shard& getShard(const data_event_id& key) const { return mShards[shardIndex(key)]; }
+
+    ProcParser mProcParser;
+    std::array<Shard, kShardCount> mShards;
+    std::atomic_size_t mSize = 0;
 
     struct ExitedEntry {
         data_event_id key;
@@ -47,6 +47,11 @@ DEFINE_FLAG_INT32(ebpf_process_cache_gc_interval_sec,
                   30);
 DEFINE_FLAG_INT32(ebpf_event_retry_limit, "Number of attempts to retry processing ebpf event", 15);
 DEFINE_FLAG_INT32(ebpf_event_retry_interval_sec, "Time in seconds between ebpf event retries", 2);
+// the bpf programs still emit process events with bpf_perf_event_output, which the verifier rejects on a ring buffer,
+// so keep perf buffers until they move to bpf_ringbuf_reserve/submit
+DEFINE_FLAG_INT32(ebpf_process_ring_buffer_size,
+                  "Bytes of the ring buffer carrying process events, power of 2, 0 for per-cpu perf buffers",
+                  0);
 
 namespace logtail::ebpf {
 
@@ -156,6 +161,7 @@ bool ProcessCacheManager::Init() {
     ProcessConfig pconfig;
 
     pconfig.mPerfBufferSpec = {{"tcpmon_map", 128, this, HandleKernelProcessEvent, HandleKernelProcessEventLost}};
+    pconfig.mPerfBufferSpec[0].mRingBufferSize = INT32_FLAG(ebpf_process_ring_buffer_size);
     ebpfConfig->mConfig = pconfig;
     mRunFlag = true;
     mPoller = async(std::launch::async, &ProcessCacheManager::pollPerfBuffers, this);
@@ -247,66 +253,14 @@ bool ProcessCacheManager::FinalizeProcessTags(uint32_t pid, uint64_t ktime, LogE
     // call_name, added by xxx_security_manager
     // event_time, added by xxx_security_manager
 
-    // finalize proc tags
+    // finalize proc tags, the events point into the tag blocks retained by their source buffer
     auto& proc = *procPtr;
     auto& sb = logEvent.GetSourceBuffer();
-    auto execIdSb = sb->CopyString(proc.Get<kExecId>());
-    logEvent.SetContentNoCopy(kExecId.LogKey(), StringView(execIdSb.data, execIdSb.size));
-
-    auto pidSb = sb->CopyString(proc.Get<kProcessId>());
-    logEvent.SetContentNoCopy(kProcessId.LogKey(), StringView(pidSb.data, pidSb.size));
-
-    auto uidSb = sb->CopyString(proc.Get<kUid>());
-    logEvent.SetContentNoCopy(kUid.LogKey(), StringView(uidSb.data, uidSb.size));
-
-    auto userSb = sb->CopyString(proc.Get<kUser>());
-    logEvent.SetContentNoCopy(kUser.LogKey(), StringView(userSb.data, userSb.size));
-
-    auto binarySb = sb->CopyString(proc.Get<kBinary>());
-    logEvent.SetContentNoCopy(kBinary.LogKey(), StringView(binarySb.data, binarySb.size));
-
-    auto argsSb = sb->CopyString(proc.Get<kArguments>());
-    logEvent.SetContentNoCopy(kArguments.LogKey(), StringView(argsSb.data, argsSb.size));
-
-    auto cwdSb = sb->CopyString(proc.Get<kCWD>());
-    logEvent.SetContentNoCopy(kCWD.LogKey(), StringView(cwdSb.data, cwdSb.size));
-
-    auto ktimeSb = sb->CopyString(proc.Get<kKtime>());
-    logEvent.SetContentNoCopy(kKtime.LogKey(), StringView(ktimeSb.data, ktimeSb.size));
-
-    auto permitted = sb->CopyString(proc.Get<kCapPermitted>());
-    logEvent.SetContentNoCopy(kCapPermitted.LogKey(), StringView(permitted.data, permitted.size));
-
-    auto effective = sb->CopyString(proc.Get<kCapEffective>());
-    logEvent.SetContentNoCopy(kCapEffective.LogKey(), StringView(effective.data, effective.size));
-
-    auto inheritable = sb->CopyString(proc.Get<kCapInheritable>());
-    logEvent.SetContentNoCopy(kCapInheritable.LogKey(), StringView(inheritable.data, inheritable.size));
-
-    if (!proc.Get<kContainerId>().empty()) {
-        auto containerId = sb->CopyString(proc.Get<kContainerId>());
-        logEvent.SetContentNoCopy(kContainerId.LogKey(), StringView(containerId.data, containerId.size));
-    }
-    auto containerInfo = proc.LoadContainerInfo();
-    if (containerInfo) {
-        auto containerName = sb->CopyString(containerInfo->mContainerName);
-        logEvent.SetContentNoCopy(kLocalContainerName.LogKey(), StringView(containerName.data, containerName.size));
-        auto imageName = sb->CopyString(containerInfo->mImageName);
-        logEvent.SetContentNoCopy(kContainerImageName.LogKey(), StringView(imageName.data, imageName.size));
-    }
-    auto podInfo = proc.LoadK8sPodInfo();
-    if (podInfo) {
-        auto workloadKind = sb->CopyString(podInfo->mWorkloadKind);
-        logEvent.SetContentNoCopy(kWorkloadKind.LogKey(), StringView(workloadKind.data, workloadKind.size));
-        auto workloadName = sb->CopyString(podInfo->mWorkloadName);
-        logEvent.SetContentNoCopy(kWorkloadName.LogKey(), StringView(workloadName.data, workloadName.size));
-        auto namespaceStr = sb->CopyString(podInfo->mNamespace);
-        logEvent.SetContentNoCopy(kNamespace.LogKey(), StringView(namespaceStr.data, namespaceStr.size));
-        auto podName = sb->CopyString(podInfo->mPodName);
-        logEvent.SetContentNoCopy(kPodName.LogKey(), StringView(podName.data, podName.size));
-        // auto containerName = sb->CopyString(podInfo->mContainerName);
-        // logEvent.SetContentNoCopy(kContainerName.LogKey(), StringView(containerName.data, containerName.size));
+    auto tagBlock = proc.GetTagBlock();
+    for (const auto& tag : tagBlock->GetTags()) {
+        logEvent.SetContentNoCopy(tag.first, tag.second);
     }
+    sb->Retain(std::move(tagBlock));
 
     auto parentProcPtr = mProcessCache.Lookup({proc.mPPid, proc.mPKtime});
     // for parent
@@ -314,36 +268,11 @@ bool ProcessCacheManager::FinalizeProcessTags(uint32_t pid, uint64_t ktime, LogE
         return true;
     }
     // finalize parent tags
-    auto& parentProc = *parentProcPtr;
-    auto parentExecIdSb = sb->CopyString(parentProc.Get<kExecId>());
-    logEvent.SetContentNoCopy(kParentExecId.LogKey(), StringView(parentExecIdSb.data, parentExecIdSb.size));
-
-    auto parentPidSb = sb->CopyString(parentProc.Get<kProcessId>());
-    logEvent.SetContentNoCopy(kParentProcessId.LogKey(), StringView(parentPidSb.data, parentPidSb.size));
-
-    auto parentUidSb = sb->CopyString(parentProc.Get<kUid>());
-    logEvent.SetContentNoCopy(kParentUid.LogKey(), StringView(parentUidSb.data, parentUidSb.size));
-
-    auto parentUserSb = sb->CopyString(parentProc.Get<kUser>());
-    logEvent.SetContentNoCopy(kParentUser.LogKey(), StringView(parentUserSb.data, parentUserSb.size));
-
-    auto parentBinarySb = sb->CopyString(parentProc.Get<kBinary>());
-    logEvent.SetContentNoCopy(kParentBinary.LogKey(), StringView(parentBinarySb.data, parentBinarySb.size));
-
-    auto parentArgsSb = sb->CopyString(parentProc.Get<kArguments>());
-    logEvent.SetContentNoCopy(kParentArguments.LogKey(), StringView(parentArgsSb.data, parentArgsSb.size));
-
-    auto parentCwdSb = sb->CopyString(parentProc.Get<kCWD>());
-    logEvent.SetContentNoCopy(kParentCWD.LogKey(), StringView(parentCwdSb.data, parentCwdSb.size));
-
-    auto parentKtimeSb = sb->CopyString(parentProc.Get<kKtime>());
-    logEvent.SetContentNoCopy(kParentKtime.LogKey(), StringView(parentKtimeSb.data, parentKtimeSb.size));
-
-    if (!parentProc.Get<kContainerId>().empty()) {
-        auto parentContainerId = sb->CopyString(parentProc.Get<kContainerId>());
-        logEvent.SetContentNoCopy(kParentContainerId.LogKey(),
-                                  StringView(parentContainerId.data, parentContainerId.size));
+    auto parentTagBlock = parentProcPtr->GetParentTagBlock();
+    for (const auto& tag : parentTagBlock->GetTags()) {
+        logEvent.SetContentNoCopy(tag.first, tag.second);
     }
+    sb->Retain(std::move(parentTagBlock));
     return true;
 }
 
@@ -14,7 +14,24 @@
 
 #include "ebpf/plugin/ProcessCacheValue.h"
 
+#include "ebpf/type/table/BaseElements.h"
+
 namespace logtail {
+
+ProcessTagBlock::ProcessTagBlock(const Tags& tags) {
+    size_t size = 0;
+    for (const auto& tag : tags) {
+        size += tag.second.size();
+    }
+    // reserved up front, so the views taken below are not invalidated by appending
+    mData.reserve(size);
+    mTags.reserve(tags.size());
+    for (const auto& tag : tags) {
+        mTags.emplace_back(tag.first, StringView(mData.data() + mData.size(), tag.second.size()));
+        mData.append(tag.second.data(), tag.second.size());
+    }
+}
+
 ProcessCacheValue* ProcessCacheValue::CloneContents() {
     auto* newValue = new ProcessCacheValue();
     for (size_t i = 0; i < mContents.Size(); ++i) {
@@ -24,4 +41,63 @@ ProcessCacheValue* ProcessCacheValue::CloneContents() {
     return newValue;
 }
 
+std::shared_ptr<const ProcessTagBlock> ProcessCacheValue::GetTagBlock() {
+    auto containerInfo = LoadContainerInfo();
+    auto podInfo = LoadK8sPodInfo();
+    std::lock_guard<std::mutex> lock(mTagBlockMutex);
+    if (mTagBlock && mTagBlockContainerInfo == containerInfo && mTagBlockK8sPodInfo == podInfo) {
+        return mTagBlock;
+    }
+
+    ProcessTagBlock::Tags tags = {{ebpf::kExecId.LogKey(), Get<ebpf::kExecId>()},
+                                  {ebpf::kProcessId.LogKey(), Get<ebpf::kProcessId>()},
+                                  {ebpf::kUid.LogKey(), Get<ebpf::kUid>()},
+                                  {ebpf::kUser.LogKey(), Get<ebpf::kUser>()},
+                                  {ebpf::kBinary.LogKey(), Get<ebpf::kBinary>()},
+                                  {ebpf::kArguments.LogKey(), Get<ebpf::kArguments>()},
+                                  {ebpf::kCWD.LogKey(), Get<ebpf::kCWD>()},
+                                  {ebpf::kKtime.LogKey(), Get<ebpf::kKtime>()},
+                                  {ebpf::kCapPermitted.LogKey(), Get<ebpf::kCapPermitted>()},
+                                  {ebpf::kCapEffective.LogKey(), Get<ebpf::kCapEffective>()},
+                                  {ebpf::kCapInheritable.LogKey(), Get<ebpf::kCapInheritable>()}};
+    if (!Get<ebpf::kContainerId>().empty()) {
+        tags.emplace_back(ebpf::kContainerId.LogKey(), Get<ebpf::kContainerId>());
+    }
+    if (containerInfo) {
+        tags.emplace_back(ebpf::kLocalContainerName.LogKey(), containerInfo->mContainerName);
+        tags.emplace_back(ebpf::kContainerImageName.LogKey(), containerInfo->mImageName);
+    }
+    if (podInfo) {
+        tags.emplace_back(ebpf::kWorkloadKind.LogKey(), podInfo->mWorkloadKind);
+        tags.emplace_back(ebpf::kWorkloadName.LogKey(), podInfo->mWorkloadName);
+        tags.emplace_back(ebpf::kNamespace.LogKey(), podInfo->mNamespace);
+        tags.emplace_back(ebpf::kPodName.LogKey(), podInfo->mPodName);
+    }
+    mTagBlock = std::make_shared<const ProcessTagBlock>(tags);
+    mTagBlockContainerInfo = std::move(containerInfo);
+    mTagBlockK8sPodInfo = std::move(podInfo);
+    return mTagBlock;
+}
+
+std::shared_ptr<const ProcessTagBlock> ProcessCacheValue::GetParentTagBlock() {
+    std::lock_guard<std::mutex> lock(mTagBlockMutex);
+    if (mParentTagBlock) {
+        return mParentTagBlock;
+    }
+
+    ProcessTagBlock::Tags tags = {{ebpf::kParentExecId.LogKey(), Get<ebpf::kExecId>()},
+                                  {ebpf::kParentProcessId.LogKey(), Get<ebpf::kProcessId>()},
+                                  {ebpf::kParentUid.LogKey(), Get<ebpf::kUid>()},
+                                  {ebpf::kParentUser.LogKey(), Get<ebpf::kUser>()},
+                                  {ebpf::kParentBinary.LogKey(), Get<ebpf::kBinary>()},
+                                  {ebpf::kParentArguments.LogKey(), Get<ebpf::kArguments>()},
+                                  {ebpf::kParentCWD.LogKey(), Get<ebpf::kCWD>()},
+                                  {ebpf::kParentKtime.LogKey(), Get<ebpf::kKtime>()}};
+    if (!Get<ebpf::kContainerId>().empty()) {
+        tags.emplace_back(ebpf::kParentContainerId.LogKey(), Get<ebpf::kContainerId>());
+    }
+    mParentTagBlock = std::make_shared<const ProcessTagBlock>(tags);
+    return mParentTagBlock;
+}
+
 } // namespace logtail
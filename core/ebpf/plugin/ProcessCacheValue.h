@@ -18,7 +18,12 @@
 #include <coolbpf/security/data_msg.h>
 #include <cstdint>
 
+#include <atomic>
+#include <memory>
 #include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "ContainerInfo.h"
 #include "common/StringView.h"
@@ -28,6 +33,22 @@
 
 namespace logtail {
 
+// Tags of a process serialized once into a single buffer. A block is immutable once built and shared by the events of
+// the process, which point into it instead of copying the tags into their own source buffer.
+class ProcessTagBlock {
+public:
+    using Tags = std::vector<std::pair<StringView, StringView>>;
+
+    // keys must be static, values are copied into the block
+    explicit ProcessTagBlock(const Tags& tags);
+
+    const Tags& GetTags() const { return mTags; }
+
+private:
+    std::string mData;
+    Tags mTags;
+};
+
 class ProcessCacheValue {
 public:
     enum class LifeStage { kInUse, kDeletePending, kDeleteReady, kDeleted };
@@ -112,6 +133,12 @@ public:
 
     std::shared_ptr<SourceBuffer> GetSourceBuffer() { return mContents.GetSourceBuffer(); }
 
+    // Tags of the process itself, rebuilt when the container or pod info has been changed since the last build.
+    std::shared_ptr<const ProcessTagBlock> GetTagBlock();
+    // Tags added to the events of the children of the process. Contents are not changed once the process is cached,
+    // so the block is only built once.
+    std::shared_ptr<const ProcessTagBlock> GetParentTagBlock();
+
     int RefCount() { return mRefCount; }
 
     int IncRef() { return ++mRefCount; }
@@ -130,6 +157,11 @@ private:
     std::shared_ptr<ContainerMeta> mContainerInfo;
     mutable std::mutex mK8sPodInfoMutex;
     std::shared_ptr<K8sPodInfo> mK8sPodInfo;
+    std::mutex mTagBlockMutex;
+    std::shared_ptr<const ProcessTagBlock> mTagBlock;
+    std::shared_ptr<ContainerMeta> mTagBlockContainerInfo;
+    std::shared_ptr<K8sPodInfo> mTagBlockK8sPodInfo;
+    std::shared_ptr<const ProcessTagBlock> mParentTagBlock;
     std::atomic_int mRefCount = 0;
     std::atomic<enum LifeStage> mLifeStage = LifeStage::kInUse;
 };
@@ -47,6 +47,20 @@ bool Connection::IsLocalhost() const {
     return (remoteIp == kLoopbackStr || remoteIp == kLocalhostStr || remoteIp == kZeroAddrStr);
 }
 
+void Connection::Reset(const ConnId& connId) {
+    mConnId = connId;
+    mProtocol = support_proto_e::ProtoUnknown;
+    mRole = support_role_e::IsUnknown;
+    mMetaFlags = 0;
+    mTags.Reset();
+    mEpoch = 4;
+    mIsClose = false;
+    mMarkCloseTime = {};
+    mLastUpdateTs = 0;
+    mLastActiveTs = INT64_MAX;
+    mCurrStats.Clear();
+}
+
 // only called by poller thread ...
 void Connection::UpdateConnState(struct conn_ctrl_event_t* event) {
     if (EventClose == event->type) {
@@ -94,16 +108,11 @@ void Connection::UpdateConnStats(struct conn_stats_event_t* event) {
     this->RecordLastUpdateTs(event->ts);
 }
 
-bool Connection::GenerateConnStatsRecord(const std::shared_ptr<AbstractRecord>& in) {
-    auto* record = static_cast<ConnStatsRecord*>(in.get());
-    if (!record) {
-        return false;
-    }
-
-    record->mRecvPackets = (mCurrStats.mRecvPackets == 0) ? 0 : mCurrStats.mRecvPackets;
-    record->mSendPackets = (mCurrStats.mSendPackets == 0) ? 0 : mCurrStats.mSendPackets;
-    record->mRecvBytes = (mCurrStats.mRecvBytes == 0) ? 0 : mCurrStats.mRecvBytes;
-    record->mSendBytes = (mCurrStats.mSendBytes == 0) ? 0 : mCurrStats.mSendBytes;
+bool Connection::GenerateConnStatsRecord(ConnStatsRecord& record) {
+    record.mRecvPackets = (mCurrStats.mRecvPackets == 0) ? 0 : mCurrStats.mRecvPackets;
+    record.mSendPackets = (mCurrStats.mSendPackets == 0) ? 0 : mCurrStats.mSendPackets;
+    record.mRecvBytes = (mCurrStats.mRecvBytes == 0) ? 0 : mCurrStats.mRecvBytes;
+    record.mSendBytes = (mCurrStats.mSendBytes == 0) ? 0 : mCurrStats.mSendBytes;
     mCurrStats.Clear();
 
     return true;
@@ -36,6 +36,8 @@ namespace logtail::ebpf {
 
 class AbstractRecord;
 class ConnStatsRecord;
+template <class T>
+class RecordPtr;
 
 struct ConnStatsData {
 public:
@@ -52,12 +54,17 @@ public:
 
 class Connection {
 public:
+    // a connection inactive for longer than this is destroyed
+    static constexpr int64_t kIdleTimeoutMs = 10000;
+
     ~Connection() {}
     Connection(const Connection&) = delete;
     Connection(Connection&&) = delete;
     Connection& operator=(const Connection&) = delete;
     Connection& operator=(Connection&&) = delete;
     explicit Connection(const ConnId& connId) : mConnId(connId) {}
+    // Reinitialize a released connection for connId, the memory of the tags is reused.
+    void Reset(const ConnId& connId);
     void UpdateConnStats(struct conn_stats_event_t* event);
     void UpdateConnState(struct conn_ctrl_event_t* event);
 
@@ -70,14 +77,14 @@ public:
             return true;
         }
         auto nowTs = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
-        return nowTs > mLastActiveTs && (nowTs - mLastActiveTs) > 10000; // 10s
+        return nowTs > mLastActiveTs && (nowTs - mLastActiveTs) > kIdleTimeoutMs;
     }
 
     [[nodiscard]] bool IsClose() const { return mIsClose; }
 
     [[nodiscard]] int GetEpoch() const { return mEpoch; }
 
-    void CountDown() { this->mEpoch--; }
+    void CountDown(int n = 1) { this->mEpoch -= n; }
 
     uint64_t GetLastUpdateTs() const { return mLastUpdateTs; }
     uint64_t GetLastActiveTs() const { return mLastActiveTs; }
@@ -147,7 +154,7 @@ public:
     void TryAttachSelfMeta();
     void TryAttachPeerMeta(int family = -1, uint32_t ip = std::numeric_limits<uint32_t>::max());
 
-    bool GenerateConnStatsRecord(const std::shared_ptr<AbstractRecord>& in);
+    bool GenerateConnStatsRecord(ConnStatsRecord& record);
 
     [[nodiscard]] support_role_e GetRole() const { return mRole; }
 
@@ -14,6 +14,8 @@
 
 #include "ConnectionManager.h"
 
+#include <algorithm>
+
 #include "logger/Logger.h"
 
 extern "C" {
@@ -22,63 +24,137 @@ extern "C" {
 
 namespace logtail::ebpf {
 
-std::shared_ptr<Connection> ConnectionManager::getOrCreateConnection(const ConnId& connId) {
-    if (mConnections.size() >= static_cast<size_t>(mMaxConnections.load())) {
+ConnectionPool::~ConnectionPool() {
+    for (auto* conn : mConnections) {
+        delete conn;
+    }
+}
+
+std::shared_ptr<Connection> ConnectionPool::Acquire(const ConnId& connId) {
+    Connection* conn = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(mMux);
+        if (!mConnections.empty()) {
+            conn = mConnections.back();
+            mConnections.pop_back();
+        }
+    }
+    if (conn == nullptr) {
+        conn = new Connection(connId);
+    } else {
+        conn->Reset(connId);
+    }
+    // records holding the connection keep the pool alive
+    return std::shared_ptr<Connection>(conn, [pool = shared_from_this()](Connection* c) { pool->Release(c); });
+}
+
+void ConnectionPool::Release(Connection* conn) {
+    {
+        std::lock_guard<std::mutex> lock(mMux);
+        if (mConnections.size() < mCapacity) {
+            mConnections.push_back(conn);
+            return;
+        }
+    }
+    delete conn;
+}
+
+size_t ConnectionPool::Size() {
+    std::lock_guard<std::mutex> lock(mMux);
+    return mConnections.size();
+}
+
+ConnectionManager::ConnectionEntry* ConnectionManager::getEntry(const ConnId& connId) {
+    auto& shard = getShard(connId);
+    auto it = shard.find(connId);
+    if (it != shard.end()) {
+        return &it->second;
+    }
+    return nullptr;
+}
+
+ConnectionManager::ConnectionEntry* ConnectionManager::getOrCreateEntry(const ConnId& connId) {
+    auto& shard = getShard(connId);
+    auto it = shard.find(connId);
+    if (it != shard.end()) {
+        return &it->second;
+    }
+
+    if (mConnectionTotal.load() >= mMaxConnections.load()) {
         // max connections exceeded ...
         LOG_DEBUG(sLogger, ("max connection limit exceeded!", ""));
         return nullptr;
     }
 
-    auto it = mConnections.find(connId);
-    if (it != mConnections.end()) {
-        return it->second;
-    }
-
     mConnectionTotal.fetch_add(1);
 
-    std::shared_ptr<Connection> conn = std::make_shared<Connection>(connId);
-    conn->RecordActive();
-    mConnections.insert({connId, conn});
-    return conn;
+    auto& entry = shard[connId];
+    entry.mConn = mConnectionPool->Acquire(connId);
+    entry.mNextStatsTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(kConnStatsIntervalMs);
+    recordActive(connId, entry);
+    // attach metadata in the next iteration
+    schedule(connId, entry, mTick);
+    return &entry;
+}
+
+std::shared_ptr<Connection> ConnectionManager::getOrCreateConnection(const ConnId& connId) {
+    auto* entry = getOrCreateEntry(connId);
+    return entry ? entry->mConn : nullptr;
 }
 
 std::shared_ptr<Connection> ConnectionManager::getConnection(const ConnId& connId) {
-    auto it = mConnections.find(connId);
-    if (it != mConnections.end()) {
-        return it->second;
-    }
-    return nullptr;
+    auto* entry = getEntry(connId);
+    return entry ? entry->mConn : nullptr;
 }
 
 void ConnectionManager::deleteConnection(const ConnId& connId) {
-    mConnections.erase(connId);
-    mConnectionTotal.fetch_add(-1);
+    if (getShard(connId).erase(connId) > 0) {
+        mConnectionTotal.fetch_add(-1);
+    }
+}
+
+void ConnectionManager::recordActive(const ConnId& connId, ConnectionEntry& entry) {
+    entry.mConn->RecordActive();
+    entry.mCountedTick = mTick;
+    if (entry.mConn->IsClose()) {
+        schedule(connId, entry, mTick + entry.mConn->GetEpoch() + 1);
+    }
+}
+
+void ConnectionManager::schedule(const ConnId& connId, ConnectionEntry& entry, uint64_t dueTick) {
+    dueTick = std::min(std::max(dueTick, mTick), mTick + kWheelSize - 1);
+    if (entry.mDueTick <= dueTick) {
+        return;
+    }
+    // the connection may be left in the slot it was due before, which is skipped when that slot expires
+    entry.mDueTick = dueTick;
+    mWheel[dueTick % kWheelSize].push_back(connId);
 }
 
 void ConnectionManager::AcceptNetCtrlEvent(struct conn_ctrl_event_t* event) {
     // update net stats
     ConnId connId = ConnId(event->conn_id.fd, event->conn_id.tgid, event->conn_id.start);
-    auto conn = getOrCreateConnection(connId);
-    if (nullptr == conn) {
+    auto* entry = getOrCreateEntry(connId);
+    if (nullptr == entry) {
         return;
     }
 
-    conn->UpdateConnState(event);
-    conn->RecordActive();
+    entry->mConn->UpdateConnState(event);
+    recordActive(connId, *entry);
 }
 
 std::shared_ptr<Connection> ConnectionManager::AcceptNetDataEvent(struct conn_data_event_t* event) {
     ConnId connId = ConnId(event->conn_id.fd, event->conn_id.tgid, event->conn_id.start);
-    auto conn = getOrCreateConnection(connId);
+    auto* entry = getOrCreateEntry(connId);
 
-    if (nullptr == conn) {
+    if (nullptr == entry) {
         return nullptr;
     }
 
     // TryAttachL7
-    conn->TryAttachL7Meta(event->role, event->protocol);
-    conn->RecordActive();
-    return conn;
+    entry->mConn->TryAttachL7Meta(event->role, event->protocol);
+    recordActive(connId, *entry);
+    return entry->mConn;
 }
 
 void ConnectionManager::AcceptNetStatsEvent(struct conn_stats_event_t* event) {
@@ -87,8 +163,8 @@ void ConnectionManager::AcceptNetStatsEvent(struct conn_stats_event_t* event) {
     }
     // udpate conn tracker stats
     ConnId connId = ConnId(event->conn_id.fd, event->conn_id.tgid, event->conn_id.start);
-    auto conn = getOrCreateConnection(connId);
-    if (conn == nullptr) {
+    auto* entry = getOrCreateEntry(connId);
+    if (entry == nullptr) {
         // log error
         LOG_DEBUG(sLogger,
                   ("GetOrCreateConntracker get null. pid",
@@ -97,65 +173,78 @@ void ConnectionManager::AcceptNetStatsEvent(struct conn_stats_event_t* event) {
     }
 
     // update conn tracker stats
-    conn->UpdateConnStats(event);
-    conn->RecordActive();
+    entry->mConn->UpdateConnStats(event);
+    recordActive(connId, *entry);
+}
+
+bool ConnectionManager::checkConnection(const ConnId& connId,
+                                        ConnectionEntry& entry,
+                                        const std::chrono::steady_clock::time_point& now) {
+    auto& connection = entry.mConn;
+    // the epoch counts the iterations since the last activity
+    connection->CountDown(static_cast<int>(mTick - entry.mCountedTick));
+    entry.mCountedTick = mTick;
+
+    connection->TryAttachPeerMeta();
+    connection->TryAttachSelfMeta();
+
+    if (connection->ReadyToDestroy(now)) {
+        return false;
+    }
+
+    if (mEnableConnStats && connection->IsMetaAttachReadyForNetRecord() && now >= entry.mNextStatsTime) {
+        auto statsRecord = RecordPool<ConnStatsRecord>::GetInstance().Acquire(connection);
+        bool res = connection->GenerateConnStatsRecord(*statsRecord);
+        if (res && mConnStatsHandler) {
+            RecordPtr<AbstractRecord> record(std::move(statsRecord));
+            mConnStatsHandler(record);
+        }
+        entry.mNextStatsTime = now + std::chrono::milliseconds(kConnStatsIntervalMs);
+    }
+
+    auto ticksUntil
+        = [](int64_t ms) { return static_cast<uint64_t>(std::max<int64_t>(1, (ms + kTickMs - 1) / kTickMs)); };
+    auto nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+    auto idleMs = std::max<int64_t>(0, nowMs - static_cast<int64_t>(connection->GetLastActiveTs()));
+    uint64_t dueTick = mTick + ticksUntil(Connection::kIdleTimeoutMs - idleMs + 1);
+    if (connection->IsClose()) {
+        dueTick = std::min(dueTick, mTick + std::max(1, connection->GetEpoch() + 1));
+    }
+    if (mEnableConnStats) {
+        auto statsMs = std::chrono::duration_cast<std::chrono::milliseconds>(entry.mNextStatsTime - now).count();
+        dueTick = std::min(dueTick, mTick + ticksUntil(statsMs));
+    }
+    if (!connection->IsMetaAttachReadyForNetRecord()) {
+        dueTick = std::min(dueTick, mTick + entry.mMetaRetryTicks);
+        entry.mMetaRetryTicks = std::min(entry.mMetaRetryTicks * 2, kMaxMetaRetryTicks);
+    }
+    schedule(connId, entry, dueTick);
+    return true;
 }
 
 void ConnectionManager::Iterations() {
     std::chrono::time_point<std::chrono::steady_clock> now = std::chrono::steady_clock::now();
-    auto nowTs = std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count();
-    // report every seconds ...
-    bool needGenRecord = (nowTs - mLastReportTs > 5);
+    // mDueConnections is empty here, and its capacity is left to the slot
+    mDueConnections.swap(mWheel[mTick % kWheelSize]);
     LOG_DEBUG(sLogger,
-              ("[Iterations] conn tracker map size", mConnections.size())("total count", mConnectionTotal.load()));
+              ("[Iterations] due conn trackers", mDueConnections.size())("total count", mConnectionTotal.load()));
     int n = 0;
-    std::vector<ConnId> deleteQueue;
-    for (const auto& it : mConnections) {
-        auto connId = it.first;
-        auto connection = it.second;
-        if (!connection) {
-            // should not happen ...
-            LOG_WARNING(sLogger, ("no conn tracker??? pid", connId.tgid)("fd", connId.fd)("start", connId.start));
-            deleteQueue.push_back(it.first);
+    for (const auto& connId : mDueConnections) {
+        auto* entry = getEntry(connId);
+        if (entry == nullptr || entry->mDueTick != mTick) {
+            // deleted or rescheduled
             continue;
         }
-
-        connection->TryAttachPeerMeta();
-        connection->TryAttachSelfMeta();
-
-        bool forceGenRecord = false;
-        if (connection && connection->ReadyToDestroy(now)) {
-            forceGenRecord = true;
-            // push conn stats ...
-            deleteQueue.push_back(it.first);
-            connection->MarkConnDeleted();
+        entry->mDueTick = kNotScheduled;
+        if (!checkConnection(connId, *entry, now)) {
+            entry->mConn->MarkConnDeleted();
+            deleteConnection(connId);
+            LOG_DEBUG(sLogger, ("delete conntrackers pid", connId.tgid)("fd", connId.fd)("start", connId.start));
             n++;
-            continue;
-        }
-
-        if (mEnableConnStats && connection->IsMetaAttachReadyForNetRecord() && (needGenRecord || forceGenRecord)) {
-            std::shared_ptr<AbstractRecord> record = std::make_shared<ConnStatsRecord>(connection);
-            LOG_DEBUG(sLogger,
-                      ("needGenRecord", needGenRecord)("mEnableConnStats", mEnableConnStats)("forceGenRecord",
-                                                                                             forceGenRecord));
-            bool res = connection->GenerateConnStatsRecord(record);
-            if (res && mConnStatsHandler) {
-                mConnStatsHandler(record);
-            }
-            if (needGenRecord) {
-                mLastReportTs = nowTs; // update report ts
-            }
         }
-
-        // when we query for conn tracker, we record active
-        connection->CountDown();
-    }
-
-    // clean conn trackers ...
-    for (const auto& connId : deleteQueue) {
-        deleteConnection(connId);
-        LOG_DEBUG(sLogger, ("delete conntrackers pid", connId.tgid)("fd", connId.fd)("start", connId.start));
     }
+    mDueConnections.clear();
+    ++mTick;
 
     LOG_DEBUG(sLogger, ("[Iterations] remove conntrackers", n)("total conntrackers", mConnectionTotal.load()));
 }
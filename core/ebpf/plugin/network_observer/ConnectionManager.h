@@ -14,6 +14,7 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <memory>
@@ -23,6 +24,7 @@
 #include <string_view>
 #include <thread>
 #include <unordered_map>
+#include <vector>
 
 #include "Connection.h"
 #include "common/Lock.h"
@@ -33,14 +35,39 @@ extern "C" {
 
 namespace logtail::ebpf {
 
+// Connection objects released by their last holder are kept here and reset on reuse, together with the memory of
+// their tags. Connections may be released by any thread that holds a record.
+class ConnectionPool : public std::enable_shared_from_this<ConnectionPool> {
+public:
+    explicit ConnectionPool(size_t capacity) : mCapacity(capacity) {}
+    ~ConnectionPool();
+    ConnectionPool(const ConnectionPool&) = delete;
+    ConnectionPool& operator=(const ConnectionPool&) = delete;
+
+    std::shared_ptr<Connection> Acquire(const ConnId& connId);
+    size_t Size();
+
+private:
+    void Release(Connection* conn);
+
+    std::mutex mMux;
+    std::vector<Connection*> mConnections;
+    size_t mCapacity;
+};
+
 // used in poller thread
+//
+// Iterations() is called after every poll. Instead of visiting every connection, each connection sits in one slot of
+// a timing wheel ticked once per Iterations(), and is only checked when it is due: when a closed connection has
+// counted down its epoch, when it may have been idle for too long, when its stats have to be reported, or when its
+// metadata has to be attached again, which is retried with an exponential backoff.
 class ConnectionManager {
 public:
     static std::unique_ptr<ConnectionManager> Create(int maxConnections = 5000) {
         return std::unique_ptr<ConnectionManager>(new ConnectionManager(maxConnections));
     }
 
-    using ConnStatsHandler = std::function<void(std::shared_ptr<AbstractRecord>& record)>;
+    using ConnStatsHandler = std::function<void(RecordPtr<AbstractRecord>& record)>;
 
     ~ConnectionManager() {}
 
@@ -58,28 +85,68 @@ public:
     void UpdateMaxConnectionThreshold(int max) { mMaxConnections = max; }
 
 private:
-    explicit ConnectionManager(int maxConnections) : mMaxConnections(maxConnections), mConnectionTotal(0) {}
+    static constexpr uint64_t kNotScheduled = UINT64_MAX;
+
+    struct ConnectionEntry {
+        std::shared_ptr<Connection> mConn;
+        // the tick up to which the epoch of the connection has been counted down
+        uint64_t mCountedTick = 0;
+        uint64_t mDueTick = kNotScheduled;
+        uint32_t mMetaRetryTicks = 1;
+        std::chrono::steady_clock::time_point mNextStatsTime;
+    };
+    // the table is sharded so that growing it rehashes one shard at a time on the poller thread
+    using ConnectionShard = std::unordered_map<ConnId, ConnectionEntry, ConnIdHash>;
+
+    static constexpr size_t kShardNum = 16;
+    static constexpr size_t kWheelSize = 64;
+    // Iterations() is called once per poll window
+    static constexpr int64_t kTickMs = 200;
+    static constexpr int64_t kConnStatsIntervalMs = 5000;
+    // records waiting for the meta are rolled back every 300ms and dropped after 5 times, so the meta must be retried
+    // well within that window
+    static constexpr uint32_t kMaxMetaRetryTicks = 4;
+    static constexpr size_t kConnectionPoolSize = 1024;
+
+    explicit ConnectionManager(int maxConnections)
+        : mMaxConnections(maxConnections),
+          mConnectionTotal(0),
+          mConnectionPool(std::make_shared<ConnectionPool>(kConnectionPoolSize)) {}
 
     std::shared_ptr<Connection> getOrCreateConnection(const ConnId&);
     void deleteConnection(const ConnId&);
     std::shared_ptr<Connection> getConnection(const ConnId&);
 
+    ConnectionShard& getShard(const ConnId& connId) { return mShards[ConnIdHash()(connId) % kShardNum]; }
+    ConnectionEntry* getEntry(const ConnId& connId);
+    ConnectionEntry* getOrCreateEntry(const ConnId& connId);
+    // record the activity of the connection, and check it soon if it has been closed
+    void recordActive(const ConnId& connId, ConnectionEntry& entry);
+    // put the entry in the wheel at dueTick, unless it is already due earlier
+    void schedule(const ConnId& connId, ConnectionEntry& entry, uint64_t dueTick);
+    // return false if the connection should be deleted, otherwise schedule its next check
+    bool checkConnection(const ConnId& connId,
+                         ConnectionEntry& entry,
+                         const std::chrono::steady_clock::time_point& now);
+
     std::atomic_int mMaxConnections;
 
     std::atomic_bool mEnableConnStats = false;
     ConnStatsHandler mConnStatsHandler = nullptr;
 
     std::atomic_int64_t mConnectionTotal;
-    // object pool, used for cache some conn_tracker objects
-    // lock used to protect conn_trackers map
-    // mutable ReadWriteLock mReadWriteLock;
-    std::unordered_map<ConnId, std::shared_ptr<Connection>> mConnections;
+    std::shared_ptr<ConnectionPool> mConnectionPool;
+    std::array<ConnectionShard, kShardNum> mShards;
 
-    int64_t mLastReportTs = -1;
+    // ticks since creation, one per Iterations()
+    uint64_t mTick = 0;
+    std::array<std::vector<ConnId>, kWheelSize> mWheel;
+    std::vector<ConnId> mDueConnections;
     friend class NetworkObserverManager;
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class ConnectionUnittest;
     friend class ConnectionManagerUnittest;
+    friend class NetworkObserverManagerUnittest;
 #endif
 };
 
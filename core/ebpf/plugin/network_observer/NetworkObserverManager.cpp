@@ -14,6 +14,11 @@
 
 #include "ebpf/plugin/network_observer/NetworkObserverManager.h"
 
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+
+#include "Flags.h"
 #include "collection_pipeline/queue/ProcessQueueItem.h"
 #include "collection_pipeline/queue/ProcessQueueManager.h"
 #include "common/HashUtil.h"
@@ -35,12 +40,27 @@ extern "C" {
 #include <coolbpf/net.h>
 }
 
+DEFINE_FLAG_INT32(ebpf_network_observer_parse_worker_num,
+                  "Number of threads parsing network observer data events, 0 parses on the polling thread",
+                  2);
+DEFINE_FLAG_INT32(ebpf_network_observer_parse_queue_size,
+                  "Max data events waiting in the queue of each parse worker",
+                  16384);
+DEFINE_FLAG_INT32(ebpf_network_observer_max_capture_bytes,
+                  "Max bytes of a request or a response handed to the protocol parsers, longer bodies are cut",
+                  4096);
+DEFINE_FLAG_BOOL(ebpf_network_observer_kernel_sampling,
+                 "Sample data events in kernel when metrics are disabled, the events dropped in kernel never reach the "
+                 "parsers, so error responses and slow requests among them are lost instead of being force sampled",
+                 false);
+
 namespace logtail::ebpf {
 
 class EBPFServer;
 
 inline constexpr int kNetObserverMaxBatchConsumeSize = 4096;
 inline constexpr int kNetObserverMaxWaitTimeMS = 0;
+inline constexpr size_t kParseWorkerMaxBatchSize = 256;
 
 static constexpr uint32_t kAppIdIndex = kConnTrackerTable.ColIndex(kAppId.Name());
 static constexpr uint32_t kAppNameIndex = kConnTrackerTable.ColIndex(kAppName.Name());
@@ -55,6 +75,19 @@ static constexpr uint32_t kPeerWorkloadKindIndex = kConnTrackerTable.ColIndex(kP
 static constexpr uint32_t kPeerWorkloadNameIndex = kConnTrackerTable.ColIndex(kPeerWorkloadName.Name());
 static constexpr uint32_t kPeerNamespaceIndex = kConnTrackerTable.ColIndex(kPeerNamespace.Name());
 
+// Resets a drained aggregate table when leaving the scope it is consumed in, on every return path.
+template <class Table>
+class DrainedTableReset {
+public:
+    explicit DrainedTableReset(Table& table) : mTable(table) {}
+    ~DrainedTableReset() { mTable.Reset(); }
+    DrainedTableReset(const DrainedTableReset&) = delete;
+    DrainedTableReset& operator=(const DrainedTableReset&) = delete;
+
+private:
+    Table& mTable;
+};
+
 // apm
 const static std::string kMetricNameTag = "arms_tag_entity";
 const static std::string kMetricNameRequestTotal = "arms_rpc_requests_count";
@@ -115,85 +148,141 @@ enum {
     TCP_MAX_STATES = 13,
 };
 
-NetworkObserverManager::NetworkObserverManager(const std::shared_ptr<ProcessCacheManager>& processCacheManager,
-                                               const std::shared_ptr<EBPFAdapter>& eBPFAdapter,
-                                               moodycamel::BlockingConcurrentQueue<std::shared_ptr<CommonEvent>>& queue,
-                                               const PluginMetricManagerPtr& metricManager)
-    : AbstractManager(processCacheManager, eBPFAdapter, queue, metricManager),
-      mAppAggregator(
-          10240,
-          [](std::unique_ptr<AppMetricData>& base, const std::shared_ptr<AbstractRecord>& o) {
-              auto* other = static_cast<AbstractAppRecord*>(o.get());
-              int statusCode = other->GetStatusCode();
-              if (statusCode >= 500) {
-                  base->m5xxCount += 1;
-              } else if (statusCode >= 400) {
-                  base->m4xxCount += 1;
-              } else if (statusCode >= 300) {
-                  base->m3xxCount += 1;
-              } else {
-                  base->m2xxCount += 1;
-              }
-              base->mCount++;
-              base->mErrCount += other->IsError();
-              base->mSlowCount += other->IsSlow();
-              base->mSum += other->GetLatencySeconds();
-          },
-          [](const std::shared_ptr<AbstractRecord>& i,
-             std::shared_ptr<SourceBuffer>& sourceBuffer) -> std::unique_ptr<AppMetricData> {
-              auto* in = static_cast<AbstractAppRecord*>(i.get());
-              auto spanName = sourceBuffer->CopyString(in->GetSpanName());
-              auto connection = in->GetConnection();
-              if (!connection) {
-                  LOG_WARNING(sLogger, ("connection is null", ""));
-                  return nullptr;
-              }
-              auto data
-                  = std::make_unique<AppMetricData>(connection, sourceBuffer, StringView(spanName.data, spanName.size));
+static void aggregateAppMetric(std::unique_ptr<AppMetricData>& base, const RecordPtr<AbstractRecord>& o) {
+    auto* other = static_cast<AbstractAppRecord*>(o.get());
+    int statusCode = other->GetStatusCode();
+    if (statusCode >= 500) {
+        base->m5xxCount += 1;
+    } else if (statusCode >= 400) {
+        base->m4xxCount += 1;
+    } else if (statusCode >= 300) {
+        base->m3xxCount += 1;
+    } else {
+        base->m2xxCount += 1;
+    }
+    base->mCount++;
+    base->mErrCount += other->IsError();
+    base->mSlowCount += other->IsSlow();
+    base->mSum += other->GetLatencySeconds();
+}
 
-              const auto& ctAttrs = connection->GetConnTrackerAttrs();
-              {
-                  auto appId = sourceBuffer->CopyString(ctAttrs.Get<kAppIdIndex>());
-                  data->mTags.SetNoCopy<kAppId>(StringView(appId.data, appId.size));
+static std::unique_ptr<AppMetricData> buildAppMetric(const RecordPtr<AbstractRecord>& i,
+                                                     std::shared_ptr<SourceBuffer>& sourceBuffer) {
+    auto* in = static_cast<AbstractAppRecord*>(i.get());
+    auto spanName = sourceBuffer->CopyString(in->GetSpanName());
+    auto connection = in->GetConnection();
+    if (!connection) {
+        LOG_WARNING(sLogger, ("connection is null", ""));
+        return nullptr;
+    }
+    auto data = std::make_unique<AppMetricData>(connection, sourceBuffer, StringView(spanName.data, spanName.size));
 
-                  auto appName = sourceBuffer->CopyString(ctAttrs.Get<kAppNameIndex>());
-                  data->mTags.SetNoCopy<kAppName>(StringView(appName.data, appName.size));
+    const auto& ctAttrs = connection->GetConnTrackerAttrs();
+    {
+        auto appId = sourceBuffer->CopyString(ctAttrs.Get<kAppIdIndex>());
+        data->mTags.SetNoCopy<kAppId>(StringView(appId.data, appId.size));
 
-                  auto host = sourceBuffer->CopyString(ctAttrs.Get<kHostNameIndex>());
-                  data->mTags.SetNoCopy<kHostName>(StringView(host.data, host.size));
+        auto appName = sourceBuffer->CopyString(ctAttrs.Get<kAppNameIndex>());
+        data->mTags.SetNoCopy<kAppName>(StringView(appName.data, appName.size));
 
-                  auto ip = sourceBuffer->CopyString(ctAttrs.Get<kIp>());
-                  data->mTags.SetNoCopy<kIp>(StringView(ip.data, ip.size));
-              }
+        auto host = sourceBuffer->CopyString(ctAttrs.Get<kHostNameIndex>());
+        data->mTags.SetNoCopy<kHostName>(StringView(host.data, host.size));
 
-              auto workloadKind = sourceBuffer->CopyString(ctAttrs.Get<kWorkloadKind>());
-              data->mTags.SetNoCopy<kWorkloadKind>(StringView(workloadKind.data, workloadKind.size));
+        auto ip = sourceBuffer->CopyString(ctAttrs.Get<kIp>());
+        data->mTags.SetNoCopy<kIp>(StringView(ip.data, ip.size));
+    }
 
-              auto workloadName = sourceBuffer->CopyString(ctAttrs.Get<kWorkloadName>());
-              data->mTags.SetNoCopy<kWorkloadName>(StringView(workloadName.data, workloadName.size));
+    auto workloadKind = sourceBuffer->CopyString(ctAttrs.Get<kWorkloadKind>());
+    data->mTags.SetNoCopy<kWorkloadKind>(StringView(workloadKind.data, workloadKind.size));
 
-              auto mRpcType = sourceBuffer->CopyString(ctAttrs.Get<kRpcType>());
-              data->mTags.SetNoCopy<kRpcType>(StringView(mRpcType.data, mRpcType.size));
+    auto workloadName = sourceBuffer->CopyString(ctAttrs.Get<kWorkloadName>());
+    data->mTags.SetNoCopy<kWorkloadName>(StringView(workloadName.data, workloadName.size));
 
-              auto mCallType = sourceBuffer->CopyString(ctAttrs.Get<kCallType>());
-              data->mTags.SetNoCopy<kCallType>(StringView(mCallType.data, mCallType.size));
+    auto mRpcType = sourceBuffer->CopyString(ctAttrs.Get<kRpcType>());
+    data->mTags.SetNoCopy<kRpcType>(StringView(mRpcType.data, mRpcType.size));
 
-              auto mCallKind = sourceBuffer->CopyString(ctAttrs.Get<kCallKind>());
-              data->mTags.SetNoCopy<kCallKind>(StringView(mCallKind.data, mCallKind.size));
+    auto mCallType = sourceBuffer->CopyString(ctAttrs.Get<kCallType>());
+    data->mTags.SetNoCopy<kCallType>(StringView(mCallType.data, mCallType.size));
 
-              auto mDestId = sourceBuffer->CopyString(ctAttrs.Get<kDestId>());
-              data->mTags.SetNoCopy<kDestId>(StringView(mDestId.data, mDestId.size));
+    auto mCallKind = sourceBuffer->CopyString(ctAttrs.Get<kCallKind>());
+    data->mTags.SetNoCopy<kCallKind>(StringView(mCallKind.data, mCallKind.size));
 
-              auto endpoint = sourceBuffer->CopyString(ctAttrs.Get<kEndpoint>());
-              data->mTags.SetNoCopy<kEndpoint>(StringView(endpoint.data, endpoint.size));
+    auto mDestId = sourceBuffer->CopyString(ctAttrs.Get<kDestId>());
+    data->mTags.SetNoCopy<kDestId>(StringView(mDestId.data, mDestId.size));
 
-              auto ns = sourceBuffer->CopyString(ctAttrs.Get<kNamespace>());
-              data->mTags.SetNoCopy<kNamespace>(StringView(ns.data, ns.size));
-              return data;
-          }),
+    auto endpoint = sourceBuffer->CopyString(ctAttrs.Get<kEndpoint>());
+    data->mTags.SetNoCopy<kEndpoint>(StringView(endpoint.data, endpoint.size));
+
+    auto ns = sourceBuffer->CopyString(ctAttrs.Get<kNamespace>());
+    data->mTags.SetNoCopy<kNamespace>(StringView(ns.data, ns.size));
+    return data;
+}
+
+static void mergeAppMetric(std::unique_ptr<AppMetricData>& base, std::unique_ptr<AppMetricData>& other) {
+    base->mCount += other->mCount;
+    base->mSum += other->mSum;
+    base->mSlowCount += other->mSlowCount;
+    base->mErrCount += other->mErrCount;
+    base->m2xxCount += other->m2xxCount;
+    base->m3xxCount += other->m3xxCount;
+    base->m4xxCount += other->m4xxCount;
+    base->m5xxCount += other->m5xxCount;
+}
+
+template <typename RecordGroup>
+static void aggregateRecord(std::unique_ptr<RecordGroup>& base, const RecordPtr<AbstractRecord>& other) {
+    base->mRecords.push_back(other.Ref());
+}
+
+template <typename RecordGroup>
+static std::unique_ptr<RecordGroup> buildRecordGroup(const RecordPtr<AbstractRecord>&,
+                                                     std::shared_ptr<SourceBuffer>&) {
+    return std::make_unique<RecordGroup>();
+}
+
+template <typename RecordGroup>
+static void mergeRecordGroup(std::unique_ptr<RecordGroup>& base, std::unique_ptr<RecordGroup>& other) {
+    base->mRecords.insert(base->mRecords.end(),
+                          std::make_move_iterator(other->mRecords.begin()),
+                          std::make_move_iterator(other->mRecords.end()));
+}
+
+AppAggregateShard::AppAggregateShard()
+    : mAppAggregator(10240, aggregateAppMetric, buildAppMetric),
+      mSpanAggregator(1024, // 1024 span per second
+                      aggregateRecord<AppSpanGroup>,
+                      buildRecordGroup<AppSpanGroup>),
+      mLogAggregator(1024, // 1024 log per second
+                     aggregateRecord<AppLogGroup>,
+                     buildRecordGroup<AppLogGroup>) {
+}
+
+// Copy the event with the request and the response each cut to maxMsgBytes. Unsampled records only need the start
+// line and the headers, and sampled ones keep at most 256 bytes of a body.
+static std::unique_ptr<char[]> copyDataEvent(const conn_data_event_t* event, uint32_t maxMsgBytes) {
+    uint32_t reqLen = std::min<uint32_t>(event->request_len, maxMsgBytes);
+    uint32_t respLen = std::min<uint32_t>(event->response_len, maxMsgBytes);
+    auto copy = std::make_unique<char[]>(offsetof(conn_data_event_t, msg) + reqLen + respLen);
+    auto* out = reinterpret_cast<conn_data_event_t*>(copy.get());
+    memcpy(out, event, offsetof(conn_data_event_t, msg));
+    memcpy(out->msg, event->msg, reqLen);
+    memcpy(out->msg + reqLen, event->msg + event->request_len, respLen);
+    out->request_len = reqLen;
+    out->response_len = respLen;
+    return copy;
+}
+
+NetworkObserverManager::NetworkObserverManager(const std::shared_ptr<ProcessCacheManager>& processCacheManager,
+                                               const std::shared_ptr<EBPFAdapter>& eBPFAdapter,
+                                               moodycamel::BlockingConcurrentQueue<std::shared_ptr<CommonEvent>>& queue,
+                                               const PluginMetricManagerPtr& metricManager)
+    : AbstractManager(processCacheManager, eBPFAdapter, queue, metricManager),
+      mDrainedAppAggregator(10240),
+      mDrainedSpanAggregator(1024),
+      mDrainedLogAggregator(1024),
       mNetAggregator(
           10240,
-          [](std::unique_ptr<NetMetricData>& base, const std::shared_ptr<AbstractRecord>& o) {
+          [](std::unique_ptr<NetMetricData>& base, const RecordPtr<AbstractRecord>& o) {
               auto* other = static_cast<ConnStatsRecord*>(o.get());
               base->mDropCount += other->mDropCount;
               base->mRetransCount += other->mRetransCount;
@@ -209,7 +298,7 @@ NetworkObserverManager::NetworkObserverManager(const std::shared_ptr<ProcessCach
                   base->mStateCounts[0]++;
               }
           },
-          [](const std::shared_ptr<AbstractRecord>& i, std::shared_ptr<SourceBuffer>& sourceBuffer) {
+          [](const RecordPtr<AbstractRecord>& i, std::shared_ptr<SourceBuffer>& sourceBuffer) {
               auto* in = static_cast<ConnStatsRecord*>(i.get());
               auto connection = in->GetConnection();
               auto data = std::make_unique<NetMetricData>(connection, sourceBuffer);
@@ -253,23 +342,11 @@ NetworkObserverManager::NetworkObserverManager(const std::shared_ptr<ProcessCach
               auto ppn = sourceBuffer->CopyString(ctAttrs.Get<kPeerPodName>());
               data->mTags.SetNoCopy<kPeerPodName>(StringView(ppn.data, ppn.size));
               return data;
-          }),
-      mSpanAggregator(
-          1024, // 1024 span per second
-          [](std::unique_ptr<AppSpanGroup>& base, const std::shared_ptr<AbstractRecord>& other) {
-              base->mRecords.push_back(other);
-          },
-          [](const std::shared_ptr<AbstractRecord>&, std::shared_ptr<SourceBuffer>&) {
-              return std::make_unique<AppSpanGroup>();
-          }),
-      mLogAggregator(
-          1024, // 1024 log per second
-          [](std::unique_ptr<AppLogGroup>& base, const std::shared_ptr<AbstractRecord>& other) {
-              base->mRecords.push_back(other);
-          },
-          [](const std::shared_ptr<AbstractRecord>&, std::shared_ptr<SourceBuffer>&) {
-              return std::make_unique<AppLogGroup>();
           }) {
+    // one shard per parse worker and the shared one
+    for (int32_t i = 0; i <= std::max(INT32_FLAG(ebpf_network_observer_parse_worker_num), 0); ++i) {
+        mAggregateShards.emplace_back(std::make_unique<AppAggregateShard>());
+    }
     if (mMetricMgr) {
         // init metrics
         MetricLabels connectionNumLabels = {{METRIC_LABEL_KEY_EVENT_SOURCE, METRIC_LABEL_VALUE_EVENT_SOURCE_EBPF}};
@@ -305,17 +382,15 @@ NetworkObserverManager::NetworkObserverManager(const std::shared_ptr<ProcessCach
     }
 }
 
-std::array<size_t, 2>
-NetworkObserverManager::GenerateAggKeyForNetMetric(const std::shared_ptr<AbstractRecord>& abstractRecord) {
+bool NetworkObserverManager::GenerateAggKeyForNetMetric(const RecordPtr<AbstractRecord>& abstractRecord,
+                                                        AggregateKey& key) {
     auto* record = static_cast<ConnStatsRecord*>(abstractRecord.get());
     // calculate agg key
-    std::array<size_t, 2> result{};
-    result.fill(0UL);
-    std::hash<std::string_view> hasher;
+    key.Clear();
     auto connection = record->GetConnection();
     if (!connection) {
         LOG_WARNING(sLogger, ("connection is null", ""));
-        return {};
+        return false;
     }
 
     const auto& connTrackerAttrs = connection->GetConnTrackerAttrs();
@@ -332,27 +407,23 @@ NetworkObserverManager::GenerateAggKeyForNetMetric(const std::shared_ptr<Abstrac
                                      kPeerNamespaceIndex};
 
     for (const auto& x : kIdxes0) {
-        std::string_view attr(connTrackerAttrs[x].data(), connTrackerAttrs[x].size());
-        AttrHashCombine(result[0], hasher(attr));
+        key.AddGroupAttr(connTrackerAttrs[x]);
     }
     for (const auto& x : kIdxes1) {
-        std::string_view attr(connTrackerAttrs[x].data(), connTrackerAttrs[x].size());
-        AttrHashCombine(result[1], hasher(attr));
+        key.AddSeriesAttr(connTrackerAttrs[x]);
     }
-    return result;
+    return true;
 }
 
-std::array<size_t, 2>
-NetworkObserverManager::GenerateAggKeyForAppMetric(const std::shared_ptr<AbstractRecord>& abstractRecord) {
+bool NetworkObserverManager::GenerateAggKeyForAppMetric(const RecordPtr<AbstractRecord>& abstractRecord,
+                                                        AggregateKey& key) {
     auto* record = static_cast<AbstractAppRecord*>(abstractRecord.get());
     // calculate agg key
-    std::array<size_t, 2> result{};
-    result.fill(0UL);
-    std::hash<std::string_view> hasher;
+    key.Clear();
     auto connection = record->GetConnection();
     if (!connection) {
         LOG_WARNING(sLogger, ("connection is null", ""));
-        return {};
+        return false;
     }
 
     static constexpr std::array<uint32_t, 4> kIdxes0 = {kAppIdIndex, kAppNameIndex, kHostNameIndex, kHostIpIndex};
@@ -367,62 +438,74 @@ NetworkObserverManager::GenerateAggKeyForAppMetric(const std::shared_ptr<Abstrac
 
     const auto& ctAttrs = connection->GetConnTrackerAttrs();
     for (const auto x : kIdxes0) {
-        std::string_view attr(ctAttrs[x].data(), ctAttrs[x].size());
-        AttrHashCombine(result[0], hasher(attr));
+        key.AddGroupAttr(ctAttrs[x]);
     }
     for (const auto x : kIdxes1) {
-        std::string_view attr(ctAttrs[x].data(), ctAttrs[x].size());
-        AttrHashCombine(result[1], hasher(attr));
+        key.AddSeriesAttr(ctAttrs[x]);
     }
-    std::string_view rpc(record->GetSpanName());
-    AttrHashCombine(result[1], hasher(rpc));
+    key.AddSeriesAttr(record->GetSpanName());
 
-    return result;
+    return true;
 }
 
-std::array<size_t, 1>
-NetworkObserverManager::GenerateAggKeyForSpan(const std::shared_ptr<AbstractRecord>& abstractRecord) {
+bool NetworkObserverManager::GenerateAggKeyForSpan(const RecordPtr<AbstractRecord>& abstractRecord,
+                                                   AggregateKey& key) {
     auto* record = static_cast<AbstractAppRecord*>(abstractRecord.get());
     // calculate agg key
     // just appid
-    std::array<size_t, 1> result{};
-    result.fill(0UL);
-    std::hash<std::string_view> hasher;
+    key.Clear();
     auto connection = record->GetConnection();
     if (!connection) {
         LOG_WARNING(sLogger, ("connection is null", ""));
-        return {};
+        return false;
     }
     const auto& ctAttrs = connection->GetConnTrackerAttrs();
     static constexpr auto kIdxes = {kAppIdIndex, kAppNameIndex, kHostNameIndex, kHostIpIndex};
     for (const auto& x : kIdxes) {
-        std::string_view attr(ctAttrs[x].data(), ctAttrs[x].size());
-        AttrHashCombine(result[0], hasher(attr));
+        key.AddGroupAttr(ctAttrs[x]);
     }
 
-    return result;
+    return true;
 }
 
-std::array<size_t, 1>
-NetworkObserverManager::GenerateAggKeyForLog(const std::shared_ptr<AbstractRecord>& abstractRecord) {
+bool NetworkObserverManager::GenerateAggKeyForLog(const RecordPtr<AbstractRecord>& abstractRecord,
+                                                  AggregateKey& key) {
     auto* record = static_cast<AbstractAppRecord*>(abstractRecord.get());
     // just appid
-    std::array<size_t, 1> result{};
-    result.fill(0UL);
-    std::hash<uint64_t> hasher;
+    key.Clear();
     auto connection = record->GetConnection();
     if (!connection) {
         LOG_WARNING(sLogger, ("connection is null", ""));
-        return {};
+        return false;
     }
 
     auto connId = connection->GetConnId();
 
-    AttrHashCombine(result[0], hasher(connId.fd));
-    AttrHashCombine(result[0], hasher(connId.tgid));
-    AttrHashCombine(result[0], hasher(connId.start));
+    key.AddGroupAttr(static_cast<uint64_t>(connId.fd));
+    key.AddGroupAttr(static_cast<uint64_t>(connId.tgid));
+    key.AddGroupAttr(static_cast<uint64_t>(connId.start));
+
+    return true;
+}
 
-    return result;
+// Spans and logs only keep sampled records, so without metrics the events can be sampled in kernel and the dropped ones
+// are never copied to user space. The sampler in user space keeps the part of the rate finer than a percent. Kernel
+// sampling is opt-in since it cannot see the status or latency the parsers force sample on.
+int32_t NetworkObserverManager::updateSampler(double sampleRate) {
+    if (sampleRate < 0) {
+        LOG_WARNING(sLogger, ("invalid sample rate, must between [0, 1], use default 0.01, given", sampleRate));
+        sampleRate = 0;
+    } else if (sampleRate >= 1) {
+        sampleRate = 1.0;
+    }
+    mKernelSamplingPercent = (mEnableMetric || !BOOL_FLAG(ebpf_network_observer_kernel_sampling))
+        ? 100
+        : static_cast<int32_t>(std::ceil(sampleRate * 100));
+    double userRate = mKernelSamplingPercent == 0 ? 0 : sampleRate * 100 / mKernelSamplingPercent;
+    LOG_INFO(sLogger, ("sample rate", sampleRate)("kernel sampling percent", mKernelSamplingPercent));
+    WriteLock lk(mSamplerLock);
+    mSampler = std::make_shared<HashRatioSampler>(userRate);
+    return mKernelSamplingPercent;
 }
 
 bool NetworkObserverManager::updateParsers(const std::vector<std::string>& protocols,
@@ -454,18 +537,26 @@ bool NetworkObserverManager::ConsumeLogAggregateTree(const std::chrono::steady_c
     mExecTimes++;
 #endif
 
-    WriteLock lk(mLogAggLock);
-    SIZETAggTree<AppLogGroup, std::shared_ptr<AbstractRecord>> aggTree = this->mLogAggregator.GetAndReset();
-    lk.unlock();
+    std::lock_guard<std::mutex> consumeLock(mLogConsumeMux);
+    // the series are released once consumed, the capacity is kept for the next window
+    DrainedTableReset<decltype(mDrainedLogAggregator)> drainedReset(mDrainedLogAggregator);
+    for (auto& shard : mAggregateShards) {
+        WriteLock lk(shard->mLogAggLock);
+        shard->mLogAggregator.Swap(mMergingLogAggregator);
+        lk.unlock();
+        mDrainedLogAggregator.Merge(mMergingLogAggregator, mergeRecordGroup<AppLogGroup>);
+        mMergingLogAggregator.Reset();
+    }
+    const auto& aggTree = mDrainedLogAggregator;
 
-    auto nodes = aggTree.GetNodesWithAggDepth(1);
+    const auto& nodes = aggTree.GetGroups();
     LOG_DEBUG(sLogger, ("enter log aggregator ...", nodes.size())("node size", aggTree.NodeCount()));
     if (nodes.empty()) {
         LOG_DEBUG(sLogger, ("empty nodes...", "")("node size", aggTree.NodeCount()));
         return true;
     }
 
-    for (auto& node : nodes) {
+    for (const auto& node : nodes) {
         // convert to a item and push to process queue
         auto sourceBuffer = std::make_shared<SourceBuffer>();
         PipelineEventGroup eventGroup(sourceBuffer); // per node represent an APP ...
@@ -588,12 +679,15 @@ bool NetworkObserverManager::ConsumeNetMetricAggregateTree(const std::chrono::st
     mExecTimes++;
 #endif
 
-    WriteLock lk(mLogAggLock);
-    SIZETAggTreeWithSourceBuffer<NetMetricData, std::shared_ptr<AbstractRecord>> aggTree
-        = this->mNetAggregator.GetAndReset();
+    std::lock_guard<std::mutex> consumeLock(mNetConsumeMux);
+    // the series are released once consumed, the capacity is kept for the next window
+    DrainedTableReset<decltype(mDrainedNetAggregator)> drainedReset(mDrainedNetAggregator);
+    WriteLock lk(mNetAggLock);
+    this->mNetAggregator.Swap(mDrainedNetAggregator);
     lk.unlock();
+    const auto& aggTree = mDrainedNetAggregator;
 
-    auto nodes = aggTree.GetNodesWithAggDepth(1);
+    const auto& nodes = aggTree.GetGroups();
     LOG_DEBUG(sLogger, ("enter net aggregator ...", nodes.size())("node size", aggTree.NodeCount()));
     if (nodes.empty()) {
         LOG_DEBUG(sLogger, ("empty nodes...", "")("node size", aggTree.NodeCount()));
@@ -604,13 +698,13 @@ bool NetworkObserverManager::ConsumeNetMetricAggregateTree(const std::chrono::st
     auto duration = now.time_since_epoch();
     auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration).count();
 
-    for (auto& node : nodes) {
-        LOG_DEBUG(sLogger, ("node child size", node->mChild.size()));
+    for (const auto& node : nodes) {
+        LOG_DEBUG(sLogger, ("node child size", node.mSize));
         // convert to a item and push to process queue
         // every node represent an instance of an arms app ...
 
         // auto sourceBuffer = std::make_shared<SourceBuffer>();
-        std::shared_ptr<SourceBuffer> sourceBuffer = node->mSourceBuffer;
+        std::shared_ptr<SourceBuffer> sourceBuffer = node.mSourceBuffer;
         PipelineEventGroup eventGroup(sourceBuffer); // per node represent an APP ...
         eventGroup.SetTagNoCopy(kAppType.MetricKey(), kEBPFValue);
         eventGroup.SetTagNoCopy(kDataType.MetricKey(), kMetricValue);
@@ -744,14 +838,21 @@ bool NetworkObserverManager::ConsumeMetricAggregateTree(const std::chrono::stead
     mExecTimes++;
 #endif
 
-    LOG_DEBUG(sLogger, ("enter aggregator ...", mAppAggregator.NodeCount()));
-
-    WriteLock lk(this->mAppAggLock);
-    SIZETAggTreeWithSourceBuffer<AppMetricData, std::shared_ptr<AbstractRecord>> aggTree
-        = this->mAppAggregator.GetAndReset();
-    lk.unlock();
+    LOG_DEBUG(sLogger, ("enter aggregator, shards", mAggregateShards.size()));
+
+    std::lock_guard<std::mutex> consumeLock(mAppConsumeMux);
+    // the series are released once consumed, the capacity is kept for the next window
+    DrainedTableReset<decltype(mDrainedAppAggregator)> drainedReset(mDrainedAppAggregator);
+    for (auto& shard : mAggregateShards) {
+        WriteLock lk(shard->mAppAggLock);
+        shard->mAppAggregator.Swap(mMergingAppAggregator);
+        lk.unlock();
+        mDrainedAppAggregator.Merge(mMergingAppAggregator, mergeAppMetric);
+        mMergingAppAggregator.Reset();
+    }
+    const auto& aggTree = mDrainedAppAggregator;
 
-    auto nodes = aggTree.GetNodesWithAggDepth(1);
+    const auto& nodes = aggTree.GetGroups();
     LOG_DEBUG(sLogger, ("enter aggregator ...", nodes.size())("node size", aggTree.NodeCount()));
     if (nodes.empty()) {
         LOG_DEBUG(sLogger, ("empty nodes...", ""));
@@ -762,12 +863,12 @@ bool NetworkObserverManager::ConsumeMetricAggregateTree(const std::chrono::stead
     auto duration = now.time_since_epoch();
     auto seconds = std::chrono::duration_cast<std::chrono::seconds>(duration).count();
 
-    for (auto& node : nodes) {
-        LOG_DEBUG(sLogger, ("node child size", node->mChild.size()));
+    for (const auto& node : nodes) {
+        LOG_DEBUG(sLogger, ("node child size", node.mSize));
         // convert to a item and push to process queue
         // every node represent an instance of an arms app ...
         // auto sourceBuffer = std::make_shared<SourceBuffer>();
-        std::shared_ptr<SourceBuffer> sourceBuffer = node->mSourceBuffer;
+        std::shared_ptr<SourceBuffer> sourceBuffer = node.mSourceBuffer;
         PipelineEventGroup eventGroup(sourceBuffer); // per node represent an APP ...
         eventGroup.SetTagNoCopy(kAppType.MetricKey(), kEBPFValue);
         eventGroup.SetTagNoCopy(kDataType.MetricKey(), kMetricValue);
@@ -948,18 +1049,26 @@ bool NetworkObserverManager::ConsumeSpanAggregateTree(const std::chrono::steady_
     mExecTimes++;
 #endif
 
-    WriteLock lk(mSpanAggLock);
-    SIZETAggTree<AppSpanGroup, std::shared_ptr<AbstractRecord>> aggTree = this->mSpanAggregator.GetAndReset();
-    lk.unlock();
+    std::lock_guard<std::mutex> consumeLock(mSpanConsumeMux);
+    // the series are released once consumed, the capacity is kept for the next window
+    DrainedTableReset<decltype(mDrainedSpanAggregator)> drainedReset(mDrainedSpanAggregator);
+    for (auto& shard : mAggregateShards) {
+        WriteLock lk(shard->mSpanAggLock);
+        shard->mSpanAggregator.Swap(mMergingSpanAggregator);
+        lk.unlock();
+        mDrainedSpanAggregator.Merge(mMergingSpanAggregator, mergeRecordGroup<AppSpanGroup>);
+        mMergingSpanAggregator.Reset();
+    }
+    const auto& aggTree = mDrainedSpanAggregator;
 
-    auto nodes = aggTree.GetNodesWithAggDepth(1);
+    const auto& nodes = aggTree.GetGroups();
     LOG_DEBUG(sLogger, ("enter aggregator ...", nodes.size())("node size", aggTree.NodeCount()));
     if (nodes.empty()) {
         LOG_DEBUG(sLogger, ("empty nodes...", ""));
         return true;
     }
 
-    for (auto& node : nodes) {
+    for (const auto& node : nodes) {
         // convert to a item and push to process queue
         auto sourceBuffer = std::make_shared<SourceBuffer>();
         PipelineEventGroup eventGroup(sourceBuffer); // per node represent an APP ...
@@ -1039,7 +1148,7 @@ bool NetworkObserverManager::ConsumeSpanAggregateTree(const std::chrono::steady_
                     spanEvent->SetKind(SpanEvent::Kind::Unspecified);
                 }
 
-                spanEvent->SetName(record->GetSpanName());
+                spanEvent->SetName(record->GetSpanName().to_string());
                 spanEvent->SetTag(kHTTPReqBody.SpanKey(), record->GetReqBody());
                 spanEvent->SetTag(kHTTPRespBody.SpanKey(), record->GetRespBody());
                 spanEvent->SetTag(kHTTPReqBodySize.SpanKey(), std::to_string(record->GetReqBodySize()));
@@ -1125,16 +1234,19 @@ int NetworkObserverManager::Update(
         compareAndUpdate("EnableSpan", mPreviousOpt->mEnableSpan, opt->mEnableSpan, [this](bool, bool newValue) {
             this->mEnableSpan = newValue;
         });
-        compareAndUpdate("SampleRate", mPreviousOpt->mSampleRate, opt->mSampleRate, [this](double, double newValue) {
-            if (newValue < 0) {
-                LOG_WARNING(sLogger, ("invalid sample rate, must between [0, 1], use default 0.01, given", newValue));
-                newValue = 0;
-            } else if (newValue >= 1) {
-                newValue = 1.0;
-            }
-            WriteLock lk(mSamplerLock);
-            mSampler = std::make_shared<HashRatioSampler>(newValue);
+        bool samplingChanged = false;
+        compareAndUpdate("SampleRate", mPreviousOpt->mSampleRate, opt->mSampleRate, [&](double, double) {
+            samplingChanged = true;
         });
+        if (mPreviousOpt->mEnableMetric != opt->mEnableMetric) {
+            samplingChanged = true;
+        }
+        if (samplingChanged) {
+            auto percent = updateSampler(opt->mSampleRate);
+            if (BOOL_FLAG(ebpf_network_observer_kernel_sampling)) {
+                mEBPFAdapter->SetNetworkObserverConfig(static_cast<int32_t>(DATA_SAMPLING), percent);
+            }
+        }
         compareAndUpdate("EnableProtocols",
                          mPreviousOpt->mEnableProtocols,
                          opt->mEnableProtocols,
@@ -1173,7 +1285,7 @@ int NetworkObserverManager::Init(const std::variant<SecurityOptions*, ObserverNe
     mConnectionManager->SetConnStatsStatus(!opt->mDisableConnStats);
     mConnectionManager->UpdateMaxConnectionThreshold(opt->mMaxConnections);
     mConnectionManager->RegisterConnStatsFunc(
-        [this](std::shared_ptr<AbstractRecord>& record) { processRecord(record); });
+        [this](RecordPtr<AbstractRecord>& record) { processRecord(record, sharedShard()); });
 
     mAppId = opt->mAppId;
     mAppName = opt->mAppName;
@@ -1201,24 +1313,13 @@ int NetworkObserverManager::Init(const std::variant<SecurityOptions*, ObserverNe
     ScheduleNext(now, spanConfig);
     ScheduleNext(now, logConfig);
 
-    // init sampler
-    {
-        if (opt->mSampleRate < 0) {
-            LOG_WARNING(sLogger,
-                        ("invalid sample rate, must between [0, 1], use default 0.01, given", opt->mSampleRate));
-            opt->mSampleRate = 0;
-        } else if (opt->mSampleRate >= 1) {
-            opt->mSampleRate = 1.0;
-        }
-        WriteLock lk(mSamplerLock);
-        LOG_INFO(sLogger, ("sample rate", opt->mSampleRate));
-        mSampler = std::make_shared<HashRatioSampler>(opt->mSampleRate);
-    }
-
     mEnableLog = opt->mEnableLog;
     mEnableSpan = opt->mEnableSpan;
     mEnableMetric = opt->mEnableMetric;
 
+    // init sampler
+    updateSampler(opt->mSampleRate);
+
     mPreviousOpt = std::make_unique<ObserverNetworkOption>(*opt);
 
     std::unique_ptr<PluginConfig> pc = std::make_unique<PluginConfig>();
@@ -1286,6 +1387,7 @@ int NetworkObserverManager::Init(const std::variant<SecurityOptions*, ObserverNe
         config.mCidOffset = mCidOffset;
         config.mEnableCidFilter = true;
     }
+    config.mDataSampling = mKernelSamplingPercent;
 
     pc->mConfig = config;
     auto ret = mEBPFAdapter->StartPlugin(PluginType::NETWORK_OBSERVE, std::move(pc));
@@ -1293,7 +1395,7 @@ int NetworkObserverManager::Init(const std::variant<SecurityOptions*, ObserverNe
         return -1;
     }
 
-    mRollbackQueue = moodycamel::BlockingConcurrentQueue<std::shared_ptr<AbstractRecord>>(4096);
+    mRollbackQueue = moodycamel::BlockingConcurrentQueue<RecordPtr<AbstractRecord>>(4096);
 
     LOG_INFO(sLogger, ("begin to start ebpf ... ", ""));
     this->mFlag = true;
@@ -1409,31 +1511,45 @@ void NetworkObserverManager::runInThread() {
     // periodically poll perf buffer ...
     LOG_INFO(sLogger, ("enter core thread ", ""));
     // start a new thread to poll perf buffer ...
+    for (size_t i = 0; i + 1 < mAggregateShards.size(); ++i) {
+        mParseWorkers.emplace_back(
+            std::make_unique<ParseWorker>(std::max(INT32_FLAG(ebpf_network_observer_parse_queue_size), 1)));
+        mParseWorkers.back()->mThread = std::thread(&NetworkObserverManager::runParseWorker, this, i);
+    }
     mCoreThread = std::thread(&NetworkObserverManager::PollBufferWrapper, this);
     mRecordConsume = std::thread(&NetworkObserverManager::ConsumeRecords, this);
 
     LOG_INFO(sLogger, ("network observer plugin installed.", ""));
 }
 
-void NetworkObserverManager::processRecordAsLog(const std::shared_ptr<AbstractRecord>& record) {
-    WriteLock lk(mLogAggLock);
-    auto res = mLogAggregator.Aggregate(record, GenerateAggKeyForLog(record));
-    LOG_DEBUG(sLogger, ("agg res", res)("node count", mLogAggregator.NodeCount()));
+void NetworkObserverManager::processRecordAsLog(const RecordPtr<AbstractRecord>& record, AppAggregateShard& shard) {
+    WriteLock lk(shard.mLogAggLock);
+    if (!GenerateAggKeyForLog(record, shard.mLogAggKey)) {
+        return;
+    }
+    auto res = shard.mLogAggregator.Aggregate(record, shard.mLogAggKey);
+    LOG_DEBUG(sLogger, ("agg res", res)("node count", shard.mLogAggregator.NodeCount()));
 }
 
-void NetworkObserverManager::processRecordAsSpan(const std::shared_ptr<AbstractRecord>& record) {
-    WriteLock lk(mSpanAggLock);
-    auto res = mSpanAggregator.Aggregate(record, GenerateAggKeyForSpan(record));
-    LOG_DEBUG(sLogger, ("agg res", res)("node count", mSpanAggregator.NodeCount()));
+void NetworkObserverManager::processRecordAsSpan(const RecordPtr<AbstractRecord>& record, AppAggregateShard& shard) {
+    WriteLock lk(shard.mSpanAggLock);
+    if (!GenerateAggKeyForSpan(record, shard.mSpanAggKey)) {
+        return;
+    }
+    auto res = shard.mSpanAggregator.Aggregate(record, shard.mSpanAggKey);
+    LOG_DEBUG(sLogger, ("agg res", res)("node count", shard.mSpanAggregator.NodeCount()));
 }
 
-void NetworkObserverManager::processRecordAsMetric(const std::shared_ptr<AbstractRecord>& record) {
-    WriteLock lk(mAppAggLock);
-    auto res = mAppAggregator.Aggregate(record, GenerateAggKeyForAppMetric(record));
-    LOG_DEBUG(sLogger, ("agg res", res)("node count", mAppAggregator.NodeCount()));
+void NetworkObserverManager::processRecordAsMetric(const RecordPtr<AbstractRecord>& record, AppAggregateShard& shard) {
+    WriteLock lk(shard.mAppAggLock);
+    if (!GenerateAggKeyForAppMetric(record, shard.mAppAggKey)) {
+        return;
+    }
+    auto res = shard.mAppAggregator.Aggregate(record, shard.mAppAggKey);
+    LOG_DEBUG(sLogger, ("agg res", res)("node count", shard.mAppAggregator.NodeCount()));
 }
 
-void NetworkObserverManager::handleRollback(const std::shared_ptr<AbstractRecord>& record, bool& drop) {
+void NetworkObserverManager::handleRollback(const RecordPtr<AbstractRecord>& record, bool& drop) {
     int times = record->Rollback();
 #ifdef APSARA_UNIT_TEST_MAIN
     if (times == 1) {
@@ -1452,12 +1568,12 @@ void NetworkObserverManager::handleRollback(const std::shared_ptr<AbstractRecord
         LOG_DEBUG(sLogger,
                   ("meta not ready, rollback record, times", times)("record type",
                                                                     magic_enum::enum_name(record->GetRecordType())));
-        mRollbackQueue.try_enqueue(record);
+        mRollbackQueue.try_enqueue(record.Ref());
         drop = false;
     }
 }
 
-void NetworkObserverManager::processRecord(const std::shared_ptr<AbstractRecord>& record) {
+void NetworkObserverManager::processRecord(const RecordPtr<AbstractRecord>& record, AppAggregateShard& shard) {
     if (!record) {
         return;
     }
@@ -1492,15 +1608,15 @@ void NetworkObserverManager::processRecord(const std::shared_ptr<AbstractRecord>
 
             // handle record
             if (mEnableLog && record->ShouldSample()) {
-                processRecordAsLog(record);
+                processRecordAsLog(record, shard);
             }
             if (mEnableMetric) {
                 // TODO(qianlu): add converge ...
                 // aggregate ...
-                processRecordAsMetric(record);
+                processRecordAsMetric(record, shard);
             }
             if (mEnableSpan && record->ShouldSample()) {
-                processRecordAsSpan(record);
+                processRecordAsSpan(record, shard);
             }
             break;
         }
@@ -1526,8 +1642,10 @@ void NetworkObserverManager::processRecord(const std::shared_ptr<AbstractRecord>
             // do aggregate
             {
                 WriteLock lk(mNetAggLock);
-                auto res = mNetAggregator.Aggregate(record, GenerateAggKeyForNetMetric(record));
-                LOG_DEBUG(sLogger, ("agg res", res)("node count", mNetAggregator.NodeCount()));
+                if (GenerateAggKeyForNetMetric(record, mNetAggKey)) {
+                    auto res = mNetAggregator.Aggregate(record, mNetAggKey);
+                    LOG_DEBUG(sLogger, ("agg res", res)("node count", mNetAggregator.NodeCount()));
+                }
             }
 
             break;
@@ -1538,7 +1656,7 @@ void NetworkObserverManager::processRecord(const std::shared_ptr<AbstractRecord>
 }
 
 void NetworkObserverManager::ConsumeRecords() {
-    std::array<std::shared_ptr<AbstractRecord>, 4096> items;
+    std::array<RecordPtr<AbstractRecord>, 4096> items;
     while (mFlag) {
         // poll event from
         auto now = std::chrono::steady_clock::now();
@@ -1563,7 +1681,7 @@ void NetworkObserverManager::ConsumeRecords() {
                 LOG_ERROR(sLogger, ("Encountered null event in RollbackQueue at index", i));
                 continue;
             }
-            processRecord(event);
+            processRecord(event, sharedShard());
         }
 
         // clear
@@ -1638,22 +1756,54 @@ void NetworkObserverManager::AcceptDataEvent(struct conn_data_event_t* event) {
         return;
     }
 
+    auto maxMsgBytes = static_cast<uint32_t>(std::max(INT32_FLAG(ebpf_network_observer_max_capture_bytes), 1));
+    if (mParseWorkers.empty() || !conn) {
+        if (event->request_len <= maxMsgBytes && event->response_len <= maxMsgBytes) {
+            parseDataEvent(conn, event, sharedShard());
+            return;
+        }
+        auto copy = copyDataEvent(event, maxMsgBytes);
+        parseDataEvent(conn, reinterpret_cast<conn_data_event_t*>(copy.get()), sharedShard());
+        return;
+    }
+
+    // the event lives in the perf buffer only during this callback
+    ParseWorker::Task task{conn, copyDataEvent(event, maxMsgBytes)};
+    auto& worker = mParseWorkers[ConnIdHash()(conn->GetConnId()) % mParseWorkers.size()];
+    if (!worker->mQueue.try_enqueue(worker->mProducer, std::move(task))) {
+        mDataEventsDropTotal.fetch_add(1);
+        LOG_DEBUG(sLogger, ("parse queue is full, drop data event", ""));
+    }
+}
+
+void NetworkObserverManager::parseDataEvent(const std::shared_ptr<Connection>& conn,
+                                            conn_data_event_t* event,
+                                            AppAggregateShard& shard) {
     LOG_DEBUG(sLogger, ("begin parse, protocol is", std::string(magic_enum::enum_name(event->protocol))));
 
     ReadLock lk(mSamplerLock);
     // atomic shared_ptr
-    std::vector<std::shared_ptr<AbstractRecord>> records
-        = ProtocolParserManager::GetInstance().Parse(protocol, conn, event, mSampler);
+    std::vector<RecordPtr<AbstractRecord>> records
+        = ProtocolParserManager::GetInstance().Parse(event->protocol, conn, event, mSampler);
     lk.unlock();
 
-    if (records.empty()) {
-        return;
-    }
-
     // add records to span/event generate queue
     for (auto& record : records) {
-        processRecord(record);
-        // mRollbackQueue.enqueue(std::move(record));
+        processRecord(record, shard);
+    }
+}
+
+void NetworkObserverManager::runParseWorker(size_t idx) {
+    auto& worker = *mParseWorkers[idx];
+    auto& shard = *mAggregateShards[idx];
+    std::vector<ParseWorker::Task> tasks(kParseWorkerMaxBatchSize);
+    while (mFlag) {
+        size_t count
+            = worker.mQueue.wait_dequeue_bulk_timed(tasks.begin(), tasks.size(), std::chrono::milliseconds(200));
+        for (size_t i = 0; i < count; ++i) {
+            parseDataEvent(tasks[i].mConnection, reinterpret_cast<conn_data_event_t*>(tasks[i].mEvent.get()), shard);
+            tasks[i] = {};
+        }
     }
 }
 
@@ -1691,6 +1841,14 @@ int NetworkObserverManager::Destroy() {
     if (this->mRecordConsume.joinable()) {
         this->mRecordConsume.join();
     }
+    for (auto& worker : mParseWorkers) {
+        if (worker->mThread.joinable()) {
+            worker->mThread.join();
+        }
+    }
+    // events still queued are dropped with the workers
+    mParseWorkers.clear();
+    LOG_INFO(sLogger, ("destroy stage", "release parse workers"));
 #ifdef APSARA_UNIT_TEST_MAIN
     return 0;
 #endif
@@ -1717,22 +1875,24 @@ int NetworkObserverManager::Destroy() {
     mLostDataEventsTotal = 0;
 
     LOG_INFO(sLogger, ("destroy stage", "clear agg tree"));
-    {
-        WriteLock lk(mAppAggLock);
-        mAppAggregator.Reset();
+    for (auto& shard : mAggregateShards) {
+        {
+            WriteLock lk(shard->mAppAggLock);
+            shard->mAppAggregator.Reset();
+        }
+        {
+            WriteLock lk(shard->mSpanAggLock);
+            shard->mSpanAggregator.Reset();
+        }
+        {
+            WriteLock lk(shard->mLogAggLock);
+            shard->mLogAggregator.Reset();
+        }
     }
     {
         WriteLock lk(mNetAggLock);
         mNetAggregator.Reset();
     }
-    {
-        WriteLock lk(mSpanAggLock);
-        mSpanAggregator.Reset();
-    }
-    {
-        WriteLock lk(mLogAggLock);
-        mLogAggregator.Reset();
-    }
 
     LOG_INFO(sLogger, ("destroy stage", "release consumer thread"));
     return 0;
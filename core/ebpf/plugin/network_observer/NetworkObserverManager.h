@@ -15,6 +15,9 @@
 #pragma once
 
 #include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "common/queue/blockingconcurrentqueue.h"
@@ -24,7 +27,7 @@
 #include "ebpf/plugin/network_observer/ConnectionManager.h"
 #include "ebpf/type/CommonDataEvent.h"
 #include "ebpf/type/NetworkObserverEvent.h"
-#include "ebpf/util/AggregateTree.h"
+#include "ebpf/util/AggregateTable.h"
 #include "ebpf/util/FrequencyManager.h"
 #include "ebpf/util/sampler/Sampler.h"
 
@@ -46,6 +49,40 @@ public:
     JobType mJobType;
 };
 
+// App records are aggregated by the thread that processes them into its own shard, the consumer merges the shards
+// every window. Keys are built in the scratch keys under the table locks.
+struct AppAggregateShard {
+    AppAggregateShard();
+
+    ReadWriteLock mAppAggLock;
+    AggregateTable<AppMetricData, RecordPtr<AbstractRecord>, true> mAppAggregator;
+    AggregateKey mAppAggKey;
+
+    ReadWriteLock mSpanAggLock;
+    AggregateTable<AppSpanGroup, RecordPtr<AbstractRecord>, false> mSpanAggregator;
+    AggregateKey mSpanAggKey;
+
+    ReadWriteLock mLogAggLock;
+    AggregateTable<AppLogGroup, RecordPtr<AbstractRecord>, false> mLogAggregator;
+    AggregateKey mLogAggKey;
+};
+
+// Data events of a connection always go to the same worker, so the records of a connection are parsed in order.
+struct ParseWorker {
+    struct Task {
+        std::shared_ptr<Connection> mConnection;
+        // copy of the kernel event, which is only valid in the poll callback
+        std::unique_ptr<char[]> mEvent;
+    };
+
+    explicit ParseWorker(size_t capacity) : mQueue(capacity, 1, 0), mProducer(mQueue) {}
+
+    moodycamel::BlockingConcurrentQueue<Task> mQueue;
+    // only the polling thread enqueues
+    moodycamel::ProducerToken mProducer;
+    std::thread mThread;
+};
+
 class NetworkObserverManager : public AbstractManager {
 public:
     static std::shared_ptr<NetworkObserverManager>
@@ -83,10 +120,10 @@ public:
     void PollBufferWrapper();
     void ConsumeRecords();
 
-    std::array<size_t, 1> GenerateAggKeyForSpan(const std::shared_ptr<AbstractRecord>&);
-    std::array<size_t, 1> GenerateAggKeyForLog(const std::shared_ptr<AbstractRecord>&);
-    std::array<size_t, 2> GenerateAggKeyForAppMetric(const std::shared_ptr<AbstractRecord>&);
-    std::array<size_t, 2> GenerateAggKeyForNetMetric(const std::shared_ptr<AbstractRecord>&);
+    bool GenerateAggKeyForSpan(const RecordPtr<AbstractRecord>&, AggregateKey& key);
+    bool GenerateAggKeyForLog(const RecordPtr<AbstractRecord>&, AggregateKey& key);
+    bool GenerateAggKeyForAppMetric(const RecordPtr<AbstractRecord>&, AggregateKey& key);
+    bool GenerateAggKeyForNetMetric(const RecordPtr<AbstractRecord>&, AggregateKey& key);
 
     std::unique_ptr<PluginConfig> GeneratePluginConfig(
         [[maybe_unused]] const std::variant<SecurityOptions*, ObserverNetworkOption*>& options) override {
@@ -119,16 +156,23 @@ public:
                       const std::shared_ptr<ScheduleConfig>& config) override;
 
 private:
-    void processRecord(const std::shared_ptr<AbstractRecord>& record);
-    void processRecordAsLog(const std::shared_ptr<AbstractRecord>& record);
-    void processRecordAsSpan(const std::shared_ptr<AbstractRecord>& record);
-    void processRecordAsMetric(const std::shared_ptr<AbstractRecord>& record);
+    void processRecord(const RecordPtr<AbstractRecord>& record, AppAggregateShard& shard);
+    void processRecordAsLog(const RecordPtr<AbstractRecord>& record, AppAggregateShard& shard);
+    void processRecordAsSpan(const RecordPtr<AbstractRecord>& record, AppAggregateShard& shard);
+    void processRecordAsMetric(const RecordPtr<AbstractRecord>& record, AppAggregateShard& shard);
+
+    void parseDataEvent(const std::shared_ptr<Connection>& conn, conn_data_event_t* event, AppAggregateShard& shard);
+    void runParseWorker(size_t idx);
+    // the shard of threads that are not parse workers
+    AppAggregateShard& sharedShard() { return *mAggregateShards.back(); }
 
-    void handleRollback(const std::shared_ptr<AbstractRecord>& record, bool& drop);
+    void handleRollback(const RecordPtr<AbstractRecord>& record, bool& drop);
 
     void runInThread();
 
     bool updateParsers(const std::vector<std::string>& protocols, const std::vector<std::string>& prevProtocols);
+    // returns the percent of data events kept in kernel
+    int32_t updateSampler(double sampleRate);
 
     std::unique_ptr<ConnectionManager> mConnectionManager;
 
@@ -160,16 +204,19 @@ private:
 
     mutable ReadWriteLock mSamplerLock;
     std::shared_ptr<Sampler> mSampler;
+    int32_t mKernelSamplingPercent = 100;
 
     // store parsed records
-    moodycamel::BlockingConcurrentQueue<std::shared_ptr<AbstractRecord>> mRollbackQueue;
-    std::deque<std::shared_ptr<AbstractRecord>> mRollbackRecords;
+    moodycamel::BlockingConcurrentQueue<RecordPtr<AbstractRecord>> mRollbackQueue;
+    std::deque<RecordPtr<AbstractRecord>> mRollbackRecords;
 
     // coreThread used for polling kernel event...
     std::thread mCoreThread;
 
     std::thread mRecordConsume;
 
+    std::vector<std::unique_ptr<ParseWorker>> mParseWorkers;
+
     std::atomic_bool mEnableSpan = false;
     std::atomic_bool mEnableLog = false;
     std::atomic_bool mEnableMetric = false;
@@ -182,19 +229,26 @@ private:
     int mCidOffset = -1;
     std::unordered_set<std::string> mEnabledCids;
 
-    ReadWriteLock mAppAggLock;
-    SIZETAggTreeWithSourceBuffer<AppMetricData, std::shared_ptr<AbstractRecord>> mAppAggregator;
-
-
+    // One shard per parse worker, and a shared one at the back. Every window the consumer swaps each shard with the
+    // merging table and merges it into the drained table. Consumes of one kind may overlap when timer events run on
+    // the worker pool, so each kind holds its consume mutex while it swaps, merges and drains its tables.
+    std::vector<std::unique_ptr<AppAggregateShard>> mAggregateShards;
+    std::mutex mAppConsumeMux;
+    std::mutex mSpanConsumeMux;
+    std::mutex mLogConsumeMux;
+    AggregateTable<AppMetricData, RecordPtr<AbstractRecord>, true> mDrainedAppAggregator;
+    AggregateTable<AppMetricData, RecordPtr<AbstractRecord>, true> mMergingAppAggregator;
+    AggregateTable<AppSpanGroup, RecordPtr<AbstractRecord>, false> mDrainedSpanAggregator;
+    AggregateTable<AppSpanGroup, RecordPtr<AbstractRecord>, false> mMergingSpanAggregator;
+    AggregateTable<AppLogGroup, RecordPtr<AbstractRecord>, false> mDrainedLogAggregator;
+    AggregateTable<AppLogGroup, RecordPtr<AbstractRecord>, false> mMergingLogAggregator;
+
+    // conn stats records are only aggregated by the polling thread
+    std::mutex mNetConsumeMux;
     ReadWriteLock mNetAggLock;
-    SIZETAggTreeWithSourceBuffer<NetMetricData, std::shared_ptr<AbstractRecord>> mNetAggregator;
-
-
-    ReadWriteLock mSpanAggLock;
-    SIZETAggTree<AppSpanGroup, std::shared_ptr<AbstractRecord>> mSpanAggregator;
-
-    ReadWriteLock mLogAggLock;
-    SIZETAggTree<AppLogGroup, std::shared_ptr<AbstractRecord>> mLogAggregator;
+    AggregateTable<NetMetricData, RecordPtr<AbstractRecord>, true> mNetAggregator;
+    AggregateTable<NetMetricData, RecordPtr<AbstractRecord>, true> mDrainedNetAggregator;
+    AggregateKey mNetAggKey;
 
     std::string mClusterId;
     std::string mAppId;
@@ -215,8 +269,8 @@ private:
     std::vector<PipelineEventGroup> mLogEventGroups;
     std::vector<PipelineEventGroup> mSpanEventGroups;
 
-    int mRollbackRecordTotal = 0;
-    int mDropRecordTotal = 0;
+    std::atomic_int mRollbackRecordTotal = 0;
+    std::atomic_int mDropRecordTotal = 0;
 
     std::vector<std::string> mEnableCids;
     std::vector<std::string> mDisableCids;
@@ -17,13 +17,17 @@
 extern "C" {
 #include <coolbpf/net.h>
 }
+#include <cctype>
 #include <cstddef>
 
+#include <algorithm>
 #include <map>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "common/HashUtil.h"
+#include "common/StringView.h"
 
 
 namespace logtail::ebpf {
@@ -43,6 +47,38 @@ struct CaseInsensitiveLess {
 
 using HeadersMap = std::multimap<std::string, std::string, CaseInsensitiveLess>;
 
+// Headers of a HTTP message, kept as views into the message in their original order and looked up case insensitively.
+// Only the few headers needed to parse the body are looked up, so a linear scan is cheaper than building a map.
+class HeaderViews {
+public:
+    using value_type = std::pair<StringView, StringView>;
+    using const_iterator = std::vector<value_type>::const_iterator;
+
+    void Add(StringView name, StringView value) { mHeaders.emplace_back(name, value); }
+
+    const_iterator find(StringView name) const {
+        for (auto it = mHeaders.begin(); it != mHeaders.end(); ++it) {
+            if (it->first.size() == name.size()
+                && std::equal(name.begin(), name.end(), it->first.begin(), [](unsigned char a, unsigned char b) {
+                       return std::tolower(a) == std::tolower(b);
+                   })) {
+                return it;
+            }
+        }
+        return mHeaders.end();
+    }
+
+    const_iterator begin() const { return mHeaders.begin(); }
+    const_iterator end() const { return mHeaders.end(); }
+    [[nodiscard]] size_t size() const { return mHeaders.size(); }
+    [[nodiscard]] bool empty() const { return mHeaders.empty(); }
+    // keep the capacity for the next message
+    void clear() { mHeaders.clear(); }
+
+private:
+    std::vector<value_type> mHeaders;
+};
+
 inline enum support_proto_e& operator++(enum support_proto_e& pt) {
     pt = static_cast<enum support_proto_e>(static_cast<int>(pt) + 1);
     return pt;
@@ -26,9 +26,9 @@ class AbstractProtocolParser {
 public:
     virtual ~AbstractProtocolParser() = default;
     virtual std::shared_ptr<AbstractProtocolParser> Create() = 0;
-    virtual std::vector<std::shared_ptr<AbstractRecord>> Parse(struct conn_data_event_t* dataEvent,
-                                                               const std::shared_ptr<Connection>& conn,
-                                                               const std::shared_ptr<Sampler>& sampler = nullptr)
+    virtual std::vector<RecordPtr<AbstractRecord>> Parse(struct conn_data_event_t* dataEvent,
+                                                         const std::shared_ptr<Connection>& conn,
+                                                         const std::shared_ptr<Sampler>& sampler = nullptr)
         = 0;
 };
 
@@ -48,10 +48,10 @@ public:
     bool RemoveParser(support_proto_e type);
     std::set<support_proto_e> AvaliableProtocolTypes() const;
 
-    std::vector<std::shared_ptr<AbstractRecord>> Parse(support_proto_e type,
-                                                       const std::shared_ptr<Connection>& conn,
-                                                       struct conn_data_event_t* data,
-                                                       const std::shared_ptr<Sampler>& sampler = nullptr);
+    std::vector<RecordPtr<AbstractRecord>> Parse(support_proto_e type,
+                                                 const std::shared_ptr<Connection>& conn,
+                                                 struct conn_data_event_t* data,
+                                                 const std::shared_ptr<Sampler>& sampler = nullptr);
 
 private:
     ProtocolParserManager() {}
@@ -14,7 +14,9 @@
 
 #include "HttpParser.h"
 
-#include <map>
+#include <algorithm>
+#include <charconv>
+#include <functional>
 
 #include "common/StringTools.h"
 #include "ebpf/type/NetworkObserverEvent.h"
@@ -23,14 +25,14 @@
 
 namespace logtail::ebpf {
 
-inline constexpr char kContentLength[] = "Content-Length";
-inline constexpr char kTransferEncoding[] = "Transfer-Encoding";
-inline constexpr char kUpgrade[] = "Upgrade";
+inline constexpr StringView kContentLength = "Content-Length";
+inline constexpr StringView kTransferEncoding = "Transfer-Encoding";
+inline constexpr StringView kUpgrade = "Upgrade";
 
-std::vector<std::shared_ptr<AbstractRecord>> HTTPProtocolParser::Parse(struct conn_data_event_t* dataEvent,
-                                                                       const std::shared_ptr<Connection>& conn,
-                                                                       const std::shared_ptr<Sampler>& sampler) {
-    auto record = std::make_shared<HttpRecord>(conn);
+std::vector<RecordPtr<AbstractRecord>> HTTPProtocolParser::Parse(struct conn_data_event_t* dataEvent,
+                                                                 const std::shared_ptr<Connection>& conn,
+                                                                 const std::shared_ptr<Sampler>& sampler) {
+    auto record = RecordPool<HttpRecord>::GetInstance().Acquire(conn);
     record->SetEndTsNs(dataEvent->end_ts);
     record->SetStartTsNs(dataEvent->start_ts);
     auto spanId = GenerateSpanID();
@@ -39,10 +41,17 @@ std::vector<std::shared_ptr<AbstractRecord>> HTTPProtocolParser::Parse(struct co
         record->MarkSample();
     }
 
+    // the record keeps a copy of the payload, all fields parsed below are views into it
+    record->mPayload.assign(dataEvent->msg, dataEvent->request_len + dataEvent->response_len);
+
     // ParseResponse may set SAMPLE flag, depending on HTTP status code ...
     if (dataEvent->response_len > 0) {
-        std::string_view buf(dataEvent->msg + dataEvent->request_len, dataEvent->response_len);
+        std::string_view buf(record->mPayload.data() + dataEvent->request_len, dataEvent->response_len);
         ParseState state = http::ParseResponse(buf, record, true, false);
+        // a body cut by the capture limit still comes after a complete status line and headers
+        if (state == ParseState::kNeedsMoreData && record->GetStatusCode() > 0) {
+            state = ParseState::kSuccess;
+        }
         if (state != ParseState::kSuccess) {
             LOG_DEBUG(sLogger, ("[HTTPProtocolParser]: Parse HTTP response failed", int(state)));
             return {};
@@ -50,8 +59,11 @@ std::vector<std::shared_ptr<AbstractRecord>> HTTPProtocolParser::Parse(struct co
     }
 
     if (dataEvent->request_len > 0) {
-        std::string_view buf(dataEvent->msg, dataEvent->request_len);
+        std::string_view buf(record->mPayload.data(), dataEvent->request_len);
         ParseState state = http::ParseRequest(buf, record, false);
+        if (state == ParseState::kNeedsMoreData && !record->GetPath().empty()) {
+            state = ParseState::kSuccess;
+        }
         if (state != ParseState::kSuccess) {
             LOG_DEBUG(sLogger, ("[HTTPProtocolParser]: Parse HTTP request failed", int(state)));
             return {};
@@ -63,18 +75,17 @@ std::vector<std::shared_ptr<AbstractRecord>> HTTPProtocolParser::Parse(struct co
         record->SetTraceId(GenerateTraceID());
     }
 
-    return {record};
+    std::vector<RecordPtr<AbstractRecord>> records;
+    records.emplace_back(std::move(record));
+    return records;
 }
 
 namespace http {
-HeadersMap GetHTTPHeadersMap(const phr_header* headers, size_t numHeaders) {
-    HeadersMap result;
+void GetHTTPHeaders(const phr_header* headers, size_t numHeaders, HeaderViews& result) {
+    result.clear();
     for (size_t i = 0; i < numHeaders; i++) {
-        std::string name(headers[i].name, headers[i].name_len);
-        std::string value(headers[i].value, headers[i].value_len);
-        result.emplace(std::move(name), std::move(value));
+        result.Add(StringView(headers[i].name, headers[i].name_len), StringView(headers[i].value, headers[i].value_len));
     }
-    return result;
 }
 
 int ParseHttpRequest(std::string_view& buf, HTTPRequest& result) {
@@ -90,24 +101,24 @@ int ParseHttpRequest(std::string_view& buf, HTTPRequest& result) {
                              /*last_len*/ 0);
 }
 
-const std::string kRootPath = "/";
+constexpr StringView kRootPath = "/";
 const char kQuestionMark = '?';
-const std::string kHttP1Prefix = "http1.";
+constexpr StringView kHttp1Versions[] = {
+    "http1.0", "http1.1", "http1.2", "http1.3", "http1.4", "http1.5", "http1.6", "http1.7", "http1.8", "http1.9"};
 
-ParseState ParseRequest(std::string_view& buf, std::shared_ptr<HttpRecord>& result, bool forceSample) {
+ParseState ParseRequest(std::string_view& buf, RecordPtr<HttpRecord>& result, bool forceSample) {
     HTTPRequest req;
     int retval = http::ParseHttpRequest(buf, req);
     if (retval >= 0) {
         buf.remove_prefix(retval);
 
-        auto orginPath = std::string(req.mPath, req.mPathLen);
-        auto trimPath = TrimString(orginPath);
+        auto trimPath = Rtrim(Ltrim(StringView(req.mPath, req.mPathLen), " "), " ");
         std::size_t pos = trimPath.find(kQuestionMark);
 
-        if (trimPath.empty() || (pos != std::string::npos && pos == 0)) {
+        if (trimPath.empty() || (pos != StringView::npos && pos == 0)) {
             result->SetPath(kRootPath);
             result->SetRealPath(kRootPath);
-        } else if (pos != std::string::npos) {
+        } else if (pos != StringView::npos) {
             result->SetPath(trimPath.substr(0, pos));
         } else {
             result->SetPath(trimPath);
@@ -115,9 +126,10 @@ ParseState ParseRequest(std::string_view& buf, std::shared_ptr<HttpRecord>& resu
         }
 
         if (result->ShouldSample() || forceSample) {
-            result->SetProtocolVersion(kHttP1Prefix + std::to_string(req.mMinorVersion));
-            result->SetMethod(std::string(req.mMethod, req.mMethodLen));
-            result->SetReqHeaderMap(http::GetHTTPHeadersMap(req.mHeaders, req.mNumHeaders));
+            // pico only accepts a single digit minor version
+            result->SetProtocolVersion(kHttp1Versions[req.mMinorVersion]);
+            result->SetMethod(StringView(req.mMethod, req.mMethodLen));
+            http::GetHTTPHeaders(req.mHeaders, req.mNumHeaders, result->mReqHeaders);
             return ParseRequestBody(buf, result);
         }
         return ParseState::kSuccess;
@@ -129,16 +141,17 @@ ParseState ParseRequest(std::string_view& buf, std::shared_ptr<HttpRecord>& resu
     return ParseState::kInvalid;
 }
 
-ParseState PicoParseChunked(std::string_view& data, size_t bodySizeLimitBytes, std::string& result, size_t& bodySize) {
-    // Make a copy of the data because phr_decode_chunked mutates the input,
-    // and if the original parse fails due to a lack of data, we need the original
-    // state to be preserved.
-    std::string dataCopy(data);
-
+ParseState PicoParseChunked(
+    std::string_view& data, std::string& payload, size_t bodySizeLimitBytes, StringView& result, size_t& bodySize) {
+    // phr_decode_chunked rewrites its input, so the chunks are decoded in place on the payload owned by the record
+    std::less_equal<const char*> le;
+    if (!le(payload.data(), data.data()) || !le(data.data() + data.size(), payload.data() + payload.size())) {
+        return ParseState::kInvalid;
+    }
     phr_chunked_decoder chunkDecoder = {};
     chunkDecoder.consume_trailer = 1;
-    char* buf = dataCopy.data();
-    size_t bufSize = dataCopy.size();
+    char* buf = payload.data() + (data.data() - payload.data());
+    size_t bufSize = data.size();
     ssize_t retval = phr_decode_chunked(&chunkDecoder, buf, &bufSize);
 
     if (retval == -1) {
@@ -151,16 +164,11 @@ ParseState PicoParseChunked(std::string_view& data, size_t bodySizeLimitBytes, s
     }
     if (retval >= 0) {
         // Found a complete message.
-        dataCopy.resize(std::min(bufSize, bodySizeLimitBytes));
-        // data_copy.resize(buf_size);
-        dataCopy.shrink_to_fit();
-        result = std::move(dataCopy);
+        result = StringView(buf, std::min(bufSize, bodySizeLimitBytes));
         bodySize = bufSize;
 
-        // phr_decode_chunked rewrites the buffer in place, removing chunked-encoding headers.
-        // So we cannot simply remove the prefix, but rather have to shorten the buffer too.
-        // This is done via retval, which specifies how many unprocessed bytes are left.
-        data.remove_prefix(data.size() - retval);
+        // The retval bytes after the message are left unprocessed, and moved right after the decoded body.
+        data = std::string_view(buf + bufSize, retval);
 
         return ParseState::kSuccess;
     }
@@ -169,23 +177,24 @@ ParseState PicoParseChunked(std::string_view& data, size_t bodySizeLimitBytes, s
 }
 
 
-ParseState ParseChunked(std::string_view& data, size_t bodySizeLimitBytes, std::string& result, size_t& bodySize) {
-    return PicoParseChunked(data, bodySizeLimitBytes, result, bodySize);
+ParseState ParseChunked(
+    std::string_view& data, std::string& payload, size_t bodySizeLimitBytes, StringView& result, size_t& bodySize) {
+    return PicoParseChunked(data, payload, bodySizeLimitBytes, result, bodySize);
 }
 
-ParseState ParseRequestBody(std::string_view& buf, std::shared_ptr<HttpRecord>& result) {
+ParseState ParseRequestBody(std::string_view& buf, RecordPtr<HttpRecord>& result) {
     // Case 1: Content-Length
-    const auto contentLengthIter = result->GetReqHeaderMap().find(kContentLength);
-    if (contentLengthIter != result->GetReqHeaderMap().end()) {
-        std::string_view contentLenStr = contentLengthIter->second;
+    const auto contentLengthIter = result->GetReqHeaders().find(kContentLength);
+    if (contentLengthIter != result->GetReqHeaders().end()) {
+        std::string_view contentLenStr(contentLengthIter->second.data(), contentLengthIter->second.size());
         auto r = ParseContent(contentLenStr, buf, 256, result->mReqBody, result->mReqBodySize);
         return r;
     }
 
     // Case 2: Chunked transfer.
-    const auto transferEncodingIter = result->GetReqHeaderMap().find(kTransferEncoding);
-    if (transferEncodingIter != result->GetReqHeaderMap().end() && transferEncodingIter->second == "chunked") {
-        auto s = ParseChunked(buf, 256, result->mReqBody, result->mReqBodySize);
+    const auto transferEncodingIter = result->GetReqHeaders().find(kTransferEncoding);
+    if (transferEncodingIter != result->GetReqHeaders().end() && transferEncodingIter->second == "chunked") {
+        auto s = ParseChunked(buf, result->mPayload, 256, result->mReqBody, result->mReqBodySize);
 
         return s;
     }
@@ -197,7 +206,7 @@ ParseState ParseRequestBody(std::string_view& buf, std::shared_ptr<HttpRecord>&
     // not contain a payload body and the method semantics do not anticipate such a body."
     //
     // We apply this to all methods, since we have no better strategy in other cases.
-    result->mReqBody = "";
+    result->mReqBody = StringView();
     return ParseState::kSuccess;
 }
 
@@ -219,34 +228,28 @@ bool ParseContentLength(const std::string_view& contentLenStr, size_t* len) {
         return false;
     }
 
-    try {
-        size_t pos;
-        std::stoull(contentLenStr.data());
-        *len = std::stoull(std::string(contentLenStr), &pos);
-        if (pos != contentLenStr.size()) {
-            return false;
-        }
-    } catch (const std::exception& e) {
-        return false;
-    }
-
-    return true;
+    const char* end = contentLenStr.data() + contentLenStr.size();
+    auto [ptr, ec] = std::from_chars(contentLenStr.data(), end, *len);
+    return ec == std::errc() && ptr == end;
 }
 
 ParseState ParseContent(std::string_view& contentLenStr,
                         std::string_view& data,
                         size_t bodySizeLimitBytes,
-                        std::string& result,
+                        StringView& result,
                         size_t& bodySize) {
     size_t len;
     if (!ParseContentLength(contentLenStr, &len)) {
         return ParseState::kInvalid;
     }
     if (data.size() < len) {
+        // keep the part of the body that was captured
+        result = StringView(data.data(), std::min(data.size(), bodySizeLimitBytes));
+        bodySize = len;
         return ParseState::kNeedsMoreData;
     }
 
-    result = data.substr(0, std::min(len, bodySizeLimitBytes));
+    result = StringView(data.data(), std::min(len, bodySizeLimitBytes));
     // *result = data->substr(0, len);
 
     bodySize = len;
@@ -262,7 +265,7 @@ bool StartsWithHttp(const std::string_view& buf) {
     return buf.size() >= kPrefix.size() && buf.substr(0, kPrefix.size()) == kPrefix;
 }
 
-ParseState ParseResponseBody(std::string_view& buf, std::shared_ptr<HttpRecord>& result, bool closed) {
+ParseState ParseResponseBody(std::string_view& buf, RecordPtr<HttpRecord>& result, bool closed) {
     HTTPResponse r;
     bool adjacentResp = StartsWithHttp(buf) && (ParseHttpResponse(buf, &r) > 0);
 
@@ -271,18 +274,18 @@ ParseState ParseResponseBody(std::string_view& buf, std::shared_ptr<HttpRecord>&
     }
 
     // Case 1: Content-Length
-    const auto contentLengthIter = result->GetRespHeaderMap().find(kContentLength);
-    if (contentLengthIter != result->GetRespHeaderMap().end()) {
-        std::string_view contentLenStr = contentLengthIter->second;
+    const auto contentLengthIter = result->GetRespHeaders().find(kContentLength);
+    if (contentLengthIter != result->GetRespHeaders().end()) {
+        std::string_view contentLenStr(contentLengthIter->second.data(), contentLengthIter->second.size());
         auto s = ParseContent(contentLenStr, buf, 256, result->mRespBody, result->mRespBodySize);
         // CTX_DCHECK_LE(result->body.size(), FLAGS_http_body_limit_bytes);
         return s;
     }
 
     // Case 2: Chunked transfer.
-    const auto transferEncodingIter = result->GetRespHeaderMap().find(kTransferEncoding);
-    if (transferEncodingIter != result->GetRespHeaderMap().end() && transferEncodingIter->second == "chunked") {
-        auto s = ParseChunked(buf, 256, result->mRespBody, result->mRespBodySize);
+    const auto transferEncodingIter = result->GetRespHeaders().find(kTransferEncoding);
+    if (transferEncodingIter != result->GetRespHeaders().end() && transferEncodingIter->second == "chunked") {
+        auto s = ParseChunked(buf, result->mPayload, 256, result->mRespBody, result->mRespBodySize);
         // CTX_DCHECK_LE(result->body.size(), FLAGS_http_body_limit_bytes);
         return s;
     }
@@ -291,12 +294,12 @@ ParseState ParseResponseBody(std::string_view& buf, std::shared_ptr<HttpRecord>&
     // The status codes below MUST not have a body, according to the spec.
     // See: https://tools.ietf.org/html/rfc2616#section-4.4
     if ((result->mCode >= 100 && result->mCode < 200) || result->mCode == 204 || result->mCode == 304) {
-        result->mRespBody = "";
+        result->mRespBody = StringView();
 
         // Status 101 is an even more special case.
         if (result->mCode == 101) {
-            const auto upgradeIter = result->GetRespHeaderMap().find(kUpgrade);
-            if (upgradeIter == result->GetRespHeaderMap().end()) {
+            const auto upgradeIter = result->GetRespHeaders().find(kUpgrade);
+            if (upgradeIter == result->GetRespHeaders().end()) {
             }
 
             return ParseState::kEOS;
@@ -312,13 +315,13 @@ ParseState ParseResponseBody(std::string_view& buf, std::shared_ptr<HttpRecord>&
     // such messages are terminated by the close of the connection.
     // TODO(yzhao): For now we just accumulate messages, let probe_close() submit a message to
     // perf buffer, so that we can terminate such messages.
-    result->mRespBody = buf;
+    result->mRespBody = StringView(buf.data(), buf.size());
     buf.remove_prefix(buf.size());
 
     return ParseState::kSuccess;
 }
 
-ParseState ParseResponse(std::string_view& buf, std::shared_ptr<HttpRecord>& result, bool closed, bool forceSample) {
+ParseState ParseResponse(std::string_view& buf, RecordPtr<HttpRecord>& result, bool closed, bool forceSample) {
     HTTPResponse resp;
     int retval = ParseHttpResponse(buf, &resp);
 
@@ -331,8 +334,8 @@ ParseState ParseResponse(std::string_view& buf, std::shared_ptr<HttpRecord>& res
         }
 
         if (result->ShouldSample() || forceSample) {
-            result->SetRespHeaderMap(http::GetHTTPHeadersMap(resp.mHeaders, resp.mNumHeaders));
-            result->SetRespMsg(std::string(resp.mMsg, resp.mMsgLen));
+            http::GetHTTPHeaders(resp.mHeaders, resp.mNumHeaders, result->mRespHeaders);
+            result->SetRespMsg(StringView(resp.mMsg, resp.mMsgLen));
             return ParseResponseBody(buf, result, closed);
         }
         return ParseState::kSuccess;
@@ -70,20 +70,21 @@ enum class ParseState {
 
 namespace http {
 
-ParseState ParseRequest(std::string_view& buf, std::shared_ptr<HttpRecord>& result, bool forceSample = false);
+// A chunked body is decoded in place, so buf has to be a view into result->mPayload for the body to be parsed.
+ParseState ParseRequest(std::string_view& buf, RecordPtr<HttpRecord>& result, bool forceSample = false);
 
-ParseState ParseRequestBody(std::string_view& buf, std::shared_ptr<HttpRecord>& result);
+ParseState ParseRequestBody(std::string_view& buf, RecordPtr<HttpRecord>& result);
 
-HeadersMap GetHTTPHeadersMap(const phr_header* headers, size_t numHeaders);
+void GetHTTPHeaders(const phr_header* headers, size_t numHeaders, HeaderViews& result);
 
 ParseState ParseContent(std::string_view& contentLenStr,
                         std::string_view& data,
                         size_t bodySizeLimitBytes,
-                        std::string& result,
+                        StringView& result,
                         size_t& bodySize);
 
-ParseState
-ParseResponse(std::string_view& buf, std::shared_ptr<HttpRecord>& result, bool closed, bool forceSample = false);
+// Same as ParseRequest, buf has to be a view into result->mPayload for a chunked body.
+ParseState ParseResponse(std::string_view& buf, RecordPtr<HttpRecord>& result, bool closed, bool forceSample = false);
 
 int ParseHttpRequest(std::string_view& buf, HTTPRequest& result);
 } // namespace http
@@ -93,9 +94,9 @@ class HTTPProtocolParser : public AbstractProtocolParser {
 public:
     std::shared_ptr<AbstractProtocolParser> Create() override { return std::make_shared<HTTPProtocolParser>(); }
 
-    std::vector<std::shared_ptr<AbstractRecord>> Parse(struct conn_data_event_t* dataEvent,
-                                                       const std::shared_ptr<Connection>& conn,
-                                                       const std::shared_ptr<Sampler>& sampler = nullptr) override;
+    std::vector<RecordPtr<AbstractRecord>> Parse(struct conn_data_event_t* dataEvent,
+                                                 const std::shared_ptr<Connection>& conn,
+                                                 const std::shared_ptr<Sampler>& sampler = nullptr) override;
 };
 
 REGISTER_PROTOCOL_PARSER(support_proto_e::ProtoHTTP, HTTPProtocolParser)
@@ -14,8 +14,12 @@
 
 #pragma once
 
+#include <atomic>
 #include <map>
+#include <mutex>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include "ebpf/plugin/network_observer/Connection.h"
@@ -36,12 +40,126 @@ enum class RecordType {
     CONN_STATS_RECORD,
 };
 
+// RecordPtr holds a reference of a record through the intrusive reference count of the record. It can only be moved,
+// holders that retain the record besides the current one, e.g. the rollback queue or a span group, must take another
+// reference explicitly with Ref().
+template <class T>
+class RecordPtr {
+public:
+    RecordPtr() = default;
+    RecordPtr(std::nullptr_t) {}
+    explicit RecordPtr(T* record) : mRecord(record) {
+        if (mRecord) {
+            mRecord->AddRef();
+        }
+    }
+    RecordPtr(RecordPtr&& other) noexcept : mRecord(std::exchange(other.mRecord, nullptr)) {}
+    template <class U, class = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    RecordPtr(RecordPtr<U>&& other) noexcept : mRecord(std::exchange(other.mRecord, nullptr)) {}
+    RecordPtr(const RecordPtr&) = delete;
+    RecordPtr& operator=(const RecordPtr&) = delete;
+    RecordPtr& operator=(RecordPtr&& other) noexcept {
+        if (this != &other) {
+            reset();
+            mRecord = std::exchange(other.mRecord, nullptr);
+        }
+        return *this;
+    }
+    ~RecordPtr() { reset(); }
+
+    [[nodiscard]] RecordPtr Ref() const { return RecordPtr(mRecord); }
+
+    T* get() const { return mRecord; }
+    T* operator->() const { return mRecord; }
+    T& operator*() const { return *mRecord; }
+    explicit operator bool() const { return mRecord != nullptr; }
+    bool operator==(std::nullptr_t) const { return mRecord == nullptr; }
+    bool operator!=(std::nullptr_t) const { return mRecord != nullptr; }
+
+    void reset() {
+        if (mRecord) {
+            mRecord->Release();
+            mRecord = nullptr;
+        }
+    }
+
+private:
+    template <class U>
+    friend class RecordPtr;
+
+    T* mRecord = nullptr;
+};
+
+// RecordPool keeps released records of one type, so that a record is reused with the capacity of its strings instead
+// of being allocated for every parsed request or connection stats. Records can be released by any thread.
+template <class T>
+class RecordPool {
+public:
+    // never destroyed, records held by static singletons such as EBPFServer are still recycled at exit
+    static RecordPool& GetInstance() {
+        static auto* sInstance = new RecordPool;
+        return *sInstance;
+    }
+
+    RecordPool(const RecordPool&) = delete;
+    RecordPool& operator=(const RecordPool&) = delete;
+
+    RecordPtr<T> Acquire(const std::shared_ptr<Connection>& connection) {
+        T* record = nullptr;
+        {
+            std::lock_guard<std::mutex> lk(mMux);
+            if (!mRecords.empty()) {
+                record = mRecords.back();
+                mRecords.pop_back();
+            }
+        }
+        if (record == nullptr) {
+            return RecordPtr<T>(new T(connection));
+        }
+        record->mConnection = connection;
+        return RecordPtr<T>(record);
+    }
+
+    // called when the last reference of the record is released
+    void Recycle(T* record) {
+        // release the connection and clear the content now, a pooled record should not hold anything
+        record->Reset();
+        {
+            std::lock_guard<std::mutex> lk(mMux);
+            if (mRecords.size() < kPoolSize) {
+                mRecords.push_back(record);
+                return;
+            }
+        }
+        delete record;
+    }
+
+    size_t Size() {
+        std::lock_guard<std::mutex> lk(mMux);
+        return mRecords.size();
+    }
+
+private:
+    static constexpr size_t kPoolSize = 4096;
+
+    RecordPool() = default;
+
+    std::mutex mMux;
+    std::vector<T*> mRecords;
+};
+
 /// record ///
 class AbstractRecord {
 public:
     virtual ~AbstractRecord() {}
+    void AddRef() { mRefCount.fetch_add(1, std::memory_order_relaxed); }
+    void Release() {
+        if (mRefCount.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            Recycle();
+        }
+    }
     virtual RecordType GetRecordType() = 0;
-    virtual const std::string& GetSpanName() = 0;
+    virtual StringView GetSpanName() = 0;
 
     uint64_t GetStartTimeStamp() { return mStartTs; }
     uint64_t GetEndTimeStamp() { return mEndTs; }
@@ -60,37 +178,57 @@ public:
     [[nodiscard]] virtual int GetStatusCode() const = 0;
 
 protected:
-    uint64_t mStartTs;
-    uint64_t mEndTs;
+    // return the record to the pool of its type, records not managed by a pool are deleted
+    virtual void Recycle() { delete this; }
+    virtual void Reset() {
+        mStartTs = 0;
+        mEndTs = 0;
+        mIsSample = false;
+        mRollbackCount = 0;
+    }
+
+    uint64_t mStartTs = 0;
+    uint64_t mEndTs = 0;
     bool mIsSample = false;
     int mRollbackCount = 0;
+
+private:
+    std::atomic_int mRefCount = 0;
 };
 
-inline const std::string kSpanNameEmpty;
-inline const std::string kConnStatsSpan = "CONN_STATS";
+inline constexpr StringView kSpanNameEmpty;
+inline constexpr StringView kConnStatsSpan = "CONN_STATS";
 
 class AbstractNetRecord : public AbstractRecord {
 public:
     ~AbstractNetRecord() override {}
-    const std::string& GetSpanName() override { return kSpanNameEmpty; }
+    StringView GetSpanName() override { return kSpanNameEmpty; }
     RecordType GetRecordType() override { return RecordType::CONN_STATS_RECORD; }
-    [[nodiscard]] std::shared_ptr<Connection> GetConnection() const { return mConnection; }
-    explicit AbstractNetRecord(std::shared_ptr<Connection>& connection) : mConnection(connection) {}
+    [[nodiscard]] const std::shared_ptr<Connection>& GetConnection() const { return mConnection; }
+    explicit AbstractNetRecord(const std::shared_ptr<Connection>& connection) : mConnection(connection) {}
 
 protected:
+    void Reset() override {
+        AbstractRecord::Reset();
+        mConnection.reset();
+    }
+
     std::shared_ptr<Connection> mConnection;
+
+    template <class T>
+    friend class RecordPool;
 };
 
 class ConnStatsRecord : public AbstractNetRecord {
 public:
     ~ConnStatsRecord() override {}
-    explicit ConnStatsRecord(std::shared_ptr<Connection>& connection) : AbstractNetRecord(connection) {}
+    explicit ConnStatsRecord(const std::shared_ptr<Connection>& connection) : AbstractNetRecord(connection) {}
     RecordType GetRecordType() override { return RecordType::CONN_STATS_RECORD; }
     [[nodiscard]] bool IsError() const override { return false; }
     [[nodiscard]] bool IsSlow() const override { return false; }
     [[nodiscard]] int GetStatusCode() const override { return 0; }
 
-    const std::string& GetSpanName() override { return kConnStatsSpan; }
+    StringView GetSpanName() override { return kConnStatsSpan; }
     int mState = 0;
     uint64_t mDropCount = 0;
     uint64_t mRttVar = 0;
@@ -100,13 +238,30 @@ public:
     uint64_t mSendPackets = 0;
     uint64_t mRecvBytes = 0;
     uint64_t mSendBytes = 0;
+
+protected:
+    void Recycle() override { RecordPool<ConnStatsRecord>::GetInstance().Recycle(this); }
+    void Reset() override {
+        AbstractNetRecord::Reset();
+        mState = 0;
+        mDropCount = 0;
+        mRttVar = 0;
+        mRtt = 0;
+        mRetransCount = 0;
+        mRecvPackets = 0;
+        mSendPackets = 0;
+        mRecvBytes = 0;
+        mSendBytes = 0;
+    }
+
+    friend class RecordPool<ConnStatsRecord>;
 };
 
 // AbstractAppRecord is intentionally designed to distinguish L5 and L7 Record of AbstractNetRecord. AbstractAppRecord
 // is L7, while ConnStatsRecord is L5.
 class AbstractAppRecord : public AbstractNetRecord {
 public:
-    explicit AbstractAppRecord(std::shared_ptr<Connection>& connection) : AbstractNetRecord(connection) {}
+    explicit AbstractAppRecord(const std::shared_ptr<Connection>& connection) : AbstractNetRecord(connection) {}
     ~AbstractAppRecord() override {}
 
     void SetTraceId(std::array<uint64_t, 4>&& traceId) { mTraceId = traceId; }
@@ -114,75 +269,103 @@ public:
 
     RecordType GetRecordType() override { return RecordType::APP_RECORD; }
 
-    virtual const std::string& GetReqBody() const = 0;
-    virtual const std::string& GetRespBody() const = 0;
+    virtual StringView GetReqBody() const = 0;
+    virtual StringView GetRespBody() const = 0;
     virtual size_t GetReqBodySize() const = 0;
     virtual size_t GetRespBodySize() const = 0;
-    virtual const std::string& GetMethod() const = 0;
-    virtual const HeadersMap& GetReqHeaderMap() const = 0;
-    virtual const HeadersMap& GetRespHeaderMap() const = 0;
-    virtual const std::string& GetProtocolVersion() const = 0;
-    virtual const std::string& GetPath() const = 0;
+    virtual StringView GetMethod() const = 0;
+    virtual const HeaderViews& GetReqHeaders() const = 0;
+    virtual const HeaderViews& GetRespHeaders() const = 0;
+    virtual StringView GetProtocolVersion() const = 0;
+    virtual StringView GetPath() const = 0;
 
     mutable std::array<uint64_t, 4> mTraceId{};
     mutable std::array<uint64_t, 2> mSpanId{};
+
+protected:
+    void Reset() override {
+        AbstractNetRecord::Reset();
+        mTraceId = {};
+        mSpanId = {};
+    }
 };
 
+// The views of a HttpRecord point into the buffer the message is parsed from. HTTPProtocolParser parses from mPayload,
+// the copy of the payload of the data event owned by the record, so the record stays valid after the event is gone.
 class HttpRecord : public AbstractAppRecord {
 public:
     ~HttpRecord() override {}
-    explicit HttpRecord(std::shared_ptr<Connection> connection) : AbstractAppRecord(connection) {}
+    explicit HttpRecord(const std::shared_ptr<Connection>& connection) : AbstractAppRecord(connection) {}
 
-    void SetPath(const std::string& path) { mPath = path; }
+    void SetPath(StringView path) { mPath = path; }
 
-    void SetRealPath(const std::string& path) { mRealPath = path; }
+    void SetRealPath(StringView path) { mRealPath = path; }
 
-    void SetReqBody(const std::string& body) { mReqBody = body; }
+    void SetReqBody(StringView body) { mReqBody = body; }
 
-    void SetRespBody(const std::string& body) { mRespBody = body; }
+    void SetRespBody(StringView body) { mRespBody = body; }
 
-    void SetMethod(const std::string& method) { mHttpMethod = method; }
+    void SetMethod(StringView method) { mHttpMethod = method; }
 
-    void SetProtocolVersion(const std::string& version) { mProtocolVersion = version; }
+    void SetProtocolVersion(StringView version) { mProtocolVersion = version; }
 
     void SetStatusCode(int code) { mCode = code; }
 
-    void SetReqHeaderMap(HeadersMap&& headerMap) { mReqHeaderMap = std::move(headerMap); }
-
-    void SetRespHeaderMap(HeadersMap&& headerMap) { mRespHeaderMap = std::move(headerMap); }
-
-    void SetRespMsg(std::string&& msg) { mRespMsg = std::move(msg); }
+    void SetRespMsg(StringView msg) { mRespMsg = msg; }
 
     bool IsError() const override { return mCode >= 400; }
 
     bool IsSlow() const override { return GetLatencyMs() > 500; }
     int GetStatusCode() const override { return mCode; }
-    const std::string& GetReqBody() const override { return mReqBody; }
-    const std::string& GetRespBody() const override { return mRespBody; }
-    std::string GetRespMsg() const { return mRespMsg; }
+    StringView GetReqBody() const override { return mReqBody; }
+    StringView GetRespBody() const override { return mRespBody; }
+    StringView GetRespMsg() const { return mRespMsg; }
     size_t GetReqBodySize() const override { return mReqBodySize; }
     size_t GetRespBodySize() const override { return mRespBodySize; }
-    const std::string& GetMethod() const override { return mHttpMethod; }
-    const HeadersMap& GetReqHeaderMap() const override { return mReqHeaderMap; }
-    const HeadersMap& GetRespHeaderMap() const override { return mRespHeaderMap; }
-    const std::string& GetProtocolVersion() const override { return mProtocolVersion; }
-    const std::string& GetPath() const override { return mPath; }
-    const std::string& GetRealPath() const { return mRealPath; }
-    const std::string& GetSpanName() override { return mPath; }
+    StringView GetMethod() const override { return mHttpMethod; }
+    const HeaderViews& GetReqHeaders() const override { return mReqHeaders; }
+    const HeaderViews& GetRespHeaders() const override { return mRespHeaders; }
+    StringView GetProtocolVersion() const override { return mProtocolVersion; }
+    StringView GetPath() const override { return mPath; }
+    StringView GetRealPath() const { return mRealPath; }
+    StringView GetSpanName() override { return mPath; }
 
     int mCode = 0;
     size_t mReqBodySize = 0;
     size_t mRespBodySize = 0;
-    std::string mPath;
-    std::string mRealPath;
-    std::string mConvPath;
-    std::string mReqBody;
-    std::string mRespBody;
-    std::string mHttpMethod;
-    std::string mProtocolVersion;
-    std::string mRespMsg;
-    HeadersMap mReqHeaderMap;
-    HeadersMap mRespHeaderMap;
+    // chunked bodies are decoded in place
+    std::string mPayload;
+    StringView mPath;
+    StringView mRealPath;
+    StringView mReqBody;
+    StringView mRespBody;
+    StringView mHttpMethod;
+    StringView mProtocolVersion;
+    StringView mRespMsg;
+    HeaderViews mReqHeaders;
+    HeaderViews mRespHeaders;
+
+protected:
+    void Recycle() override { RecordPool<HttpRecord>::GetInstance().Recycle(this); }
+    // the payload and the headers are cleared to keep their capacity
+    void Reset() override {
+        AbstractAppRecord::Reset();
+        mCode = 0;
+        mReqBodySize = 0;
+        mRespBodySize = 0;
+        mPayload.clear();
+        mPath = StringView();
+        mRealPath = StringView();
+        mReqBody = StringView();
+        mRespBody = StringView();
+        mHttpMethod = StringView();
+        mProtocolVersion = StringView();
+        mRespMsg = StringView();
+        mReqHeaders.clear();
+        mRespHeaders.clear();
+    }
+
+    friend class RecordPool<HttpRecord>;
 };
 
 class MetricData {
@@ -258,7 +441,7 @@ public:
     AppSpanGroup() = default;
     ~AppSpanGroup() {}
 
-    std::vector<std::shared_ptr<AbstractRecord>> mRecords;
+    std::vector<RecordPtr<AbstractRecord>> mRecords;
 };
 
 class AppLogGroup {
@@ -266,7 +449,7 @@ public:
     AppLogGroup() = default;
     ~AppLogGroup() {}
 
-    std::vector<std::shared_ptr<AbstractRecord>> mRecords;
+    std::vector<RecordPtr<AbstractRecord>> mRecords;
 };
 
 
@@ -44,6 +44,16 @@ public:
 
     [[nodiscard]] constexpr size_t Size() const { return schema->Size(); }
 
+    // Clear all values, the source buffer is reused if no one else holds it.
+    void Reset() {
+        if (mSourceBuffer.use_count() == 1) {
+            mSourceBuffer->Reset();
+        } else {
+            mSourceBuffer = std::make_shared<SourceBuffer>();
+        }
+        mRow.fill(StringView());
+    }
+
     template <const DataElement& TElement>
     inline void SetNoCopy(const StringView& val) {
         constexpr uint32_t idx = schema->ColIndex(TElement.Name());
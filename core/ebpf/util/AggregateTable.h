@@ -0,0 +1,329 @@
+// Copyright 2025 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "xxhash/xxhash.h"
+
+#include "common/StringView.h"
+#include "common/memory/SourceBuffer.h"
+#include "logger/Logger.h"
+
+namespace logtail::ebpf {
+
+// Key of an aggregated series. The group part selects the group the series is consumed with (e.g. an app instance),
+// and the series part selects the series within the group; a key without series part makes the group itself a
+// series. Attributes are length prefixed, so two keys are equal only if all of their attributes are equal.
+class AggregateKey {
+public:
+    void Clear() {
+        mGroup.clear();
+        mSeries.clear();
+    }
+    void AddGroupAttr(StringView attr) { Append(mGroup, attr); }
+    void AddGroupAttr(uint64_t attr) { mGroup.append(reinterpret_cast<const char*>(&attr), sizeof(attr)); }
+    void AddSeriesAttr(StringView attr) { Append(mSeries, attr); }
+
+    StringView GroupKey() const { return StringView(mGroup.data(), mGroup.size()); }
+    StringView SeriesKey() const { return StringView(mSeries.data(), mSeries.size()); }
+
+private:
+    static void Append(std::string& key, StringView attr) {
+        auto len = static_cast<uint32_t>(attr.size());
+        key.append(reinterpret_cast<const char*>(&len), sizeof(len));
+        key.append(attr.data(), attr.size());
+    }
+
+    std::string mGroup;
+    std::string mSeries;
+};
+
+// AggregateTable is a flat replacement of AggTree for keys of at most two levels. Groups and series live in two
+// vectors indexed by open addressing tables and compared by full key, and all key bytes are appended to one arena
+// string. Reset() keeps the capacity of all of them, so a table swapped in and out every window stops allocating
+// once it has seen the peak number of series, except for the data built for each new series.
+template <class Data, class Value, bool NeedSourceBuffer>
+class AggregateTable {
+public:
+    static constexpr uint32_t kNil = std::numeric_limits<uint32_t>::max();
+
+    struct Group {
+        uint64_t mHash = 0;
+        uint32_t mKeyOffset = 0;
+        uint32_t mKeyLen = 0;
+        // series of the group chained in insertion order
+        uint32_t mFirst = kNil;
+        uint32_t mLast = kNil;
+        uint32_t mSize = 0;
+        std::shared_ptr<SourceBuffer> mSourceBuffer;
+    };
+
+    struct Entry {
+        uint64_t mHash = 0;
+        uint32_t mKeyOffset = 0;
+        uint32_t mKeyLen = 0;
+        uint32_t mGroup = 0;
+        uint32_t mNext = kNil;
+        std::unique_ptr<Data> mData;
+    };
+
+    using AggregateFunc = std::function<void(std::unique_ptr<Data>&, const Value&)>;
+    using BuildFunc = std::function<std::unique_ptr<Data>(const Value&, std::shared_ptr<SourceBuffer>&)>;
+    using MergeFunc = std::function<void(std::unique_ptr<Data>&, std::unique_ptr<Data>&)>;
+
+    // Only used as the other side of Swap(), or as the target of Merge() when given a limit.
+    AggregateTable() = default;
+    explicit AggregateTable(size_t maxNodes) : mMaxNodes(maxNodes) {}
+    AggregateTable(size_t maxNodes, const AggregateFunc& aggregateFunc, const BuildFunc& buildFunc)
+        : mMaxNodes(maxNodes), mAggregateFunc(aggregateFunc), mBuildFunc(buildFunc) {}
+
+    bool Aggregate(const Value& d, const AggregateKey& key) {
+        auto groupKey = key.GroupKey();
+        auto seriesKey = key.SeriesKey();
+        uint64_t groupHash = XXH64(groupKey.data(), groupKey.size(), 0);
+        uint32_t groupIdx = FindGroup(groupHash, groupKey);
+        uint64_t entryHash = XXH64(seriesKey.data(), seriesKey.size(), groupHash);
+        uint32_t entryIdx = groupIdx == kNil ? kNil : FindEntry(entryHash, groupIdx, seriesKey);
+        if (entryIdx == kNil) {
+            size_t newNodes = (groupIdx == kNil ? 1 : 0) + (seriesKey.empty() ? 0 : 1);
+            if (mNodeCount + newNodes > mMaxNodes) {
+                // when we exceed the maximum limit, we will drop new metrics
+                LOG_ERROR(sLogger, ("maximum limit exceeded", mMaxNodes));
+                return false;
+            }
+            if (groupIdx == kNil) {
+                groupIdx = AddGroup(groupHash, groupKey);
+            }
+            entryIdx = AddEntry(entryHash, groupIdx, seriesKey);
+            mNodeCount += newNodes;
+        }
+        auto& entry = mEntries[entryIdx];
+        if (!entry.mData) {
+            entry.mData = mBuildFunc(d, mGroups[entry.mGroup].mSourceBuffer);
+            if (!entry.mData) {
+                return false;
+            }
+        }
+        mAggregateFunc(entry.mData, d);
+        return true;
+    }
+
+    const std::vector<Group>& GetGroups() const { return mGroups; }
+
+    void ForEach(const Group& group, const std::function<void(const Data*)>& call) const {
+        for (uint32_t i = group.mFirst; i != kNil; i = mEntries[i].mNext) {
+            if (mEntries[i].mData) {
+                call(mEntries[i].mData.get());
+            }
+        }
+    }
+
+    void ForEach(const std::function<void(const Data*)>& call) const {
+        for (const auto& group : mGroups) {
+            ForEach(group, call);
+        }
+    }
+
+    // Drop all series but keep the allocated capacity.
+    void Reset() {
+        mGroups.clear();
+        mEntries.clear();
+        mArena.clear();
+        std::fill(mGroupIndex.begin(), mGroupIndex.end(), 0);
+        std::fill(mEntryIndex.begin(), mEntryIndex.end(), 0);
+        mNodeCount = 0;
+    }
+
+    // Exchange the series with other, which keeps its own limit and functions. Swapping with a drained table every
+    // window lets the two tables reuse each other's capacity.
+    void Swap(AggregateTable& other) noexcept {
+        mGroups.swap(other.mGroups);
+        mEntries.swap(other.mEntries);
+        mArena.swap(other.mArena);
+        mGroupIndex.swap(other.mGroupIndex);
+        mEntryIndex.swap(other.mEntryIndex);
+        std::swap(mNodeCount, other.mNodeCount);
+    }
+
+    // Move the series of other into this table, a series present in both is combined by mergeFunc. Data moved in
+    // may point into the source buffer of its group in other, so the group it lands in retains that buffer.
+    bool Merge(AggregateTable& other, const MergeFunc& mergeFunc) {
+        bool complete = true;
+        for (auto& otherGroup : other.mGroups) {
+            StringView groupKey(other.mArena.data() + otherGroup.mKeyOffset, otherGroup.mKeyLen);
+            uint32_t groupIdx = FindGroup(otherGroup.mHash, groupKey);
+            for (uint32_t i = otherGroup.mFirst; i != kNil; i = other.mEntries[i].mNext) {
+                auto& otherEntry = other.mEntries[i];
+                if (!otherEntry.mData) {
+                    continue;
+                }
+                StringView seriesKey(other.mArena.data() + otherEntry.mKeyOffset, otherEntry.mKeyLen);
+                uint32_t entryIdx = groupIdx == kNil ? kNil : FindEntry(otherEntry.mHash, groupIdx, seriesKey);
+                if (entryIdx == kNil) {
+                    size_t newNodes = (groupIdx == kNil ? 1 : 0) + (seriesKey.empty() ? 0 : 1);
+                    if (mNodeCount + newNodes > mMaxNodes) {
+                        complete = false;
+                        continue;
+                    }
+                    if (groupIdx == kNil) {
+                        groupIdx = AddGroup(otherGroup.mHash, groupKey, otherGroup.mSourceBuffer);
+                    }
+                    entryIdx = AddEntry(otherEntry.mHash, groupIdx, seriesKey);
+                    mNodeCount += newNodes;
+                }
+                auto& entry = mEntries[entryIdx];
+                if (entry.mData) {
+                    mergeFunc(entry.mData, otherEntry.mData);
+                } else {
+                    entry.mData = std::move(otherEntry.mData);
+                }
+            }
+            if (NeedSourceBuffer && groupIdx != kNil && mGroups[groupIdx].mSourceBuffer != otherGroup.mSourceBuffer) {
+                mGroups[groupIdx].mSourceBuffer->Retain(otherGroup.mSourceBuffer);
+            }
+        }
+        if (!complete) {
+            LOG_ERROR(sLogger, ("maximum limit exceeded when merging", mMaxNodes));
+        }
+        return complete;
+    }
+
+    [[nodiscard]] size_t NodeCount() const { return mNodeCount; }
+
+private:
+    bool KeyEqual(uint32_t offset, uint32_t len, StringView key) const {
+        return len == key.size() && (len == 0 || memcmp(mArena.data() + offset, key.data(), len) == 0);
+    }
+
+    uint32_t FindGroup(uint64_t hash, StringView key) const {
+        if (mGroupIndex.empty()) {
+            return kNil;
+        }
+        size_t mask = mGroupIndex.size() - 1;
+        for (size_t pos = hash & mask;; pos = (pos + 1) & mask) {
+            uint32_t slot = mGroupIndex[pos];
+            if (slot == 0) {
+                return kNil;
+            }
+            const auto& group = mGroups[slot - 1];
+            if (group.mHash == hash && KeyEqual(group.mKeyOffset, group.mKeyLen, key)) {
+                return slot - 1;
+            }
+        }
+    }
+
+    uint32_t FindEntry(uint64_t hash, uint32_t groupIdx, StringView key) const {
+        if (mEntryIndex.empty()) {
+            return kNil;
+        }
+        size_t mask = mEntryIndex.size() - 1;
+        for (size_t pos = hash & mask;; pos = (pos + 1) & mask) {
+            uint32_t slot = mEntryIndex[pos];
+            if (slot == 0) {
+                return kNil;
+            }
+            const auto& entry = mEntries[slot - 1];
+            if (entry.mHash == hash && entry.mGroup == groupIdx && KeyEqual(entry.mKeyOffset, entry.mKeyLen, key)) {
+                return slot - 1;
+            }
+        }
+    }
+
+    uint32_t AppendKey(StringView key) {
+        auto offset = static_cast<uint32_t>(mArena.size());
+        mArena.append(key.data(), key.size());
+        return offset;
+    }
+
+    uint32_t AddGroup(uint64_t hash, StringView key, std::shared_ptr<SourceBuffer> sourceBuffer = nullptr) {
+        auto idx = static_cast<uint32_t>(mGroups.size());
+        auto& group = mGroups.emplace_back();
+        group.mHash = hash;
+        group.mKeyOffset = AppendKey(key);
+        group.mKeyLen = static_cast<uint32_t>(key.size());
+        if (NeedSourceBuffer) {
+            // the source buffer is handed over to the event group of this group when consumed
+            group.mSourceBuffer = sourceBuffer ? std::move(sourceBuffer) : std::make_shared<SourceBuffer>();
+        }
+        Insert(mGroupIndex, mGroups, hash, idx);
+        return idx;
+    }
+
+    uint32_t AddEntry(uint64_t hash, uint32_t groupIdx, StringView key) {
+        auto idx = static_cast<uint32_t>(mEntries.size());
+        auto& entry = mEntries.emplace_back();
+        entry.mHash = hash;
+        entry.mKeyOffset = AppendKey(key);
+        entry.mKeyLen = static_cast<uint32_t>(key.size());
+        entry.mGroup = groupIdx;
+        auto& group = mGroups[groupIdx];
+        if (group.mLast == kNil) {
+            group.mFirst = idx;
+        } else {
+            mEntries[group.mLast].mNext = idx;
+        }
+        group.mLast = idx;
+        ++group.mSize;
+        Insert(mEntryIndex, mEntries, hash, idx);
+        return idx;
+    }
+
+    // keep the load factor of the index under 1/2
+    template <class T>
+    static void Insert(std::vector<uint32_t>& index, const std::vector<T>& items, uint64_t hash, uint32_t idx) {
+        if (items.size() * 2 > index.size()) {
+            std::vector<uint32_t> newIndex(std::max<size_t>(index.size() * 2, 64), 0);
+            size_t mask = newIndex.size() - 1;
+            for (uint32_t i = 0; i < idx; ++i) {
+                size_t pos = items[i].mHash & mask;
+                while (newIndex[pos] != 0) {
+                    pos = (pos + 1) & mask;
+                }
+                newIndex[pos] = i + 1;
+            }
+            index.swap(newIndex);
+        }
+        size_t mask = index.size() - 1;
+        size_t pos = hash & mask;
+        while (index[pos] != 0) {
+            pos = (pos + 1) & mask;
+        }
+        index[pos] = idx + 1;
+    }
+
+    size_t mMaxNodes = 0UL;
+    size_t mNodeCount = 0UL;
+    std::vector<Group> mGroups;
+    std::vector<Entry> mEntries;
+    std::string mArena;
+    // 1-based index of mGroups and mEntries, 0 if the slot is empty
+    std::vector<uint32_t> mGroupIndex;
+    std::vector<uint32_t> mEntryIndex;
+
+    AggregateFunc mAggregateFunc;
+    BuildFunc mBuildFunc;
+};
+
+} // namespace logtail::ebpf
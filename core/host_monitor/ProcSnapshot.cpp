@@ -0,0 +1,402 @@
+/*
+ * Copyright 2025 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "host_monitor/ProcSnapshot.h"
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <thread>
+
+#include "common/Flags.h"
+#include "host_monitor/Constants.h"
+#include "logger/Logger.h"
+
+DEFINE_FLAG_INT32(process_collect_silent_count, "number of process scanned between a sleep", 1000);
+DEFINE_FLAG_INT32(host_monitor_proc_snapshot_ttl_ms,
+                  "collectors asking for a proc snapshot within this time share the same scan",
+                  1000);
+DEFINE_FLAG_INT32(host_monitor_max_cached_proc_fds, "max stat files of processes kept open between scans", 2048);
+
+using namespace std;
+
+namespace logtail {
+
+namespace {
+
+const size_t kReadBufferSize = 4096;
+
+bool ParseUInt(const char* begin, const char* end, uint64_t& value) {
+    if (begin == end) {
+        return false;
+    }
+    uint64_t res = 0;
+    for (const char* p = begin; p < end; ++p) {
+        if (*p < '0' || *p > '9') {
+            return false;
+        }
+        res = res * 10 + (*p - '0');
+    }
+    value = res;
+    return true;
+}
+
+template <typename T>
+bool ParseInt(const char* begin, const char* end, T& value) {
+    bool negative = begin < end && *begin == '-';
+    uint64_t res = 0;
+    if (!ParseUInt(negative ? begin + 1 : begin, end, res)) {
+        return false;
+    }
+    value = negative ? -static_cast<T>(res) : static_cast<T>(res);
+    return true;
+}
+
+bool ParsePid(const char* name, pid_t& pid) {
+    return ParseInt(name, name + strlen(name), pid) && pid > 0;
+}
+
+} // namespace
+
+ProcSnapshotManager::~ProcSnapshotManager() {
+    CloseProcDir();
+    CloseSystemStat();
+}
+
+shared_ptr<const ProcSnapshot> ProcSnapshotManager::GetSnapshot() {
+    lock_guard<mutex> lock(mMux);
+    auto now = chrono::steady_clock::now();
+    if (mProcDirPath != PROCESS_DIR.string()) {
+        // PROCESS_DIR is only changed by tests
+        CloseProcDir();
+        mSnapshot.reset();
+    }
+    if (mSnapshot && now < mSnapshot->mTime + chrono::milliseconds(INT32_FLAG(host_monitor_proc_snapshot_ttl_ms))) {
+        return mSnapshot;
+    }
+    if (!OpenProcDir()) {
+        return nullptr;
+    }
+    auto snapshot = make_shared<ProcSnapshot>();
+    if (!Scan(*snapshot)) {
+        return nullptr;
+    }
+    // the scan may take long on hosts with many processes, the ttl starts when it is done
+    snapshot->mTime = chrono::steady_clock::now();
+    mSnapshot = std::move(snapshot);
+    return mSnapshot;
+}
+
+bool ProcSnapshotManager::ReadProcessStat(pid_t pid, ProcessStat& stat) {
+    lock_guard<mutex> lock(mMux);
+    if (mProcDirPath != PROCESS_DIR.string()) {
+        CloseProcDir();
+        mSnapshot.reset();
+    }
+    if (!OpenProcDir()) {
+        return false;
+    }
+    StatFd statFd;
+    if (!ReadStat(pid, statFd, false)) {
+        return false;
+    }
+    return ParseProcessStat(pid, mBuffer.data(), mBuffer.size(), stat);
+}
+
+bool ProcSnapshotManager::ReadSystemStat(vector<string>& lines) {
+    lock_guard<mutex> lock(mSystemStatMux);
+    auto path = (PROCESS_DIR / PROCESS_STAT).string();
+    if (mSystemStatPath != path) {
+        // PROCESS_DIR is only changed by tests
+        CloseSystemStat();
+        mSystemStatPath = path;
+    }
+    if (mSystemStatFd < 0) {
+        mSystemStatFd = open(mSystemStatPath.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    if (mSystemStatFd < 0 || !PRead(mSystemStatFd, mSystemStatBuffer)) {
+        return false;
+    }
+    const char* p = mSystemStatBuffer.data();
+    const char* end = p + mSystemStatBuffer.size();
+    while (p < end) {
+        const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+        if (eol == nullptr) {
+            eol = end;
+        }
+        if (eol > p) {
+            lines.emplace_back(p, eol);
+        }
+        p = eol + 1;
+    }
+    return true;
+}
+
+void ProcSnapshotManager::Clear() {
+    {
+        lock_guard<mutex> lock(mMux);
+        CloseProcDir();
+        mSnapshot.reset();
+    }
+    lock_guard<mutex> lock(mSystemStatMux);
+    CloseSystemStat();
+}
+
+void ProcSnapshotManager::CloseSystemStat() {
+    if (mSystemStatFd >= 0) {
+        close(mSystemStatFd);
+        mSystemStatFd = -1;
+    }
+    mSystemStatPath.clear();
+}
+
+bool ProcSnapshotManager::OpenProcDir() {
+    if (mProcDir != nullptr) {
+        return true;
+    }
+    mProcDirPath = PROCESS_DIR.string();
+    mProcDirFd = open(mProcDirPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (mProcDirFd < 0) {
+        LOG_ERROR(sLogger, ("failed to open proc dir", mProcDirPath)("errno", errno));
+        return false;
+    }
+    // the DIR owns a dup of the fd, so that openat can still use mProcDirFd
+    int dirFd = dup(mProcDirFd);
+    mProcDir = dirFd < 0 ? nullptr : fdopendir(dirFd);
+    if (mProcDir == nullptr) {
+        LOG_ERROR(sLogger, ("failed to open proc dir", mProcDirPath)("errno", errno));
+        if (dirFd >= 0) {
+            close(dirFd);
+        }
+        close(mProcDirFd);
+        mProcDirFd = -1;
+        return false;
+    }
+    return true;
+}
+
+void ProcSnapshotManager::CloseProcDir() {
+    for (auto& item : mStatFds) {
+        if (item.second.mFd >= 0) {
+            close(item.second.mFd);
+        }
+    }
+    mStatFds.clear();
+    mOpenStatFdCnt = 0;
+    if (mProcDir != nullptr) {
+        closedir(mProcDir);
+        mProcDir = nullptr;
+    }
+    if (mProcDirFd >= 0) {
+        close(mProcDirFd);
+        mProcDirFd = -1;
+    }
+    mProcDirPath.clear();
+}
+
+bool ProcSnapshotManager::Scan(ProcSnapshot& snapshot) {
+    ++mGeneration;
+    rewinddir(mProcDir);
+    snapshot.mProcesses.reserve(mStatFds.size());
+    int readCount = 0;
+    size_t maxCachedFds = static_cast<size_t>(max(INT32_FLAG(host_monitor_max_cached_proc_fds), 0));
+    // leave at least half of the fd limit to the rest of the process
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY) {
+        maxCachedFds = min(maxCachedFds, static_cast<size_t>(limit.rlim_cur / 2));
+    }
+    while (auto* entry = readdir(mProcDir)) {
+        pid_t pid = 0;
+        if (!ParsePid(entry->d_name, pid)) {
+            continue;
+        }
+        if (++readCount > INT32_FLAG(process_collect_silent_count)) {
+            readCount = 0;
+            this_thread::sleep_for(chrono::milliseconds(100));
+        }
+        auto [it, inserted] = mStatFds.try_emplace(pid);
+        auto& statFd = it->second;
+        // processes seen in the previous scan are long-lived enough to keep their stat file open
+        bool keepOpen = !inserted && statFd.mGeneration + 1 == mGeneration && mOpenStatFdCnt < maxCachedFds;
+        statFd.mGeneration = mGeneration;
+        if (!ReadStat(pid, statFd, keepOpen)) {
+            continue;
+        }
+        snapshot.mProcesses.emplace_back();
+        if (!ParseProcessStat(pid, mBuffer.data(), mBuffer.size(), snapshot.mProcesses.back())) {
+            LOG_WARNING(sLogger, ("failed to parse process stat", pid)("stat", mBuffer));
+            snapshot.mProcesses.pop_back();
+        }
+    }
+
+    for (auto it = mStatFds.begin(); it != mStatFds.end();) {
+        if (it->second.mGeneration != mGeneration) {
+            if (it->second.mFd >= 0) {
+                close(it->second.mFd);
+                --mOpenStatFdCnt;
+            }
+            it = mStatFds.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    return true;
+}
+
+bool ProcSnapshotManager::PRead(int fd, string& buffer) {
+    size_t len = 0;
+    buffer.resize(max(buffer.capacity(), kReadBufferSize));
+    while (true) {
+        ssize_t n = pread(fd, &buffer[len], buffer.size() - len, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        len += n;
+        if (n == 0 || len < buffer.size()) {
+            break;
+        }
+        buffer.resize(buffer.size() * 2);
+    }
+    buffer.resize(len);
+    return len > 0;
+}
+
+bool ProcSnapshotManager::ReadStat(pid_t pid, StatFd& statFd, bool keepOpen) {
+    if (statFd.mFd >= 0) {
+        if (PRead(statFd.mFd, mBuffer)) {
+            return true;
+        }
+        // the process has exited, and the pid may have been reused
+        close(statFd.mFd);
+        statFd.mFd = -1;
+        --mOpenStatFdCnt;
+    }
+    char path[32];
+    snprintf(path, sizeof(path), "%d/stat", pid);
+    int fd = openat(mProcDirFd, path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        // the process exited during the scan
+        return false;
+    }
+    bool res = PRead(fd, mBuffer);
+    if (res && keepOpen) {
+        statFd.mFd = fd;
+        ++mOpenStatFdCnt;
+    } else {
+        close(fd);
+    }
+    return res;
+}
+
+// 数据样例: /proc/1/stat
+// 1 (cat) R 0 1 1 34816 1 4194560 1110 0 0 0 1 1 0 0 20 0 1 0 18938584 4505600 171 18446744073709551615 4194304 4238788
+// 140727020025920 0 0 0 0 0 0 0 0 0 17 3 0 0 0 0 0 6336016 6337300 21442560 140727020027760 140727020027777
+// 140727020027777 140727020027887 0
+bool ProcSnapshotManager::ParseProcessStat(pid_t pid, const char* data, size_t len, ProcessStat& ps) {
+    ps.pid = pid;
+    const char* end = data + len;
+    const char* nameStart = static_cast<const char*>(memchr(data, '(', len));
+    const char* nameEnd = end;
+    while (nameEnd > data && *(nameEnd - 1) != ')') {
+        --nameEnd;
+    }
+    if (nameStart == nullptr || nameEnd == data || nameStart >= nameEnd - 1) {
+        return false;
+    }
+    ps.name.assign(nameStart + 1, nameEnd - 1);
+
+    const char* p = nameEnd;
+    int idx = static_cast<int>(EnumProcessStat::state);
+    for (; idx <= static_cast<int>(EnumProcessStat::processor); ++idx) {
+        while (p < end && *p == ' ') {
+            ++p;
+        }
+        const char* fieldStart = p;
+        while (p < end && *p != ' ' && *p != '\n') {
+            ++p;
+        }
+        if (p == fieldStart) {
+            return false;
+        }
+        bool ok = true;
+        switch (static_cast<EnumProcessStat>(idx)) {
+            case EnumProcessStat::state:
+                ps.state = *fieldStart;
+                break;
+            case EnumProcessStat::ppid:
+                ok = ParseInt(fieldStart, p, ps.parentPid);
+                break;
+            case EnumProcessStat::tty_nr:
+                ok = ParseInt(fieldStart, p, ps.tty);
+                break;
+            case EnumProcessStat::minflt:
+                ok = ParseUInt(fieldStart, p, ps.minorFaults);
+                break;
+            case EnumProcessStat::majflt:
+                ok = ParseUInt(fieldStart, p, ps.majorFaults);
+                break;
+            case EnumProcessStat::utime:
+                ok = ParseUInt(fieldStart, p, ps.utimeTicks);
+                break;
+            case EnumProcessStat::stime:
+                ok = ParseUInt(fieldStart, p, ps.stimeTicks);
+                break;
+            case EnumProcessStat::cutime:
+                ok = ParseUInt(fieldStart, p, ps.cutimeTicks);
+                break;
+            case EnumProcessStat::cstime:
+                ok = ParseUInt(fieldStart, p, ps.cstimeTicks);
+                break;
+            case EnumProcessStat::priority:
+                ok = ParseInt(fieldStart, p, ps.priority);
+                break;
+            case EnumProcessStat::nice:
+                ok = ParseInt(fieldStart, p, ps.nice);
+                break;
+            case EnumProcessStat::num_threads:
+                ok = ParseInt(fieldStart, p, ps.numThreads);
+                break;
+            case EnumProcessStat::starttime:
+                ok = ParseInt(fieldStart, p, ps.startTicks);
+                break;
+            case EnumProcessStat::vsize:
+                ok = ParseUInt(fieldStart, p, ps.vSize);
+                break;
+            case EnumProcessStat::rss:
+                ok = ParseUInt(fieldStart, p, ps.rss);
+                if (ok) {
+                    ps.rss *= getpagesize();
+                }
+                break;
+            case EnumProcessStat::processor:
+                ok = ParseInt(fieldStart, p, ps.processor);
+                break;
+            default:
+                break;
+        }
+        if (!ok) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace logtail
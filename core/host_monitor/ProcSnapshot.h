@@ -0,0 +1,104 @@
+/*
+ * Copyright 2025 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <dirent.h>
+#include <sys/types.h>
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/ProcParser.h"
+
+namespace logtail {
+
+// One scan of the processes in PROCESS_DIR shared by all host monitor collectors.
+struct ProcSnapshot {
+    // when the scan completed
+    std::chrono::steady_clock::time_point mTime;
+    std::vector<ProcessStat> mProcesses;
+};
+
+// ProcSnapshotManager scans PROCESS_DIR at most once per host_monitor_proc_snapshot_ttl_ms, no matter how many
+// collectors ask for it. The proc directory is opened once, and the stat files of processes seen in previous scans
+// are kept open and re-read with pread, so that a scan of a long-lived process costs a single syscall.
+class ProcSnapshotManager {
+public:
+    ProcSnapshotManager(const ProcSnapshotManager&) = delete;
+    ProcSnapshotManager& operator=(const ProcSnapshotManager&) = delete;
+
+    static ProcSnapshotManager* GetInstance() {
+        static ProcSnapshotManager instance;
+        return &instance;
+    }
+
+    // Return nullptr if PROCESS_DIR can not be read.
+    std::shared_ptr<const ProcSnapshot> GetSnapshot();
+    bool ReadProcessStat(pid_t pid, ProcessStat& stat);
+    // Read the lines of <proc>/stat. It never waits for a process scan.
+    bool ReadSystemStat(std::vector<std::string>& lines);
+    // Close all cached fds and drop the last snapshot.
+    void Clear();
+
+    // Parse the content of /proc/<pid>/stat without splitting it into strings.
+    static bool ParseProcessStat(pid_t pid, const char* data, size_t len, ProcessStat& stat);
+
+private:
+    struct StatFd {
+        int mFd = -1;
+        uint64_t mGeneration = 0;
+    };
+
+    ProcSnapshotManager() = default;
+    ~ProcSnapshotManager();
+
+    bool OpenProcDir();
+    void CloseProcDir();
+    bool Scan(ProcSnapshot& snapshot);
+    void CloseSystemStat();
+    // Read the whole file of fd into buffer, return false on error.
+    static bool PRead(int fd, std::string& buffer);
+    // Read <proc>/<pid>/stat into mBuffer, reusing and keeping the fd in statFd if possible.
+    bool ReadStat(pid_t pid, StatFd& statFd, bool keepOpen);
+
+    std::mutex mMux;
+    std::string mProcDirPath;
+    int mProcDirFd = -1;
+    DIR* mProcDir = nullptr;
+    std::unordered_map<pid_t, StatFd> mStatFds;
+    size_t mOpenStatFdCnt = 0;
+    uint64_t mGeneration = 0;
+    std::string mBuffer;
+    std::shared_ptr<const ProcSnapshot> mSnapshot;
+
+    // <proc>/stat has its own lock, so that reading it is not blocked by a scan of all processes
+    std::mutex mSystemStatMux;
+    std::string mSystemStatPath;
+    int mSystemStatFd = -1;
+    std::string mSystemStatBuffer;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class ProcSnapshotUnittest;
+#endif
+};
+
+} // namespace logtail
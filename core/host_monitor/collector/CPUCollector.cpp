@@ -24,7 +24,7 @@
 #include "MetricValue.h"
 #include "common/StringTools.h"
 #include "host_monitor/Constants.h"
-#include "host_monitor/SystemInformationTools.h"
+#include "host_monitor/ProcSnapshot.h"
 #include "logger/Logger.h"
 
 namespace logtail {
@@ -79,10 +79,11 @@ bool CPUCollector::Collect(const HostMonitorTimerEvent::CollectConfig& collectCo
 
 bool CPUCollector::GetHostSystemCPUStat(std::vector<CPUStat>& cpus) {
     std::vector<std::string> cpuLines;
-    std::string errorMessage;
-    if (!GetHostSystemStat(cpuLines, errorMessage)) {
+    if (!ProcSnapshotManager::GetInstance()->ReadSystemStat(cpuLines) || cpuLines.empty()) {
         if (mValidState) {
-            LOG_WARNING(sLogger, ("failed to get system cpu", "invalid CPU collector")("error msg", errorMessage));
+            LOG_WARNING(sLogger,
+                        ("failed to get system cpu", "invalid CPU collector")(
+                            "error msg", "failed to read " + (PROCESS_DIR / PROCESS_STAT).string()));
             mValidState = false;
         }
         return false;
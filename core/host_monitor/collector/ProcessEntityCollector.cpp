@@ -21,38 +21,49 @@
 #include <sched.h>
 #include <unistd.h>
 
-#include <functional>
+#include <algorithm>
+#include <charconv>
 #include <memory>
-#include <queue>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "ProcParser.h"
 #include "common/FileSystemUtil.h"
-#include "common/Flags.h"
 #include "common/HashUtil.h"
 #include "common/MachineInfoUtil.h"
 #include "common/StringTools.h"
 #include "common/StringView.h"
 #include "constants/EntityConstants.h"
 #include "host_monitor/Constants.h"
-#include "host_monitor/SystemInformationTools.h"
+#include "host_monitor/ProcSnapshot.h"
 #include "logger/Logger.h"
 #include "models/PipelineEventGroup.h"
 
-DEFINE_FLAG_INT32(process_collect_silent_count, "number of process scanned between a sleep", 1000);
-
 namespace logtail {
 
 const size_t ProcessTopN = 20;
 
 const std::string ProcessEntityCollector::sName = "process_entity";
 
-ProcessEntityCollector::ProcessEntityCollector()
-    : mProcParser(""), mProcessSilentCount(INT32_FLAG(process_collect_silent_count)) {
+namespace {
+
+StringView CopyToBuffer(SourceBuffer& sourceBuffer, StringView value) {
+    auto sb = sourceBuffer.CopyString(value);
+    return StringView(sb.data, sb.size);
+}
+
+template <typename T>
+StringView FormatToBuffer(SourceBuffer& sourceBuffer, T value) {
+    char buf[24];
+    auto res = std::to_chars(buf, buf + sizeof(buf), value);
+    return CopyToBuffer(sourceBuffer, StringView(buf, res.ptr - buf));
 }
 
+} // namespace
+
+ProcessEntityCollector::ProcessEntityCollector() = default;
+
 system_clock::time_point ProcessEntityCollector::TicksToUnixTime(int64_t startTicks) {
     return system_clock::time_point{static_cast<milliseconds>(startTicks)
                                     + milliseconds{GetHostSystemBootTime() * 1000}};
@@ -65,38 +76,54 @@ bool ProcessEntityCollector::Collect(const HostMonitorTimerEvent::CollectConfig&
     }
     std::vector<ExtendedProcessStatPtr> processes;
     GetSortedProcess(processes, ProcessTopN);
+    if (processes.empty()) {
+        return true;
+    }
+
+    // fields shared by all processes of this tick
+    auto& sourceBuffer = group->GetSourceBuffer();
+    time_t logtime = time(nullptr);
+    int64_t bootTimeMs = GetHostSystemBootTime() * 1000;
+    std::string domain;
+    std::string entityType;
+    std::string hostEntityType;
+    StringView hostEntityID;
+    FetchDomainInfo(domain, entityType, hostEntityType, hostEntityID);
+    auto domainBuffer = CopyToBuffer(*sourceBuffer, domain);
+    auto entityTypeBuffer = CopyToBuffer(*sourceBuffer, entityType);
+    auto hostEntityTypeBuffer = CopyToBuffer(*sourceBuffer, hostEntityType);
+    auto hostEntityIDBuffer = CopyToBuffer(*sourceBuffer, hostEntityID);
+    auto logtimeBuffer = FormatToBuffer(*sourceBuffer, logtime);
+    auto keepAliveBuffer = FormatToBuffer(*sourceBuffer, collectConfig.mInterval.count() * 2);
+
+    group->ReserveEvents(group->GetEvents().size() + processes.size() * 2);
     for (const auto& extentedProcess : processes) {
-        auto process = extentedProcess->stat;
+        const auto& process = extentedProcess->stat;
         auto* event = group->AddLogEvent();
-        time_t logtime = time(nullptr);
         event->SetTimestamp(logtime);
 
         auto startTime = system_clock::time_point{static_cast<milliseconds>(process.startTicks)
-                                                  + milliseconds{GetHostSystemBootTime() * 1000}};
-
-        std::string processCreateTime = std::to_string(duration_cast<seconds>(startTime.time_since_epoch()).count());
+                                                  + milliseconds{bootTimeMs}};
+        auto processCreateTime
+            = FormatToBuffer(*sourceBuffer, duration_cast<seconds>(startTime.time_since_epoch()).count());
+        auto pid = FormatToBuffer(*sourceBuffer, process.pid);
 
         // common fields
-        std::string domain;
-        std::string entityType;
-        std::string hostEntityType;
-        StringView hostEntityID;
-        FetchDomainInfo(domain, entityType, hostEntityType, hostEntityID);
-        event->SetContent(DEFAULT_CONTENT_KEY_DOMAIN, domain);
-        event->SetContent(DEFAULT_CONTENT_KEY_ENTITY_TYPE, entityType);
-        auto entityID = GetProcessEntityID(std::to_string(process.pid), processCreateTime, hostEntityID);
-        event->SetContent(DEFAULT_CONTENT_KEY_ENTITY_ID, entityID);
-
-        event->SetContent(DEFAULT_CONTENT_KEY_FIRST_OBSERVED_TIME, processCreateTime);
-        event->SetContent(DEFAULT_CONTENT_KEY_LAST_OBSERVED_TIME, std::to_string(logtime));
-        int keepAliveSeconds = collectConfig.mInterval.count() * 2;
-        event->SetContent(DEFAULT_CONTENT_KEY_KEEP_ALIVE_SECONDS, std::to_string(keepAliveSeconds));
+        event->SetContentNoCopy(DEFAULT_CONTENT_KEY_DOMAIN, domainBuffer);
+        event->SetContentNoCopy(DEFAULT_CONTENT_KEY_ENTITY_TYPE, entityTypeBuffer);
+        auto entityID
+            = CopyToBuffer(*sourceBuffer, GetProcessEntityID(pid, processCreateTime, hostEntityIDBuffer));
+        event->SetContentNoCopy(DEFAULT_CONTENT_KEY_ENTITY_ID, entityID);
+
+        event->SetContentNoCopy(DEFAULT_CONTENT_KEY_FIRST_OBSERVED_TIME, processCreateTime);
+        event->SetContentNoCopy(DEFAULT_CONTENT_KEY_LAST_OBSERVED_TIME, logtimeBuffer);
+        event->SetContentNoCopy(DEFAULT_CONTENT_KEY_KEEP_ALIVE_SECONDS, keepAliveBuffer);
 
         // custom fields
-        event->SetContent(DEFAULT_CONTENT_KEY_PROCESS_PID, std::to_string(process.pid));
-        event->SetContent(DEFAULT_CONTENT_KEY_PROCESS_PPID, std::to_string(process.parentPid));
+        event->SetContentNoCopy(DEFAULT_CONTENT_KEY_PROCESS_PID, pid);
+        event->SetContentNoCopy(DEFAULT_CONTENT_KEY_PROCESS_PPID, FormatToBuffer(*sourceBuffer, process.parentPid));
         event->SetContent(DEFAULT_CONTENT_KEY_PROCESS_COMM, process.name);
-        event->SetContent(DEFAULT_CONTENT_KEY_PROCESS_KTIME, processCreateTime);
+        event->SetContentNoCopy(DEFAULT_CONTENT_KEY_PROCESS_KTIME, processCreateTime);
         // event->SetContent(DEFAULT_CONTENT_KEY_PROCESS_USER, ""); TODO: get user name
         // event->SetContent(DEFAULT_CONTENT_KEY_PROCESS_CWD, ""); TODO: get cwd
         // event->SetContent(DEFAULT_CONTENT_KEY_PROCESS_BINARY, ""); TODO: get binary
@@ -107,153 +134,124 @@ bool ProcessEntityCollector::Collect(const HostMonitorTimerEvent::CollectConfig&
         // process -> host link
         auto* linkEvent = group->AddLogEvent();
         linkEvent->SetTimestamp(logtime);
-        linkEvent->SetContent(DEFAULT_CONTENT_KEY_SRC_DOMAIN, domain);
-        linkEvent->SetContent(DEFAULT_CONTENT_KEY_SRC_ENTITY_TYPE, entityType);
-        linkEvent->SetContent(DEFAULT_CONTENT_KEY_SRC_ENTITY_ID, entityID);
-        linkEvent->SetContent(DEFAULT_CONTENT_KEY_DEST_DOMAIN, domain);
-        linkEvent->SetContent(DEFAULT_CONTENT_KEY_DEST_ENTITY_TYPE, hostEntityType);
-        linkEvent->SetContent(DEFAULT_CONTENT_KEY_DEST_ENTITY_ID, hostEntityID);
-        linkEvent->SetContent(DEFAULT_CONTENT_KEY_RELATION_TYPE, DEFAULT_CONTENT_VALUE_METHOD_UPDATE);
-        linkEvent->SetContent(DEFAULT_CONTENT_KEY_RELATION_TYPE, DEFAULT_CONTENT_VALUE_METHOD_UPDATE);
-        linkEvent->SetContent(DEFAULT_CONTENT_KEY_FIRST_OBSERVED_TIME, processCreateTime);
-        linkEvent->SetContent(DEFAULT_CONTENT_KEY_LAST_OBSERVED_TIME, std::to_string(logtime));
-        linkEvent->SetContent(DEFAULT_CONTENT_KEY_KEEP_ALIVE_SECONDS, std::to_string(keepAliveSeconds));
+        linkEvent->SetContentNoCopy(DEFAULT_CONTENT_KEY_SRC_DOMAIN, domainBuffer);
+        linkEvent->SetContentNoCopy(DEFAULT_CONTENT_KEY_SRC_ENTITY_TYPE, entityTypeBuffer);
+        linkEvent->SetContentNoCopy(DEFAULT_CONTENT_KEY_SRC_ENTITY_ID, entityID);
+        linkEvent->SetContentNoCopy(DEFAULT_CONTENT_KEY_DEST_DOMAIN, domainBuffer);
+        linkEvent->SetContentNoCopy(DEFAULT_CONTENT_KEY_DEST_ENTITY_TYPE, hostEntityTypeBuffer);
+        linkEvent->SetContentNoCopy(DEFAULT_CONTENT_KEY_DEST_ENTITY_ID, hostEntityIDBuffer);
+        linkEvent->SetContentNoCopy(DEFAULT_CONTENT_KEY_RELATION_TYPE, DEFAULT_CONTENT_VALUE_METHOD_UPDATE);
+        linkEvent->SetContentNoCopy(DEFAULT_CONTENT_KEY_FIRST_OBSERVED_TIME, processCreateTime);
+        linkEvent->SetContentNoCopy(DEFAULT_CONTENT_KEY_LAST_OBSERVED_TIME, logtimeBuffer);
+        linkEvent->SetContentNoCopy(DEFAULT_CONTENT_KEY_KEEP_ALIVE_SECONDS, keepAliveBuffer);
     }
     return true;
 }
 
 void ProcessEntityCollector::GetSortedProcess(std::vector<ExtendedProcessStatPtr>& processStats, size_t topN) {
-    steady_clock::time_point now = steady_clock::now();
-    auto compare = [](const std::pair<ExtendedProcessStatPtr, double>& a,
-                      const std::pair<ExtendedProcessStatPtr, double>& b) { return a.second > b.second; };
-    std::priority_queue<std::pair<ExtendedProcessStatPtr, double>,
-                        std::vector<std::pair<ExtendedProcessStatPtr, double>>,
-                        decltype(compare)>
-        queue(compare);
-
-    int readCount = 0;
-    std::unordered_map<pid_t, ExtendedProcessStatPtr> newProcessStat;
-    WalkAllProcess(PROCESS_DIR, [&](const std::string& dirName) {
-        if (++readCount > mProcessSilentCount) {
-            readCount = 0;
-            std::this_thread::sleep_for(milliseconds{100});
+    processStats.clear();
+    auto snapshot = ProcSnapshotManager::GetInstance()->GetSnapshot();
+    if (!snapshot) {
+        if (mValidState) {
+            LOG_ERROR(sLogger,
+                      ("failed to read proc dir", "invalid ProcessEntity collector")("root", PROCESS_DIR.string()));
+            mValidState = false;
         }
-        pid_t pid{};
-        if (!StringTo(dirName, pid)) {
-            return;
+        return;
+    }
+    mValidState = true;
+
+    ++mGeneration;
+    mCandidates.clear();
+    for (const auto& stat : snapshot->mProcesses) {
+        if (stat.pid == 0) {
+            continue;
         }
-        if (pid != 0) {
-            bool isFirstCollect = false;
-            auto ptr = GetProcessStat(pid, isFirstCollect);
-            newProcessStat[pid] = ptr;
-            if (ptr && !isFirstCollect) {
-                queue.emplace(ptr, ptr->cpuInfo.percent);
-            }
-            if (queue.size() > topN) {
-                queue.pop();
-            }
+        auto& entry = mProcessEntries[stat.pid];
+        if (UpdateProcessEntry(entry, stat, snapshot->mTime)) {
+            mCandidates.emplace_back(entry.mStat.cpuInfo.percent, &entry.mStat);
         }
-    });
+    }
 
-    processStats.clear();
-    processStats.reserve(queue.size());
-    while (!queue.empty()) {
-        processStats.push_back(queue.top().first);
-        queue.pop();
+    // only the top N candidates are ordered
+    auto compare = [](const std::pair<double, const ExtendedProcessStat*>& a,
+                      const std::pair<double, const ExtendedProcessStat*>& b) { return a.first > b.first; };
+    if (mCandidates.size() > topN) {
+        std::nth_element(mCandidates.begin(), mCandidates.begin() + topN, mCandidates.end(), compare);
+        mCandidates.resize(topN);
+    }
+    std::sort(mCandidates.begin(), mCandidates.end(), compare);
+    processStats.reserve(mCandidates.size());
+    for (const auto& candidate : mCandidates) {
+        processStats.emplace_back(std::make_shared<ExtendedProcessStat>(*candidate.second));
+    }
+
+    // evict processes not seen in this scan
+    for (auto it = mProcessEntries.begin(); it != mProcessEntries.end();) {
+        if (it->second.mGeneration != mGeneration) {
+            it = mProcessEntries.erase(it);
+        } else {
+            ++it;
+        }
     }
-    std::reverse(processStats.begin(), processStats.end());
 
     if (processStats.empty()) {
         LOG_INFO(sLogger, ("first collect Process Cpu info", "empty"));
     }
     LOG_DEBUG(sLogger, ("collect Process Cpu info, top", processStats.size()));
-
-    mPrevProcessStat = std::move(newProcessStat);
-    mProcessSortTime = now;
+    mProcessSortTime = snapshot->mTime;
 }
 
-ExtendedProcessStatPtr ProcessEntityCollector::GetProcessStat(pid_t pid, bool& isFirstCollect) {
-    const auto now = steady_clock::now();
-
-    // TODO: more accurate cache
-    auto prev = mPrevProcessStat.find(pid);
-    if (prev == mPrevProcessStat.end() || prev->second == nullptr
-        || prev->second->lastStatTime.time_since_epoch().count() == 0) {
-        isFirstCollect = true;
-    } else {
-        isFirstCollect = false;
-    }
+bool ProcessEntityCollector::UpdateProcessEntry(ProcessEntry& entry,
+                                                const ProcessStat& stat,
+                                                steady_clock::time_point now) {
+    // a reused pid is a new process
+    bool isFirstCollect = entry.mGeneration == 0 || entry.mStat.stat.startTicks != stat.startTicks;
+    entry.mGeneration = mGeneration;
     // proc/[pid]/stat的统计粒度通常为10ms，两次采样之间需要足够大才能平滑。
-    if (prev != mPrevProcessStat.end() && prev->second && now < prev->second->lastStatTime + seconds{1}) {
-        return prev->second;
-    }
-    auto ptr = ReadNewProcessStat(pid);
-    if (!ptr) {
-        return nullptr;
+    if (!isFirstCollect && now < entry.mStat.lastStatTime + seconds{1}) {
+        return true;
     }
 
     // calculate CPU related fields
-    {
-        ptr->lastStatTime = now;
-        constexpr const uint64_t MILLISECOND = 1000;
-        ptr->cpuInfo.user = (ptr->stat.utimeTicks + ptr->stat.cutimeTicks) * MILLISECOND / SYSTEM_HERTZ;
-        ptr->cpuInfo.sys = (ptr->stat.stimeTicks + ptr->stat.cstimeTicks) * MILLISECOND / SYSTEM_HERTZ;
-        ptr->cpuInfo.total = ptr->cpuInfo.user + ptr->cpuInfo.sys;
-        if (isFirstCollect || ptr->cpuInfo.total <= prev->second->cpuInfo.total) {
-            // first time called
-            ptr->cpuInfo.percent = 0.0;
-        } else {
-            auto totalDiff = static_cast<double>(ptr->cpuInfo.total - prev->second->cpuInfo.total);
-            auto timeDiff = static_cast<double>(
-                std::chrono::duration_cast<std::chrono::milliseconds>(ptr->lastStatTime.time_since_epoch()
-                                                                      - prev->second->lastStatTime.time_since_epoch())
-                    .count());
-            ptr->cpuInfo.percent = totalDiff / timeDiff;
-        }
+    constexpr const uint64_t MILLISECOND = 1000;
+    auto& cpuInfo = entry.mStat.cpuInfo;
+    uint64_t user = (stat.utimeTicks + stat.cutimeTicks) * MILLISECOND / SYSTEM_HERTZ;
+    uint64_t sys = (stat.stimeTicks + stat.cstimeTicks) * MILLISECOND / SYSTEM_HERTZ;
+    uint64_t total = user + sys;
+    if (isFirstCollect || total <= cpuInfo.total) {
+        // first time called
+        cpuInfo.percent = 0.0;
+    } else {
+        auto totalDiff = static_cast<double>(total - cpuInfo.total);
+        auto timeDiff = static_cast<double>(duration_cast<milliseconds>(now - entry.mStat.lastStatTime).count());
+        cpuInfo.percent = timeDiff > 0 ? totalDiff / timeDiff : 0.0;
     }
-    return ptr;
+    cpuInfo.user = user;
+    cpuInfo.sys = sys;
+    cpuInfo.total = total;
+    entry.mStat.stat = stat;
+    entry.mStat.lastStatTime = now;
+    return !isFirstCollect;
 }
 
 ExtendedProcessStatPtr ProcessEntityCollector::ReadNewProcessStat(pid_t pid) {
     LOG_DEBUG(sLogger, ("read process stat", pid));
-    auto processStat = PROCESS_DIR / std::to_string(pid) / PROCESS_STAT;
-
-    std::string line;
-    if (FileReadResult::kOK != ReadFileContent(processStat.string(), line)) {
-        LOG_ERROR(sLogger, ("read process stat", "fail")("file", processStat));
+    auto ptr = std::make_shared<ExtendedProcessStat>();
+    if (!ProcSnapshotManager::GetInstance()->ReadProcessStat(pid, ptr->stat)) {
+        LOG_ERROR(sLogger, ("read process stat", "fail")("file", PROCESS_DIR / std::to_string(pid) / PROCESS_STAT));
         return nullptr;
     }
-    auto ptr = std::make_shared<ExtendedProcessStat>();
-    mProcParser.ParseProcessStat(pid, line, ptr->stat);
     return ptr;
 }
 
-bool ProcessEntityCollector::WalkAllProcess(const std::filesystem::path& root,
-                                            const std::function<void(const std::string&)>& callback) {
-    if (!std::filesystem::exists(root) || !std::filesystem::is_directory(root)) {
-        if (mValidState) {
-            LOG_ERROR(sLogger,
-                      ("root path is not a directory or not exist", "invalid ProcessEntity collector")("root", root));
-            mValidState = false;
-        }
-        return false;
-    }
-    mValidState = true;
-
-    for (const auto& dirEntry :
-         std::filesystem::directory_iterator{root, std::filesystem::directory_options::skip_permission_denied}) {
-        std::string filename = dirEntry.path().filename().string();
-        if (IsInt(filename)) {
-            callback(filename);
-        }
-    }
-    return true;
-}
-
 std::string ProcessEntityCollector::GetProcessEntityID(StringView pid, StringView createTime, StringView hostEntityID) {
-    std::ostringstream oss;
-    oss << hostEntityID << pid << createTime;
-    auto bigID = CalcMD5(oss.str());
+    std::string key;
+    key.reserve(hostEntityID.size() + pid.size() + createTime.size());
+    key.append(hostEntityID.data(), hostEntityID.size())
+        .append(pid.data(), pid.size())
+        .append(createTime.data(), createTime.size());
+    auto bigID = CalcMD5(key);
     std::transform(bigID.begin(), bigID.end(), bigID.begin(), ::tolower);
     return bigID;
 }
@@ -283,10 +281,11 @@ int64_t ProcessEntityCollector::GetHostSystemBootTime() {
         return systemBootSeconds;
     }
     int64_t currentSeconds = duration_cast<seconds>(system_clock::now().time_since_epoch()).count();
-    std::vector<std::string> lines = {};
-    std::string errorMessage;
-    if (!GetHostSystemStat(lines, errorMessage)) {
-        LOG_WARNING(sLogger, ("failed to get system boot time", "use current time instead")("error msg", errorMessage));
+    std::vector<std::string> lines;
+    if (!ProcSnapshotManager::GetInstance()->ReadSystemStat(lines) || lines.empty()) {
+        LOG_WARNING(sLogger,
+                    ("failed to get system boot time", "use current time instead")(
+                        "error msg", "failed to read " + (PROCESS_DIR / PROCESS_STAT).string()));
         return currentSeconds;
     }
     for (auto const& line : lines) {
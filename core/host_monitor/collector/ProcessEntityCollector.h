@@ -26,6 +26,8 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "common/ProcParser.h"
 #include "common/StringView.h"
@@ -52,6 +54,12 @@ struct ExtendedProcessStat {
 
 using ExtendedProcessStatPtr = std::shared_ptr<ExtendedProcessStat>;
 
+struct ProcessEntry {
+    ExtendedProcessStat mStat;
+    // generation of the last scan seeing the process
+    uint64_t mGeneration = 0;
+};
+
 
 class ProcessEntityCollector : public BaseCollector {
 public:
@@ -66,10 +74,9 @@ public:
 private:
     system_clock::time_point TicksToUnixTime(int64_t startTicks);
     void GetSortedProcess(std::vector<ExtendedProcessStatPtr>& processStats, size_t topN);
-    ExtendedProcessStatPtr GetProcessStat(pid_t pid, bool& isFirstCollect);
+    // Return false if the process is collected for the first time and has no CPU delta yet.
+    bool UpdateProcessEntry(ProcessEntry& entry, const ProcessStat& stat, steady_clock::time_point now);
     ExtendedProcessStatPtr ReadNewProcessStat(pid_t pid);
-    ExtendedProcessStatPtr ParseProcessStat(pid_t pid, std::string& line);
-    bool WalkAllProcess(const std::filesystem::path& root, const std::function<void(const std::string&)>& callback);
 
     std::string GetProcessEntityID(StringView pid, StringView createTime, StringView hostEntityID);
     void FetchDomainInfo(std::string& domain,
@@ -79,13 +86,14 @@ private:
     int64_t GetHostSystemBootTime();
 
     steady_clock::time_point mProcessSortTime;
-    std::unordered_map<pid_t, ExtendedProcessStatPtr> mPrevProcessStat;
-    ProcParser mProcParser;
-
-    const int mProcessSilentCount;
+    // the latest sample of each process, updated in place and evicted when the pid is not seen in a scan
+    std::unordered_map<pid_t, ProcessEntry> mProcessEntries;
+    uint64_t mGeneration = 0;
+    std::vector<std::pair<double, const ExtendedProcessStat*>> mCandidates;
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class ProcessEntityCollectorUnittest;
+    friend class ProcessEntityCollectorBenchmark;
 #endif
 };
 
@@ -18,6 +18,7 @@
 
 #include <ctime>
 
+#include <algorithm>
 #include <chrono>
 #include <future>
 #include <memory>
@@ -39,6 +40,20 @@ using namespace std;
 
 DEFINE_FLAG_STRING(ipv4_cluster_cidrs, "cluster cidr", "");
 DEFINE_FLAG_BOOL(disable_k8s_meta, "disable k8s metadata", false);
+DEFINE_FLAG_INT32(k8s_metadata_negative_cache_ttl_sec,
+                  "seconds an ip unknown to the metadata server is not queried again",
+                  300);
+DEFINE_FLAG_INT32(k8s_metadata_unknown_cid_cache_ttl_sec,
+                  "seconds a container id unknown to the metadata server is not queried again, kept short since a new "
+                  "container is usually known to the server a moment later",
+                  5);
+DEFINE_FLAG_INT32(k8s_metadata_max_batch_keys, "max keys sent to the metadata server in one request", 200);
+DEFINE_FLAG_INT32(k8s_metadata_max_pending_keys,
+                  "max keys waiting for a metadata query, beyond which new keys are dropped",
+                  10000);
+DEFINE_FLAG_INT32(k8s_metadata_node_sync_interval_sec,
+                  "interval to refresh the pods of this node from the metadata server, 0 to disable",
+                  60);
 
 namespace logtail {
 
@@ -86,7 +101,10 @@ K8sMetadata::~K8sMetadata() {
 }
 
 K8sMetadata::K8sMetadata(size_t ipCacheSize, size_t cidCacheSize, size_t externalIpCacheSize)
-    : mIpCache(ipCacheSize, 20), mContainerCache(cidCacheSize, 20), mExternalIpCache(externalIpCacheSize, 20) {
+    : mIpCache(ipCacheSize, 20),
+      mContainerCache(cidCacheSize, 20),
+      mExternalIpCache(externalIpCacheSize, 20),
+      mUnknownCidCache(cidCacheSize, 20) {
     mServiceHost = STRING_FLAG(k8s_metadata_server_name);
     mServicePort = INT32_FLAG(k8s_metadata_server_port);
     const char* value = getenv("_node_ip_");
@@ -386,6 +404,9 @@ std::vector<std::string> K8sMetadata::GetByContainerIdsFromServer(std::vector<st
     std::vector<std::string> res;
     std::string reqBody = KeysToReqBody(containerIds);
     status = SendRequestToOperator(mServiceHost, reqBody, PodInfoType::ContainerIdInfo, res);
+    if (status) {
+        UpdateUnknownCidCache(containerIds, res);
+    }
     return res;
 }
 
@@ -401,15 +422,35 @@ bool K8sMetadata::GetByLocalHostFromServer() {
 
 void K8sMetadata::SetContainerCache(const std::string& key, const std::shared_ptr<K8sPodInfo>& info) {
     mContainerCache.insert(key, info);
+    mUnknownCidCache.remove(key);
 }
 
 void K8sMetadata::SetIpCache(const std::string& key, const std::shared_ptr<K8sPodInfo>& info) {
     mIpCache.insert(key, info);
+    mExternalIpCache.remove(key);
+}
+
+static std::chrono::steady_clock::time_point MissExpireTimeFromNow(int32_t ttlSec) {
+    return std::chrono::steady_clock::now() + std::chrono::seconds(std::max(0, ttlSec));
+}
+
+// an expired miss is evicted, so that the next lookup queries the metadata server again
+template <typename Cache>
+static bool IsCachedMiss(Cache& cache, const std::string& key) {
+    std::chrono::steady_clock::time_point expireTime;
+    if (!cache.tryGetCopy(key, expireTime)) {
+        return false;
+    }
+    if (std::chrono::steady_clock::now() < expireTime) {
+        return true;
+    }
+    cache.remove(key);
+    return false;
 }
 
 void K8sMetadata::SetExternalIpCache(const std::string& ip) {
     LOG_DEBUG(sLogger, (ip, "is external, inset into cache ..."));
-    mExternalIpCache.insert(ip, uint8_t(0));
+    mExternalIpCache.insert(ip, MissExpireTimeFromNow(INT32_FLAG(k8s_metadata_negative_cache_ttl_sec)));
 }
 
 void K8sMetadata::UpdateExternalIpCache(const std::vector<std::string>& queryIps,
@@ -426,6 +467,22 @@ void K8sMetadata::UpdateExternalIpCache(const std::vector<std::string>& queryIps
     }
 }
 
+void K8sMetadata::UpdateUnknownCidCache(const std::vector<std::string>& queryCids,
+                                        const std::vector<std::string>& retCids) {
+    std::set<std::string> hash(retCids.begin(), retCids.end());
+    auto expireTime = MissExpireTimeFromNow(INT32_FLAG(k8s_metadata_unknown_cid_cache_ttl_sec));
+    for (const auto& cid : queryCids) {
+        if (!hash.count(cid)) {
+            LOG_DEBUG(sLogger, (cid, "mark as unknown container id"));
+            mUnknownCidCache.insert(cid, expireTime);
+        }
+    }
+}
+
+bool K8sMetadata::IsUnknownContainerId(const std::string& containerId) {
+    return IsCachedMiss(mUnknownCidCache, containerId);
+}
+
 std::vector<std::string> K8sMetadata::GetByIpsFromServer(std::vector<std::string>& ips, bool& status, bool force) {
     std::vector<std::string> res;
     std::string reqBody = KeysToReqBody(ips);
@@ -462,8 +519,8 @@ std::shared_ptr<K8sPodInfo> K8sMetadata::GetInfoByIpFromCache(const StringView&
     return nullptr;
 }
 
-bool K8sMetadata::IsExternalIp(const StringView& ip) const {
-    return mExternalIpCache.contains(std::string(ip));
+bool K8sMetadata::IsExternalIp(const StringView& ip) {
+    return IsCachedMiss(mExternalIpCache, std::string(ip));
 }
 
 bool K8sMetadata::IsClusterIpForIPv4(uint32_t ip) const {
@@ -488,16 +545,32 @@ void K8sMetadata::AsyncQueryMetadata(PodInfoType type, const StringView& str) {
         return;
     }
     std::string key = std::string(str);
-    std::unique_lock<std::mutex> lock(mStateMux);
-    if (mPendingKeys.find(key) != mPendingKeys.end()) {
-        // already in query queue ...
+    if (type == PodInfoType::ContainerIdInfo && IsUnknownContainerId(key)) {
         return;
     }
-    mPendingKeys.insert(key);
-    if (type == PodInfoType::IpInfo) {
-        mBatchKeys.push_back(key);
-    } else if (type == PodInfoType::ContainerIdInfo) {
-        mBatchCids.push_back(key);
+    bool batchFull = false;
+    {
+        std::unique_lock<std::mutex> lock(mStateMux);
+        if (mPendingKeys.find(key) != mPendingKeys.end()) {
+            // already in query queue ...
+            return;
+        }
+        if (mPendingKeys.size() >= static_cast<size_t>(std::max(0, INT32_FLAG(k8s_metadata_max_pending_keys)))) {
+            // server is lagging behind, drop the key and let a later miss query it again
+            return;
+        }
+        mPendingKeys.insert(key);
+        if (type == PodInfoType::IpInfo) {
+            mBatchKeys.push_back(key);
+            batchFull = mBatchKeys.size() >= static_cast<size_t>(std::max(1, INT32_FLAG(k8s_metadata_max_batch_keys)));
+        } else if (type == PodInfoType::ContainerIdInfo) {
+            mBatchCids.push_back(key);
+            batchFull = mBatchCids.size() >= static_cast<size_t>(std::max(1, INT32_FLAG(k8s_metadata_max_batch_keys)));
+        }
+    }
+    if (batchFull) {
+        // no need to wait for the merge window once a full request can be sent
+        mCv.notify_one();
     }
 }
 
@@ -536,27 +609,35 @@ void K8sMetadata::ProcessBatch() {
                                  std::vector<std::string>& srcItems,
                                  std::vector<std::string>& pendingItems,
                                  std::unordered_set<std::string>& pendingSet) {
-        if (!srcItems.empty()) {
+        // split into requests of bounded size, so that a burst of misses does not turn into one slow query
+        const size_t batchSize = std::max(1, INT32_FLAG(k8s_metadata_max_batch_keys));
+        for (size_t begin = 0; begin < srcItems.size(); begin += batchSize) {
+            auto end = srcItems.begin() + std::min(srcItems.size(), begin + batchSize);
+            std::vector<std::string> items(std::make_move_iterator(srcItems.begin() + begin),
+                                           std::make_move_iterator(end));
             bool status = false;
             if (mIsValid) {
-                processFunc(srcItems, status);
+                processFunc(items, status);
             }
 
             std::unique_lock<std::mutex> lock(mStateMux);
             if (!status) {
-                for (const auto& item : srcItems) {
+                for (auto& item : items) {
                     if (!item.empty()) {
-                        pendingItems.emplace_back(item);
+                        pendingItems.emplace_back(std::move(item));
                     }
                 }
             } else {
-                for (const auto& item : srcItems) {
+                for (const auto& item : items) {
                     pendingSet.erase(item);
                 }
             }
         }
     };
 
+#ifndef APSARA_UNIT_TEST_MAIN
+    auto nextNodeSyncTime = std::chrono::steady_clock::now();
+#endif
     while (mFlag) {
         std::vector<std::string> keysToProcess;
         std::vector<std::string> cidKeysToProcess;
@@ -567,6 +648,22 @@ void K8sMetadata::ProcessBatch() {
             if (!mFlag) {
                 break;
             }
+        }
+
+#ifndef APSARA_UNIT_TEST_MAIN
+        // prefetch the pods of this node at startup and refresh them periodically, so that lookups of local
+        // containers and pod ips rarely have to wait for a query
+        const auto syncInterval = std::chrono::seconds(INT32_FLAG(k8s_metadata_node_sync_interval_sec));
+        if (syncInterval.count() > 0 && mIsValid && std::chrono::steady_clock::now() >= nextNodeSyncTime) {
+            bool status = GetByLocalHostFromServer();
+            nextNodeSyncTime = std::chrono::steady_clock::now()
+                + (status ? syncInterval : std::min<std::chrono::seconds>(syncInterval, std::chrono::seconds(5)));
+            LOG_DEBUG(sLogger, ("sync pods of local host, status", status));
+        }
+#endif
+
+        {
+            std::unique_lock<std::mutex> lock(mStateMux);
             if (!mIsValid || (mBatchKeys.empty() && mBatchCids.empty())) {
                 continue;
             }
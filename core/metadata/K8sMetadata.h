@@ -17,6 +17,7 @@
 #pragma once
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <string>
@@ -28,6 +29,7 @@
 #include "common/Flags.h"
 #include "common/LRUCache.h"
 #include "common/NetworkUtil.h"
+#include "common/ShardedLRUCache.h"
 #include "common/StringView.h"
 #include "common/http/HttpRequest.h"
 #include "monitor/metric_models/MetricRecord.h"
@@ -54,9 +56,13 @@ struct K8sMetadataHttpRequest;
 
 class K8sMetadata {
 private:
-    lru11::Cache<std::string, std::shared_ptr<K8sPodInfo>, std::mutex> mIpCache;
-    lru11::Cache<std::string, std::shared_ptr<K8sPodInfo>, std::mutex> mContainerCache;
-    lru11::Cache<std::string, uint8_t, std::mutex> mExternalIpCache;
+    using MissExpireTime = std::chrono::steady_clock::time_point;
+
+    ShardedLRUCache<std::string, std::shared_ptr<K8sPodInfo>> mIpCache;
+    ShardedLRUCache<std::string, std::shared_ptr<K8sPodInfo>> mContainerCache;
+    // negative caches, keys unknown to the metadata server are not queried again until their entry expires
+    ShardedLRUCache<std::string, MissExpireTime> mExternalIpCache;
+    ShardedLRUCache<std::string, MissExpireTime> mUnknownCidCache;
 
     std::string mServiceHost;
     int32_t mServicePort;
@@ -72,11 +78,11 @@ private:
     void ProcessBatch();
 
     mutable std::mutex mStateMux;
-    std::unordered_set<std::string> mPendingKeys; // 增加上限
+    std::unordered_set<std::string> mPendingKeys; // bounded by k8s_metadata_max_pending_keys
 
     mutable std::condition_variable mCv;
-    std::vector<std::string> mBatchKeys; // 增加上限
-    std::vector<std::string> mBatchCids; // 增加上限
+    std::vector<std::string> mBatchKeys;
+    std::vector<std::string> mBatchCids;
     std::atomic_bool mEnable = false;
     bool mFlag = false;
     std::thread mQueryThread;
@@ -103,6 +109,8 @@ private:
     void SetContainerCache(const std::string& key, const std::shared_ptr<K8sPodInfo>& info);
     void SetExternalIpCache(const std::string&);
     void UpdateExternalIpCache(const std::vector<std::string>& queryIps, const std::vector<std::string>& retIps);
+    void UpdateUnknownCidCache(const std::vector<std::string>& queryCids, const std::vector<std::string>& retCids);
+    bool IsUnknownContainerId(const std::string& containerId);
     bool FromInfoJson(const Json::Value& json, K8sPodInfo& info);
     bool FromContainerJson(const Json::Value& json, std::shared_ptr<ContainerData> data, PodInfoType infoType);
     void HandleMetadataResponse(PodInfoType infoType,
@@ -132,7 +140,8 @@ public:
     std::shared_ptr<K8sPodInfo> GetInfoByContainerIdFromCache(const StringView& containerId);
     // get info by ip from cache
     std::shared_ptr<K8sPodInfo> GetInfoByIpFromCache(const StringView& ip);
-    bool IsExternalIp(const StringView& ip) const;
+    // true if the metadata server recently reported ip as not belonging to any pod
+    bool IsExternalIp(const StringView& ip);
     bool IsClusterIpForIPv4(uint32_t ip) const;
     bool SendRequestToOperator(const std::string& urlHost,
                                const std::string& request,
@@ -34,9 +34,20 @@ void LogEvent::Reset() {
     mAllocatedContentSize = 0;
     mFileOffset = 0;
     mRawSize = 0;
+    mLazyParser = nullptr;
+    mDiscardedByParser = false;
 }
 
 StringView LogEvent::GetContent(StringView key) const {
+    MaterializeFor(key);
+    auto it = mIndex.find(key);
+    if (it != mIndex.end()) {
+        return mContents[it->second].first.second;
+    }
+    return gEmptyStringView;
+}
+
+StringView LogEvent::PeekContent(StringView key) const {
     auto it = mIndex.find(key);
     if (it != mIndex.end()) {
         return mContents[it->second].first.second;
@@ -45,6 +56,7 @@ StringView LogEvent::GetContent(StringView key) const {
 }
 
 bool LogEvent::HasContent(StringView key) const {
+    MaterializeFor(key);
     return mIndex.find(key) != mIndex.end();
 }
 
@@ -65,6 +77,8 @@ void LogEvent::SetContentNoCopy(const StringBuffer& key, const StringBuffer& val
 }
 
 void LogEvent::SetContentNoCopy(StringView key, StringView val) {
+    // always materialize before modification to keep the original order of contents
+    MaterializeAll();
     auto rst = mIndex.insert(make_pair(key, mContents.size()));
     if (!rst.second) {
         auto& it = rst.first;
@@ -78,6 +92,7 @@ void LogEvent::SetContentNoCopy(StringView key, StringView val) {
 }
 
 void LogEvent::DelContent(StringView key) {
+    MaterializeAll();
     auto it = mIndex.find(key);
     if (it != mIndex.end()) {
         auto& field = mContents[it->second].first;
@@ -87,12 +102,73 @@ void LogEvent::DelContent(StringView key) {
     }
 }
 
+void LogEvent::CompactContents() {
+    MaterializeAll();
+    size_t wIdx = 0;
+    for (size_t rIdx = 0; rIdx < mContents.size(); ++rIdx) {
+        if (!mContents[rIdx].second) {
+            continue;
+        }
+        if (wIdx != rIdx) {
+            mContents[wIdx] = mContents[rIdx];
+            auto it = mIndex.find(mContents[wIdx].first.first);
+            // with duplicated keys, only the indexed one should be updated
+            if (it != mIndex.end() && it->second == rIdx) {
+                it->second = wIdx;
+            }
+        }
+        ++wIdx;
+    }
+    mContents.erase(mContents.begin() + wIdx, mContents.end());
+}
+
+void LogEvent::RebuildIndex() {
+    mIndex.clear();
+    for (size_t i = 0; i < mContents.size(); ++i) {
+        mIndex[mContents[i].first.first] = i;
+    }
+}
+
+void LogEvent::MergeRenamedContents(const vector<bool>& renamed) {
+    mIndex.clear();
+    bool merged = false;
+    for (size_t i = 0; i < mContents.size(); ++i) {
+        auto rst = mIndex.insert(make_pair(mContents[i].first.first, i));
+        if (rst.second) {
+            continue;
+        }
+        auto& indexed = rst.first->second;
+        if (!renamed[i] && !renamed[indexed]) {
+            // duplicated keys appended by AppendContentNoCopy are kept
+            indexed = i;
+            continue;
+        }
+        // the content not renamed keeps its position, otherwise the first one does, and the value of the last renamed
+        // one wins
+        size_t kept = renamed[indexed] && !renamed[i] ? i : indexed;
+        size_t dropped = kept == i ? indexed : i;
+        StringView val = renamed[i] ? mContents[i].first.second : mContents[indexed].first.second;
+        auto& keptField = mContents[kept].first;
+        const auto& droppedField = mContents[dropped].first;
+        mAllocatedContentSize -= droppedField.first.size() + droppedField.second.size() + keptField.second.size();
+        mAllocatedContentSize += val.size();
+        keptField.second = val;
+        mContents[dropped].second = false;
+        indexed = kept;
+        merged = true;
+    }
+    if (merged) {
+        CompactContents();
+    }
+}
+
 void LogEvent::SetLevel(const std::string& level) {
     const StringBuffer& b = GetSourceBuffer()->CopyString(level);
     mLevel = StringView(b.data, b.size);
 }
 
 LogEvent::ContentIterator LogEvent::FindContent(StringView key) {
+    MaterializeFor(key);
     auto it = mIndex.find(key);
     if (it != mIndex.end()) {
         return ContentIterator(mContents.begin() + it->second, mContents);
@@ -101,6 +177,7 @@ LogEvent::ContentIterator LogEvent::FindContent(StringView key) {
 }
 
 LogEvent::ConstContentIterator LogEvent::FindContent(StringView key) const {
+    MaterializeFor(key);
     auto it = mIndex.find(key);
     if (it != mIndex.end()) {
         return ConstContentIterator(mContents.begin() + it->second, mContents);
@@ -109,6 +186,7 @@ LogEvent::ConstContentIterator LogEvent::FindContent(StringView key) const {
 }
 
 LogEvent::ContentIterator LogEvent::begin() {
+    MaterializeAll();
     auto it = mContents.begin();
     while (it != mContents.end() && !it->second) {
         ++it;
@@ -130,6 +208,7 @@ LogEvent::ConstContentIterator LogEvent::end() const {
 }
 
 LogEvent::ConstContentIterator LogEvent::cbegin() const {
+    MaterializeAll();
     auto it = mContents.cbegin();
     while (it != mContents.cend() && !it->second) {
         ++it;
@@ -142,15 +221,35 @@ LogEvent::ConstContentIterator LogEvent::cend() const {
 }
 
 void LogEvent::AppendContentNoCopy(StringView key, StringView val) {
+    MaterializeAll();
     mAllocatedContentSize += key.size() + val.size();
     mContents.emplace_back(make_pair(key, val), true);
     mIndex[key] = mContents.size() - 1;
 }
 
 size_t LogEvent::DataSize() const {
+    // a pending parse is not run here, since the pipeline measures every event around each processor. The unparsed
+    // source, which the parsed contents are carved out of, stands in as the estimate.
     return PipelineEvent::DataSize() + sizeof(decltype(mContents)) + mAllocatedContentSize;
 }
 
+void LogEvent::SetLazyParser(LazyLogParser* parser) {
+    Materialize();
+    mLazyParser = parser;
+}
+
+void LogEvent::Materialize() {
+    if (!mLazyParser) {
+        return;
+    }
+    // reset first, since the parser accesses the contents of this event
+    LazyLogParser* parser = mLazyParser;
+    mLazyParser = nullptr;
+    if (!parser->ParseLazily(*this)) {
+        mDiscardedByParser = true;
+    }
+}
+
 #ifdef APSARA_UNIT_TEST_MAIN
 Json::Value LogEvent::ToJson(bool enableEventMeta) const {
     Json::Value root;
@@ -61,6 +61,22 @@ private:
     const ContentsContainer& container;
 };
 
+class LogEvent;
+
+// Parser whose work on a log event can be deferred until the contents of the event are actually accessed, so that
+// events dropped before that point, e.g., by a filter on some other key, are never parsed.
+class LazyLogParser {
+public:
+    virtual ~LazyLogParser() = default;
+
+    // Returns false if the event should be discarded after parsing. The event may have been moved to another group
+    // since the parse was deferred, so only the event itself and its current source buffer can be used.
+    virtual bool ParseLazily(LogEvent& e) = 0;
+    // Returns true if parsing may add, modify or delete the content with the key. Contents of e must be read with
+    // PeekContent.
+    virtual bool MayTouch(const LogEvent& e, StringView key) const = 0;
+};
+
 class LogEvent : public PipelineEvent {
     friend class PipelineEventGroup;
     friend class EventPool;
@@ -82,6 +98,15 @@ public:
     void SetContentNoCopy(const StringBuffer& key, const StringBuffer& val);
     void SetContentNoCopy(StringView key, StringView val);
     void DelContent(StringView key);
+    // drop the tombstones left by DelContent, so that iterators and serializers walk a dense array afterwards
+    void CompactContents();
+    // Rewrite all contents in a single pass, which is much cheaper than a series of SetContent/DelContent calls. op is
+    // called on each valid content, may modify it in place, and returns false if the content should be dropped.
+    // Contents are compacted afterwards. Like SetContent, renaming a content to an existing key overwrites the value of
+    // the existing content, which keeps its position, and the renamed content is dropped. When several contents are
+    // renamed to the same new key, the last one wins.
+    template <typename F>
+    void RewriteContents(F&& op);
 
     void SetPosition(uint64_t offset, uint64_t size) {
         mFileOffset = offset;
@@ -92,8 +117,14 @@ public:
     StringView GetLevel() const { return mLevel; }
     void SetLevel(const std::string& level);
 
-    bool Empty() const { return mIndex.empty(); }
-    size_t Size() const { return mIndex.size(); }
+    bool Empty() const {
+        MaterializeAll();
+        return mIndex.empty();
+    }
+    size_t Size() const {
+        MaterializeAll();
+        return mIndex.size();
+    }
 
     ContentIterator begin();
     ContentIterator end();
@@ -102,8 +133,20 @@ public:
     ConstContentIterator cbegin() const;
     ConstContentIterator cend() const;
 
+    // estimated from the unparsed contents if a parse is pending
     size_t DataSize() const override;
 
+    // The parser must outlive the event, or the event must be materialized before the parser is destroyed. Any pending
+    // parse is materialized before a new one is set.
+    void SetLazyParser(LazyLogParser* parser);
+    bool HasPendingParse() const { return mLazyParser != nullptr; }
+    // get the content as is, without running the pending parse
+    StringView PeekContent(StringView key) const;
+    // Run the pending parse, if any. Accessors do this automatically, so it is only needed when the parse result
+    // should be checked via IsDiscardedByParser.
+    void Materialize();
+    bool IsDiscardedByParser() const { return mDiscardedByParser; }
+
 #ifdef APSARA_UNIT_TEST_MAIN
     Json::Value ToJson(bool enableEventMeta = false) const override;
     bool FromJson(const Json::Value&) override;
@@ -116,6 +159,20 @@ private:
     // We do not invalidate existing LogContent when the same key has arrived.
     friend class ProcessorParseApsaraNative;
     void AppendContentNoCopy(StringView key, StringView val);
+    void RebuildIndex();
+    // rebuild the index after RewriteContents, merging the renamed contents into those with the same key
+    void MergeRenamedContents(const std::vector<bool>& renamed);
+    // end() and cend() never materialize, so that iterators returned by FindContent stay comparable with them.
+    void MaterializeFor(StringView key) const {
+        if (mLazyParser && mLazyParser->MayTouch(*this, key)) {
+            const_cast<LogEvent*>(this)->Materialize();
+        }
+    }
+    void MaterializeAll() const {
+        if (mLazyParser) {
+            const_cast<LogEvent*>(this)->Materialize();
+        }
+    }
 
     // since log reduce in SLS server requires the original order of log contents, we have to maintain this sequential
     // information for backward compatability.
@@ -125,6 +182,53 @@ private:
     uint64_t mFileOffset = 0;
     uint64_t mRawSize = 0;
     StringView mLevel;
+    LazyLogParser* mLazyParser = nullptr;
+    bool mDiscardedByParser = false;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class LogEventUnittest;
+#endif
 };
 
+template <typename F>
+void LogEvent::RewriteContents(F&& op) {
+    MaterializeAll();
+    bool indexExpired = false;
+    // only allocated when some key is changed
+    std::vector<bool> renamed;
+    size_t wIdx = 0;
+    for (size_t rIdx = 0; rIdx < mContents.size(); ++rIdx) {
+        auto& item = mContents[rIdx];
+        if (!item.second) {
+            continue;
+        }
+        const LogContent origin = item.first;
+        if (!op(item.first)) {
+            mAllocatedContentSize -= origin.first.size() + origin.second.size();
+            indexExpired = true;
+            continue;
+        }
+        mAllocatedContentSize += item.first.first.size() + item.first.second.size() - origin.first.size()
+            - origin.second.size();
+        if (item.first.first.data() != origin.first.data() || item.first.first.size() != origin.first.size()) {
+            indexExpired = true;
+            if (renamed.empty()) {
+                renamed.resize(mContents.size());
+            }
+            renamed[wIdx] = true;
+        }
+        if (wIdx != rIdx) {
+            mContents[wIdx] = item;
+            indexExpired = true;
+        }
+        ++wIdx;
+    }
+    mContents.erase(mContents.begin() + wIdx, mContents.end());
+    if (!renamed.empty()) {
+        MergeRenamedContents(renamed);
+    } else if (indexExpired) {
+        RebuildIndex();
+    }
+}
+
 } // namespace logtail
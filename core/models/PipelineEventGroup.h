@@ -59,6 +59,7 @@ enum class EventGroupMetaKey {
     PROMETHEUS_UP_STATE,
     PROMETHEUS_STREAM_ID,
     PROMETHEUS_STREAM_TOTAL,
+    PROMETHEUS_SERIES_RELABELED,
 
     INTERNAL_DATA_TARGET_REGION,
     INTERNAL_DATA_TYPE,
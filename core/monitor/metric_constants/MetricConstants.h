@@ -106,8 +106,12 @@ extern const std::string METRIC_LABEL_KEY_INSTANCE;
 extern const std::string METRIC_PLUGIN_PROM_SUBSCRIBE_TARGETS;
 extern const std::string METRIC_PLUGIN_PROM_SUBSCRIBE_TOTAL;
 extern const std::string METRIC_PLUGIN_PROM_SUBSCRIBE_TIME_MS;
+extern const std::string METRIC_PLUGIN_PROM_SUBSCRIBE_UNCHANGED_TOTAL;
+extern const std::string METRIC_PLUGIN_PROM_SUBSCRIBE_UPDATE_TIME_MS;
+extern const std::string METRIC_PLUGIN_PROM_SUBSCRIBE_RELABELED_TARGETS;
 extern const std::string METRIC_PLUGIN_PROM_SCRAPE_TIME_MS;
 extern const std::string METRIC_PLUGIN_PROM_SCRAPE_DELAY_TOTAL;
+extern const std::string METRIC_PLUGIN_PROM_SCRAPE_LAG_MS;
 
 /**********************************************************
  *   input_ebpf
@@ -168,6 +172,14 @@ extern const std::string METRIC_PLUGIN_OUT_FAILED_EVENTS_TOTAL;
 extern const std::string METRIC_PLUGIN_OUT_KEY_NOT_FOUND_EVENTS_TOTAL;
 extern const std::string METRIC_PLUGIN_OUT_SUCCESSFUL_EVENTS_TOTAL;
 
+/**********************************************************
+ *   processor_parse_regex_native
+ *   processor_parse_json_native
+ **********************************************************/
+// events that were not parsed before being dropped equal to lazy_events_total - materialized_events_total
+extern const std::string METRIC_PLUGIN_LAZY_EVENTS_TOTAL;
+extern const std::string METRIC_PLUGIN_MATERIALIZED_EVENTS_TOTAL;
+
 /**********************************************************
  *   all flusher （所有发送插件通用指标）
  **********************************************************/
@@ -207,6 +219,28 @@ extern const std::string METRIC_PLUGIN_UNMATCHED_EVENTS_TOTAL;
 extern const std::string METRIC_PLUGIN_PARSE_STDERR_TOTAL;
 extern const std::string METRIC_PLUGIN_PARSE_STDOUT_TOTAL;
 
+/**********************************************************
+ *   processor_project_fields_native
+ **********************************************************/
+extern const std::string METRIC_PLUGIN_DROPPED_FIELDS_TOTAL;
+extern const std::string METRIC_PLUGIN_RENAMED_FIELDS_TOTAL;
+
+/**********************************************************
+ *   processor_prom_parse_metric_native
+ **********************************************************/
+extern const std::string METRIC_PLUGIN_PROM_SERIES_CACHE_HITS_TOTAL;
+extern const std::string METRIC_PLUGIN_PROM_SERIES_CACHE_MISSES_TOTAL;
+
+/**********************************************************
+ *   processor_aggregate_metric_native
+ **********************************************************/
+extern const std::string METRIC_PLUGIN_AGGREGATED_EVENTS_TOTAL;
+// events passed through because their window has been flushed or is too far ahead
+extern const std::string METRIC_PLUGIN_LATE_EVENTS_TOTAL;
+// events passed through because the window has reached MaxSeries
+extern const std::string METRIC_PLUGIN_OVERFLOW_EVENTS_TOTAL;
+extern const std::string METRIC_PLUGIN_AGGREGATE_SERIES_NUM;
+
 /**********************************************************
  *   flusher_sls
  **********************************************************/
@@ -301,6 +335,8 @@ extern const std::string& METRIC_RUNNER_TOTAL_DELAY_MS;
 extern const std::string METRIC_RUNNER_CLIENT_REGISTER_STATE;
 extern const std::string METRIC_RUNNER_CLIENT_REGISTER_RETRY_TOTAL;
 extern const std::string METRIC_RUNNER_JOBS_TOTAL;
+extern const std::string METRIC_RUNNER_INFLIGHT_SCRAPES_TOTAL;
+extern const std::string METRIC_RUNNER_QUEUED_SCRAPES_TOTAL;
 
 /**********************************************************
  *   all sinks
@@ -58,8 +58,12 @@ const std::string METRIC_LABEL_KEY_INSTANCE = "instance";
 const std::string METRIC_PLUGIN_PROM_SUBSCRIBE_TARGETS = "prom_subscribe_targets";
 const std::string METRIC_PLUGIN_PROM_SUBSCRIBE_TOTAL = "prom_subscribe_total";
 const std::string METRIC_PLUGIN_PROM_SUBSCRIBE_TIME_MS = "prom_subscribe_time_ms";
+const std::string METRIC_PLUGIN_PROM_SUBSCRIBE_UNCHANGED_TOTAL = "prom_subscribe_unchanged_total";
+const std::string METRIC_PLUGIN_PROM_SUBSCRIBE_UPDATE_TIME_MS = "prom_subscribe_update_time_ms";
+const std::string METRIC_PLUGIN_PROM_SUBSCRIBE_RELABELED_TARGETS = "prom_subscribe_relabeled_targets";
 const std::string METRIC_PLUGIN_PROM_SCRAPE_TIME_MS = "prom_scrape_time_ms";
 const std::string METRIC_PLUGIN_PROM_SCRAPE_DELAY_TOTAL = "prom_scrape_delay_total";
+const std::string METRIC_PLUGIN_PROM_SCRAPE_LAG_MS = "prom_scrape_lag_ms";
 
 /**********************************************************
  *   input_ebpf
@@ -120,6 +124,13 @@ const string METRIC_PLUGIN_OUT_FAILED_EVENTS_TOTAL = "out_failed_events_total";
 const string METRIC_PLUGIN_OUT_KEY_NOT_FOUND_EVENTS_TOTAL = "out_key_not_found_events_total";
 const string METRIC_PLUGIN_OUT_SUCCESSFUL_EVENTS_TOTAL = "out_successful_events_total";
 
+/**********************************************************
+ *   processor_parse_regex_native
+ *   processor_parse_json_native
+ **********************************************************/
+const string METRIC_PLUGIN_LAZY_EVENTS_TOTAL = "lazy_events_total";
+const string METRIC_PLUGIN_MATERIALIZED_EVENTS_TOTAL = "materialized_events_total";
+
 /**********************************************************
  *   processor_parse_apsara_native
  *   processor_parse_timestamp_native
@@ -145,6 +156,26 @@ const string METRIC_PLUGIN_UNMATCHED_EVENTS_TOTAL = "unmatched_events_total";
 const string METRIC_PLUGIN_PARSE_STDERR_TOTAL = "parse_stderr_total";
 const string METRIC_PLUGIN_PARSE_STDOUT_TOTAL = "parse_stdout_total";
 
+/**********************************************************
+ *   processor_project_fields_native
+ **********************************************************/
+const string METRIC_PLUGIN_DROPPED_FIELDS_TOTAL = "dropped_fields_total";
+const string METRIC_PLUGIN_RENAMED_FIELDS_TOTAL = "renamed_fields_total";
+
+/**********************************************************
+ *   processor_prom_parse_metric_native
+ **********************************************************/
+const string METRIC_PLUGIN_PROM_SERIES_CACHE_HITS_TOTAL = "series_cache_hits_total";
+const string METRIC_PLUGIN_PROM_SERIES_CACHE_MISSES_TOTAL = "series_cache_misses_total";
+
+/**********************************************************
+ *   processor_aggregate_metric_native
+ **********************************************************/
+const string METRIC_PLUGIN_AGGREGATED_EVENTS_TOTAL = "aggregated_events_total";
+const string METRIC_PLUGIN_LATE_EVENTS_TOTAL = "late_events_total";
+const string METRIC_PLUGIN_OVERFLOW_EVENTS_TOTAL = "overflow_events_total";
+const string METRIC_PLUGIN_AGGREGATE_SERIES_NUM = "aggregate_series_num";
+
 
 /**********************************************************
  *   all flusher （所有发送插件通用指标）
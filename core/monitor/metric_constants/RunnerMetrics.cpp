@@ -43,6 +43,8 @@ const string& METRIC_RUNNER_TOTAL_DELAY_MS = METRIC_TOTAL_DELAY_MS;
 const string METRIC_RUNNER_CLIENT_REGISTER_STATE = "client_register_state";
 const string METRIC_RUNNER_CLIENT_REGISTER_RETRY_TOTAL = "client_register_retry_total";
 const string METRIC_RUNNER_JOBS_TOTAL = "jobs_total";
+const string METRIC_RUNNER_INFLIGHT_SCRAPES_TOTAL = "inflight_scrapes_total";
+const string METRIC_RUNNER_QUEUED_SCRAPES_TOTAL = "queued_scrapes_total";
 
 /**********************************************************
  *   all sinks
@@ -25,6 +25,11 @@
 #include "plugin/processor/inner/ProcessorMergeMultilineLogNative.h"
 #include "plugin/processor/inner/ProcessorParseContainerLogNative.h"
 #include "plugin/processor/inner/ProcessorSplitLogStringNative.h"
+#include "plugin/processor/inner/ProcessorSplitParseContainerLogNative.h"
+
+DEFINE_FLAG_BOOL(enable_container_stdio_fused_parsing,
+                 "split, parse and merge partial container logs in a single pass over the read buffer",
+                 false);
 
 using namespace std;
 
@@ -298,21 +303,10 @@ bool InputContainerStdio::Stop(bool isPipelineRemoving) {
 
 bool InputContainerStdio::CreateInnerProcessors() {
     unique_ptr<ProcessorInstance> processor;
-    // ProcessorSplitLogStringNative
-    {
+    if (BOOL_FLAG(enable_container_stdio_fused_parsing)) {
+        // ProcessorSplitParseContainerLogNative
         Json::Value detail;
-        processor = PluginRegistry::GetInstance()->CreateProcessor(ProcessorSplitLogStringNative::sName,
-                                                                   mContext->GetPipeline().GenNextPluginMeta(false));
-        detail["SplitChar"] = Json::Value('\n');
-        if (!processor->Init(detail, *mContext)) {
-            return false;
-        }
-        mInnerProcessors.emplace_back(std::move(processor));
-    }
-    // ProcessorParseContainerLogNative
-    {
-        Json::Value detail;
-        processor = PluginRegistry::GetInstance()->CreateProcessor(ProcessorParseContainerLogNative::sName,
+        processor = PluginRegistry::GetInstance()->CreateProcessor(ProcessorSplitParseContainerLogNative::sName,
                                                                    mContext->GetPipeline().GenNextPluginMeta(false));
         detail["IgnoringStdout"] = Json::Value(mIgnoringStdout);
         detail["IgnoringStderr"] = Json::Value(mIgnoringStderr);
@@ -322,17 +316,8 @@ bool InputContainerStdio::CreateInnerProcessors() {
             return false;
         }
         mInnerProcessors.emplace_back(std::move(processor));
-    }
-    // ProcessorMergeMultilineLogNative
-    {
-        Json::Value detail;
-        processor = PluginRegistry::GetInstance()->CreateProcessor(ProcessorMergeMultilineLogNative::sName,
-                                                                   mContext->GetPipeline().GenNextPluginMeta(false));
-        detail["MergeType"] = Json::Value("flag");
-        if (!processor->Init(detail, *mContext)) {
-            return false;
-        }
-        mInnerProcessors.emplace_back(std::move(processor));
+    } else if (!CreateSplitParseMergeProcessors()) {
+        return false;
     }
     if (mMultiline.IsMultiline()) {
         Json::Value detail;
@@ -365,4 +350,45 @@ bool InputContainerStdio::CreateInnerProcessors() {
     return true;
 }
 
+bool InputContainerStdio::CreateSplitParseMergeProcessors() {
+    unique_ptr<ProcessorInstance> processor;
+    // ProcessorSplitLogStringNative
+    {
+        Json::Value detail;
+        processor = PluginRegistry::GetInstance()->CreateProcessor(ProcessorSplitLogStringNative::sName,
+                                                                   mContext->GetPipeline().GenNextPluginMeta(false));
+        detail["SplitChar"] = Json::Value('\n');
+        if (!processor->Init(detail, *mContext)) {
+            return false;
+        }
+        mInnerProcessors.emplace_back(std::move(processor));
+    }
+    // ProcessorParseContainerLogNative
+    {
+        Json::Value detail;
+        processor = PluginRegistry::GetInstance()->CreateProcessor(ProcessorParseContainerLogNative::sName,
+                                                                   mContext->GetPipeline().GenNextPluginMeta(false));
+        detail["IgnoringStdout"] = Json::Value(mIgnoringStdout);
+        detail["IgnoringStderr"] = Json::Value(mIgnoringStderr);
+        detail["KeepingSourceWhenParseFail"] = Json::Value(mKeepingSourceWhenParseFail);
+        detail["IgnoreParseWarning"] = Json::Value(mIgnoreParseWarning);
+        if (!processor->Init(detail, *mContext)) {
+            return false;
+        }
+        mInnerProcessors.emplace_back(std::move(processor));
+    }
+    // ProcessorMergeMultilineLogNative
+    {
+        Json::Value detail;
+        processor = PluginRegistry::GetInstance()->CreateProcessor(ProcessorMergeMultilineLogNative::sName,
+                                                                   mContext->GetPipeline().GenNextPluginMeta(false));
+        detail["MergeType"] = Json::Value("flag");
+        if (!processor->Init(detail, *mContext)) {
+            return false;
+        }
+        mInnerProcessors.emplace_back(std::move(processor));
+    }
+    return true;
+}
+
 } // namespace logtail
@@ -59,6 +59,7 @@ private:
     IntGaugePtr mMonitorFileTotal;
 
     bool CreateInnerProcessors();
+    bool CreateSplitParseMergeProcessors();
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class InputContainerStdioUnittest;
@@ -16,10 +16,15 @@
 
 #include "plugin/processor/CommonParserOptions.h"
 
+#include "common/Flags.h"
 #include "common/ParamExtractor.h"
 #include "constants/Constants.h"
 #include "plugin/processor/inner/ProcessorParseContainerLogNative.h"
 
+DEFINE_FLAG_BOOL(enable_lazy_log_parsing,
+                 "defer parsing of parse_regex and parse_json processors until the contents of events are accessed",
+                 false);
+
 using namespace std;
 
 namespace logtail {
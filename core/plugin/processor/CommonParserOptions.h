@@ -37,6 +37,11 @@ struct CommonParserOptions {
     bool ShouldAddSourceContent(bool parseSuccess);
     bool ShouldAddLegacyUnmatchedRawLog(bool parseSuccess);
     bool ShouldEraseEvent(bool parseSuccess, const LogEvent& sourceEvent, const GroupMetadata& metadata);
+    // Returns true if ShouldEraseEvent does not depend on the metadata, so that the parse can be deferred until the
+    // event may no longer belong to the group.
+    bool CanEraseWithoutMetadata(const GroupMetadata& metadata) const {
+        return mKeepingSourceWhenParseFail || metadata.find(EventGroupMetaKey::LOG_FILE_OFFSET_KEY) == metadata.end();
+    }
 };
 
 } // namespace logtail
@@ -0,0 +1,547 @@
+/*
+ * Copyright 2025 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "plugin/processor/ProcessorAggregateMetricNative.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "xxhash/xxhash.h"
+
+#include "collection_pipeline/batch/TimeoutFlushManager.h"
+#include "common/ParamExtractor.h"
+#include "logger/Logger.h"
+#include "monitor/metric_constants/MetricConstants.h"
+
+using namespace std;
+
+namespace logtail {
+
+const string ProcessorAggregateMetricNative::sName = "processor_aggregate_metric_native";
+
+namespace {
+
+const size_t kInitialBucketCnt = 64;
+const size_t kMaxFreeTables = 2;
+
+bool ParseMethod(const string& str, AggregateMethod& method) {
+    static const unordered_map<string, AggregateMethod> sMethods = {{"sum", AggregateMethod::SUM},
+                                                                     {"count", AggregateMethod::COUNT},
+                                                                     {"min", AggregateMethod::MIN},
+                                                                     {"max", AggregateMethod::MAX},
+                                                                     {"last", AggregateMethod::LAST},
+                                                                     {"avg", AggregateMethod::AVG},
+                                                                     {"merge", AggregateMethod::MERGE}};
+    auto it = sMethods.find(str);
+    if (it == sMethods.end()) {
+        return false;
+    }
+    method = it->second;
+    return true;
+}
+
+bool EndsWith(StringView s, StringView suffix) {
+    return s.size() >= suffix.size() && s.substr(s.size() - suffix.size()) == suffix;
+}
+
+void AppendField(string& key, StringView field) {
+    uint32_t len = field.size();
+    key.append(reinterpret_cast<const char*>(&len), sizeof(len));
+    key.append(field.data(), field.size());
+}
+
+StringView ReadField(StringView key, size_t& pos) {
+    uint32_t len = 0;
+    memcpy(&len, key.data() + pos, sizeof(len));
+    pos += sizeof(len);
+    StringView field = key.substr(pos, len);
+    pos += len;
+    return field;
+}
+
+} // namespace
+
+void AggregateValue::Add(double value, time_t timestamp, AggregateMethod method, uint64_t seriesHash) {
+    if (mCount == 0) {
+        mMin = mMax = value;
+    } else {
+        mMin = min(mMin, value);
+        mMax = max(mMax, value);
+    }
+    mSum += value;
+    ++mCount;
+    if (mCount == 1 || timestamp >= mLastTime) {
+        mLast = value;
+        mLastTime = timestamp;
+    }
+    if (method == AggregateMethod::MERGE) {
+        if (!mSeries) {
+            mSeries = make_unique<unordered_map<uint64_t, double>>();
+        }
+        (*mSeries)[seriesHash] = value;
+    }
+}
+
+double AggregateValue::Result(AggregateMethod method) const {
+    switch (method) {
+        case AggregateMethod::SUM:
+            return mSum;
+        case AggregateMethod::COUNT:
+            return static_cast<double>(mCount);
+        case AggregateMethod::MIN:
+            return mMin;
+        case AggregateMethod::MAX:
+            return mMax;
+        case AggregateMethod::AVG:
+            return mCount == 0 ? 0.0 : mSum / mCount;
+        case AggregateMethod::MERGE: {
+            if (!mSeries) {
+                return mLast;
+            }
+            double res = 0.0;
+            for (const auto& item : *mSeries) {
+                res += item.second;
+            }
+            return res;
+        }
+        default:
+            return mLast;
+    }
+}
+
+void AggregateTable::Init(size_t maxEntries) {
+    mMaxEntries = maxEntries;
+    Rehash(kInitialBucketCnt);
+}
+
+AggregateTable::Entry* AggregateTable::FindOrInsert(uint64_t hash, const string& key, uint32_t tagSet, bool& inserted) {
+    inserted = false;
+    size_t bucket = hash & (mBuckets.size() - 1);
+    for (uint32_t idx = mBuckets[bucket]; idx != 0; idx = mEntries[idx - 1].mNext) {
+        auto& entry = mEntries[idx - 1];
+        if (entry.mHash == hash && entry.mKeyLen == key.size()
+            && memcmp(mArena.data() + entry.mKeyOffset, key.data(), key.size()) == 0) {
+            return &entry;
+        }
+    }
+    if (mEntries.size() >= mMaxEntries) {
+        return nullptr;
+    }
+    if (mEntries.size() >= mBuckets.size()) {
+        Rehash(mBuckets.size() * 2);
+        bucket = hash & (mBuckets.size() - 1);
+    }
+    mEntries.emplace_back();
+    auto& entry = mEntries.back();
+    entry.mHash = hash;
+    entry.mKeyOffset = mArena.size();
+    entry.mKeyLen = key.size();
+    entry.mTagSet = tagSet;
+    entry.mNext = mBuckets[bucket];
+    mBuckets[bucket] = mEntries.size();
+    mArena.append(key);
+    inserted = true;
+    return &entry;
+}
+
+bool AggregateTable::FindTagSet(uint64_t hash, uint32_t& index) const {
+    auto it = mTagSetIndex.find(hash);
+    if (it == mTagSetIndex.end()) {
+        return false;
+    }
+    index = it->second;
+    return true;
+}
+
+uint32_t AggregateTable::AddTagSet(uint64_t hash, vector<pair<string, string>>&& tags) {
+    uint32_t index = mTagSets.size();
+    mTagSets.emplace_back(std::move(tags));
+    mTagSetIndex.emplace(hash, index);
+    return index;
+}
+
+void AggregateTable::Clear() {
+    fill(mBuckets.begin(), mBuckets.end(), 0);
+    mEntries.clear();
+    mArena.clear();
+    mTagSets.clear();
+    mTagSetIndex.clear();
+}
+
+void AggregateTable::Rehash(size_t bucketCnt) {
+    mBuckets.assign(bucketCnt, 0);
+    for (size_t i = 0; i < mEntries.size(); ++i) {
+        size_t bucket = mEntries[i].mHash & (bucketCnt - 1);
+        mEntries[i].mNext = mBuckets[bucket];
+        mBuckets[bucket] = i + 1;
+    }
+}
+
+bool ProcessorAggregateMetricNative::Init(const Json::Value& config) {
+    string errorMsg;
+
+    // Interval
+    if (!GetOptionalUIntParam(config, "Interval", mIntervalSecs, errorMsg)) {
+        PARAM_WARNING_DEFAULT(mContext->GetLogger(),
+                              mContext->GetAlarm(),
+                              errorMsg,
+                              mIntervalSecs,
+                              sName,
+                              mContext->GetConfigName(),
+                              mContext->GetProjectName(),
+                              mContext->GetLogstoreName(),
+                              mContext->GetRegion());
+    } else if (mIntervalSecs == 0) {
+        mIntervalSecs = 60;
+        PARAM_WARNING_DEFAULT(mContext->GetLogger(),
+                              mContext->GetAlarm(),
+                              "uint param Interval is 0",
+                              mIntervalSecs,
+                              sName,
+                              mContext->GetConfigName(),
+                              mContext->GetProjectName(),
+                              mContext->GetLogstoreName(),
+                              mContext->GetRegion());
+    }
+
+    // GroupByTags
+    if (!GetOptionalListParam(config, "GroupByTags", mGroupByTags, errorMsg)) {
+        PARAM_ERROR_RETURN(mContext->GetLogger(),
+                           mContext->GetAlarm(),
+                           errorMsg,
+                           sName,
+                           mContext->GetConfigName(),
+                           mContext->GetProjectName(),
+                           mContext->GetLogstoreName(),
+                           mContext->GetRegion());
+    }
+
+    // Method
+    string method;
+    if (!GetOptionalStringParam(config, "Method", method, errorMsg)) {
+        PARAM_WARNING_DEFAULT(mContext->GetLogger(),
+                              mContext->GetAlarm(),
+                              errorMsg,
+                              "last",
+                              sName,
+                              mContext->GetConfigName(),
+                              mContext->GetProjectName(),
+                              mContext->GetLogstoreName(),
+                              mContext->GetRegion());
+    } else if (!method.empty() && !ParseMethod(method, mDefaultMethod)) {
+        PARAM_ERROR_RETURN(mContext->GetLogger(),
+                           mContext->GetAlarm(),
+                           "string param Method is not valid",
+                           sName,
+                           mContext->GetConfigName(),
+                           mContext->GetProjectName(),
+                           mContext->GetLogstoreName(),
+                           mContext->GetRegion());
+    }
+
+    // Methods
+    unordered_map<string, string> methods;
+    if (!GetOptionalMapParam(config, "Methods", methods, errorMsg)) {
+        PARAM_ERROR_RETURN(mContext->GetLogger(),
+                           mContext->GetAlarm(),
+                           errorMsg,
+                           sName,
+                           mContext->GetConfigName(),
+                           mContext->GetProjectName(),
+                           mContext->GetLogstoreName(),
+                           mContext->GetRegion());
+    }
+    for (const auto& item : methods) {
+        AggregateMethod m = AggregateMethod::LAST;
+        if (!ParseMethod(item.second, m)) {
+            PARAM_ERROR_RETURN(mContext->GetLogger(),
+                               mContext->GetAlarm(),
+                               "value in map param Methods is not valid",
+                               sName,
+                               mContext->GetConfigName(),
+                               mContext->GetProjectName(),
+                               mContext->GetLogstoreName(),
+                               mContext->GetRegion());
+        }
+        mMethods[item.first] = m;
+    }
+
+    // HistogramMerge
+    if (!GetOptionalBoolParam(config, "HistogramMerge", mHistogramMerge, errorMsg)) {
+        PARAM_WARNING_DEFAULT(mContext->GetLogger(),
+                              mContext->GetAlarm(),
+                              errorMsg,
+                              mHistogramMerge,
+                              sName,
+                              mContext->GetConfigName(),
+                              mContext->GetProjectName(),
+                              mContext->GetLogstoreName(),
+                              mContext->GetRegion());
+    }
+
+    // MaxSeries
+    if (!GetOptionalUIntParam(config, "MaxSeries", mMaxSeries, errorMsg)) {
+        PARAM_WARNING_DEFAULT(mContext->GetLogger(),
+                              mContext->GetAlarm(),
+                              errorMsg,
+                              mMaxSeries,
+                              sName,
+                              mContext->GetConfigName(),
+                              mContext->GetProjectName(),
+                              mContext->GetLogstoreName(),
+                              mContext->GetRegion());
+    }
+
+    mAggregatedEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_AGGREGATED_EVENTS_TOTAL);
+    mLateEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_LATE_EVENTS_TOTAL);
+    mOverflowEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_OVERFLOW_EVENTS_TOTAL);
+    mSeriesNum = GetMetricsRecordRef().CreateIntGauge(METRIC_PLUGIN_AGGREGATE_SERIES_NUM);
+
+    return true;
+}
+
+void ProcessorAggregateMetricNative::Process(vector<PipelineEventGroup>& logGroupList) {
+    lock_guard<mutex> lock(mMux);
+    mNow = time(nullptr);
+    for (auto& logGroup : logGroupList) {
+        Process(logGroup);
+    }
+    FlushWindows(mNow, logGroupList, false);
+}
+
+void ProcessorAggregateMetricNative::Flush(vector<PipelineEventGroup>& logGroupList, bool force) {
+    lock_guard<mutex> lock(mMux);
+    mNow = time(nullptr);
+    FlushWindows(mNow, logGroupList, force);
+}
+
+void ProcessorAggregateMetricNative::Process(PipelineEventGroup& logGroup) {
+    auto& events = logGroup.MutableEvents();
+    if (events.empty()) {
+        return;
+    }
+    uint64_t tagSetHash = 0;
+    for (const auto& tag : logGroup.GetTags()) {
+        tagSetHash = XXH64(tag.first.data(), tag.first.size(), tagSetHash);
+        tagSetHash = XXH64(tag.second.data(), tag.second.size(), tagSetHash);
+    }
+
+    size_t wIdx = 0;
+    for (size_t rIdx = 0; rIdx < events.size(); ++rIdx) {
+        if (IsSupportedEvent(events[rIdx]) && Aggregate(events[rIdx].Cast<MetricEvent>(), logGroup, tagSetHash)) {
+            continue;
+        }
+        if (wIdx != rIdx) {
+            events[wIdx] = std::move(events[rIdx]);
+        }
+        ++wIdx;
+    }
+    events.erase(events.begin() + wIdx, events.end());
+}
+
+bool ProcessorAggregateMetricNative::IsSupportedEvent(const PipelineEventPtr& e) const {
+    return e.Is<MetricEvent>();
+}
+
+bool ProcessorAggregateMetricNative::Aggregate(MetricEvent& e, const PipelineEventGroup& group, uint64_t tagSetHash) {
+    bool isMulti = e.Is<UntypedMultiDoubleValues>();
+    if (!isMulti && !e.Is<UntypedSingleValue>()) {
+        return false;
+    }
+    time_t timestamp = e.GetTimestamp();
+    time_t windowStart = timestamp - timestamp % mIntervalSecs;
+    if (windowStart + static_cast<time_t>(mIntervalSecs) <= mFlushedUntil
+        || windowStart > mNow + static_cast<time_t>(mIntervalSecs)) {
+        ADD_COUNTER(mLateEventsTotal, 1);
+        return false;
+    }
+
+    StringView name = e.GetName();
+    AggregateMethod method = GetMethod(name);
+    bool keepHistogramTags = mHistogramMerge && !mGroupByTags.empty();
+    mKeyTags.clear();
+    for (auto it = e.TagsBegin(); it != e.TagsEnd(); ++it) {
+        if (mGroupByTags.empty() || find(mGroupByTags.begin(), mGroupByTags.end(), it->first) != mGroupByTags.end()
+            || (keepHistogramTags && (it->first == "le" || it->first == "quantile"))) {
+            mKeyTags.emplace_back(it->first, it->second);
+        }
+    }
+    sort(mKeyTags.begin(), mKeyTags.end());
+
+    mKeyBuffer.clear();
+    mKeyBuffer.append(reinterpret_cast<const char*>(&tagSetHash), sizeof(tagSetHash));
+    AppendField(mKeyBuffer, name);
+    for (const auto& tag : mKeyTags) {
+        AppendField(mKeyBuffer, tag.first);
+        AppendField(mKeyBuffer, tag.second);
+    }
+    uint64_t hash = XXH64(mKeyBuffer.data(), mKeyBuffer.size(), 0);
+
+    // source series merged into the same key are told apart by the hash of all their tags, which must not depend on
+    // the order of the tags
+    uint64_t seriesHash = 0;
+    if (method == AggregateMethod::MERGE) {
+        seriesHash = XXH64(name.data(), name.size(), tagSetHash);
+        for (auto it = e.TagsBegin(); it != e.TagsEnd(); ++it) {
+            seriesHash += XXH64(it->second.data(), it->second.size(), XXH64(it->first.data(), it->first.size(), 0));
+        }
+    }
+
+    auto it = mWindows.find(windowStart);
+    if (it == mWindows.end()) {
+        AggregateTable table;
+        if (!mFreeTables.empty()) {
+            table = std::move(mFreeTables.back());
+            mFreeTables.pop_back();
+        } else {
+            table.Init(mMaxSeries);
+        }
+        it = mWindows.emplace(windowStart, std::move(table)).first;
+    }
+    auto& table = it->second;
+    uint32_t tagSet = 0;
+    if (!table.FindTagSet(tagSetHash, tagSet)) {
+        vector<pair<string, string>> tags;
+        for (const auto& tag : group.GetTags()) {
+            tags.emplace_back(tag.first.to_string(), tag.second.to_string());
+        }
+        tagSet = table.AddTagSet(tagSetHash, std::move(tags));
+    }
+    bool inserted = false;
+    auto* entry = table.FindOrInsert(hash, mKeyBuffer, tagSet, inserted);
+    if (entry == nullptr) {
+        ADD_COUNTER(mOverflowEventsTotal, 1);
+        return false;
+    }
+    if (inserted) {
+        entry->mMethod = method;
+        entry->mIsMulti = isMulti;
+    } else if (entry->mIsMulti != isMulti) {
+        return false;
+    }
+
+    if (!isMulti) {
+        entry->mValue.Add(e.GetValue<UntypedSingleValue>()->mValue, timestamp, method, seriesHash);
+    } else {
+        const auto* values = e.GetValue<UntypedMultiDoubleValues>();
+        for (auto valueIt = values->ValuesBegin(); valueIt != values->ValuesEnd(); ++valueIt) {
+            auto fieldIt = find_if(entry->mFields.begin(), entry->mFields.end(), [&](const auto& field) {
+                return field.first == valueIt->first;
+            });
+            if (fieldIt == entry->mFields.end()) {
+                entry->mFields.emplace_back(valueIt->first.to_string(),
+                                            make_pair(valueIt->second.MetricType, AggregateValue()));
+                fieldIt = entry->mFields.end() - 1;
+            }
+            fieldIt->second.second.Add(valueIt->second.Value, timestamp, method, seriesHash);
+        }
+    }
+    ADD_COUNTER(mAggregatedEventsTotal, 1);
+    return true;
+}
+
+AggregateMethod ProcessorAggregateMetricNative::GetMethod(StringView name) const {
+    if (!mMethods.empty()) {
+        auto it = mMethods.find(name.to_string());
+        if (it != mMethods.end()) {
+            return it->second;
+        }
+    }
+    if (mHistogramMerge
+        && (EndsWith(name, "_bucket") || EndsWith(name, "_sum") || EndsWith(name, "_count"))) {
+        return AggregateMethod::MERGE;
+    }
+    return mDefaultMethod;
+}
+
+void ProcessorAggregateMetricNative::FlushWindows(time_t now, vector<PipelineEventGroup>& logGroupList, bool force) {
+    while (!mWindows.empty()) {
+        auto it = mWindows.begin();
+        time_t windowEnd = it->first + mIntervalSecs;
+        if (!force && windowEnd > now) {
+            break;
+        }
+        BuildGroups(it->first, it->second, logGroupList);
+        mFlushedUntil = max(mFlushedUntil, windowEnd);
+        if (mFreeTables.size() < kMaxFreeTables) {
+            it->second.Clear();
+            mFreeTables.emplace_back(std::move(it->second));
+        }
+        mWindows.erase(it);
+    }
+
+    size_t seriesNum = 0;
+    for (const auto& item : mWindows) {
+        seriesNum += item.second.Size();
+    }
+    SET_GAUGE(mSeriesNum, seriesNum);
+    if (!mWindows.empty()) {
+        // make sure the open windows are flushed even if no more events come
+        time_t windowEnd = mWindows.begin()->first + mIntervalSecs;
+        TimeoutFlushManager::GetInstance()->UpdateProcessorRecord(
+            mContext->GetConfigName(), static_cast<uint32_t>(max<time_t>(windowEnd - now, 1)));
+    }
+}
+
+void ProcessorAggregateMetricNative::BuildGroups(time_t windowStart,
+                                                 const AggregateTable& table,
+                                                 vector<PipelineEventGroup>& logGroupList) {
+    if (table.Empty()) {
+        return;
+    }
+    size_t first = logGroupList.size();
+    for (const auto& tags : table.GetTagSets()) {
+        logGroupList.emplace_back(make_shared<SourceBuffer>());
+        for (const auto& tag : tags) {
+            logGroupList.back().SetTag(tag.first, tag.second);
+        }
+    }
+
+    for (const auto& entry : table.GetEntries()) {
+        auto& group = logGroupList[first + entry.mTagSet];
+        auto* e = group.AddMetricEvent();
+        e->SetTimestamp(windowStart);
+
+        StringView key = table.GetKey(entry);
+        size_t pos = sizeof(uint64_t);
+        StringView name = ReadField(key, pos);
+        e->SetName(name.to_string());
+        while (pos < key.size()) {
+            StringView tagKey = ReadField(key, pos);
+            StringView tagValue = ReadField(key, pos);
+            e->SetTag(tagKey, tagValue);
+        }
+
+        if (!entry.mIsMulti) {
+            e->SetValue(UntypedSingleValue{entry.mValue.Result(entry.mMethod)});
+        } else {
+            e->SetValue(map<StringView, UntypedMultiDoubleValue>());
+            auto* values = e->MutableValue<UntypedMultiDoubleValues>();
+            for (const auto& field : entry.mFields) {
+                values->SetValue(field.first,
+                                 UntypedMultiDoubleValue{field.second.first, field.second.second.Result(entry.mMethod)});
+            }
+        }
+    }
+
+    // tag sets whose events all overflowed have no events
+    logGroupList.erase(remove_if(logGroupList.begin() + first,
+                                 logGroupList.end(),
+                                 [](const PipelineEventGroup& group) { return group.GetEvents().empty(); }),
+                       logGroupList.end());
+}
+
+} // namespace logtail
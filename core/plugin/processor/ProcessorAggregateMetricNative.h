@@ -0,0 +1,144 @@
+/*
+ * Copyright 2025 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "collection_pipeline/plugin/interface/Processor.h"
+#include "models/MetricEvent.h"
+#include "monitor/metric_models/MetricTypes.h"
+
+namespace logtail {
+
+enum class AggregateMethod { SUM, COUNT, MIN, MAX, LAST, AVG, MERGE };
+
+// Accumulated state of one value of an aggregation key within a window.
+struct AggregateValue {
+    double mSum = 0.0;
+    double mMin = 0.0;
+    double mMax = 0.0;
+    double mLast = 0.0;
+    time_t mLastTime = 0;
+    uint64_t mCount = 0;
+    // last value of each source series, only used by MERGE
+    std::unique_ptr<std::unordered_map<uint64_t, double>> mSeries;
+
+    void Add(double value, time_t timestamp, AggregateMethod method, uint64_t seriesHash);
+    double Result(AggregateMethod method) const;
+};
+
+// Aggregation table of one window. Entries live in one vector and are chained by index from a power of two bucket
+// array, and the key bytes of all entries are appended to a single arena string, so a window costs a few large
+// allocations instead of one per series. Clear() keeps the capacity for the next window.
+class AggregateTable {
+public:
+    struct Entry {
+        uint64_t mHash = 0;
+        uint32_t mKeyOffset = 0;
+        uint32_t mKeyLen = 0;
+        uint32_t mNext = 0;
+        uint32_t mTagSet = 0;
+        AggregateMethod mMethod = AggregateMethod::LAST;
+        bool mIsMulti = false;
+        AggregateValue mValue;
+        std::vector<std::pair<std::string, std::pair<UntypedValueMetricType, AggregateValue>>> mFields;
+    };
+
+    void Init(size_t maxEntries);
+    // Return the entry of key, creating it if absent; nullptr if the table is full.
+    Entry* FindOrInsert(uint64_t hash, const std::string& key, uint32_t tagSet, bool& inserted);
+    bool FindTagSet(uint64_t hash, uint32_t& index) const;
+    uint32_t AddTagSet(uint64_t hash, std::vector<std::pair<std::string, std::string>>&& tags);
+    void Clear();
+
+    bool Empty() const { return mEntries.empty(); }
+    size_t Size() const { return mEntries.size(); }
+    const std::vector<Entry>& GetEntries() const { return mEntries; }
+    StringView GetKey(const Entry& entry) const { return StringView(mArena.data() + entry.mKeyOffset, entry.mKeyLen); }
+    const std::vector<std::vector<std::pair<std::string, std::string>>>& GetTagSets() const { return mTagSets; }
+
+private:
+    void Rehash(size_t bucketCnt);
+
+    size_t mMaxEntries = 0;
+    // 1-based index of the first entry of each bucket, 0 if empty
+    std::vector<uint32_t> mBuckets;
+    std::vector<Entry> mEntries;
+    std::string mArena;
+    // group tags of the source event groups
+    std::vector<std::vector<std::pair<std::string, std::string>>> mTagSets;
+    std::unordered_map<uint64_t, uint32_t> mTagSetIndex;
+};
+
+class ProcessorAggregateMetricNative : public Processor {
+public:
+    static const std::string sName;
+
+    const std::string& Name() const override { return sName; }
+    bool Init(const Json::Value& config) override;
+    void Process(std::vector<PipelineEventGroup>& logGroupList) override;
+    void Flush(std::vector<PipelineEventGroup>& logGroupList, bool force) override;
+
+protected:
+    bool IsSupportedEvent(const PipelineEventPtr& e) const override;
+    void Process(PipelineEventGroup& logGroup) override;
+
+private:
+    // Return false if the event is not aggregated and should be kept in its group.
+    bool Aggregate(MetricEvent& e, const PipelineEventGroup& group, uint64_t tagSetHash);
+    AggregateMethod GetMethod(StringView name) const;
+    void FlushWindows(time_t now, std::vector<PipelineEventGroup>& logGroupList, bool force);
+    void BuildGroups(time_t windowStart, const AggregateTable& table, std::vector<PipelineEventGroup>& logGroupList);
+
+    uint32_t mIntervalSecs = 60;
+    std::vector<std::string> mGroupByTags;
+    AggregateMethod mDefaultMethod = AggregateMethod::LAST;
+    std::unordered_map<std::string, AggregateMethod> mMethods;
+    bool mHistogramMerge = true;
+    uint32_t mMaxSeries = 100000;
+
+    // processor runner threads may process groups of the same pipeline concurrently
+    std::mutex mMux;
+    // window start -> table
+    std::map<time_t, AggregateTable> mWindows;
+    // tables of flushed windows kept for reuse
+    std::vector<AggregateTable> mFreeTables;
+    time_t mFlushedUntil = 0;
+    time_t mNow = 0;
+    std::string mKeyBuffer;
+    std::vector<std::pair<StringView, StringView>> mKeyTags;
+
+    CounterPtr mAggregatedEventsTotal;
+    CounterPtr mLateEventsTotal;
+    CounterPtr mOverflowEventsTotal;
+    IntGaugePtr mSeriesNum;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class ProcessorAggregateMetricNativeUnittest;
+#endif
+};
+
+} // namespace logtail
@@ -15,6 +15,9 @@
  */
 #include "plugin/processor/ProcessorDesensitizeNative.h"
 
+#include <cctype>
+#include <cstring>
+
 #include "collection_pipeline/plugin/instance/ProcessorInstance.h"
 #include "common/HashUtil.h"
 #include "common/ParamExtractor.h"
@@ -26,6 +29,194 @@ namespace logtail {
 
 const std::string ProcessorDesensitizeNative::sName = "processor_desensitize_native";
 
+// Longest run of literal bytes that every match of the regex alternative must contain. Returns false when the
+// alternative uses syntax we do not understand, in which case no prefilter should be applied.
+static bool ExtractMandatoryLiteral(StringView alt, std::string& best) {
+    std::string cur;
+    size_t i = 0;
+    while (i < alt.size()) {
+        std::string token;
+        bool isLiteral = false;
+        char c = alt[i];
+        if (c == '\\') {
+            if (i + 1 >= alt.size()) {
+                return false;
+            }
+            char n = alt[i + 1];
+            if (std::isalnum(static_cast<unsigned char>(n))) {
+                if (n == 'x' || n == 'p' || n == 'P' || n == 'Q' || n == 'E' || n == 'C') {
+                    return false;
+                }
+            } else {
+                token.assign(1, n);
+                isLiteral = true;
+            }
+            i += 2;
+        } else if (c == '[') {
+            size_t j = i + 1;
+            if (j < alt.size() && alt[j] == '^') {
+                ++j;
+            }
+            if (j < alt.size() && alt[j] == ']') {
+                ++j;
+            }
+            while (j < alt.size() && alt[j] != ']') {
+                j += alt[j] == '\\' ? 2 : 1;
+            }
+            if (j >= alt.size()) {
+                return false;
+            }
+            i = j + 1;
+        } else if (c == '(') {
+            int depth = 0;
+            size_t j = i;
+            for (; j < alt.size(); ++j) {
+                if (alt[j] == '\\') {
+                    ++j;
+                } else if (alt[j] == '(') {
+                    ++depth;
+                } else if (alt[j] == ')' && --depth == 0) {
+                    break;
+                }
+            }
+            if (j >= alt.size()) {
+                return false;
+            }
+            i = j + 1;
+        } else if (c == '.' || c == '^' || c == '$') {
+            ++i;
+        } else if (c == '*' || c == '+' || c == '?' || c == '{' || c == ')' || c == '|') {
+            return false;
+        } else {
+            // keep utf-8 multibyte characters as a whole so that quantifiers apply to the full character
+            size_t j = i + 1;
+            if (static_cast<unsigned char>(c) >= 0x80) {
+                while (j < alt.size() && (static_cast<unsigned char>(alt[j]) & 0xC0) == 0x80) {
+                    ++j;
+                }
+            }
+            token.assign(alt.data() + i, j - i);
+            isLiteral = true;
+            i = j;
+        }
+
+        bool optional = false;
+        bool repeated = false;
+        if (i < alt.size()) {
+            if (alt[i] == '*' || alt[i] == '?') {
+                optional = true;
+                ++i;
+            } else if (alt[i] == '+') {
+                repeated = true;
+                ++i;
+            } else if (alt[i] == '{') {
+                size_t j = i + 1;
+                while (j < alt.size() && alt[j] != '}') {
+                    ++j;
+                }
+                if (j >= alt.size()) {
+                    return false;
+                }
+                if (i + 1 < j && alt[i + 1] == '0') {
+                    optional = true;
+                } else {
+                    repeated = true;
+                }
+                i = j + 1;
+            }
+            if ((optional || repeated) && i < alt.size() && alt[i] == '?') {
+                ++i;
+            }
+        }
+
+        if (isLiteral && !optional) {
+            cur += token;
+            if (repeated) {
+                // case: ab+c, both "ab" and "bc" are mandatory
+                if (cur.size() > best.size()) {
+                    best = cur;
+                }
+                cur = token;
+            }
+        } else {
+            if (cur.size() > best.size()) {
+                best = cur;
+            }
+            cur.clear();
+        }
+    }
+    if (cur.size() > best.size()) {
+        best = cur;
+    }
+    return true;
+}
+
+static bool ExtractRequiredLiterals(const std::string& pattern, std::vector<std::string>& literals) {
+    // inline flags may turn on case insensitive matching
+    for (size_t pos = pattern.find("(?"); pos != std::string::npos; pos = pattern.find("(?", pos + 2)) {
+        if (pos + 2 >= pattern.size() || (pattern[pos + 2] != ':' && pattern[pos + 2] != 'P')) {
+            return false;
+        }
+    }
+    // split top level alternatives
+    std::vector<StringView> alternatives;
+    int depth = 0;
+    bool inClass = false;
+    size_t begin = 0;
+    for (size_t i = 0; i < pattern.size(); ++i) {
+        char c = pattern[i];
+        if (c == '\\') {
+            ++i;
+        } else if (inClass) {
+            inClass = c != ']';
+        } else if (c == '[') {
+            inClass = true;
+            if (i + 1 < pattern.size() && pattern[i + 1] == '^') {
+                ++i;
+            }
+            if (i + 1 < pattern.size() && pattern[i + 1] == ']') {
+                ++i;
+            }
+        } else if (c == '(') {
+            ++depth;
+        } else if (c == ')') {
+            --depth;
+        } else if (c == '|' && depth == 0) {
+            alternatives.emplace_back(pattern.data() + begin, i - begin);
+            begin = i + 1;
+        }
+    }
+    alternatives.emplace_back(pattern.data() + begin, pattern.size() - begin);
+
+    std::vector<std::string> res;
+    for (const auto& alt : alternatives) {
+        std::string literal;
+        if (!ExtractMandatoryLiteral(alt, literal) || literal.empty()) {
+            return false;
+        }
+        res.emplace_back(std::move(literal));
+    }
+    literals.swap(res);
+    return true;
+}
+
+static bool ContainsLiteral(StringView value, const std::string& literal) {
+    const char* cur = value.data();
+    const char* end = value.data() + value.size();
+    while (static_cast<size_t>(end - cur) >= literal.size()) {
+        // memchr is vectorized in libc, so scanning for the first byte is cheap
+        cur = static_cast<const char*>(memchr(cur, literal[0], end - cur - literal.size() + 1));
+        if (cur == nullptr) {
+            return false;
+        }
+        if (memcmp(cur + 1, literal.data() + 1, literal.size() - 1) == 0) {
+            return true;
+        }
+        ++cur;
+    }
+    return false;
+}
+
 bool ProcessorDesensitizeNative::Init(const Json::Value& config) {
     std::string errorMsg;
 
@@ -81,6 +272,8 @@ bool ProcessorDesensitizeNative::Init(const Json::Value& config) {
                                mContext->GetRegion());
         }
     }
+    mIsReplacingLiteral = mReplacingString.find('\\') == std::string::npos;
+    mReplacingLiteral = mReplacingString;
     mReplacingString = std::string("\\1") + mReplacingString;
 
     // ContentPatternBeforeReplacedString
@@ -123,6 +316,10 @@ bool ProcessorDesensitizeNative::Init(const Json::Value& config) {
                            mContext->GetRegion());
     }
 
+    if (!ExtractRequiredLiterals(mContentPatternBeforeReplacedString, mRequiredLiterals)) {
+        mRequiredLiterals.clear();
+    }
+
     // ReplacingAll
     if (!GetOptionalBoolParam(config, "ReplacingAll", mReplacingAll, errorMsg)) {
         PARAM_WARNING_DEFAULT(mContext->GetLogger(),
@@ -179,11 +376,24 @@ void ProcessorDesensitizeNative::ProcessEvent(PipelineEventPtr& e) {
         if (item.second.empty()) {
             continue;
         }
+        processed = true;
+        if (!MayContainSensitiveWord(item.second)) {
+            continue;
+        }
+        if (mMethod == DesensitizeMethod::MD5_OPTION || mIsReplacingLiteral) {
+            StringView result;
+            auto rst = CastOneSensitiveWord(item.second, *sourceEvent.GetSourceBuffer(), result);
+            if (rst == CastResult::CAST) {
+                sourceEvent.SetContentNoCopy(item.first, result);
+            }
+            if (rst != CastResult::UNSUPPORTED) {
+                continue;
+            }
+        }
         std::string value = item.second.to_string();
         CastOneSensitiveWord(&value);
         StringBuffer valueBuffer = sourceEvent.GetSourceBuffer()->CopyString(value);
         sourceEvent.SetContentNoCopy(item.first, StringView(valueBuffer.data, valueBuffer.size));
-        processed = true;
     }
     if (processed) {
         ADD_COUNTER(mOutSuccessfulEventsTotal, 1);
@@ -196,6 +406,72 @@ void ProcessorDesensitizeNative::ProcessEvent(PipelineEventPtr& e) {
     }
 }
 
+bool ProcessorDesensitizeNative::MayContainSensitiveWord(StringView value) const {
+    if (mRequiredLiterals.empty()) {
+        return true;
+    }
+    for (const auto& literal : mRequiredLiterals) {
+        if (ContainsLiteral(value, literal)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+ProcessorDesensitizeNative::CastResult ProcessorDesensitizeNative::CastOneSensitiveWord(StringView value,
+                                                                                      SourceBuffer& sourceBuffer,
+                                                                                      StringView& result) const {
+    // sensitive ranges [first, second) to be replaced, the prefix matched by group 1 is kept as is
+    std::vector<std::pair<size_t, size_t>> ranges;
+    re2::StringPiece input(value.data(), value.size());
+    re2::StringPiece groups[2];
+    size_t pos = 0;
+    while (pos <= value.size()) {
+        if (!mRegex->Match(input, pos, value.size(), RE2::UNANCHORED, groups, 2)) {
+            break;
+        }
+        size_t matchBegin = groups[0].data() - value.data();
+        size_t matchEnd = matchBegin + groups[0].size();
+        if (groups[0].empty()) {
+            // empty matches are handled differently by the md5 and const methods, leave them to the string version
+            return CastResult::UNSUPPORTED;
+        }
+        size_t keepEnd = groups[1].data() == nullptr ? matchBegin : groups[1].data() + groups[1].size() - value.data();
+        ranges.emplace_back(keepEnd, matchEnd);
+        if (!mReplacingAll) {
+            break;
+        }
+        pos = matchEnd;
+    }
+    if (ranges.empty()) {
+        return CastResult::UNCHANGED;
+    }
+
+    const size_t replacementSize = mMethod == DesensitizeMethod::MD5_OPTION ? 32 : mReplacingLiteral.size();
+    size_t size = value.size();
+    for (const auto& range : ranges) {
+        size = size - (range.second - range.first) + replacementSize;
+    }
+    StringBuffer buffer = sourceBuffer.AllocateStringBuffer(size);
+    char* dst = buffer.data;
+    size_t last = 0;
+    for (const auto& range : ranges) {
+        memcpy(dst, value.data() + last, range.first - last);
+        dst += range.first - last;
+        if (mMethod == DesensitizeMethod::MD5_OPTION) {
+            CalcMD5(value.data() + range.first, range.second - range.first, dst);
+        } else {
+            memcpy(dst, mReplacingLiteral.data(), replacementSize);
+        }
+        dst += replacementSize;
+        last = range.second;
+    }
+    memcpy(dst, value.data() + last, value.size() - last);
+    buffer.size = size;
+    result = StringView(buffer.data, buffer.size);
+    return CastResult::CAST;
+}
+
 void ProcessorDesensitizeNative::CastOneSensitiveWord(std::string* value) {
     std::string* pVal = value;
     bool rst = false;
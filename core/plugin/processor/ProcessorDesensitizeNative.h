@@ -16,6 +16,9 @@
 
 #pragma once
 
+#include <string>
+#include <vector>
+
 #include "re2/re2.h"
 
 #include "collection_pipeline/plugin/interface/Processor.h"
@@ -51,10 +54,21 @@ protected:
     bool IsSupportedEvent(const PipelineEventPtr& e) const override;
 
 private:
+    // result of the zero-copy cast, values it cannot handle are cast by the string version as before
+    enum class CastResult { UNCHANGED, CAST, UNSUPPORTED };
+
     void ProcessEvent(PipelineEventPtr& e);
+    bool MayContainSensitiveWord(StringView value) const;
+    CastResult CastOneSensitiveWord(StringView value, SourceBuffer& sourceBuffer, StringView& result) const;
     void CastOneSensitiveWord(std::string* value);
 
     std::shared_ptr<re2::RE2> mRegex;
+    // Literals extracted from ContentPatternBeforeReplacedString, at least one of them must appear in the value for
+    // the regex to match. Empty if no such literal can be determined.
+    std::vector<std::string> mRequiredLiterals;
+    // ReplacingString without the leading group reference, valid only when it contains no rewrite escapes.
+    std::string mReplacingLiteral;
+    bool mIsReplacingLiteral = true;
 
     CounterPtr mDiscardedEventsTotal;
     CounterPtr mOutFailedEventsTotal;
@@ -63,6 +77,7 @@ private:
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class ProcessorParseApsaraNativeUnittest;
+    friend class ProcessorDesensitizeNativeUnittest;
 #endif
 };
 
@@ -21,10 +21,13 @@
 #include "rapidjson/writer.h"
 
 #include "collection_pipeline/plugin/instance/ProcessorInstance.h"
+#include "common/Flags.h"
 #include "common/ParamExtractor.h"
 #include "models/LogEvent.h"
 #include "monitor/metric_constants/MetricConstants.h"
 
+DECLARE_FLAG_BOOL(enable_lazy_log_parsing);
+
 namespace logtail {
 
 static std::string RapidjsonValueToString(const rapidjson::Value& value) {
@@ -74,10 +77,18 @@ bool ProcessorParseJsonNative::Init(const Json::Value& config) {
         return false;
     }
 
+    mLazyParsing = BOOL_FLAG(enable_lazy_log_parsing);
+    mTouchedKeys.clear();
+    mTouchedKeys.insert(mSourceKey);
+    mTouchedKeys.insert(mCommonParserOptions.mRenamedSourceKey);
+    mTouchedKeys.insert(CommonParserOptions::legacyUnmatchedRawLogKey);
+
     mDiscardedEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_DISCARDED_EVENTS_TOTAL);
     mOutFailedEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_OUT_FAILED_EVENTS_TOTAL);
     mOutKeyNotFoundEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_OUT_KEY_NOT_FOUND_EVENTS_TOTAL);
     mOutSuccessfulEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_OUT_SUCCESSFUL_EVENTS_TOTAL);
+    mLazyEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_LAZY_EVENTS_TOTAL);
+    mMaterializedEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_MATERIALIZED_EVENTS_TOTAL);
 
     return true;
 }
@@ -114,11 +125,50 @@ bool ProcessorParseJsonNative::ProcessEvent(const StringView& logPath,
         ADD_COUNTER(mOutKeyNotFoundEventsTotal, 1);
         return true;
     }
+    if (mLazyParsing && mCommonParserOptions.CanEraseWithoutMetadata(metadata)) {
+        sourceEvent.SetLazyParser(this);
+        ADD_COUNTER(mLazyEventsTotal, 1);
+        return true;
+    }
+    return ParseEvent(sourceEvent, logPath, metadata);
+}
+
+bool ProcessorParseJsonNative::ParseLazily(LogEvent& e) {
+    static const GroupMetadata sEmptyMetadata;
+    ADD_COUNTER(mMaterializedEventsTotal, 1);
+    return ParseEvent(e, StringView(), sEmptyMetadata);
+}
+
+bool ProcessorParseJsonNative::MayTouch(const LogEvent& e, StringView key) const {
+    if (mTouchedKeys.find(key) != mTouchedKeys.end()) {
+        return true;
+    }
+    // A key of the json object appears in the raw json as is, unless it is written with escapes. Those that need no
+    // escape can still be written with \u escapes, or \/ for the slash.
+    for (char c : key) {
+        if (c == '"' || c == '\\' || c == '/' || static_cast<unsigned char>(c) < 0x20) {
+            return true;
+        }
+    }
+    StringView raw = e.PeekContent(mSourceKey);
+    if (raw.find("\\u") != StringView::npos) {
+        return true;
+    }
+    for (size_t pos = raw.find(key); pos != StringView::npos; pos = raw.find(key, pos + 1)) {
+        if (pos > 0 && raw[pos - 1] == '"' && pos + key.size() < raw.size() && raw[pos + key.size()] == '"') {
+            return true;
+        }
+    }
+    return false;
+}
 
+bool ProcessorParseJsonNative::ParseEvent(LogEvent& sourceEvent,
+                                          const StringView& logPath,
+                                          const GroupMetadata& metadata) {
     auto rawContent = sourceEvent.GetContent(mSourceKey);
 
     bool sourceKeyOverwritten = false;
-    bool parseSuccess = JsonLogLineParser(sourceEvent, logPath, e, sourceKeyOverwritten);
+    bool parseSuccess = JsonLogLineParser(sourceEvent, logPath, sourceKeyOverwritten);
 
     if (!parseSuccess || !sourceKeyOverwritten) {
         sourceEvent.DelContent(mSourceKey);
@@ -139,7 +189,6 @@ bool ProcessorParseJsonNative::ProcessEvent(const StringView& logPath,
 
 bool ProcessorParseJsonNative::JsonLogLineParser(LogEvent& sourceEvent,
                                                  const StringView& logPath,
-                                                 PipelineEventPtr& e,
                                                  bool& sourceKeyOverwritten) {
     StringView buffer = sourceEvent.GetContent(mSourceKey);
 
@@ -15,19 +15,25 @@
  */
 #pragma once
 
+#include <string>
+#include <unordered_set>
+
 #include "collection_pipeline/plugin/interface/Processor.h"
 #include "models/LogEvent.h"
 #include "plugin/processor/CommonParserOptions.h"
 
 namespace logtail {
 
-class ProcessorParseJsonNative : public Processor {
+class ProcessorParseJsonNative : public Processor, public LazyLogParser {
 public:
     static const std::string sName;
 
     const std::string& Name() const override { return sName; }
     bool Init(const Json::Value& config) override;
     void Process(PipelineEventGroup& logGroup) override;
+    bool ParseLazily(LogEvent& e) override;
+    // keys of json objects are unknown until parsed, so the raw json is searched for the key
+    bool MayTouch(const LogEvent& e, StringView key) const override;
 
     // Source field name.
     std::string mSourceKey;
@@ -37,17 +43,21 @@ protected:
     bool IsSupportedEvent(const PipelineEventPtr& e) const override;
 
 private:
-    bool JsonLogLineParser(LogEvent& sourceEvent,
-                           const StringView& logPath,
-                           PipelineEventPtr& e,
-                           bool& sourceKeyOverwritten);
+    bool JsonLogLineParser(LogEvent& sourceEvent, const StringView& logPath, bool& sourceKeyOverwritten);
     void AddLog(const StringView& key, const StringView& value, LogEvent& targetEvent, bool overwritten = true);
     bool ProcessEvent(const StringView& logPath, PipelineEventPtr& e, const GroupMetadata& metadata);
+    bool ParseEvent(LogEvent& sourceEvent, const StringView& logPath, const GroupMetadata& metadata);
+
+    bool mLazyParsing = false;
+    // keys that parsing may add, modify or delete besides the keys of the json object
+    std::unordered_set<StringView, StringViewHash, StringViewEqual> mTouchedKeys;
 
     CounterPtr mDiscardedEventsTotal;
     CounterPtr mOutFailedEventsTotal;
     CounterPtr mOutKeyNotFoundEventsTotal;
     CounterPtr mOutSuccessfulEventsTotal;
+    CounterPtr mLazyEventsTotal;
+    CounterPtr mMaterializedEventsTotal;
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class ProcessorParseJsonNativeUnittest;
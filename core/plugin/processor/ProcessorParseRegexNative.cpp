@@ -17,9 +17,12 @@
 #include "plugin/processor/ProcessorParseRegexNative.h"
 
 #include "app_config/AppConfig.h"
+#include "common/Flags.h"
 #include "common/ParamExtractor.h"
 #include "monitor/metric_constants/MetricConstants.h"
 
+DECLARE_FLAG_BOOL(enable_lazy_log_parsing);
+
 namespace logtail {
 
 const std::string ProcessorParseRegexNative::sName = "processor_parse_regex_native";
@@ -92,10 +95,20 @@ bool ProcessorParseRegexNative::Init(const Json::Value& config) {
         return false;
     }
 
+    mLazyParsing = BOOL_FLAG(enable_lazy_log_parsing);
+    mTouchedKeys.clear();
+    mTouchedKeys.insert(mKeys.begin(), mKeys.end());
+    mTouchedKeys.insert(mKeys.empty() ? DEFAULT_CONTENT_KEY : mKeys[0]);
+    mTouchedKeys.insert(mSourceKey);
+    mTouchedKeys.insert(mCommonParserOptions.mRenamedSourceKey);
+    mTouchedKeys.insert(CommonParserOptions::legacyUnmatchedRawLogKey);
+
     mDiscardedEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_DISCARDED_EVENTS_TOTAL);
     mOutFailedEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_OUT_FAILED_EVENTS_TOTAL);
     mOutKeyNotFoundEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_OUT_KEY_NOT_FOUND_EVENTS_TOTAL);
     mOutSuccessfulEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_OUT_SUCCESSFUL_EVENTS_TOTAL);
+    mLazyEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_LAZY_EVENTS_TOTAL);
+    mMaterializedEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_MATERIALIZED_EVENTS_TOTAL);
 
     return true;
 }
@@ -136,6 +149,27 @@ bool ProcessorParseRegexNative::ProcessEvent(const StringView& logPath,
         ADD_COUNTER(mOutKeyNotFoundEventsTotal, 1);
         return true;
     }
+    if (mLazyParsing && mCommonParserOptions.CanEraseWithoutMetadata(metadata)) {
+        sourceEvent.SetLazyParser(this);
+        ADD_COUNTER(mLazyEventsTotal, 1);
+        return true;
+    }
+    return ParseEvent(sourceEvent, logPath, metadata);
+}
+
+bool ProcessorParseRegexNative::ParseLazily(LogEvent& e) {
+    static const GroupMetadata sEmptyMetadata;
+    ADD_COUNTER(mMaterializedEventsTotal, 1);
+    return ParseEvent(e, StringView(), sEmptyMetadata);
+}
+
+bool ProcessorParseRegexNative::MayTouch(const LogEvent& e, StringView key) const {
+    return mTouchedKeys.find(key) != mTouchedKeys.end();
+}
+
+bool ProcessorParseRegexNative::ParseEvent(LogEvent& sourceEvent,
+                                           const StringView& logPath,
+                                           const GroupMetadata& metadata) {
     auto rawContent = sourceEvent.GetContent(mSourceKey);
     bool parseSuccess = true;
 
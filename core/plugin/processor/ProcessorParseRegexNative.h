@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <unordered_set>
 #include <vector>
 
 #include "boost/regex.hpp"
@@ -26,13 +27,15 @@
 
 namespace logtail {
 
-class ProcessorParseRegexNative : public Processor {
+class ProcessorParseRegexNative : public Processor, public LazyLogParser {
 public:
     static const std::string sName;
 
     const std::string& Name() const override { return sName; }
     bool Init(const Json::Value& config) override;
     void Process(PipelineEventGroup& logGroup) override;
+    bool ParseLazily(LogEvent& e) override;
+    bool MayTouch(const LogEvent& e, StringView key) const override;
 
     // Source field name.
     std::string mSourceKey;
@@ -48,6 +51,8 @@ protected:
 private:
     /// @return false if data need to be discarded
     bool ProcessEvent(const StringView& logPath, PipelineEventPtr& e, const GroupMetadata& metadata);
+    /// @return false if data need to be discarded
+    bool ParseEvent(LogEvent& sourceEvent, const StringView& logPath, const GroupMetadata& metadata);
     bool WholeLineModeParser(LogEvent& sourceEvent, const std::string& key);
     bool RegexLogLineParser(LogEvent& sourceEvent,
                             const boost::regex& reg,
@@ -58,11 +63,16 @@ private:
     bool mSourceKeyOverwritten = false;
     bool mIsWholeLineMode = false;
     boost::regex mReg;
+    bool mLazyParsing = false;
+    // all keys that parsing may add, modify or delete
+    std::unordered_set<StringView, StringViewHash, StringViewEqual> mTouchedKeys;
 
     CounterPtr mDiscardedEventsTotal;
     CounterPtr mOutFailedEventsTotal;
     CounterPtr mOutKeyNotFoundEventsTotal;
     CounterPtr mOutSuccessfulEventsTotal;
+    CounterPtr mLazyEventsTotal;
+    CounterPtr mMaterializedEventsTotal;
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class ProcessorParseRegexNativeUnittest;
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "plugin/processor/ProcessorProjectFieldsNative.h"
+
+#include "collection_pipeline/plugin/instance/ProcessorInstance.h"
+#include "common/ParamExtractor.h"
+#include "models/PipelineEventGroup.h"
+#include "monitor/metric_constants/MetricConstants.h"
+
+using namespace std;
+
+namespace logtail {
+
+const string ProcessorProjectFieldsNative::sName = "processor_project_fields_native";
+
+bool ProcessorProjectFieldsNative::Init(const Json::Value& config) {
+    string errorMsg;
+
+    // Include
+    if (!GetOptionalListParam(config, "Include", mInclude, errorMsg)) {
+        PARAM_ERROR_RETURN(mContext->GetLogger(),
+                           mContext->GetAlarm(),
+                           errorMsg,
+                           sName,
+                           mContext->GetConfigName(),
+                           mContext->GetProjectName(),
+                           mContext->GetLogstoreName(),
+                           mContext->GetRegion());
+    }
+
+    // Exclude
+    if (!GetOptionalListParam(config, "Exclude", mExclude, errorMsg)) {
+        PARAM_ERROR_RETURN(mContext->GetLogger(),
+                           mContext->GetAlarm(),
+                           errorMsg,
+                           sName,
+                           mContext->GetConfigName(),
+                           mContext->GetProjectName(),
+                           mContext->GetLogstoreName(),
+                           mContext->GetRegion());
+    }
+
+    // SourceKeys + DestKeys
+    if (!GetOptionalListParam(config, "SourceKeys", mSourceKeys, errorMsg)
+        || !GetOptionalListParam(config, "DestKeys", mDestKeys, errorMsg)) {
+        PARAM_ERROR_RETURN(mContext->GetLogger(),
+                           mContext->GetAlarm(),
+                           errorMsg,
+                           sName,
+                           mContext->GetConfigName(),
+                           mContext->GetProjectName(),
+                           mContext->GetLogstoreName(),
+                           mContext->GetRegion());
+    }
+    if (mSourceKeys.size() != mDestKeys.size()) {
+        PARAM_ERROR_RETURN(mContext->GetLogger(),
+                           mContext->GetAlarm(),
+                           "param SourceKeys and DestKeys does not have the same size",
+                           sName,
+                           mContext->GetConfigName(),
+                           mContext->GetProjectName(),
+                           mContext->GetLogstoreName(),
+                           mContext->GetRegion());
+    }
+    for (const auto& key : mDestKeys) {
+        if (key.empty()) {
+            PARAM_ERROR_RETURN(mContext->GetLogger(),
+                               mContext->GetAlarm(),
+                               "value in list param DestKeys is empty",
+                               sName,
+                               mContext->GetConfigName(),
+                               mContext->GetProjectName(),
+                               mContext->GetLogstoreName(),
+                               mContext->GetRegion());
+        }
+    }
+    if (mInclude.empty() && mExclude.empty() && mSourceKeys.empty()) {
+        PARAM_ERROR_RETURN(mContext->GetLogger(),
+                           mContext->GetAlarm(),
+                           "none of param Include, Exclude and SourceKeys is given",
+                           sName,
+                           mContext->GetConfigName(),
+                           mContext->GetProjectName(),
+                           mContext->GetLogstoreName(),
+                           mContext->GetRegion());
+    }
+
+    // compile the rules, the earlier inserted one wins when a key appears in more than one list
+    mRules.clear();
+    for (const auto& key : mExclude) {
+        mRules.emplace(StringView(key), FieldRule{FieldAction::DROP, 0});
+    }
+    for (size_t i = 0; i < mSourceKeys.size(); ++i) {
+        mRules.emplace(StringView(mSourceKeys[i]), FieldRule{FieldAction::RENAME, i});
+    }
+    for (const auto& key : mInclude) {
+        mRules.emplace(StringView(key), FieldRule{FieldAction::KEEP, 0});
+    }
+    mDropUnmatched = !mInclude.empty();
+
+    mDroppedFieldsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_DROPPED_FIELDS_TOTAL);
+    mRenamedFieldsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_RENAMED_FIELDS_TOTAL);
+
+    return true;
+}
+
+void ProcessorProjectFieldsNative::Process(PipelineEventGroup& logGroup) {
+    if (logGroup.GetEvents().empty()) {
+        return;
+    }
+
+    // new keys are copied into the source buffer of the group on first use, so that all events share the same copy
+    vector<StringView> destKeys(mDestKeys.size());
+    auto& sourceBuffer = logGroup.GetSourceBuffer();
+    size_t droppedCnt = 0;
+    size_t renamedCnt = 0;
+    for (auto& e : logGroup.MutableEvents()) {
+        if (!IsSupportedEvent(e)) {
+            continue;
+        }
+        e.Cast<LogEvent>().RewriteContents([&](LogContent& content) {
+            auto it = mRules.find(content.first);
+            if (it == mRules.end()) {
+                droppedCnt += mDropUnmatched;
+                return !mDropUnmatched;
+            }
+            switch (it->second.mAction) {
+                case FieldAction::DROP:
+                    ++droppedCnt;
+                    return false;
+                case FieldAction::RENAME: {
+                    auto& key = destKeys[it->second.mDestSlot];
+                    if (key.empty()) {
+                        auto b = sourceBuffer->CopyString(mDestKeys[it->second.mDestSlot]);
+                        key = StringView(b.data, b.size);
+                    }
+                    content.first = key;
+                    ++renamedCnt;
+                    return true;
+                }
+                default:
+                    return true;
+            }
+        });
+    }
+    ADD_COUNTER(mDroppedFieldsTotal, droppedCnt);
+    ADD_COUNTER(mRenamedFieldsTotal, renamedCnt);
+}
+
+bool ProcessorProjectFieldsNative::IsSupportedEvent(const PipelineEventPtr& e) const {
+    return e.Is<LogEvent>();
+}
+
+} // namespace logtail
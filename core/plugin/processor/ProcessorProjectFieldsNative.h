@@ -0,0 +1,72 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "collection_pipeline/plugin/interface/Processor.h"
+#include "common/StringView.h"
+#include "models/LogEvent.h"
+
+namespace logtail {
+
+// Keeps, drops and renames log contents in a single pass. The rule set is compiled at Init into a hash table from
+// source key to action, so that each event is rewritten in place and compacted at once instead of going through a
+// series of SetContent/DelContent calls, each of which updates the index and leaves a tombstone behind.
+class ProcessorProjectFieldsNative : public Processor {
+public:
+    static const std::string sName;
+
+    const std::string& Name() const override { return sName; }
+    bool Init(const Json::Value& config) override;
+    void Process(PipelineEventGroup& logGroup) override;
+
+    // Keys to be kept. If not empty, keys neither in this list nor in SourceKeys are dropped.
+    std::vector<std::string> mInclude;
+    // Keys to be dropped, which takes precedence over all other rules.
+    std::vector<std::string> mExclude;
+    // Keys to be renamed to the corresponding ones in DestKeys.
+    std::vector<std::string> mSourceKeys;
+    std::vector<std::string> mDestKeys;
+
+protected:
+    bool IsSupportedEvent(const PipelineEventPtr& e) const override;
+
+private:
+    enum class FieldAction { KEEP, DROP, RENAME };
+
+    struct FieldRule {
+        FieldAction mAction = FieldAction::KEEP;
+        // index of the new key in mDestKeys, only valid for RENAME
+        size_t mDestSlot = 0;
+    };
+
+    // keys refer to the strings in the config lists above
+    std::unordered_map<StringView, FieldRule, StringViewHash, StringViewEqual> mRules;
+    bool mDropUnmatched = false;
+
+    CounterPtr mDroppedFieldsTotal;
+    CounterPtr mRenamedFieldsTotal;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class ProcessorProjectFieldsNativeUnittest;
+#endif
+};
+
+} // namespace logtail
@@ -61,11 +61,13 @@ public:
     bool mIgnoreParseWarning = false;
     bool mKeepingSourceWhenParseFail = true;
 
+    // parse docker json log line in place, escaped characters in the log field are unescaped within the buffer
+    static bool ParseDockerLog(char* buffer, int32_t size, DockerLog& dockerLog);
+
 protected:
     bool IsSupportedEvent(const PipelineEventPtr& e) const override;
 
 private:
-    static bool ParseDockerLog(char* buffer, int32_t size, DockerLog& dockerLog);
     bool ProcessEvent(StringView containerType, PipelineEventPtr& e, PipelineEventGroup& logGroup);
     bool ProcessEvent(StringView containerType, PipelineEventPtr& e);
     void ResetDockerJsonLogField(char* data, StringView key, StringView value, LogEvent& targetEvent);
@@ -2,14 +2,21 @@
 
 #include "json/json.h"
 
+#include "common/Flags.h"
 #include "common/StringTools.h"
 #include "logger/Logger.h"
 #include "models/MetricEvent.h"
 #include "models/PipelineEventGroup.h"
 #include "models/PipelineEventPtr.h"
 #include "models/RawEvent.h"
+#include "monitor/metric_constants/MetricConstants.h"
+#include "plugin/processor/inner/ProcessorPromRelabelMetricNative.h"
 #include "prometheus/Constants.h"
 
+DEFINE_FLAG_BOOL(enable_prom_series_cache, "cache relabeled series of each prometheus target", false);
+DEFINE_FLAG_INT64(prom_series_cache_max_size, "max series cached for each prometheus target", 1000000);
+DEFINE_FLAG_INT32(prom_series_cache_expire_seconds, "series cache of a target is removed if not used", 600);
+
 using namespace std;
 namespace logtail {
 
@@ -21,6 +28,10 @@ bool ProcessorPromParseMetricNative::Init(const Json::Value& config) {
     if (!mScrapeConfigPtr->InitStaticConfig(config)) {
         return false;
     }
+    mEnableSeriesCache = BOOL_FLAG(enable_prom_series_cache);
+
+    mSeriesCacheHitsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_PROM_SERIES_CACHE_HITS_TOTAL);
+    mSeriesCacheMissesTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_PROM_SERIES_CACHE_MISSES_TOTAL);
     return true;
 }
 
@@ -39,8 +50,25 @@ void ProcessorPromParseMetricNative::Process(PipelineEventGroup& eGroup) {
     TextParser parser(mScrapeConfigPtr->mHonorTimestamps);
     parser.SetDefaultTimestamp(timestamp, nanoSec);
 
-    for (auto& e : events) {
-        ProcessEvent(e, newEvents, eGroup, parser);
+    StringView targetId = eGroup.GetMetadata(EventGroupMetaKey::PROMETHEUS_STREAM_ID);
+    // events parsed by the scraper in stream parse mode have no series text to look up, so they are left to
+    // processor_prom_relabel_metric_native
+    bool streamParsed = !events.empty() && events[0].Is<MetricEvent>();
+    if (mEnableSeriesCache && !targetId.empty() && !streamParsed) {
+        auto cache = GetSeriesCache(targetId);
+        const auto& targetTags = eGroup.GetTags();
+        {
+            lock_guard<mutex> lock(cache->mMutex);
+            cache->mCache.StartScrape(timestampMilliSec);
+            for (auto& e : events) {
+                ProcessEventWithCache(e, newEvents, eGroup, parser, cache->mCache, targetTags);
+            }
+        }
+        eGroup.SetMetadata(EventGroupMetaKey::PROMETHEUS_SERIES_RELABELED, string("true"));
+    } else {
+        for (auto& e : events) {
+            ProcessEvent(e, newEvents, eGroup, parser);
+        }
     }
     events.swap(newEvents);
 }
@@ -53,6 +81,11 @@ bool ProcessorPromParseMetricNative::ProcessEvent(PipelineEventPtr& e,
                                                   EventsContainer& newEvents,
                                                   PipelineEventGroup& eGroup,
                                                   TextParser& parser) {
+    // already parsed by the scraper in stream parse mode
+    if (e.Is<MetricEvent>()) {
+        newEvents.emplace_back(std::move(e));
+        return true;
+    }
     if (!IsSupportedEvent(e)) {
         return false;
     }
@@ -65,4 +98,75 @@ bool ProcessorPromParseMetricNative::ProcessEvent(PipelineEventPtr& e,
     return true;
 }
 
+bool ProcessorPromParseMetricNative::ProcessEventWithCache(PipelineEventPtr& e,
+                                                           EventsContainer& newEvents,
+                                                           PipelineEventGroup& eGroup,
+                                                           TextParser& parser,
+                                                           prom::SeriesCache& cache,
+                                                           const GroupTags& targetTags) {
+    // a stream parsed event in a group of raw events, the group is marked as relabeled so it must be relabeled here
+    if (e.Is<MetricEvent>()) {
+        if (ProcessorPromRelabelMetricNative::RelabelMetric(e.Cast<MetricEvent>(), targetTags, *mScrapeConfigPtr)) {
+            newEvents.emplace_back(std::move(e));
+        }
+        return true;
+    }
+    if (!IsSupportedEvent(e)) {
+        return false;
+    }
+    StringView line = e.Cast<RawEvent>().GetContent();
+    size_t seriesLength = TextParser::GetSeriesLength(line);
+    StringView series = line.substr(0, seriesLength);
+    std::unique_ptr<MetricEvent> metricEvent = eGroup.CreateMetricEvent(true);
+
+    bool dropped = false;
+    if (seriesLength > 0 && cache.Lookup(series, *metricEvent, dropped)) {
+        ADD_COUNTER(mSeriesCacheHitsTotal, 1);
+        if (!dropped && parser.ParseSample(line, seriesLength, *metricEvent)) {
+            newEvents.emplace_back(std::move(metricEvent), true, nullptr);
+        }
+        return true;
+    }
+
+    ADD_COUNTER(mSeriesCacheMissesTotal, 1);
+    if (!parser.ParseLine(line, *metricEvent)) {
+        return true;
+    }
+    metricEvent->SetTag(string(prometheus::NAME), metricEvent->GetName());
+    if (!ProcessorPromRelabelMetricNative::RelabelMetric(*metricEvent, targetTags, *mScrapeConfigPtr)) {
+        if (seriesLength > 0) {
+            cache.Add(series, nullptr);
+        }
+        return true;
+    }
+    if (seriesLength > 0) {
+        cache.Add(series, metricEvent.get());
+    }
+    newEvents.emplace_back(std::move(metricEvent), true, nullptr);
+    return true;
+}
+
+shared_ptr<ProcessorPromParseMetricNative::TargetSeriesCache>
+ProcessorPromParseMetricNative::GetSeriesCache(StringView targetId) {
+    time_t now = time(nullptr);
+    lock_guard<mutex> lock(mSeriesCachesMutex);
+    // caches of removed targets are released after expiration
+    if (now - mLastSeriesCacheSweepTime >= 60) {
+        for (auto it = mSeriesCaches.begin(); it != mSeriesCaches.end();) {
+            if (now - it->second->mLastUsedTime > INT32_FLAG(prom_series_cache_expire_seconds)) {
+                it = mSeriesCaches.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        mLastSeriesCacheSweepTime = now;
+    }
+    auto& cache = mSeriesCaches[targetId.to_string()];
+    if (!cache) {
+        cache = make_shared<TargetSeriesCache>(INT64_FLAG(prom_series_cache_max_size));
+    }
+    cache->mLastUsedTime = now;
+    return cache;
+}
+
 } // namespace logtail
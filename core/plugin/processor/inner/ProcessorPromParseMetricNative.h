@@ -1,10 +1,16 @@
 #pragma once
 
+#include <ctime>
+
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include "collection_pipeline/plugin/interface/Processor.h"
 #include "models/PipelineEventGroup.h"
 #include "models/PipelineEventPtr.h"
+#include "prometheus/component/SeriesCache.h"
 #include "prometheus/labels/TextParser.h"
 #include "prometheus/schedulers/ScrapeConfig.h"
 
@@ -21,11 +27,39 @@ protected:
     bool IsSupportedEvent(const PipelineEventPtr&) const override;
 
 private:
+    struct TargetSeriesCache {
+        explicit TargetSeriesCache(size_t maxSize) : mCache(maxSize) {}
+
+        std::mutex mMutex;
+        prom::SeriesCache mCache;
+        // protected by mSeriesCachesMutex
+        time_t mLastUsedTime = 0;
+    };
+
     bool ProcessEvent(PipelineEventPtr&, EventsContainer&, PipelineEventGroup&, TextParser& parser);
+    // With the series cache, events are relabeled here as well, and processor_prom_relabel_metric_native will skip
+    // them.
+    bool ProcessEventWithCache(PipelineEventPtr&,
+                               EventsContainer&,
+                               PipelineEventGroup&,
+                               TextParser& parser,
+                               prom::SeriesCache& cache,
+                               const GroupTags& targetTags);
+    std::shared_ptr<TargetSeriesCache> GetSeriesCache(StringView targetId);
+
     std::unique_ptr<ScrapeConfig> mScrapeConfigPtr;
+    bool mEnableSeriesCache = false;
+
+    std::mutex mSeriesCachesMutex;
+    std::unordered_map<std::string, std::shared_ptr<TargetSeriesCache>> mSeriesCaches;
+    time_t mLastSeriesCacheSweepTime = 0;
+
+    CounterPtr mSeriesCacheHitsTotal;
+    CounterPtr mSeriesCacheMissesTotal;
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class InputPrometheusUnittest;
+    friend class ProcessorParsePrometheusMetricUnittest;
 #endif
 };
 
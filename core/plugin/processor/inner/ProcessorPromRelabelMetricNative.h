@@ -46,6 +46,10 @@ public:
     bool Init(const Json::Value& config) override;
     void Process(PipelineEventGroup& metricGroup) override;
 
+    // Apply target labels, metric relabel configs and external labels to a parsed metric event. Return false if the
+    // event is dropped.
+    static bool RelabelMetric(MetricEvent& e, const GroupTags& targetTags, const ScrapeConfig& scrapeConfig);
+
 protected:
     bool IsSupportedEvent(const PipelineEventPtr& e) const override;
 
@@ -0,0 +1,371 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "plugin/processor/inner/ProcessorSplitParseContainerLogNative.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/ParamExtractor.h"
+#include "models/LogEvent.h"
+#include "monitor/metric_constants/MetricConstants.h"
+#include "plugin/processor/inner/ProcessorParseContainerLogNative.h"
+
+namespace logtail {
+
+const std::string ProcessorSplitParseContainerLogNative::sName = "processor_split_parse_container_log_native";
+
+bool ProcessorSplitParseContainerLogNative::Init(const Json::Value& config) {
+    std::string errorMsg;
+
+    // SourceKey
+    if (!GetOptionalStringParam(config, "SourceKey", mSourceKey, errorMsg)) {
+        PARAM_WARNING_DEFAULT(mContext->GetLogger(),
+                              mContext->GetAlarm(),
+                              errorMsg,
+                              mSourceKey,
+                              sName,
+                              mContext->GetConfigName(),
+                              mContext->GetProjectName(),
+                              mContext->GetLogstoreName(),
+                              mContext->GetRegion());
+    }
+
+    // IgnoringStdout
+    if (!GetOptionalBoolParam(config, "IgnoringStdout", mIgnoringStdout, errorMsg)) {
+        PARAM_WARNING_DEFAULT(mContext->GetLogger(),
+                              mContext->GetAlarm(),
+                              errorMsg,
+                              mIgnoringStdout,
+                              sName,
+                              mContext->GetConfigName(),
+                              mContext->GetProjectName(),
+                              mContext->GetLogstoreName(),
+                              mContext->GetRegion());
+    }
+
+    // IgnoringStderr
+    if (!GetOptionalBoolParam(config, "IgnoringStderr", mIgnoringStderr, errorMsg)) {
+        PARAM_WARNING_DEFAULT(mContext->GetLogger(),
+                              mContext->GetAlarm(),
+                              errorMsg,
+                              mIgnoringStderr,
+                              sName,
+                              mContext->GetConfigName(),
+                              mContext->GetProjectName(),
+                              mContext->GetLogstoreName(),
+                              mContext->GetRegion());
+    }
+
+    // IgnoreParseWarning
+    if (!GetOptionalBoolParam(config, "IgnoreParseWarning", mIgnoreParseWarning, errorMsg)) {
+        PARAM_WARNING_DEFAULT(mContext->GetLogger(),
+                              mContext->GetAlarm(),
+                              errorMsg,
+                              mIgnoreParseWarning,
+                              sName,
+                              mContext->GetConfigName(),
+                              mContext->GetProjectName(),
+                              mContext->GetLogstoreName(),
+                              mContext->GetRegion());
+    }
+
+    // KeepingSourceWhenParseFail
+    if (!GetOptionalBoolParam(config, "KeepingSourceWhenParseFail", mKeepingSourceWhenParseFail, errorMsg)) {
+        PARAM_WARNING_DEFAULT(mContext->GetLogger(),
+                              mContext->GetAlarm(),
+                              errorMsg,
+                              mKeepingSourceWhenParseFail,
+                              sName,
+                              mContext->GetConfigName(),
+                              mContext->GetProjectName(),
+                              mContext->GetLogstoreName(),
+                              mContext->GetRegion());
+    }
+
+    mOutFailedEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_OUT_FAILED_EVENTS_TOTAL);
+    mParseStdoutTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_PARSE_STDOUT_TOTAL);
+    mParseStderrTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_PARSE_STDERR_TOTAL);
+    mMergedEventsTotal = GetMetricsRecordRef().CreateCounter(METRIC_PLUGIN_MERGED_EVENTS_TOTAL);
+
+    return true;
+}
+
+void ProcessorSplitParseContainerLogNative::Process(PipelineEventGroup& logGroup) {
+    if (logGroup.GetEvents().empty()) {
+        return;
+    }
+    StringView containerType = logGroup.GetMetadata(EventGroupMetaKey::LOG_FORMAT);
+    EventsContainer newEvents;
+    for (PipelineEventPtr& e : logGroup.MutableEvents()) {
+        ProcessEvent(logGroup, containerType, std::move(e), newEvents);
+    }
+    logGroup.SwapEvents(newEvents);
+}
+
+bool ProcessorSplitParseContainerLogNative::IsSupportedEvent(const PipelineEventPtr& e) const {
+    if (e.Is<LogEvent>()) {
+        return true;
+    }
+    LOG_ERROR(mContext->GetLogger(),
+              ("unexpected error", "unsupported log event")("processor", sName)("config", mContext->GetConfigName()));
+    mContext->GetAlarm().SendAlarm(SPLIT_LOG_FAIL_ALARM,
+                                   "unexpected error: unsupported log event.\tprocessor: " + sName
+                                       + "\tconfig: " + mContext->GetConfigName(),
+                                   mContext->GetRegion(),
+                                   mContext->GetProjectName(),
+                                   mContext->GetConfigName(),
+                                   mContext->GetLogstoreName());
+    return false;
+}
+
+void ProcessorSplitParseContainerLogNative::ProcessEvent(PipelineEventGroup& logGroup,
+                                                         StringView containerType,
+                                                         PipelineEventPtr&& e,
+                                                         EventsContainer& newEvents) {
+    if (!IsSupportedEvent(e)) {
+        newEvents.emplace_back(std::move(e));
+        return;
+    }
+    LogEvent& sourceEvent = e.Cast<LogEvent>();
+
+    std::string errorMsg;
+    if (sourceEvent.Size() != 1) {
+        errorMsg = "log event fields cnt does not equal to 1";
+    } else if (!sourceEvent.HasContent(mSourceKey)) {
+        errorMsg = "log event does not have content key";
+    }
+    if (!errorMsg.empty()) {
+        newEvents.emplace_back(std::move(e));
+        LOG_ERROR(mContext->GetLogger(),
+                  ("unexpected error", errorMsg)("processor", sName)("config", mContext->GetConfigName()));
+        mContext->GetAlarm().SendAlarm(SPLIT_LOG_FAIL_ALARM,
+                                       "unexpected error: " + errorMsg + ".\tprocessor: " + sName
+                                           + "\tconfig: " + mContext->GetConfigName(),
+                                       mContext->GetRegion(),
+                                       mContext->GetProjectName(),
+                                       mContext->GetConfigName(),
+                                       mContext->GetLogstoreName());
+        return;
+    }
+
+    const bool isContainerd = containerType == ProcessorParseContainerLogNative::CONTAINERD_TEXT;
+    const bool isDockerJson = containerType == ProcessorParseContainerLogNative::DOCKER_JSON_FILE;
+    const bool hasOffsetKey = logGroup.HasMetadata(EventGroupMetaKey::LOG_FILE_OFFSET_KEY);
+
+    StringView sourceVal = sourceEvent.GetContent(mSourceKey);
+    StringBuffer sourceKey = logGroup.GetSourceBuffer()->CopyString(mSourceKey);
+
+    // pending event made of consecutive partial lines, the content of each following line is moved right behind the
+    // content of the previous one, which is always safe since lines are visited in buffer order
+    std::unique_ptr<LogEvent> pending;
+    char* pendingBegin = nullptr;
+    char* pendingEnd = nullptr;
+    uint64_t pendingLength = 0;
+    size_t pendingCnt = 0;
+
+    size_t begin = 0;
+    while (begin < sourceVal.size()) {
+        const char* lineBegin = sourceVal.data() + begin;
+        const char* lineEnd = static_cast<const char*>(memchr(lineBegin, '\n', sourceVal.size() - begin));
+        if (lineEnd == nullptr) {
+            lineEnd = sourceVal.data() + sourceVal.size();
+        }
+        StringView line(lineBegin, lineEnd - lineBegin);
+        auto const offset = sourceEvent.GetPosition().first + begin;
+        auto const length = begin + line.size() == sourceVal.size() ? sourceEvent.GetPosition().second - begin
+                                                                     : line.size() + 1;
+        begin += line.size() + 1;
+
+        ContainerLogLine res;
+        bool isRaw = false;
+        LineParseResult result = LineParseResult::OK;
+        if (isContainerd) {
+            result = ParseContainerdTextLine(line, res, errorMsg);
+        } else if (isDockerJson) {
+            result = ParseDockerJsonLine(line, res, errorMsg);
+        } else {
+            isRaw = true;
+        }
+        if (result == LineParseResult::IGNORED) {
+            continue;
+        }
+        if (result == LineParseResult::FAIL) {
+            ADD_COUNTER(mOutFailedEventsTotal, 1);
+            SendParseFailAlarm(containerType, errorMsg);
+            if (!mKeepingSourceWhenParseFail) {
+                continue;
+            }
+            isRaw = true;
+        }
+        if (isRaw) {
+            res = ContainerLogLine();
+            res.mContent = line;
+        }
+
+        if (pending) {
+            memmove(pendingEnd, res.mContent.data(), res.mContent.size());
+            pendingEnd += res.mContent.size();
+            pendingLength += length;
+            ++pendingCnt;
+            if (!res.mIsPartial) {
+                pending->SetContentNoCopy(ProcessorParseContainerLogNative::containerLogKey,
+                                          StringView(pendingBegin, pendingEnd - pendingBegin));
+                pending->SetPosition(pending->GetPosition().first, pendingLength);
+                ADD_COUNTER(mMergedEventsTotal, pendingCnt);
+                newEvents.emplace_back(std::move(pending), true, nullptr);
+            }
+            continue;
+        }
+
+        std::unique_ptr<LogEvent> targetEvent = logGroup.CreateLogEvent(true);
+        if (isRaw) {
+            targetEvent->SetContentNoCopy(StringView(sourceKey.data, sourceKey.size), res.mContent);
+        } else {
+            targetEvent->SetContentNoCopy(ProcessorParseContainerLogNative::containerTimeKey, res.mTime);
+            targetEvent->SetContentNoCopy(ProcessorParseContainerLogNative::containerSourceKey, res.mSource);
+            targetEvent->SetContentNoCopy(ProcessorParseContainerLogNative::containerLogKey, res.mContent);
+        }
+        targetEvent->SetTimestamp(sourceEvent.GetTimestamp(), sourceEvent.GetTimestampNanosecond());
+        targetEvent->SetPosition(offset, length);
+        if (hasOffsetKey) {
+            StringBuffer offsetStr = logGroup.GetSourceBuffer()->CopyString(ToString(offset));
+            targetEvent->SetContentNoCopy(logGroup.GetMetadata(EventGroupMetaKey::LOG_FILE_OFFSET_KEY),
+                                          StringView(offsetStr.data, offsetStr.size));
+        }
+        if (res.mIsPartial) {
+            pendingBegin = const_cast<char*>(res.mContent.data());
+            pendingEnd = pendingBegin + res.mContent.size();
+            pendingLength = length;
+            pendingCnt = 1;
+            pending = std::move(targetEvent);
+        } else {
+            newEvents.emplace_back(std::move(targetEvent), true, nullptr);
+        }
+    }
+    if (pending) {
+        // the buffer ends with partial lines, output what we have as is
+        pending->SetContentNoCopy(ProcessorParseContainerLogNative::containerLogKey,
+                                  StringView(pendingBegin, pendingEnd - pendingBegin));
+        pending->SetPosition(pending->GetPosition().first, pendingLength);
+        ADD_COUNTER(mMergedEventsTotal, pendingCnt);
+        newEvents.emplace_back(std::move(pending), true, nullptr);
+    }
+}
+
+ProcessorSplitParseContainerLogNative::LineParseResult
+ProcessorSplitParseContainerLogNative::ParseContainerdTextLine(StringView line,
+                                                               ContainerLogLine& res,
+                                                               std::string& errorMsg) {
+    const char* lineEnd = line.data() + line.size();
+    // 寻找第一个分隔符位置 时间 _time_
+    const char* pch1 = std::find(line.data(), lineEnd, ProcessorParseContainerLogNative::CONTAINERD_DELIMITER);
+    if (pch1 == lineEnd) {
+        errorMsg = "time field cannot be found in log line.\tfirst 1KB log:" + line.substr(0, 1024).to_string();
+        return LineParseResult::FAIL;
+    }
+    res.mTime = StringView(line.data(), pch1 - line.data());
+
+    // 寻找第二个分隔符位置 容器标签 _source_
+    const char* pch2 = std::find(pch1 + 1, lineEnd, ProcessorParseContainerLogNative::CONTAINERD_DELIMITER);
+    if (pch2 == lineEnd) {
+        errorMsg = "source field cannot be found in log line.\tfirst 1KB log:" + line.substr(0, 1024).to_string();
+        return LineParseResult::FAIL;
+    }
+    res.mSource = StringView(pch1 + 1, pch2 - pch1 - 1);
+    if (res.mSource != "stdout" && res.mSource != "stderr") {
+        errorMsg = "source field not valid\tsource:" + res.mSource.to_string()
+            + "\tfirst 1KB log:" + line.substr(0, 1024).to_string();
+        return LineParseResult::FAIL;
+    }
+    if (CheckSource(res.mSource) == LineParseResult::IGNORED) {
+        return LineParseResult::IGNORED;
+    }
+
+    // 如果既不以 P 开头，也不以 F 开头
+    if (pch2 + 1 >= lineEnd
+        || (*(pch2 + 1) != ProcessorParseContainerLogNative::CONTAINERD_PART_TAG
+            && *(pch2 + 1) != ProcessorParseContainerLogNative::CONTAINERD_FULL_TAG)) {
+        res.mContent = StringView(pch2 + 1, lineEnd - pch2 - 1);
+        return LineParseResult::OK;
+    }
+
+    // 寻找第三个分隔符位置
+    const char* pch3 = std::find(pch2 + 1, lineEnd, ProcessorParseContainerLogNative::CONTAINERD_DELIMITER);
+    if (pch3 == lineEnd || pch3 != pch2 + 2) {
+        // case: 2021-08-25T07:00:00.000000000Z stdout P
+        // case: 2021-08-25T07:00:00.000000000Z stdout PP 1
+        res.mContent = StringView(pch2 + 1, lineEnd - pch2 - 1);
+        return LineParseResult::OK;
+    }
+    res.mContent = StringView(pch3 + 1, lineEnd - pch3 - 1);
+    res.mIsPartial = *(pch2 + 1) == ProcessorParseContainerLogNative::CONTAINERD_PART_TAG;
+    return LineParseResult::OK;
+}
+
+ProcessorSplitParseContainerLogNative::LineParseResult ProcessorSplitParseContainerLogNative::ParseDockerJsonLine(
+    StringView line, ContainerLogLine& res, std::string& errorMsg) {
+    DockerLog entry;
+    if (!ProcessorParseContainerLogNative::ParseDockerLog(const_cast<char*>(line.data()), line.size(), entry)) {
+        errorMsg = "docker stdout json log line is not a valid json obejct.\tfirst 1KB log:"
+            + line.substr(0, 1024).to_string();
+        return LineParseResult::FAIL;
+    }
+    if (entry.stream != "stdout" && entry.stream != "stderr") {
+        errorMsg = "source field cannot be found in log line.sourceValue:\t" + entry.stream.to_string()
+            + "\tfirst 1KB log:" + line.substr(0, 1024).to_string();
+        return LineParseResult::FAIL;
+    }
+    if (CheckSource(entry.stream) == LineParseResult::IGNORED) {
+        return LineParseResult::IGNORED;
+    }
+    res.mTime = entry.time;
+    res.mSource = entry.stream;
+    res.mContent = entry.log;
+    if (!res.mContent.empty() && res.mContent.back() == '\n') {
+        res.mContent = StringView(res.mContent.data(), res.mContent.size() - 1);
+    }
+    return LineParseResult::OK;
+}
+
+ProcessorSplitParseContainerLogNative::LineParseResult
+ProcessorSplitParseContainerLogNative::CheckSource(StringView source) {
+    if (source == "stdout") {
+        ADD_COUNTER(mParseStdoutTotal, 1);
+        return mIgnoringStdout ? LineParseResult::IGNORED : LineParseResult::OK;
+    }
+    ADD_COUNTER(mParseStderrTotal, 1);
+    return mIgnoringStderr ? LineParseResult::IGNORED : LineParseResult::OK;
+}
+
+void ProcessorSplitParseContainerLogNative::SendParseFailAlarm(StringView containerType, std::string& errorMsg) {
+    if (!mIgnoreParseWarning && AlarmManager::GetInstance()->IsLowLevelAlarmValid()) {
+        LOG_WARNING(sLogger,
+                    ("failed to parse log line, errorMsg", errorMsg)("container runtime", containerType)(
+                        "processor", sName)("config", mContext->GetConfigName()));
+        AlarmManager::GetInstance()->SendAlarm(PARSE_LOG_FAIL_ALARM,
+                                               "failed to parse log line, error: " + errorMsg
+                                                   + "\tcontainer runtime: " + containerType.to_string()
+                                                   + "\tprocessor: " + sName + "\tconfig: " + mContext->GetConfigName(),
+                                               GetContext().GetRegion(),
+                                               GetContext().GetProjectName(),
+                                               GetContext().GetConfigName(),
+                                               GetContext().GetLogstoreName());
+    }
+    errorMsg.clear();
+}
+
+} // namespace logtail
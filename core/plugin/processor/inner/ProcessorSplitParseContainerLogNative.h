@@ -0,0 +1,78 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "collection_pipeline/plugin/interface/Processor.h"
+#include "constants/Constants.h"
+#include "models/LogEvent.h"
+
+namespace logtail {
+
+// Fused replacement for ProcessorSplitLogStringNative + ProcessorParseContainerLogNative +
+// ProcessorMergeMultilineLogNative(flag) used by input_container_stdio. The read buffer is scanned exactly once: each
+// line is parsed in place as soon as its boundary is found, and containerd partial (P) lines are merged into the
+// pending event within the same loop.
+class ProcessorSplitParseContainerLogNative : public Processor {
+public:
+    static const std::string sName;
+
+    const std::string& Name() const override { return sName; }
+    bool Init(const Json::Value& config) override;
+    void Process(PipelineEventGroup& logGroup) override;
+
+    // Source field name.
+    std::string mSourceKey = DEFAULT_CONTENT_KEY;
+    bool mIgnoringStdout = false;
+    bool mIgnoringStderr = false;
+    bool mIgnoreParseWarning = false;
+    bool mKeepingSourceWhenParseFail = true;
+
+protected:
+    bool IsSupportedEvent(const PipelineEventPtr& e) const override;
+
+private:
+    enum class LineParseResult { OK, FAIL, IGNORED };
+
+    struct ContainerLogLine {
+        StringView mTime;
+        StringView mSource;
+        StringView mContent;
+        bool mIsPartial = false;
+    };
+
+    void ProcessEvent(PipelineEventGroup& logGroup,
+                      StringView containerType,
+                      PipelineEventPtr&& e,
+                      EventsContainer& newEvents);
+    LineParseResult ParseContainerdTextLine(StringView line, ContainerLogLine& res, std::string& errorMsg);
+    LineParseResult ParseDockerJsonLine(StringView line, ContainerLogLine& res, std::string& errorMsg);
+    LineParseResult CheckSource(StringView source);
+    void SendParseFailAlarm(StringView containerType, std::string& errorMsg);
+
+    CounterPtr mOutFailedEventsTotal;
+    CounterPtr mParseStdoutTotal;
+    CounterPtr mParseStderrTotal;
+    CounterPtr mMergedEventsTotal;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class ProcessorSplitParseContainerLogNativeUnittest;
+#endif
+};
+
+} // namespace logtail
@@ -90,9 +90,14 @@ const char* const PrometheusProto = "PrometheusProto";
 const char* const PrometheusText0_0_4 = "PrometheusText0.0.4";
 const char* const OpenMetricsText0_0_1 = "OpenMetricsText0.0.1";
 const char* const OpenMetricsText1_0_0 = "OpenMetricsText1.0.0";
+const char* const CONTENT_TYPE = "Content-Type";
+const char* const CONTENT_ENCODING = "Content-Encoding";
+const char* const PROTOBUF_CONTENT_TYPE = "application/vnd.google.protobuf";
 
 // metric labels
 const char* const JOB = "job";
+const char* const LE = "le";
+const char* const QUANTILE = "quantile";
 const std::string INSTANCE = "instance";
 const char* const ADDRESS_LABEL_NAME = "__address__";
 const char* const SCRAPE_INTERVAL_LABEL_NAME = "__scrape_interval__";
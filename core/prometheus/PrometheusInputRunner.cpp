@@ -32,6 +32,7 @@
 #include "monitor/metric_constants/MetricConstants.h"
 #include "prometheus/Constants.h"
 #include "prometheus/Utils.h"
+#include "prometheus/async/PromScrapeDispatcher.h"
 
 using namespace std;
 
@@ -64,6 +65,9 @@ PrometheusInputRunner::PrometheusInputRunner()
     mPromRegisterState = mMetricsRecordRef.CreateIntGauge(METRIC_RUNNER_CLIENT_REGISTER_STATE);
     mPromJobNum = mMetricsRecordRef.CreateIntGauge(METRIC_RUNNER_JOBS_TOTAL);
     mPromRegisterRetryTotal = mMetricsRecordRef.CreateCounter(METRIC_RUNNER_CLIENT_REGISTER_RETRY_TOTAL);
+    PromScrapeDispatcher::GetInstance()->SetMetrics(
+        mMetricsRecordRef.CreateIntGauge(METRIC_RUNNER_INFLIGHT_SCRAPES_TOTAL),
+        mMetricsRecordRef.CreateIntGauge(METRIC_RUNNER_QUEUED_SCRAPES_TOTAL));
 }
 
 /// @brief receive scrape jobs from input plugins and update scrape jobs
@@ -205,6 +209,7 @@ void PrometheusInputRunner::Stop() {
 
     LOG_INFO(sLogger, ("PrometheusInputRunner", "cancel all target subscribers"));
     CancelAllTargetSubscriber();
+    PromScrapeDispatcher::GetInstance()->Clear();
     {
         WriteLock lock(mSubscriberMapRWLock);
         mTargetSubscriberSchedulerMap.clear();
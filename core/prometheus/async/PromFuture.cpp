@@ -30,6 +30,7 @@ template <typename... Args>
 void PromFuture<Args...>::Cancel() {
     WriteLock lock(mStateRWLock);
     mState = PromFutureState::Done;
+    mCancelled = true;
 }
 
 template class PromFuture<HttpResponse&, uint64_t>;
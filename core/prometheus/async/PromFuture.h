@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <functional>
 
 #include "common/Lock.h"
@@ -18,9 +19,12 @@ public:
     void AddDoneCallback(CallbackSignature&&);
 
     void Cancel();
+    // unlike Process, this does not consume the future
+    bool IsCancelled() const { return mCancelled; }
 
 protected:
     PromFutureState mState = {PromFutureState::New};
+    std::atomic_bool mCancelled = false;
     ReadWriteLock mStateRWLock;
 
     std::vector<CallbackSignature> mDoneCallbacks;
@@ -7,6 +7,7 @@
 #include <utility>
 
 #include "common/http/HttpRequest.h"
+#include "prometheus/async/PromScrapeDispatcher.h"
 
 namespace logtail {
 
@@ -43,6 +44,10 @@ PromHttpRequest::PromHttpRequest(const std::string& method,
 }
 
 void PromHttpRequest::OnSendDone(HttpResponse& response) {
+    if (mHoldsScrapeSlot) {
+        mHoldsScrapeSlot = false;
+        PromScrapeDispatcher::GetInstance()->OnRequestDone();
+    }
     if (mFuture != nullptr) {
         mFuture->Process(
             response, std::chrono::duration_cast<std::chrono::milliseconds>(mLastSendTime.time_since_epoch()).count());
@@ -56,4 +61,9 @@ void PromHttpRequest::OnSendDone(HttpResponse& response) {
     return true;
 }
 
+[[nodiscard]] bool PromHttpRequest::IsCancelled() const {
+    return (mIsContextValidFuture != nullptr && mIsContextValidFuture->IsCancelled())
+        || (mFuture != nullptr && mFuture->IsCancelled());
+}
+
 } // namespace logtail
@@ -31,6 +31,11 @@ public:
 
     void OnSendDone(HttpResponse& response) override;
     [[nodiscard]] bool IsContextValid() const override;
+    // true if the scheduler of the request has been cancelled, does not consume the context future
+    [[nodiscard]] bool IsCancelled() const;
+
+    // set when the request is sent by PromScrapeDispatcher, whose in-flight slot is released once the request is done
+    bool mHoldsScrapeSlot = false;
 
 private:
     void SetNextExecTime(std::chrono::steady_clock::time_point execTime);
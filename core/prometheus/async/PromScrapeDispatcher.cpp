@@ -0,0 +1,169 @@
+/*
+ * Copyright 2025 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prometheus/async/PromScrapeDispatcher.h"
+
+#include <algorithm>
+
+#include "common/Flags.h"
+#include "common/http/AsynCurlRunner.h"
+#include "logger/Logger.h"
+
+DEFINE_FLAG_INT32(prom_max_inflight_scrapes,
+                  "max scrape requests in flight at the same time for all prometheus jobs, 0 means unlimited",
+                  0);
+DEFINE_FLAG_INT32(prom_max_queued_scrapes_per_job,
+                  "max scrape requests queued for one prometheus job, the oldest one is expired beyond it",
+                  1000);
+
+using namespace std;
+
+namespace logtail {
+
+void PromScrapeDispatcher::Submit(const string& jobName,
+                                  unique_ptr<PromHttpRequest>&& request,
+                                  chrono::steady_clock::time_point execTime,
+                                  chrono::seconds interval,
+                                  CounterPtr lagMs) {
+    auto expireTime = interval.count() > 0 ? execTime + interval : chrono::steady_clock::time_point::max();
+    Item item{std::move(request), execTime, expireTime, std::move(lagMs)};
+    {
+        unique_lock<mutex> lock(mMux);
+        auto limit = INT32_FLAG(prom_max_inflight_scrapes);
+        if (limit > 0 && mInFlight >= static_cast<size_t>(limit)) {
+            auto& queue = mQueues[jobName];
+            queue.emplace_back(std::move(item));
+            Item evicted;
+            if (queue.size() > static_cast<size_t>(max(1, INT32_FLAG(prom_max_queued_scrapes_per_job)))) {
+                evicted = std::move(queue.front());
+                queue.pop_front();
+            } else {
+                ++mQueued;
+            }
+            SET_GAUGE(mQueuedGauge, mQueued);
+            lock.unlock();
+            if (evicted.mRequest != nullptr) {
+                Discard(std::move(evicted));
+            }
+            return;
+        }
+        ++mInFlight;
+        mLastJob = jobName;
+        SET_GAUGE(mInFlightGauge, mInFlight);
+    }
+    Dispatch(std::move(item));
+}
+
+void PromScrapeDispatcher::OnRequestDone() {
+    while (true) {
+        Item item;
+        {
+            lock_guard<mutex> lock(mMux);
+            if (mInFlight > 0) {
+                --mInFlight;
+            }
+            auto limit = INT32_FLAG(prom_max_inflight_scrapes);
+            if ((limit > 0 && mInFlight >= static_cast<size_t>(limit)) || !PopNext(item)) {
+                SET_GAUGE(mInFlightGauge, mInFlight);
+                return;
+            }
+            // hold the slot while the context is checked, so that concurrent submits can not take it
+            ++mInFlight;
+            SET_GAUGE(mInFlightGauge, mInFlight);
+            SET_GAUGE(mQueuedGauge, mQueued);
+        }
+        // the context future has been consumed by the timer, so only cancellation and age are checked here
+        if (!item.mRequest->IsCancelled() && chrono::steady_clock::now() < item.mExpireTime) {
+            Dispatch(std::move(item));
+            return;
+        }
+        Discard(std::move(item));
+    }
+}
+
+void PromScrapeDispatcher::Clear() {
+    lock_guard<mutex> lock(mMux);
+    mQueues.clear();
+    mQueued = 0;
+    // in-flight requests still complete through OnRequestDone, which drains the counter
+    SET_GAUGE(mQueuedGauge, 0);
+}
+
+void PromScrapeDispatcher::SetMetrics(IntGaugePtr inFlight, IntGaugePtr queued) {
+    lock_guard<mutex> lock(mMux);
+    mInFlightGauge = std::move(inFlight);
+    mQueuedGauge = std::move(queued);
+}
+
+size_t PromScrapeDispatcher::GetInFlightCount() {
+    lock_guard<mutex> lock(mMux);
+    return mInFlight;
+}
+
+size_t PromScrapeDispatcher::GetQueuedCount() {
+    lock_guard<mutex> lock(mMux);
+    return mQueued;
+}
+
+void PromScrapeDispatcher::Dispatch(Item&& item) {
+    auto lag = chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - item.mExecTime).count();
+    if (lag > 0) {
+        ADD_COUNTER(item.mLagMs, lag);
+    }
+    item.mRequest->mHoldsScrapeSlot = true;
+    AsynCurlRunner::GetInstance()->AddRequest(std::move(item.mRequest));
+}
+
+void PromScrapeDispatcher::Discard(Item&& item) {
+    if (item.mRequest->IsCancelled()) {
+        LOG_DEBUG(sLogger, ("drop queued scrape request", "scheduler is cancelled")("host", item.mRequest->mHost));
+        return;
+    }
+    // complete the request as timed out, the scheduler only schedules its next scrape once the current one is done
+    LOG_DEBUG(sLogger, ("expire queued scrape request", "waited too long")("host", item.mRequest->mHost));
+    item.mRequest->mResponse.SetNetworkStatus(NetworkCode::Timeout, "scrape request expired in dispatcher queue");
+    item.mRequest->OnSendDone(item.mRequest->mResponse);
+}
+
+bool PromScrapeDispatcher::PopNext(Item& item) {
+    if (mQueues.empty()) {
+        return false;
+    }
+    auto it = mQueues.upper_bound(mLastJob);
+    if (it == mQueues.end()) {
+        it = mQueues.begin();
+    }
+    item = std::move(it->second.front());
+    it->second.pop_front();
+    --mQueued;
+    mLastJob = it->first;
+    if (it->second.empty()) {
+        mQueues.erase(it);
+    }
+    return true;
+}
+
+bool PromScrapeTimerEvent::IsValid() const {
+    return mRequest->IsContextValid();
+}
+
+bool PromScrapeTimerEvent::Execute() {
+    PromScrapeDispatcher::GetInstance()->Submit(
+        mJobName, std::move(mRequest), GetExecTime(), mInterval, std::move(mLagMs));
+    return true;
+}
+
+} // namespace logtail
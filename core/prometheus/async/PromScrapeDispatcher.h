@@ -0,0 +1,116 @@
+/*
+ * Copyright 2025 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "common/timer/TimerEvent.h"
+#include "monitor/metric_models/MetricTypes.h"
+#include "prometheus/async/PromHttpRequest.h"
+
+namespace logtail {
+
+// PromScrapeDispatcher bounds the number of scrape requests sent to AsynCurlRunner at the same time. Requests over the
+// budget are queued per job and dispatched round-robin across jobs when in-flight requests are done, so that a job
+// with many targets can not starve the others. Queued requests of cancelled schedulers are dropped, and those waiting
+// longer than their scrape interval are completed as timed out, so that their schedulers move on to the next scrape.
+class PromScrapeDispatcher {
+public:
+    PromScrapeDispatcher(const PromScrapeDispatcher&) = delete;
+    PromScrapeDispatcher& operator=(const PromScrapeDispatcher&) = delete;
+
+    static PromScrapeDispatcher* GetInstance() {
+        static PromScrapeDispatcher instance;
+        return &instance;
+    }
+
+    // execTime is the ideal fire time of the scrape, the lag between it and the actual dispatch is added to lagMs. A
+    // request still queued one interval after execTime is expired, 0 means never.
+    void Submit(const std::string& jobName,
+                std::unique_ptr<PromHttpRequest>&& request,
+                std::chrono::steady_clock::time_point execTime,
+                std::chrono::seconds interval = std::chrono::seconds::zero(),
+                CounterPtr lagMs = nullptr);
+    // Called once for each dispatched request when it is done.
+    void OnRequestDone();
+    // Drop all queued requests. In-flight ones are still counted until they are done.
+    void Clear();
+
+    void SetMetrics(IntGaugePtr inFlight, IntGaugePtr queued);
+
+    size_t GetInFlightCount();
+    size_t GetQueuedCount();
+
+private:
+    struct Item {
+        std::unique_ptr<PromHttpRequest> mRequest;
+        std::chrono::steady_clock::time_point mExecTime;
+        std::chrono::steady_clock::time_point mExpireTime;
+        CounterPtr mLagMs;
+    };
+
+    PromScrapeDispatcher() = default;
+    ~PromScrapeDispatcher() = default;
+
+    static void Dispatch(Item&& item);
+    static void Discard(Item&& item);
+    bool PopNext(Item& item);
+
+    std::mutex mMux;
+    size_t mInFlight = 0;
+    size_t mQueued = 0;
+    std::map<std::string, std::deque<Item>> mQueues;
+    // the job last dispatched from, the next queued request is taken from the job after it
+    std::string mLastJob;
+
+    IntGaugePtr mInFlightGauge;
+    IntGaugePtr mQueuedGauge;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class PromAsynUnittest;
+#endif
+};
+
+class PromScrapeTimerEvent : public TimerEvent {
+public:
+    PromScrapeTimerEvent(std::chrono::steady_clock::time_point execTime,
+                         std::string jobName,
+                         std::unique_ptr<PromHttpRequest>&& request,
+                         std::chrono::seconds interval = std::chrono::seconds::zero(),
+                         CounterPtr lagMs = nullptr)
+        : TimerEvent(execTime),
+          mJobName(std::move(jobName)),
+          mRequest(std::move(request)),
+          mInterval(interval),
+          mLagMs(std::move(lagMs)) {}
+
+    bool IsValid() const override;
+    bool Execute() override;
+
+private:
+    std::string mJobName;
+    std::unique_ptr<PromHttpRequest> mRequest;
+    std::chrono::seconds mInterval;
+    CounterPtr mLagMs;
+};
+
+} // namespace logtail
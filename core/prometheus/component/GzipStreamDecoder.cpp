@@ -0,0 +1,94 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prometheus/component/GzipStreamDecoder.h"
+
+#include <zlib.h>
+
+#include "logger/Logger.h"
+
+using namespace std;
+
+namespace logtail::prom {
+
+static const size_t kOutBufferSize = 64 * 1024;
+
+GzipStreamDecoder::GzipStreamDecoder() : mStream(make_unique<z_stream>()) {
+}
+
+GzipStreamDecoder::~GzipStreamDecoder() {
+    if (mInited) {
+        inflateEnd(mStream.get());
+    }
+}
+
+bool GzipStreamDecoder::Decode(const char* data, size_t len, const OutputCallback& callback) {
+    if (!mInited) {
+        *mStream = z_stream();
+        // 16 + MAX_WBITS: decode gzip header and trailer
+        if (inflateInit2(mStream.get(), 16 + MAX_WBITS) != Z_OK) {
+            LOG_ERROR(sLogger, ("failed to init gzip decoder", mStream->msg ? mStream->msg : ""));
+            return false;
+        }
+        mInited = true;
+        mOutBuffer.resize(kOutBufferSize);
+    }
+
+    mStream->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    mStream->avail_in = static_cast<uInt>(len);
+    // keep inflating while there is input, or the output buffer was filled up and more output may be pending
+    do {
+        if (mStreamEnd) {
+            // a new gzip member follows
+            inflateReset(mStream.get());
+            mStreamEnd = false;
+        }
+        mStream->next_out = reinterpret_cast<Bytef*>(mOutBuffer.data());
+        mStream->avail_out = static_cast<uInt>(mOutBuffer.size());
+        int ret = inflate(mStream.get(), Z_NO_FLUSH);
+        if (ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR) {
+            LOG_WARNING(sLogger, ("failed to decode gzip body", mStream->msg ? mStream->msg : "")("code", ret));
+            return false;
+        }
+        size_t produced = mOutBuffer.size() - mStream->avail_out;
+        if (produced > 0) {
+            mDecodedSize += produced;
+            if (!callback(mOutBuffer.data(), produced)) {
+                return false;
+            }
+        }
+        if (ret == Z_STREAM_END) {
+            mStreamEnd = true;
+            if (mStream->avail_in == 0) {
+                break;
+            }
+        } else if (ret == Z_BUF_ERROR && produced == 0) {
+            break;
+        }
+    } while (mStream->avail_in > 0 || mStream->avail_out == 0);
+    return true;
+}
+
+void GzipStreamDecoder::Reset() {
+    if (mInited) {
+        inflateEnd(mStream.get());
+        mInited = false;
+    }
+    mStreamEnd = false;
+    mDecodedSize = 0;
+}
+
+} // namespace logtail::prom
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <string>
+
+struct z_stream_s;
+
+namespace logtail::prom {
+
+// Incremental gzip decoder for scrape bodies, fed with the chunks passed to the curl write callback. Concatenated gzip
+// members are supported.
+class GzipStreamDecoder {
+public:
+    using OutputCallback = std::function<bool(const char* data, size_t len)>;
+
+    GzipStreamDecoder();
+    ~GzipStreamDecoder();
+    GzipStreamDecoder(const GzipStreamDecoder&) = delete;
+    GzipStreamDecoder& operator=(const GzipStreamDecoder&) = delete;
+
+    // Decompress the chunk and pass the output to callback piece by piece. Return false if the data is corrupted or
+    // the callback fails.
+    bool Decode(const char* data, size_t len, const OutputCallback& callback);
+    void Reset();
+
+    size_t GetDecodedSize() const { return mDecodedSize; }
+
+private:
+    std::unique_ptr<z_stream_s> mStream;
+    bool mInited = false;
+    bool mStreamEnd = false;
+    std::string mOutBuffer;
+    size_t mDecodedSize = 0;
+};
+
+} // namespace logtail::prom
@@ -0,0 +1,88 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prometheus/component/SeriesCache.h"
+
+using namespace std;
+
+namespace logtail::prom {
+
+void SeriesCache::StartScrape(uint64_t scrapeTimestampMilliSec) {
+    if (scrapeTimestampMilliSec == mScrapeTimestampMilliSec) {
+        return;
+    }
+    mScrapeTimestampMilliSec = scrapeTimestampMilliSec;
+    ++mGeneration;
+    for (auto it = mEntries.begin(); it != mEntries.end();) {
+        if (it->second->mLastSeen + 2 < mGeneration) {
+            it = mEntries.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+bool SeriesCache::Lookup(StringView series, MetricEvent& event, bool& dropped) {
+    auto it = mEntries.find(series);
+    if (it == mEntries.end()) {
+        return false;
+    }
+    auto& entry = *it->second;
+    entry.mLastSeen = mGeneration;
+    dropped = entry.mDropped;
+    if (dropped) {
+        return true;
+    }
+
+    auto b = event.GetSourceBuffer()->CopyString(entry.mData);
+    const char* data = b.data;
+    event.SetNameNoCopy(StringView(data, entry.mLengths[0]));
+    data += entry.mLengths[0];
+    for (size_t i = 1; i + 1 < entry.mLengths.size(); i += 2) {
+        StringView key(data, entry.mLengths[i]);
+        data += entry.mLengths[i];
+        StringView value(data, entry.mLengths[i + 1]);
+        data += entry.mLengths[i + 1];
+        event.SetTagNoCopy(key, value);
+    }
+    return true;
+}
+
+void SeriesCache::Add(StringView series, const MetricEvent* event) {
+    if (mEntries.size() >= mMaxSize) {
+        return;
+    }
+    auto entry = make_unique<Entry>();
+    entry->mSeries.assign(series.data(), series.size());
+    entry->mLastSeen = mGeneration;
+    if (event == nullptr) {
+        entry->mDropped = true;
+    } else {
+        entry->mLengths.reserve(1 + event->TagsSize() * 2);
+        entry->mData.append(event->GetName().data(), event->GetName().size());
+        entry->mLengths.push_back(event->GetName().size());
+        for (auto it = event->TagsBegin(); it != event->TagsEnd(); ++it) {
+            entry->mData.append(it->first.data(), it->first.size());
+            entry->mData.append(it->second.data(), it->second.size());
+            entry->mLengths.push_back(it->first.size());
+            entry->mLengths.push_back(it->second.size());
+        }
+    }
+    StringView key(entry->mSeries);
+    mEntries.emplace(key, std::move(entry));
+}
+
+} // namespace logtail::prom
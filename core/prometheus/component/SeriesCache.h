@@ -0,0 +1,65 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/StringView.h"
+#include "models/MetricEvent.h"
+
+namespace logtail::prom {
+
+// Cache of relabeled series of a single target, keyed by the raw series text (metric name and labels) in the
+// exposition format, like the scrape cache of Prometheus. Since almost all series stay the same between scrapes, a
+// cached series only needs its sample value and timestamp to be parsed. Not thread safe.
+class SeriesCache {
+public:
+    explicit SeriesCache(size_t maxSize) : mMaxSize(maxSize) {}
+
+    // Start a new generation when the scrape timestamp changes, and remove series missing in the last 2 scrapes.
+    void StartScrape(uint64_t scrapeTimestampMilliSec);
+
+    // Return false if series is not cached. Otherwise, dropped is set if the series is dropped by relabeling, or the
+    // name and labels of the series are copied into the source buffer of event.
+    bool Lookup(StringView series, MetricEvent& event, bool& dropped);
+    // event should be null if the series is dropped by relabeling.
+    void Add(StringView series, const MetricEvent* event);
+
+    size_t Size() const { return mEntries.size(); }
+
+private:
+    struct Entry {
+        std::string mSeries;
+        uint64_t mLastSeen = 0;
+        bool mDropped = false;
+        // metric name followed by label keys and values
+        std::string mData;
+        std::vector<uint32_t> mLengths;
+    };
+
+    std::unordered_map<StringView, std::unique_ptr<Entry>, StringViewHash, StringViewEqual> mEntries;
+    size_t mMaxSize = 0;
+    uint64_t mGeneration = 0;
+    uint64_t mScrapeTimestampMilliSec = 0;
+};
+
+} // namespace logtail::prom
@@ -13,6 +13,7 @@
 #include "common/StringTools.h"
 #include "logger/Logger.h"
 #include "models/PipelineEventGroup.h"
+#include "prometheus/Constants.h"
 #include "prometheus/Utils.h"
 #include "runner/ProcessorRunner.h"
 
@@ -20,6 +21,8 @@ DEFINE_FLAG_INT64(prom_stream_bytes_size, "stream bytes size", 1024 * 1024);
 DEFINE_FLAG_INT64(prom_max_sample_length, "max sample length", 8 * 1024);
 
 DEFINE_FLAG_BOOL(enable_prom_stream_scrape, "enable prom stream scrape", true);
+DEFINE_FLAG_BOOL(enable_prom_stream_parse, "parse prom samples while scraping instead of in processors", false);
+DEFINE_FLAG_INT64(prom_stream_parse_max_events, "max events of a stream in stream parse mode", 8192);
 
 using namespace std;
 
@@ -53,50 +56,147 @@ size_t StreamScraper::MetricWriteCallback(char* buffer, size_t size, size_t nmem
     }
 
     auto* body = static_cast<StreamScraper*>(data);
+    if (!body->mBodyFormatDetected) {
+        body->DetectBodyFormat(buffer, sizes);
+    }
+
+    bool succeeded = true;
+    if (body->mGzipDecoder) {
+        succeeded = body->mGzipDecoder->Decode(
+            buffer, sizes, [body](const char* p, size_t n) { return body->ConsumeBody(p, n); });
+    } else {
+        succeeded = body->ConsumeBody(buffer, sizes);
+    }
+    if (!succeeded) {
+        // returning a different size aborts the transfer, and the scrape fails
+        return 0;
+    }
+
+    if (BOOL_FLAG(enable_prom_stream_scrape)
+        && (body->mCurrStreamSize >= (size_t)INT64_FLAG(prom_stream_bytes_size)
+            || ((body->mParser || body->mProtobufParser)
+                && body->mEventGroup.GetEvents().size() >= (size_t)INT64_FLAG(prom_stream_parse_max_events)))) {
+        body->mStreamIndex++;
+        body->SendMetrics();
+    }
+
+    return sizes;
+}
+
+void StreamScraper::DetectBodyFormat(const char* buffer, size_t len) {
+    mBodyFormatDetected = true;
+    string contentType;
+    string contentEncoding;
+    if (mResponseHeader) {
+        auto it = mResponseHeader->find(prometheus::CONTENT_TYPE);
+        if (it != mResponseHeader->end()) {
+            contentType = it->second;
+        }
+        it = mResponseHeader->find(prometheus::CONTENT_ENCODING);
+        if (it != mResponseHeader->end()) {
+            contentEncoding = it->second;
+        }
+    }
+    // the gzip magic number is checked as well, since no text or protobuf body starts with it
+    if (contentEncoding.find(prometheus::GZIP) != string::npos
+        || (len >= 2 && static_cast<uint8_t>(buffer[0]) == 0x1f && static_cast<uint8_t>(buffer[1]) == 0x8b)) {
+        mGzipDecoder = make_unique<GzipStreamDecoder>();
+    }
+    if (StartWith(contentType, prometheus::PROTOBUF_CONTENT_TYPE)) {
+        mProtobufParser = make_unique<ProtobufParser>(mHonorTimestamps);
+        mProtobufParser->SetDefaultTimestamp(mScrapeTimestampMilliSec / 1000,
+                                             mScrapeTimestampMilliSec % 1000 * 1000000);
+        mProtobufParser->SetEventPool(true, mEventPool);
+    }
+}
+
+bool StreamScraper::ConsumeBody(const char* buffer, size_t len) {
+    if (mProtobufParser) {
+        if (!ConsumeProtobuf(buffer, len)) {
+            return false;
+        }
+    } else {
+        ConsumeText(buffer, len);
+    }
+    mRawSize += len;
+    mCurrStreamSize += len;
+    return true;
+}
 
+void StreamScraper::ConsumeText(const char* buffer, size_t len) {
     size_t begin = 0;
-    for (size_t end = begin; end < sizes; ++end) {
+    for (size_t end = begin; end < len; ++end) {
         if (buffer[end] == '\n') {
-            if (begin == 0 && !body->mCache.empty()) {
-                body->mCache.append(buffer, end);
-                body->AddEvent(body->mCache.data(), body->mCache.size());
-                body->mCache.clear();
+            if (begin == 0 && !mCache.empty()) {
+                mCache.append(buffer, end);
+                AddEvent(mCache.data(), mCache.size());
+                mCache.clear();
             } else if (begin != end) {
-                body->AddEvent(buffer + begin, end - begin);
+                AddEvent(buffer + begin, end - begin);
             }
             begin = end + 1;
         }
     }
 
-    if (begin < sizes) {
-        body->mCache.append(buffer + begin, sizes - begin);
+    if (begin < len) {
+        mCache.append(buffer + begin, len - begin);
         // limit the last line cache size to prom_max_sample_length bytes
-        if (body->mCache.size() > mMaxSampleLength) {
+        if (mCache.size() > mMaxSampleLength) {
             LOG_WARNING(sLogger, ("stream scraper", "cache is too large, drop it."));
-            body->mCache.clear();
+            mCache.clear();
         }
     }
-    body->mRawSize += sizes;
-    body->mCurrStreamSize += sizes;
+}
 
-    if (BOOL_FLAG(enable_prom_stream_scrape) && body->mCurrStreamSize >= (size_t)INT64_FLAG(prom_stream_bytes_size)) {
-        body->mStreamIndex++;
-        body->SendMetrics();
+bool StreamScraper::ConsumeProtobuf(const char* buffer, size_t len) {
+    auto& events = mEventGroup.MutableEvents();
+    size_t begin = events.size();
+    if (!mProtobufParser->Feed(buffer, len, mEventGroup)) {
+        LOG_WARNING(sLogger, ("stream scraper", "invalid protobuf body")("target", mHash));
+        return false;
     }
-
-    return sizes;
+    for (size_t i = begin; i < events.size(); ++i) {
+        auto& e = events[i].Cast<MetricEvent>();
+        e.SetTagNoCopy(prometheus::NAME, e.GetName());
+    }
+    mScrapeSamplesScraped += events.size() - begin;
+    return true;
 }
 
 void StreamScraper::AddEvent(const char* line, size_t len) {
-    if (IsValidMetric(StringView(line, len))) {
-        auto* e = mEventGroup.AddRawEvent(true, mEventPool);
-        auto sb = mEventGroup.GetSourceBuffer()->CopyString(line, len);
-        e->SetContentNoCopy(sb);
-        mScrapeSamplesScraped++;
+    if (!IsValidMetric(StringView(line, len))) {
+        return;
     }
+    mScrapeSamplesScraped++;
+    auto sb = mEventGroup.GetSourceBuffer()->CopyString(line, len);
+    if (mParser) {
+        // name and labels point to the copied line in the source buffer of the current stream
+        auto e = mEventGroup.CreateMetricEvent(true, mEventPool);
+        if (mParser->ParseLine(StringView(sb.data, sb.size), *e)) {
+            e->SetTagNoCopy(prometheus::NAME, e->GetName());
+            mEventGroup.MutableEvents().emplace_back(std::move(e), true, mEventPool);
+        }
+        return;
+    }
+    auto* e = mEventGroup.AddRawEvent(true, mEventPool);
+    e->SetContentNoCopy(sb);
+}
+
+void StreamScraper::EnableStreamParse(bool honorTimestamps) {
+    mHonorTimestamps = honorTimestamps;
+    mParser = std::make_unique<TextParser>(honorTimestamps);
+    mParser->SetDefaultTimestamp(mScrapeTimestampMilliSec / 1000, mScrapeTimestampMilliSec % 1000 * 1000000);
+}
+
+void StreamScraper::SetResponseHeader(const std::map<std::string, std::string, decltype(compareHeader)*>* header) {
+    mResponseHeader = header;
 }
 
 void StreamScraper::FlushCache() {
+    if (mProtobufParser && mProtobufParser->HasPendingData()) {
+        LOG_WARNING(sLogger, ("stream scraper", "protobuf body is truncated")("target", mHash));
+        mProtobufParser->Reset();
+    }
     if (!mCache.empty()) {
         AddEvent(mCache.data(), mCache.size());
         mCache.clear();
@@ -144,6 +244,9 @@ void StreamScraper::Reset() {
     mCache.clear();
     mStreamIndex = 0;
     mScrapeSamplesScraped = 0;
+    mBodyFormatDetected = false;
+    mGzipDecoder.reset();
+    mProtobufParser.reset();
 }
 
 void StreamScraper::SetAutoMetricMeta(double scrapeDurationSeconds, bool upState, const string& scrapeState) {
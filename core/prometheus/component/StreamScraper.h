@@ -6,12 +6,20 @@
 
 #include "Labels.h"
 #include "collection_pipeline/queue/QueueKey.h"
+#include "common/http/HttpResponse.h"
 #include "models/PipelineEventGroup.h"
+#include "prometheus/component/GzipStreamDecoder.h"
+#include "prometheus/labels/ProtobufParser.h"
+#include "prometheus/labels/TextParser.h"
 
 #ifdef APSARA_UNIT_TEST_MAIN
 #include <vector>
 
 #include "collection_pipeline/queue/ProcessQueueItem.h"
+
+namespace logtail {
+class TextParserBenchmark;
+} // namespace logtail
 #endif
 
 namespace logtail::prom {
@@ -28,12 +36,21 @@ public:
     void SendMetrics();
     void Reset();
     void SetAutoMetricMeta(double scrapeDurationSeconds, bool upState, const std::string& scrapeState);
+    // Parse samples as soon as lines arrive and send MetricEvents instead of RawEvents.
+    void EnableStreamParse(bool honorTimestamps);
+    // Headers of the response, which are used to pick the body decoder, i.e. text or protobuf, and gzip.
+    void SetResponseHeader(const std::map<std::string, std::string, decltype(compareHeader)*>* header);
+    void SetHonorTimestamps(bool honorTimestamps) { mHonorTimestamps = honorTimestamps; }
 
     size_t mRawSize = 0;
     static size_t mMaxSampleLength;
     uint64_t mStreamIndex = 0;
 
 private:
+    void DetectBodyFormat(const char* buffer, size_t len);
+    bool ConsumeBody(const char* buffer, size_t len);
+    void ConsumeText(const char* buffer, size_t len);
+    bool ConsumeProtobuf(const char* buffer, size_t len);
     void AddEvent(const char* line, size_t len);
     void PushEventGroup(PipelineEventGroup&&) const;
     void SetTargetLabels(PipelineEventGroup& eGroup) const;
@@ -53,12 +70,24 @@ private:
 
     Labels mTargetLabels;
 
+    // only set in stream parse mode
+    std::unique_ptr<TextParser> mParser;
+    bool mHonorTimestamps = true;
+
+    const std::map<std::string, std::string, decltype(compareHeader)*>* mResponseHeader = nullptr;
+    bool mBodyFormatDetected = false;
+    // set when the body is gzip encoded
+    std::unique_ptr<GzipStreamDecoder> mGzipDecoder;
+    // set when the body is in the protobuf exposition format, which is always decoded into MetricEvents
+    std::unique_ptr<ProtobufParser> mProtobufParser;
+
     // auto metrics
     uint64_t mScrapeTimestampMilliSec = 0;
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class ProcessorParsePrometheusMetricUnittest;
     friend class ScrapeSchedulerUnittest;
     friend class StreamScraperUnittest;
+    friend class logtail::TextParserBenchmark;
     mutable std::vector<std::shared_ptr<ProcessQueueItem>> mItem;
 #endif
 };
@@ -0,0 +1,522 @@
+/*
+ * Copyright 2025 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prometheus/labels/ProtobufParser.h"
+
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#include "common/Flags.h"
+#include "logger/Logger.h"
+#include "prometheus/Constants.h"
+
+DEFINE_FLAG_INT64(prom_protobuf_max_message_size, "max size of a single MetricFamily message", 64 * 1024 * 1024);
+
+using namespace std;
+
+namespace logtail {
+
+namespace {
+
+// io.prometheus.client.MetricType
+enum MetricType { COUNTER = 0, GAUGE = 1, SUMMARY = 2, UNTYPED = 3, HISTOGRAM = 4, GAUGE_HISTOGRAM = 5 };
+
+enum WireType { VARINT = 0, FIXED64 = 1, LENGTH_DELIMITED = 2, FIXED32 = 5 };
+
+// Minimal reader for the protobuf wire format. Only the field types used by metrics.proto are supported.
+class WireReader {
+public:
+    WireReader(const char* data, size_t len) : mCur(data), mEnd(data + len) {}
+
+    bool Done() const { return mCur >= mEnd; }
+    bool Failed() const { return mFailed; }
+
+    bool Next(uint32_t& field, uint32_t& wireType) {
+        uint64_t key = 0;
+        if (!ReadVarint(key)) {
+            return false;
+        }
+        field = static_cast<uint32_t>(key >> 3);
+        wireType = static_cast<uint32_t>(key & 7);
+        return true;
+    }
+
+    bool ReadVarint(uint64_t& v) {
+        v = 0;
+        for (int shift = 0; shift < 64 && mCur < mEnd; shift += 7) {
+            auto b = static_cast<uint8_t>(*mCur++);
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if ((b & 0x80) == 0) {
+                return true;
+            }
+        }
+        mFailed = true;
+        return false;
+    }
+
+    bool ReadDouble(double& v) {
+        if (mEnd - mCur < 8) {
+            mFailed = true;
+            return false;
+        }
+        // metrics are always produced on little endian hosts
+        memcpy(&v, mCur, 8);
+        mCur += 8;
+        return true;
+    }
+
+    bool ReadBytes(StringView& v) {
+        uint64_t len = 0;
+        if (!ReadVarint(len)) {
+            return false;
+        }
+        if (static_cast<uint64_t>(mEnd - mCur) < len) {
+            mFailed = true;
+            return false;
+        }
+        v = StringView(mCur, len);
+        mCur += len;
+        return true;
+    }
+
+    bool Skip(uint32_t wireType) {
+        uint64_t tmp = 0;
+        StringView bytes;
+        switch (wireType) {
+            case VARINT:
+                return ReadVarint(tmp);
+            case FIXED64:
+                if (mEnd - mCur < 8) {
+                    break;
+                }
+                mCur += 8;
+                return true;
+            case LENGTH_DELIMITED:
+                return ReadBytes(bytes);
+            case FIXED32:
+                if (mEnd - mCur < 4) {
+                    break;
+                }
+                mCur += 4;
+                return true;
+            default:
+                break;
+        }
+        mFailed = true;
+        return false;
+    }
+
+private:
+    const char* mCur;
+    const char* mEnd;
+    bool mFailed = false;
+};
+
+// Read the length prefix of a delimited message. Return false if more data is needed, and set malformed if the
+// prefix can never be valid.
+bool ReadLengthPrefix(const char* data, size_t len, uint64_t& msgLen, size_t& prefixLen, bool& malformed) {
+    msgLen = 0;
+    for (size_t i = 0; i < len && i < 10; ++i) {
+        auto b = static_cast<uint8_t>(data[i]);
+        msgLen |= static_cast<uint64_t>(b & 0x7f) << (7 * i);
+        if ((b & 0x80) == 0) {
+            prefixLen = i + 1;
+            return true;
+        }
+    }
+    malformed = len >= 10;
+    return false;
+}
+
+// Read the value of Gauge, Counter and Untyped, which are all at field 1.
+bool ReadSimpleValue(StringView msg, double& value) {
+    WireReader reader(msg.data(), msg.size());
+    uint32_t field = 0;
+    uint32_t wireType = 0;
+    while (!reader.Done() && reader.Next(field, wireType)) {
+        if (field == 1 && wireType == FIXED64) {
+            if (!reader.ReadDouble(value)) {
+                return false;
+            }
+        } else if (!reader.Skip(wireType)) {
+            return false;
+        }
+    }
+    return !reader.Failed();
+}
+
+} // namespace
+
+ProtobufParser::ProtobufParser(bool honorTimestamps) : mHonorTimestamps(honorTimestamps) {
+}
+
+void ProtobufParser::SetDefaultTimestamp(uint64_t defaultTimestamp, uint32_t defaultNanoSec) {
+    mDefaultTimestamp = defaultTimestamp;
+    mDefaultNanoTimestamp = defaultNanoSec;
+}
+
+void ProtobufParser::SetEventPool(bool fromPool, EventPool* eventPool) {
+    mFromPool = fromPool;
+    mEventPool = eventPool;
+}
+
+PipelineEventGroup ProtobufParser::Parse(const string& content, uint64_t defaultTimestamp, uint32_t defaultNanoSec) {
+    SetDefaultTimestamp(defaultTimestamp, defaultNanoSec);
+    auto eGroup = PipelineEventGroup(make_shared<SourceBuffer>());
+    if (!Feed(content.data(), content.size(), eGroup) || HasPendingData()) {
+        LOG_WARNING(sLogger, ("protobuf parser error", "truncated or malformed content"));
+    }
+    Reset();
+    return eGroup;
+}
+
+bool ProtobufParser::Feed(const char* data, size_t len, PipelineEventGroup& eGroup) {
+    uint64_t msgLen = 0;
+    size_t prefixLen = 0;
+    bool malformed = false;
+    // complete the message left by the previous chunk first
+    while (!mPending.empty() && len > 0) {
+        if (!ReadLengthPrefix(mPending.data(), mPending.size(), msgLen, prefixLen, malformed)) {
+            if (malformed) {
+                return false;
+            }
+            mPending.push_back(*data++);
+            --len;
+            continue;
+        }
+        if (msgLen > (uint64_t)INT64_FLAG(prom_protobuf_max_message_size)) {
+            LOG_WARNING(sLogger, ("protobuf message is too large", msgLen));
+            return false;
+        }
+        size_t n = min(prefixLen + msgLen - mPending.size(), len);
+        mPending.append(data, n);
+        data += n;
+        len -= n;
+        if (mPending.size() == prefixLen + msgLen) {
+            bool res = ParseMessageAt(mPending.data() + prefixLen, msgLen, eGroup);
+            mPending.clear();
+            if (!res) {
+                return false;
+            }
+        }
+    }
+
+    while (len > 0) {
+        if (!ReadLengthPrefix(data, len, msgLen, prefixLen, malformed)) {
+            if (malformed) {
+                return false;
+            }
+            mPending.assign(data, len);
+            return true;
+        }
+        if (msgLen > (uint64_t)INT64_FLAG(prom_protobuf_max_message_size)) {
+            LOG_WARNING(sLogger, ("protobuf message is too large", msgLen));
+            return false;
+        }
+        if (prefixLen + msgLen > len) {
+            mPending.reserve(prefixLen + msgLen);
+            mPending.assign(data, len);
+            return true;
+        }
+        if (!ParseMessageAt(data + prefixLen, msgLen, eGroup)) {
+            return false;
+        }
+        data += prefixLen + msgLen;
+        len -= prefixLen + msgLen;
+    }
+    return true;
+}
+
+bool ProtobufParser::ParseMessageAt(const char* data, size_t len, PipelineEventGroup& eGroup) {
+    if (len == 0) {
+        return true;
+    }
+    // names and label pairs of all metrics in the family point to this copy
+    auto sb = eGroup.GetSourceBuffer()->CopyString(data, len);
+    return ParseMetricFamily(StringView(sb.data, sb.size), eGroup);
+}
+
+bool ProtobufParser::ParseMetricFamily(StringView msg, PipelineEventGroup& eGroup) {
+    static thread_local vector<StringView> sMetrics;
+    sMetrics.clear();
+    StringView name;
+    uint64_t type = COUNTER;
+
+    WireReader reader(msg.data(), msg.size());
+    uint32_t field = 0;
+    uint32_t wireType = 0;
+    while (!reader.Done() && reader.Next(field, wireType)) {
+        if (field == 1 && wireType == LENGTH_DELIMITED) {
+            reader.ReadBytes(name);
+        } else if (field == 3 && wireType == VARINT) {
+            reader.ReadVarint(type);
+        } else if (field == 4 && wireType == LENGTH_DELIMITED) {
+            sMetrics.emplace_back();
+            reader.ReadBytes(sMetrics.back());
+        } else {
+            reader.Skip(wireType);
+        }
+    }
+    if (reader.Failed() || name.empty()) {
+        return false;
+    }
+
+    // derived series names are built once per family
+    StringView bucketName;
+    StringView sumName;
+    StringView countName;
+    if (type == SUMMARY || type == HISTOGRAM || type == GAUGE_HISTOGRAM) {
+        auto makeName = [&](const char* suffix) {
+            string s = name.to_string() + suffix;
+            auto b = eGroup.GetSourceBuffer()->CopyString(s);
+            return StringView(b.data, b.size);
+        };
+        bucketName = makeName("_bucket");
+        sumName = makeName(type == GAUGE_HISTOGRAM ? "_gsum" : "_sum");
+        countName = makeName(type == GAUGE_HISTOGRAM ? "_gcount" : "_count");
+    }
+
+    for (const auto& metric : sMetrics) {
+        mLabels.clear();
+        int64_t timestampMs = -1;
+        StringView gauge;
+        StringView counter;
+        StringView summary;
+        StringView untyped;
+        StringView histogram;
+        WireReader metricReader(metric.data(), metric.size());
+        while (!metricReader.Done() && metricReader.Next(field, wireType)) {
+            if (wireType == LENGTH_DELIMITED && field == 1) {
+                StringView pair;
+                if (!metricReader.ReadBytes(pair)) {
+                    break;
+                }
+                StringView labelName;
+                StringView labelValue;
+                WireReader pairReader(pair.data(), pair.size());
+                uint32_t pairField = 0;
+                uint32_t pairWireType = 0;
+                while (!pairReader.Done() && pairReader.Next(pairField, pairWireType)) {
+                    if (pairField == 1 && pairWireType == LENGTH_DELIMITED) {
+                        pairReader.ReadBytes(labelName);
+                    } else if (pairField == 2 && pairWireType == LENGTH_DELIMITED) {
+                        pairReader.ReadBytes(labelValue);
+                    } else {
+                        pairReader.Skip(pairWireType);
+                    }
+                }
+                if (pairReader.Failed()) {
+                    return false;
+                }
+                mLabels.emplace_back(labelName, labelValue);
+            } else if (wireType == LENGTH_DELIMITED && field == 2) {
+                metricReader.ReadBytes(gauge);
+            } else if (wireType == LENGTH_DELIMITED && field == 3) {
+                metricReader.ReadBytes(counter);
+            } else if (wireType == LENGTH_DELIMITED && field == 4) {
+                metricReader.ReadBytes(summary);
+            } else if (wireType == LENGTH_DELIMITED && field == 5) {
+                metricReader.ReadBytes(untyped);
+            } else if (wireType == LENGTH_DELIMITED && field == 7) {
+                metricReader.ReadBytes(histogram);
+            } else if (wireType == VARINT && field == 6) {
+                uint64_t ts = 0;
+                metricReader.ReadVarint(ts);
+                timestampMs = static_cast<int64_t>(ts);
+            } else {
+                metricReader.Skip(wireType);
+            }
+        }
+        if (metricReader.Failed()) {
+            return false;
+        }
+
+        switch (type) {
+            case COUNTER:
+            case GAUGE:
+            case UNTYPED: {
+                double value = 0;
+                if (!ReadSimpleValue(type == COUNTER ? counter : (type == GAUGE ? gauge : untyped), value)) {
+                    return false;
+                }
+                AddSample(eGroup, name, value, timestampMs);
+                break;
+            }
+            case SUMMARY: {
+                uint64_t count = 0;
+                double sum = 0;
+                WireReader r(summary.data(), summary.size());
+                while (!r.Done() && r.Next(field, wireType)) {
+                    if (field == 1 && wireType == VARINT) {
+                        r.ReadVarint(count);
+                    } else if (field == 2 && wireType == FIXED64) {
+                        r.ReadDouble(sum);
+                    } else if (field == 3 && wireType == LENGTH_DELIMITED) {
+                        StringView quantile;
+                        r.ReadBytes(quantile);
+                        double q = 0;
+                        double v = 0;
+                        WireReader qr(quantile.data(), quantile.size());
+                        uint32_t qField = 0;
+                        uint32_t qWireType = 0;
+                        while (!qr.Done() && qr.Next(qField, qWireType)) {
+                            if (qField == 1 && qWireType == FIXED64) {
+                                qr.ReadDouble(q);
+                            } else if (qField == 2 && qWireType == FIXED64) {
+                                qr.ReadDouble(v);
+                            } else {
+                                qr.Skip(qWireType);
+                            }
+                        }
+                        if (qr.Failed()) {
+                            return false;
+                        }
+                        FormatFloat(q, mFloatStr);
+                        auto b = eGroup.GetSourceBuffer()->CopyString(mFloatStr);
+                        AddSample(eGroup, name, v, timestampMs, prometheus::QUANTILE, StringView(b.data, b.size));
+                    } else {
+                        r.Skip(wireType);
+                    }
+                }
+                if (r.Failed()) {
+                    return false;
+                }
+                AddSample(eGroup, sumName, sum, timestampMs);
+                AddSample(eGroup, countName, static_cast<double>(count), timestampMs);
+                break;
+            }
+            case HISTOGRAM:
+            case GAUGE_HISTOGRAM: {
+                uint64_t count = 0;
+                double countFloat = -1;
+                double sum = 0;
+                bool hasInfBucket = false;
+                size_t bucketCnt = 0;
+                WireReader r(histogram.data(), histogram.size());
+                while (!r.Done() && r.Next(field, wireType)) {
+                    if (field == 1 && wireType == VARINT) {
+                        r.ReadVarint(count);
+                    } else if (field == 4 && wireType == FIXED64) {
+                        r.ReadDouble(countFloat);
+                    } else if (field == 2 && wireType == FIXED64) {
+                        r.ReadDouble(sum);
+                    } else if (field == 3 && wireType == LENGTH_DELIMITED) {
+                        StringView bucket;
+                        r.ReadBytes(bucket);
+                        uint64_t cumulative = 0;
+                        double cumulativeFloat = -1;
+                        double upperBound = 0;
+                        WireReader br(bucket.data(), bucket.size());
+                        uint32_t bField = 0;
+                        uint32_t bWireType = 0;
+                        while (!br.Done() && br.Next(bField, bWireType)) {
+                            if (bField == 1 && bWireType == VARINT) {
+                                br.ReadVarint(cumulative);
+                            } else if (bField == 4 && bWireType == FIXED64) {
+                                br.ReadDouble(cumulativeFloat);
+                            } else if (bField == 2 && bWireType == FIXED64) {
+                                br.ReadDouble(upperBound);
+                            } else {
+                                br.Skip(bWireType);
+                            }
+                        }
+                        if (br.Failed()) {
+                            return false;
+                        }
+                        hasInfBucket = std::isinf(upperBound) && upperBound > 0;
+                        FormatFloat(upperBound, mFloatStr);
+                        auto b = eGroup.GetSourceBuffer()->CopyString(mFloatStr);
+                        AddSample(eGroup,
+                                  bucketName,
+                                  cumulativeFloat >= 0 ? cumulativeFloat : static_cast<double>(cumulative),
+                                  timestampMs,
+                                  prometheus::LE,
+                                  StringView(b.data, b.size));
+                        ++bucketCnt;
+                    } else {
+                        // native histogram fields are not converted
+                        r.Skip(wireType);
+                    }
+                }
+                if (r.Failed()) {
+                    return false;
+                }
+                double total = countFloat >= 0 ? countFloat : static_cast<double>(count);
+                // the +Inf bucket is implicit in the protobuf format
+                if (bucketCnt > 0 && !hasInfBucket) {
+                    AddSample(eGroup, bucketName, total, timestampMs, prometheus::LE, "+Inf");
+                }
+                AddSample(eGroup, sumName, sum, timestampMs);
+                AddSample(eGroup, countName, total, timestampMs);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return true;
+}
+
+void ProtobufParser::AddSample(PipelineEventGroup& eGroup,
+                               StringView name,
+                               double value,
+                               int64_t timestampMs,
+                               StringView extraLabelName,
+                               StringView extraLabelValue) {
+    auto e = eGroup.CreateMetricEvent(mFromPool, mEventPool);
+    e->SetNameNoCopy(name);
+    for (const auto& [k, v] : mLabels) {
+        e->SetTagNoCopy(k, v);
+    }
+    if (!extraLabelName.empty()) {
+        e->SetTagNoCopy(extraLabelName, extraLabelValue);
+    }
+    e->SetValue<UntypedSingleValue>(value);
+    if (mHonorTimestamps && timestampMs >= 0) {
+        e->SetTimestamp(timestampMs / 1000, (timestampMs % 1000) * 1000000);
+    } else {
+        e->SetTimestamp(mDefaultTimestamp, mDefaultNanoTimestamp);
+    }
+    eGroup.MutableEvents().emplace_back(std::move(e), mFromPool, mEventPool);
+}
+
+void ProtobufParser::FormatFloat(double value, string& out) {
+    if (std::isnan(value)) {
+        out = "NaN";
+        return;
+    }
+    if (std::isinf(value)) {
+        out = value > 0 ? "+Inf" : "-Inf";
+        return;
+    }
+    // same as strconv.FormatFloat(value, 'g', -1, 64) of go: the shortest representation, in exponent form only if
+    // the exponent is less than -4 or not less than 6
+    char buf[64];
+    auto res = to_chars(buf, buf + sizeof(buf), value, chars_format::scientific);
+    const char* e = static_cast<const char*>(memchr(buf, 'e', res.ptr - buf));
+    int exp = 0;
+    from_chars(e + (e[1] == '+' ? 2 : 1), res.ptr, exp);
+    if (exp < -4 || exp >= 6) {
+        out.assign(buf, res.ptr);
+        return;
+    }
+    res = to_chars(buf, buf + sizeof(buf), value, chars_format::fixed);
+    out.assign(buf, res.ptr);
+}
+
+} // namespace logtail
@@ -0,0 +1,79 @@
+/*
+ * Copyright 2025 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "models/MetricEvent.h"
+#include "models/PipelineEventGroup.h"
+
+namespace logtail {
+
+// ProtobufParser decodes the delimited protobuf exposition format, i.e.
+// application/vnd.google.protobuf;proto=io.prometheus.client.MetricFamily;encoding=delimited, into MetricEvents of the
+// same shape as the ones produced by TextParser. Summaries and classic histograms are expanded into their
+// quantile/_bucket, _sum and _count series.
+class ProtobufParser {
+public:
+    ProtobufParser() = default;
+    explicit ProtobufParser(bool honorTimestamps);
+
+    void SetDefaultTimestamp(uint64_t defaultTimestamp, uint32_t defaultNanoSec);
+    void SetEventPool(bool fromPool, EventPool* eventPool);
+
+    PipelineEventGroup Parse(const std::string& content, uint64_t defaultTimestamp, uint32_t defaultNanoSec);
+
+    // Feed the next chunk of a delimited stream. Each complete message is copied into the SourceBuffer of eGroup and
+    // decoded, and a trailing incomplete message is kept until the next call. Return false if the stream is malformed.
+    bool Feed(const char* data, size_t len, PipelineEventGroup& eGroup);
+    // Decode one MetricFamily message, which must be owned by the SourceBuffer of eGroup.
+    bool ParseMetricFamily(StringView msg, PipelineEventGroup& eGroup);
+
+    bool HasPendingData() const { return !mPending.empty(); }
+    void Reset() { mPending.clear(); }
+
+    // Format a float label value, e.g. le and quantile, the same way as the Prometheus client libraries.
+    static void FormatFloat(double value, std::string& out);
+
+private:
+    bool ParseMessageAt(const char* data, size_t len, PipelineEventGroup& eGroup);
+    void AddSample(PipelineEventGroup& eGroup,
+                   StringView name,
+                   double value,
+                   int64_t timestampMs,
+                   StringView extraLabelName = StringView(),
+                   StringView extraLabelValue = StringView());
+
+    std::string mPending;
+    std::string mFloatStr;
+    // labels of the metric being decoded
+    std::vector<std::pair<StringView, StringView>> mLabels;
+
+    bool mHonorTimestamps{true};
+    time_t mDefaultTimestamp{0};
+    uint32_t mDefaultNanoTimestamp{0};
+    bool mFromPool{false};
+    EventPool* mEventPool{nullptr};
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class ProtobufParserUnittest;
+#endif
+};
+
+} // namespace logtail
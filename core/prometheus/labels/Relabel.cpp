@@ -28,6 +28,7 @@
 #include "common/StringTools.h"
 #include "logger/Logger.h"
 #include "prometheus/Constants.h"
+#include "prometheus/labels/RelabelProgram.h"
 
 using namespace std;
 
@@ -79,8 +80,9 @@ const std::string& ActionToString(Action action) {
     }
     return sUndefined;
 }
-RelabelConfig::RelabelConfig() : mSeparator(";"), mReplacement("$1"), mAction(Action::REPLACE) {
-    mRegex = boost::regex("().*");
+RelabelConfig::RelabelConfig()
+    : mSeparator(";"), mRegexPattern("().*"), mReplacement("$1"), mAction(Action::REPLACE) {
+    mRegex = boost::regex(mRegexPattern);
 }
 bool RelabelConfig::Init(const Json::Value& config) {
     string errorMsg;
@@ -98,8 +100,8 @@ bool RelabelConfig::Init(const Json::Value& config) {
     }
 
     if (config.isMember(prometheus::REGEX) && config[prometheus::REGEX].isString()) {
-        string re = config[prometheus::REGEX].asString();
-        mRegex = boost::regex(re);
+        mRegexPattern = config[prometheus::REGEX].asString();
+        mRegex = boost::regex(mRegexPattern);
     }
 
     if (config.isMember(prometheus::REPLACEMENT) && config[prometheus::REPLACEMENT].isString()) {
@@ -264,6 +266,12 @@ bool RelabelConfigList::Init(const Json::Value& relabelConfigs) {
             return false;
         }
     }
+    auto program = make_shared<RelabelProgram>();
+    if (program->Compile(mRelabelConfigs)) {
+        mProgram = std::move(program);
+    } else {
+        LOG_WARNING(sLogger, ("failed to compile relabel configs", "fall back to boost regex"));
+    }
     return true;
 }
 
@@ -277,6 +285,9 @@ bool RelabelConfigList::Process(Labels& l) const {
 }
 
 bool RelabelConfigList::Process(MetricEvent& event) const {
+    if (mProgram) {
+        return mProgram->Run(event);
+    }
     Labels labels;
     labels.Reset(&event);
     return Process(labels);
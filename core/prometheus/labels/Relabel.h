@@ -18,6 +18,7 @@
 #include <json/json.h>
 
 #include <boost/regex.hpp>
+#include <memory>
 #include <string>
 
 #include "prometheus/labels/Labels.h"
@@ -56,6 +57,8 @@ public:
     std::string mSeparator;
     // Regex against which the concatenation is matched.
     boost::regex mRegex;
+    // Source of mRegex, compiled again with RE2 by RelabelProgram.
+    std::string mRegexPattern;
     // Modulus to take of the hash of concatenated values from the source labels.
     uint64_t mModulus = 0;
     // TargetLabel is the label to which the resulting string is written in a replacement.
@@ -71,6 +74,8 @@ public:
 private:
 };
 
+class RelabelProgram;
+
 class RelabelConfigList {
 public:
     bool Init(const Json::Value& relabelConfigs);
@@ -81,6 +86,8 @@ public:
 
 private:
     std::vector<RelabelConfig> mRelabelConfigs;
+    // compiled form of mRelabelConfigs for metric relabeling, shared between copies of the list
+    std::shared_ptr<const RelabelProgram> mProgram;
 
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class RelabelConfigUnittest;
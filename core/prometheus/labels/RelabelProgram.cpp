@@ -0,0 +1,488 @@
+/*
+ * Copyright 2025 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "prometheus/labels/RelabelProgram.h"
+
+#include <openssl/md5.h>
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <string_view>
+
+#include "logger/Logger.h"
+#include "prometheus/Constants.h"
+#include "prometheus/labels/Relabel.h"
+
+using namespace std;
+
+namespace logtail {
+
+namespace {
+
+bool IsLiteral(StringView s, bool allowAlternation) {
+    for (char c : s) {
+        if (c == '|' && allowAlternation) {
+            continue;
+        }
+        if (strchr("\\.+*?()[]{}|^$", c) != nullptr) {
+            return false;
+        }
+    }
+    return true;
+}
+
+inline bool IsNameChar(char c) {
+    return c == '_' || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+}
+
+// Set the tag to a value which already lives in the event's SourceBuffer. The key is only copied if it is new.
+void SetTagValueNoCopy(MetricEvent& event, StringView key, StringView val) {
+    if (event.HasTag(key)) {
+        event.SetTagNoCopy(key, val);
+    } else {
+        auto b = event.GetSourceBuffer()->CopyString(key);
+        event.SetTagNoCopy(StringView(b.data, b.size), val);
+    }
+}
+
+void SetTagValue(MetricEvent& event, StringView key, StringView val) {
+    auto b = event.GetSourceBuffer()->CopyString(val);
+    SetTagValueNoCopy(event, key, StringView(b.data, b.size));
+}
+
+} // namespace
+
+bool RelabelMatcher::Init(const string& pattern, bool search) {
+    if (TryCompileLiteral(pattern)) {
+        // a search finds the same match as an anchored match only if the pattern matches everything from the start
+        if (!search || (mKind == Kind::PREFIX && mLiteral.empty())) {
+            return true;
+        }
+        mCapture = Capture::NONE;
+        mLiteral.clear();
+        mNonEmptyRest = false;
+        mAlternatives.clear();
+    }
+    mSearch = search;
+    RE2::Options options;
+    options.set_dot_nl(true);
+    options.set_log_errors(false);
+    mRegex = make_unique<re2::RE2>(pattern, options);
+    if (!mRegex->ok()) {
+        LOG_WARNING(sLogger, ("invalid relabel regex", pattern)("error", mRegex->error()));
+        return false;
+    }
+    mKind = Kind::REGEX;
+    mNumGroups = mRegex->NumberOfCapturingGroups();
+    return true;
+}
+
+bool RelabelMatcher::TryCompileLiteral(const string& pattern) {
+    StringView p(pattern);
+    // the default regex of a relabel config, which matches everything and captures nothing
+    if (p == "().*") {
+        mKind = Kind::PREFIX;
+        mCapture = Capture::EMPTY;
+        mNumGroups = 1;
+        return true;
+    }
+
+    static const struct {
+        const char* mSuffix;
+        bool mNonEmptyRest;
+        Capture mCapture;
+    } sSuffixes[] = {
+        {"(.*)", false, Capture::REST},
+        {"(.+)", true, Capture::REST},
+        {".*", false, Capture::NONE},
+        {".+", true, Capture::NONE},
+    };
+    for (const auto& suffix : sSuffixes) {
+        if (p.ends_with(suffix.mSuffix)) {
+            StringView prefix = p.substr(0, p.size() - strlen(suffix.mSuffix));
+            if (!IsLiteral(prefix, false)) {
+                continue;
+            }
+            mKind = Kind::PREFIX;
+            mLiteral = prefix.to_string();
+            mNonEmptyRest = suffix.mNonEmptyRest;
+            mCapture = suffix.mCapture;
+            mNumGroups = mCapture == Capture::NONE ? 0 : 1;
+            return true;
+        }
+    }
+
+    Capture capture = Capture::NONE;
+    if (p.starts_with("(?:") && p.ends_with(")")) {
+        p = p.substr(3, p.size() - 4);
+    } else if (p.starts_with("(") && p.ends_with(")")) {
+        p = p.substr(1, p.size() - 2);
+        capture = Capture::WHOLE;
+    }
+    if (!IsLiteral(p, true)) {
+        return false;
+    }
+    mCapture = capture;
+    mNumGroups = capture == Capture::NONE ? 0 : 1;
+    if (p.find('|') == StringView::npos) {
+        mKind = Kind::LITERAL;
+        mLiteral = p.to_string();
+        return true;
+    }
+    mKind = Kind::ALTERNATION;
+    size_t begin = 0;
+    while (true) {
+        size_t end = p.find('|', begin);
+        if (end == StringView::npos) {
+            mAlternatives.emplace_back(p.substr(begin).to_string());
+            break;
+        }
+        mAlternatives.emplace_back(p.substr(begin, end - begin).to_string());
+        begin = end + 1;
+    }
+    return true;
+}
+
+bool RelabelMatcher::Match(StringView s, vector<StringView>* groups) const {
+    switch (mKind) {
+        case Kind::PREFIX: {
+            if (!s.starts_with(mLiteral) || (mNonEmptyRest && s.size() == mLiteral.size())) {
+                return false;
+            }
+            if (groups) {
+                groups->assign(1, s);
+                if (mCapture == Capture::REST) {
+                    groups->emplace_back(s.substr(mLiteral.size()));
+                } else if (mCapture == Capture::EMPTY) {
+                    groups->emplace_back(s.data(), 0);
+                }
+            }
+            return true;
+        }
+        case Kind::LITERAL:
+        case Kind::ALTERNATION: {
+            if (mKind == Kind::LITERAL) {
+                if (s != mLiteral) {
+                    return false;
+                }
+            } else if (none_of(mAlternatives.begin(), mAlternatives.end(), [s](const string& alt) {
+                           return s == alt;
+                       })) {
+                return false;
+            }
+            if (groups) {
+                groups->assign(1, s);
+                if (mCapture == Capture::WHOLE) {
+                    groups->emplace_back(s);
+                }
+            }
+            return true;
+        }
+        case Kind::REGEX: {
+            re2::StringPiece input(s.data(), s.size());
+            auto anchor = mSearch ? RE2::UNANCHORED : RE2::ANCHOR_BOTH;
+            if (!groups) {
+                return mRegex->Match(input, 0, input.size(), anchor, nullptr, 0);
+            }
+            static thread_local vector<re2::StringPiece> sSubmatches;
+            sSubmatches.resize(mNumGroups + 1);
+            if (!mRegex->Match(input, 0, input.size(), anchor, sSubmatches.data(), sSubmatches.size())) {
+                return false;
+            }
+            groups->clear();
+            for (const auto& m : sSubmatches) {
+                groups->emplace_back(m.data(), m.size());
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+void RelabelMatcher::Expand(StringView tmpl, const vector<StringView>& groups, string& out) const {
+    auto appendGroup = [&](StringView ref) {
+        if (ref.empty()) {
+            return;
+        }
+        size_t idx = 0;
+        if (ref[0] >= '0' && ref[0] <= '9') {
+            if (from_chars(ref.data(), ref.data() + ref.size(), idx).ptr != ref.data() + ref.size()) {
+                return;
+            }
+        } else {
+            if (!mRegex) {
+                return;
+            }
+            const auto& names = mRegex->NamedCapturingGroups();
+            auto it = names.find(ref.to_string());
+            if (it == names.end()) {
+                return;
+            }
+            idx = it->second;
+        }
+        if (idx < groups.size()) {
+            out.append(groups[idx].data(), groups[idx].size());
+        }
+    };
+
+    size_t i = 0;
+    while (i < tmpl.size()) {
+        size_t pos = tmpl.find('$', i);
+        if (pos == StringView::npos || pos + 1 == tmpl.size()) {
+            out.append(tmpl.data() + i, tmpl.size() - i);
+            return;
+        }
+        out.append(tmpl.data() + i, pos - i);
+        char next = tmpl[pos + 1];
+        if (next == '$') {
+            out.push_back('$');
+            i = pos + 2;
+        } else if (next == '{') {
+            size_t end = tmpl.find('}', pos + 2);
+            if (end == StringView::npos) {
+                out.append(tmpl.data() + pos, tmpl.size() - pos);
+                return;
+            }
+            appendGroup(tmpl.substr(pos + 2, end - pos - 2));
+            i = end + 1;
+        } else if (next >= '0' && next <= '9') {
+            size_t end = pos + 1;
+            while (end < tmpl.size() && tmpl[end] >= '0' && tmpl[end] <= '9') {
+                ++end;
+            }
+            appendGroup(tmpl.substr(pos + 1, end - pos - 1));
+            i = end;
+        } else if (IsNameChar(next)) {
+            size_t end = pos + 1;
+            while (end < tmpl.size() && IsNameChar(tmpl[end])) {
+                ++end;
+            }
+            appendGroup(tmpl.substr(pos + 1, end - pos - 1));
+            i = end;
+        } else {
+            out.push_back('$');
+            i = pos + 1;
+        }
+    }
+}
+
+bool RelabelProgram::Compile(const vector<RelabelConfig>& configs) {
+    mSteps.clear();
+    mSteps.reserve(configs.size());
+    for (const auto& config : configs) {
+        Step step;
+        step.mConfig = config;
+        if (!step.mMatcher.Init(config.mRegexPattern, config.mAction == Action::REPLACE)) {
+            return false;
+        }
+        step.mTargetHasRef = config.mTargetLabel.find('$') != string::npos;
+        step.mReplacementHasRef = config.mReplacement.find('$') != string::npos;
+        if ((config.mAction == Action::KEEP || config.mAction == Action::DROP) && step.mMatcher.IsRegex()) {
+            step.mMemo = make_unique<array<MemoSlot, kMemoSlots>>();
+        }
+        mSteps.emplace_back(std::move(step));
+    }
+    return true;
+}
+
+bool RelabelProgram::Run(MetricEvent& event) const {
+    // name is kept in the event, so __name__ can reference it directly
+    event.SetTagNoCopy(StringView(prometheus::NAME), event.GetName());
+    for (const auto& step : mSteps) {
+        if (!RunStep(step, event)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+StringView RelabelProgram::JoinSourceValues(const Step& step, const MetricEvent& event, string& scratch) {
+    const auto& labels = step.mConfig.mSourceLabels;
+    if (labels.empty()) {
+        return StringView();
+    }
+    if (labels.size() == 1) {
+        return event.GetTag(labels[0]);
+    }
+    scratch.clear();
+    for (size_t i = 0; i < labels.size(); ++i) {
+        if (i != 0) {
+            scratch.append(step.mConfig.mSeparator);
+        }
+        auto v = event.GetTag(labels[i]);
+        scratch.append(v.data(), v.size());
+    }
+    return StringView(scratch);
+}
+
+bool RelabelProgram::MatchWithMemo(const Step& step, StringView val) {
+    if (!step.mMemo) {
+        return step.mMatcher.Match(val, nullptr);
+    }
+    if (val.size() > kMemoKeyMaxSize) {
+        return step.mMatcher.Match(val, nullptr);
+    }
+    auto& slot = (*step.mMemo)[hash<string_view>{}(string_view(val.data(), val.size())) & (kMemoSlots - 1)];
+    const size_t words = (val.size() + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    auto keyWord = [&val](size_t i) {
+        uint64_t word = 0;
+        memcpy(&word, val.data() + i * sizeof(uint64_t), min(sizeof(uint64_t), val.size() - i * sizeof(uint64_t)));
+        return word;
+    };
+
+    uint32_t seq = slot.mSeq.load(memory_order_acquire);
+    if ((seq & 1) == 0 && slot.mValid.load(memory_order_relaxed)
+        && slot.mKeySize.load(memory_order_relaxed) == val.size()) {
+        bool equal = true;
+        for (size_t i = 0; i < words && equal; ++i) {
+            equal = slot.mKey[i].load(memory_order_relaxed) == keyWord(i);
+        }
+        bool matched = slot.mMatched.load(memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if (equal && slot.mSeq.load(memory_order_relaxed) == seq) {
+            return matched;
+        }
+    }
+
+    bool matched = step.mMatcher.Match(val, nullptr);
+    // another thread is updating the slot, not worth waiting for
+    if ((seq & 1) == 0 && slot.mSeq.compare_exchange_strong(seq, seq + 1, memory_order_relaxed)) {
+        atomic_thread_fence(memory_order_release);
+        for (size_t i = 0; i < words; ++i) {
+            slot.mKey[i].store(keyWord(i), memory_order_relaxed);
+        }
+        slot.mKeySize.store(static_cast<uint32_t>(val.size()), memory_order_relaxed);
+        slot.mMatched.store(matched, memory_order_relaxed);
+        slot.mValid.store(true, memory_order_relaxed);
+        slot.mSeq.store(seq + 2, memory_order_release);
+    }
+    return matched;
+}
+
+bool RelabelProgram::RunStep(const Step& step, MetricEvent& event) {
+    static thread_local string sScratch;
+    static thread_local string sTarget;
+    static thread_local string sValue;
+    static thread_local vector<StringView> sGroups;
+
+    const auto& cfg = step.mConfig;
+    StringView val = JoinSourceValues(step, event, sScratch);
+    switch (cfg.mAction) {
+        case Action::DROP:
+            return !MatchWithMemo(step, val);
+        case Action::KEEP:
+            return MatchWithMemo(step, val);
+        case Action::DROPEQUAL:
+            return event.GetTag(cfg.mTargetLabel) != val;
+        case Action::KEEPEQUAL:
+            return event.GetTag(cfg.mTargetLabel) == val;
+        case Action::REPLACE: {
+            if (!step.mMatcher.Match(val, &sGroups)) {
+                break;
+            }
+            // only the first match is replaced, the rest of the value is kept around it
+            const char* matchEnd = sGroups[0].data() + sGroups[0].size();
+            StringView before(val.data(), sGroups[0].data() - val.data());
+            StringView after(matchEnd, val.data() + val.size() - matchEnd);
+            bool whole = before.empty() && after.empty();
+            StringView target(cfg.mTargetLabel);
+            if (step.mTargetHasRef || !whole) {
+                sTarget.assign(before.data(), before.size());
+                step.mMatcher.Expand(cfg.mTargetLabel, sGroups, sTarget);
+                sTarget.append(after.data(), after.size());
+                target = StringView(sTarget);
+            }
+            if (step.mReplacementHasRef || !whole) {
+                sValue.assign(before.data(), before.size());
+                step.mMatcher.Expand(cfg.mReplacement, sGroups, sValue);
+                sValue.append(after.data(), after.size());
+            } else {
+                sValue = cfg.mReplacement;
+            }
+            if (sValue.empty()) {
+                event.DelTag(target);
+                break;
+            }
+            SetTagValue(event, target, sValue);
+            break;
+        }
+        case Action::LOWERCASE:
+        case Action::UPPERCASE: {
+            sValue.assign(val.data(), val.size());
+            if (cfg.mAction == Action::LOWERCASE) {
+                transform(sValue.begin(), sValue.end(), sValue.begin(), [](unsigned char c) { return tolower(c); });
+            } else {
+                transform(sValue.begin(), sValue.end(), sValue.begin(), [](unsigned char c) { return toupper(c); });
+            }
+            SetTagValue(event, cfg.mTargetLabel, sValue);
+            break;
+        }
+        case Action::HASHMOD: {
+            // keep md5 so that targets are sharded the same way as prometheus and the boost based implementation
+            uint8_t digest[MD5_DIGEST_LENGTH];
+            MD5(reinterpret_cast<const uint8_t*>(val.data()), val.size(), digest);
+            uint64_t hashVal = 0;
+            for (int i = 8; i < MD5_DIGEST_LENGTH; ++i) {
+                hashVal = (hashVal << 8) | digest[i];
+            }
+            char buf[24];
+            auto res = to_chars(buf, buf + sizeof(buf), hashVal % cfg.mModulus);
+            SetTagValue(event, cfg.mTargetLabel, StringView(buf, res.ptr - buf));
+            break;
+        }
+        case Action::LABELMAP: {
+            static thread_local vector<pair<string, StringView>> sMapped;
+            sMapped.clear();
+            for (auto it = event.TagsBegin(); it != event.TagsEnd(); ++it) {
+                if (step.mMatcher.Match(it->first, &sGroups)) {
+                    sMapped.emplace_back(string(), it->second);
+                    step.mMatcher.Expand(cfg.mReplacement, sGroups, sMapped.back().first);
+                }
+            }
+            for (const auto& [key, value] : sMapped) {
+                SetTagValueNoCopy(event, key, value);
+            }
+            break;
+        }
+        case Action::LABELDROP:
+        case Action::LABELKEEP: {
+            static thread_local vector<StringView> sToDel;
+            sToDel.clear();
+            bool keep = cfg.mAction == Action::LABELKEEP;
+            for (auto it = event.TagsBegin(); it != event.TagsEnd(); ++it) {
+                if (step.mMatcher.Match(it->first, nullptr) != keep) {
+                    sToDel.emplace_back(it->first);
+                }
+            }
+            for (const auto& key : sToDel) {
+                event.DelTag(key);
+            }
+            break;
+        }
+        case Action::DROPMETRIC: {
+            sValue.assign(val.data(), val.size());
+            return cfg.mMatchList.find(sValue) == cfg.mMatchList.end();
+        }
+        default:
+            LOG_ERROR(sLogger, ("relabel: unknown relabel action type", ActionToString(cfg.mAction)));
+            break;
+    }
+    return true;
+}
+
+} // namespace logtail
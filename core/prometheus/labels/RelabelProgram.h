@@ -0,0 +1,114 @@
+/*
+ * Copyright 2025 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "re2/re2.h"
+
+#include "common/StringView.h"
+#include "models/MetricEvent.h"
+#include "prometheus/labels/Relabel.h"
+
+namespace logtail {
+
+// Matcher compiled from a relabel regex, fully anchored unless compiled for search. Patterns commonly seen in metric
+// relabel configs, e.g. `.*`, `(.+)`, `prefix(.*)`, `literal` and `(a|b|c)`, are matched without running a regex
+// engine; everything else falls back to RE2.
+class RelabelMatcher {
+public:
+    // With search, the first match anywhere in the input is taken, as the replace action does.
+    bool Init(const std::string& pattern, bool search = false);
+
+    // groups[0] is set to the matched part of the input and groups[i] to the i-th capture group, when groups is not
+    // null.
+    bool Match(StringView s, std::vector<StringView>* groups) const;
+    // Append tmpl to out with $1, ${1}, $name and ${name} substituted by the matched groups, and $$ by $.
+    void Expand(StringView tmpl, const std::vector<StringView>& groups, std::string& out) const;
+
+    size_t NumGroups() const { return mNumGroups; }
+    bool IsRegex() const { return mKind == Kind::REGEX; }
+
+private:
+    enum class Kind { PREFIX, LITERAL, ALTERNATION, REGEX };
+    enum class Capture { NONE, EMPTY, REST, WHOLE };
+
+    bool TryCompileLiteral(const std::string& pattern);
+
+    Kind mKind = Kind::REGEX;
+    Capture mCapture = Capture::NONE;
+    // literal value for LITERAL, prefix for PREFIX
+    std::string mLiteral;
+    bool mNonEmptyRest = false;
+    std::vector<std::string> mAlternatives;
+    std::unique_ptr<re2::RE2> mRegex;
+    bool mSearch = false;
+    size_t mNumGroups = 0;
+};
+
+// RelabelProgram is the compiled form of a RelabelConfigList used for metric relabeling. It reads and writes the tags
+// of a MetricEvent in place: source label values are StringViews into the event, the joined source value is built in
+// a thread local scratch buffer, and only newly produced values are copied into the event's SourceBuffer.
+class RelabelProgram {
+public:
+    bool Compile(const std::vector<RelabelConfig>& configs);
+    // Return false if the event should be dropped.
+    bool Run(MetricEvent& event) const;
+
+    static const size_t kMemoSlots = 1024;
+    // Longer values are always matched, without the memo.
+    static const size_t kMemoKeyMaxSize = 128;
+
+private:
+    // A seqlock: the writer makes mSeq odd while updating the slot, and a reader only trusts what it read when mSeq
+    // is even and unchanged afterwards. Writers never wait for each other, a busy slot is just not updated.
+    struct MemoSlot {
+        std::atomic<uint32_t> mSeq{0};
+        std::atomic<bool> mValid{false};
+        std::atomic<bool> mMatched{false};
+        std::atomic<uint32_t> mKeySize{0};
+        std::array<std::atomic<uint64_t>, kMemoKeyMaxSize / sizeof(uint64_t)> mKey{};
+    };
+
+    struct Step {
+        RelabelConfig mConfig;
+        RelabelMatcher mMatcher;
+        // Whether the target label and the replacement reference capture groups, i.e. need to be expanded.
+        bool mTargetHasRef = false;
+        bool mReplacementHasRef = false;
+        // Keep/drop results of the joined source values, indexed by their hash. Only used for actions whose matcher
+        // falls back to RE2.
+        std::unique_ptr<std::array<MemoSlot, kMemoSlots>> mMemo;
+    };
+
+    static StringView JoinSourceValues(const Step& step, const MetricEvent& event, std::string& scratch);
+    static bool MatchWithMemo(const Step& step, StringView val);
+    static bool RunStep(const Step& step, MetricEvent& event);
+
+    std::vector<Step> mSteps;
+
+#ifdef APSARA_UNIT_TEST_MAIN
+    friend class RelabelConfigUnittest;
+#endif
+};
+
+} // namespace logtail
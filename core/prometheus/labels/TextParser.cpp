@@ -82,6 +82,55 @@ bool TextParser::ParseLine(StringView line, MetricEvent& metricEvent) {
     return false;
 }
 
+bool TextParser::ParseSample(StringView line, size_t pos, MetricEvent& metricEvent) {
+    mLine = line;
+    mPos = pos;
+    mState = TextState::Start;
+    mTokenLength = 0;
+
+    SkipLeadingWhitespace();
+    HandleSampleValue(metricEvent);
+
+    return mState == TextState::Done;
+}
+
+size_t TextParser::GetSeriesLength(StringView line) {
+    size_t pos = 0;
+    while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) {
+        ++pos;
+    }
+    size_t nameBegin = pos;
+    while (pos < line.size() && (std::isalnum(line[pos]) || line[pos] == '_' || line[pos] == ':')) {
+        ++pos;
+    }
+    if (pos == nameBegin) {
+        return 0;
+    }
+    size_t nameEnd = pos;
+    while (pos < line.size() && (line[pos] == ' ' || line[pos] == '\t')) {
+        ++pos;
+    }
+    if (pos == line.size() || line[pos] != '{') {
+        return nameEnd;
+    }
+    // label values may contain '}' and escaped quotation marks
+    bool quoted = false;
+    for (++pos; pos < line.size(); ++pos) {
+        if (quoted) {
+            if (line[pos] == '\\') {
+                ++pos;
+            } else if (line[pos] == '"') {
+                quoted = false;
+            }
+        } else if (line[pos] == '"') {
+            quoted = true;
+        } else if (line[pos] == '}') {
+            return pos + 1;
+        }
+    }
+    return 0;
+}
+
 // start to parse metric sample:test_metric{k1="v1", k2="v2" } 9.9410452992e+10 1715829785083 # exemplarsxxx
 void TextParser::HandleStart(MetricEvent& metricEvent) {
     SkipLeadingWhitespace();
@@ -35,6 +35,11 @@ public:
     PipelineEventGroup Parse(const std::string& content, uint64_t defaultTimestamp, uint32_t defaultNanoSec);
 
     bool ParseLine(StringView line, MetricEvent& metricEvent);
+    // Parse only the sample value and the optional timestamp, which start at pos of line.
+    bool ParseSample(StringView line, size_t pos, MetricEvent& metricEvent);
+
+    // Return the length of the series part of line, i.e., metric name and labels, or 0 if the series is malformed.
+    static size_t GetSeriesLength(StringView line);
 
 private:
     void HandleError(const std::string& errMsg);
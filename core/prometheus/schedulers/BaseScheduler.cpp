@@ -40,8 +40,11 @@ void BaseScheduler::DelayExecTime(uint64_t delaySeconds) {
 }
 
 void BaseScheduler::Cancel() {
-    WriteLock lock(mLock);
-    mValidState = false;
+    {
+        WriteLock lock(mLock);
+        mValidState = false;
+    }
+    CancelTimerEvent();
 }
 
 bool BaseScheduler::IsCancelled() {
@@ -49,6 +52,24 @@ bool BaseScheduler::IsCancelled() {
     return !mValidState;
 }
 
+void BaseScheduler::PushTimerEvent(unique_ptr<TimerEvent>&& event) {
+    auto id = Timer::GetInstance()->PushEvent(std::move(event));
+    WriteLock lock(mLock);
+    mTimerEventId = id;
+}
+
+void BaseScheduler::CancelTimerEvent() {
+    uint64_t id = 0;
+    {
+        WriteLock lock(mLock);
+        id = mTimerEventId;
+        mTimerEventId = 0;
+    }
+    if (id != 0) {
+        Timer::GetInstance()->Cancel(id);
+    }
+}
+
 void BaseScheduler::SetComponent(EventPool* eventPool) {
     mEventPool = eventPool;
 }
@@ -31,6 +31,9 @@ public:
 
 protected:
     bool IsCancelled();
+    // Push the next timer event of the scheduler, which is removed from the timer on Cancel.
+    void PushTimerEvent(std::unique_ptr<TimerEvent>&& event);
+    void CancelTimerEvent();
 
     // for scrape monitor
     std::chrono::system_clock::time_point mFirstScrapeTime;
@@ -44,6 +47,7 @@ protected:
 
     ReadWriteLock mLock;
     bool mValidState = true;
+    uint64_t mTimerEventId = 0;
     std::shared_ptr<PromFuture<HttpResponse&, uint64_t>> mFuture;
     std::shared_ptr<PromFuture<>> mIsContextValidFuture;
 
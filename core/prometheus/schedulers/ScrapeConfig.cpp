@@ -8,12 +8,17 @@
 #include "json/value.h"
 
 #include "common/EncodingUtil.h"
+#include "common/Flags.h"
 #include "common/FileSystemUtil.h"
 #include "common/StringTools.h"
 #include "logger/Logger.h"
 #include "prometheus/Constants.h"
 #include "prometheus/Utils.h"
 
+DEFINE_FLAG_BOOL(prom_prefer_protobuf_scrape,
+                 "prefer the protobuf exposition format when scrape_protocols is not configured",
+                 false);
+
 using namespace std;
 
 namespace logtail {
@@ -344,6 +349,12 @@ bool ScrapeConfig::InitScrapeProtocols(const Json::Value& scrapeProtocols) {
         prometheus::OpenMetricsText0_0_1,
         prometheus::OpenMetricsText1_0_0,
     };
+    static auto sProtobufFirstScrapeProtocols = vector<string>{
+        prometheus::PrometheusProto,
+        prometheus::OpenMetricsText1_0_0,
+        prometheus::OpenMetricsText0_0_1,
+        prometheus::PrometheusText0_0_4,
+    };
 
     auto join = [](const vector<string>& strs, const string& sep) {
         string result;
@@ -395,7 +406,8 @@ bool ScrapeConfig::InitScrapeProtocols(const Json::Value& scrapeProtocols) {
 
     // if scrape_protocols is empty, use default protocols
     if (tmpScrapeProtocols.empty()) {
-        tmpScrapeProtocols = sDefaultScrapeProtocols;
+        tmpScrapeProtocols
+            = BOOL_FLAG(prom_prefer_protobuf_scrape) ? sProtobufFirstScrapeProtocols : sDefaultScrapeProtocols;
     }
     if (!validateScrapeProtocols(tmpScrapeProtocols)) {
         return false;
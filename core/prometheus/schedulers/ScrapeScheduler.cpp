@@ -25,17 +25,20 @@
 
 #include "collection_pipeline/queue/ProcessQueueManager.h"
 #include "collection_pipeline/queue/QueueKey.h"
+#include "common/Flags.h"
 #include "common/StringTools.h"
 #include "common/TimeUtil.h"
 #include "common/http/Constant.h"
-#include "common/timer/HttpRequestTimerEvent.h"
 #include "logger/Logger.h"
 #include "prometheus/Constants.h"
 #include "prometheus/Utils.h"
 #include "prometheus/async/PromFuture.h"
 #include "prometheus/async/PromHttpRequest.h"
+#include "prometheus/async/PromScrapeDispatcher.h"
 #include "prometheus/component/StreamScraper.h"
 
+DECLARE_FLAG_BOOL(enable_prom_stream_parse);
+
 using namespace std;
 
 namespace logtail {
@@ -165,7 +168,7 @@ void ScrapeScheduler::ScheduleNext() {
     }
 
     auto event = BuildScrapeTimerEvent(GetNextExecTime());
-    Timer::GetInstance()->PushEvent(std::move(event));
+    PushTimerEvent(std::move(event));
 }
 
 void ScrapeScheduler::ScrapeOnce(std::chrono::steady_clock::time_point execTime) {
@@ -176,7 +179,7 @@ void ScrapeScheduler::ScrapeOnce(std::chrono::steady_clock::time_point execTime)
     });
     mFuture = future;
     auto event = BuildScrapeTimerEvent(execTime);
-    Timer::GetInstance()->PushEvent(std::move(event));
+    PushTimerEvent(std::move(event));
 }
 
 std::unique_ptr<TimerEvent> ScrapeScheduler::BuildScrapeTimerEvent(std::chrono::steady_clock::time_point execTime) {
@@ -185,6 +188,13 @@ std::unique_ptr<TimerEvent> ScrapeScheduler::BuildScrapeTimerEvent(std::chrono::
         retry -= 1;
     }
 
+    auto* scraper = new prom::StreamScraper(
+        mTargetInfo.mLabels, mQueueKey, mInputIndex, mTargetInfo.mHash, mEventPool, mLatestScrapeTime);
+    scraper->SetHonorTimestamps(mScrapeConfigPtr->mHonorTimestamps);
+    if (BOOL_FLAG(enable_prom_stream_parse)) {
+        scraper->EnableStreamParse(mScrapeConfigPtr->mHonorTimestamps);
+    }
+
     auto request = std::make_unique<PromHttpRequest>(
         HTTP_GET,
         mScheme == prometheus::HTTPS,
@@ -195,8 +205,7 @@ std::unique_ptr<TimerEvent> ScrapeScheduler::BuildScrapeTimerEvent(std::chrono::
         mScrapeConfigPtr->mRequestHeaders,
         "",
         HttpResponse(
-            new prom::StreamScraper(
-                mTargetInfo.mLabels, mQueueKey, mInputIndex, mTargetInfo.mHash, mEventPool, mLatestScrapeTime),
+            scraper,
             [](void* p) { delete static_cast<prom::StreamScraper*>(p); },
             prom::StreamScraper::MetricWriteCallback),
         mScrapeTimeoutSeconds,
@@ -205,8 +214,11 @@ std::unique_ptr<TimerEvent> ScrapeScheduler::BuildScrapeTimerEvent(std::chrono::
         this->mIsContextValidFuture,
         mScrapeConfigPtr->mFollowRedirects,
         mScrapeConfigPtr->mEnableTLS ? std::optional<CurlTLS>(mScrapeConfigPtr->mTLS) : std::nullopt);
+    // the response lives in the request from now on, so its headers can be referenced by the scraper
+    scraper->SetResponseHeader(&request->mResponse.GetHeader());
 
-    auto timerEvent = std::make_unique<HttpRequestTimerEvent>(execTime, std::move(request));
+    auto timerEvent = std::make_unique<PromScrapeTimerEvent>(
+        execTime, mScrapeConfigPtr->mJobName, std::move(request), chrono::seconds(mInterval), mPromScrapeLagMs);
     return timerEvent;
 }
 
@@ -221,6 +233,7 @@ void ScrapeScheduler::Cancel() {
         WriteLock lock(mLock);
         mValidState = false;
     }
+    CancelTimerEvent();
 }
 
 void ScrapeScheduler::InitSelfMonitor(const MetricLabels& defaultLabels) {
@@ -239,6 +252,7 @@ void ScrapeScheduler::InitSelfMonitor(const MetricLabels& defaultLabels) {
         mMetricsRecordRef, MetricCategory::METRIC_CATEGORY_PLUGIN_SOURCE, std::move(labels));
     mPromDelayTotal = mMetricsRecordRef.CreateCounter(METRIC_PLUGIN_PROM_SCRAPE_DELAY_TOTAL);
     mPluginTotalDelayMs = mMetricsRecordRef.CreateCounter(METRIC_PLUGIN_TOTAL_DELAY_MS);
+    mPromScrapeLagMs = mMetricsRecordRef.CreateCounter(METRIC_PLUGIN_PROM_SCRAPE_LAG_MS);
 }
 
 } // namespace logtail
@@ -94,6 +94,8 @@ private:
     MetricsRecordRef mMetricsRecordRef;
     CounterPtr mPromDelayTotal;
     CounterPtr mPluginTotalDelayMs;
+    // time between the ideal fire time of scrapes and when they are actually sent
+    CounterPtr mPromScrapeLagMs;
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class ProcessorParsePrometheusMetricUnittest;
     friend class TargetSubscriberSchedulerUnittest;
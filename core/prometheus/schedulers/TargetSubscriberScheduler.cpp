@@ -16,11 +16,17 @@
 
 #include "prometheus/schedulers/TargetSubscriberScheduler.h"
 
+#include <xxhash/xxhash.h>
+
 #include <cstdlib>
 
 #include <chrono>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
+
+#include "rapidjson/reader.h"
 
 #include "AppConfig.h"
 #include "SelfMonitorMetricEvent.h"
@@ -42,6 +48,169 @@ using namespace std;
 
 namespace logtail {
 
+namespace {
+
+struct RawTargetGroup {
+    vector<string> mTargets;
+    vector<pair<string, string>> mLabels;
+};
+
+// SAX handler of the http service discovery response, i.e. [{"targets": ["host:port"], "labels": {"k": "v"}}, ...],
+// so that no DOM is built for responses with tens of thousands of targets. Other members of a target group are
+// skipped.
+class TargetGroupsHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, TargetGroupsHandler> {
+public:
+    explicit TargetGroupsHandler(vector<RawTargetGroup>& groups) : mGroups(groups) {}
+
+    bool Null() { return Scalar(string()); }
+    bool Bool(bool b) { return Scalar(b ? "true" : "false"); }
+    bool Int(int i) { return Scalar(ToString(i)); }
+    bool Uint(unsigned u) { return Scalar(ToString(u)); }
+    bool Int64(int64_t i) { return Scalar(ToString(i)); }
+    bool Uint64(uint64_t u) { return Scalar(ToString(u)); }
+    bool Double(double d) { return Scalar(ToString(d)); }
+    bool String(const char* str, rapidjson::SizeType len, bool) {
+        if (mState == State::TARGETS) {
+            mGroups.back().mTargets.emplace_back(str, len);
+            return true;
+        }
+        return Scalar(string(str, len));
+    }
+
+    bool Key(const char* str, rapidjson::SizeType len, bool) {
+        if (mState != State::SKIP) {
+            mKey.assign(str, len);
+        }
+        return true;
+    }
+
+    bool StartObject() {
+        switch (mState) {
+            case State::GROUPS:
+                mGroups.emplace_back();
+                mState = State::GROUP;
+                return true;
+            case State::GROUP:
+                if (mKey == prometheus::LABELS) {
+                    mState = State::LABELS;
+                    return true;
+                }
+                return Skip();
+            case State::SKIP:
+                ++mSkipDepth;
+                return true;
+            default:
+                return Fail();
+        }
+    }
+
+    bool EndObject(rapidjson::SizeType) {
+        switch (mState) {
+            case State::GROUP:
+                mState = State::GROUPS;
+                return true;
+            case State::LABELS:
+                mState = State::GROUP;
+                return true;
+            default:
+                return EndSkip();
+        }
+    }
+
+    bool StartArray() {
+        switch (mState) {
+            case State::ROOT:
+                mState = State::GROUPS;
+                return true;
+            case State::GROUP:
+                if (mKey == prometheus::TARGETS) {
+                    mState = State::TARGETS;
+                    return true;
+                }
+                return Skip();
+            case State::SKIP:
+                ++mSkipDepth;
+                return true;
+            default:
+                return Fail();
+        }
+    }
+
+    bool EndArray(rapidjson::SizeType) {
+        switch (mState) {
+            case State::GROUPS:
+                mState = State::DONE;
+                return true;
+            case State::TARGETS:
+                mState = State::GROUP;
+                return true;
+            default:
+                return EndSkip();
+        }
+    }
+
+    const string& GetError() const { return mErr; }
+
+private:
+    enum class State { ROOT, GROUPS, GROUP, TARGETS, LABELS, SKIP, DONE };
+
+    bool Scalar(string&& value) {
+        switch (mState) {
+            case State::GROUP:
+            case State::SKIP:
+                return true;
+            case State::LABELS:
+                mGroups.back().mLabels.emplace_back(mKey, std::move(value));
+                return true;
+            default:
+                return Fail();
+        }
+    }
+
+    bool Skip() {
+        mState = State::SKIP;
+        mSkipDepth = 1;
+        return true;
+    }
+
+    bool EndSkip() {
+        if (mState != State::SKIP) {
+            return Fail();
+        }
+        if (--mSkipDepth == 0) {
+            mState = State::GROUP;
+        }
+        return true;
+    }
+
+    bool Fail() {
+        switch (mState) {
+            case State::ROOT:
+            case State::DONE:
+                mErr = "Failed to parse JSON: target groups is not an array";
+                break;
+            case State::GROUPS:
+                mErr = "Invalid target group item found";
+                break;
+            case State::TARGETS:
+                mErr = "Invalid target item found";
+                break;
+            default:
+                mErr = "Invalid label value found";
+                break;
+        }
+        return false;
+    }
+
+    vector<RawTargetGroup>& mGroups;
+    State mState = State::ROOT;
+    string mKey;
+    size_t mSkipDepth = 0;
+    string mErr;
+};
+
+} // namespace
+
 std::chrono::steady_clock::time_point TargetSubscriberScheduler::mLastUpdateTime = std::chrono::steady_clock::now();
 uint64_t TargetSubscriberScheduler::sDelaySeconds = 0;
 TargetSubscriberScheduler::TargetSubscriberScheduler()
@@ -70,6 +239,7 @@ void TargetSubscriberScheduler::OnSubscription(HttpResponse& response, uint64_t
                              GetCurrentTimeInMilliSeconds() - timestampMilliSec);
     if (response.GetStatusCode() == 304) {
         // not modified
+        ADD_COUNTER(mPromSubscribeUnchangedTotal, 1);
         return;
     }
     if (response.GetStatusCode() != 200) {
@@ -79,6 +249,13 @@ void TargetSubscriberScheduler::OnSubscription(HttpResponse& response, uint64_t
         mETag = response.GetHeader().at(prometheus::ETAG);
     }
     const string& content = *response.GetBody<string>();
+    // the operator may not support etag, skip the update as well if the body is the same as the last applied one
+    auto contentHash = XXH64(content.data(), content.size(), 0);
+    if (mLastContentHash != 0 && contentHash == mLastContentHash) {
+        ADD_COUNTER(mPromSubscribeUnchangedTotal, 1);
+        return;
+    }
+    auto updateStartTime = GetCurrentTimeInMilliSeconds();
     vector<PromTargetInfo> targetGroup;
     if (!ParseScrapeSchedulerGroup(content, targetGroup)) {
         return;
@@ -86,7 +263,9 @@ void TargetSubscriberScheduler::OnSubscription(HttpResponse& response, uint64_t
     std::unordered_map<std::string, std::shared_ptr<ScrapeScheduler>> newScrapeSchedulerSet
         = BuildScrapeSchedulerSet(targetGroup);
     UpdateScrapeScheduler(newScrapeSchedulerSet);
+    mLastContentHash = contentHash;
     SET_GAUGE(mPromSubscriberTargets, mScrapeSchedulerMap.size());
+    ADD_COUNTER(mPromSubscribeUpdateTimeMs, GetCurrentTimeInMilliSeconds() - updateStartTime);
     ADD_COUNTER(mTotalDelayMs, GetCurrentTimeInMilliSeconds() - timestampMilliSec);
 }
 
@@ -144,51 +323,34 @@ void TargetSubscriberScheduler::UpdateScrapeScheduler(
 
 bool TargetSubscriberScheduler::ParseScrapeSchedulerGroup(const std::string& content,
                                                           std::vector<PromTargetInfo>& scrapeSchedulerGroup) {
-    string errs;
-    Json::Value root;
-    if (!ParseJsonTable(content, root, errs) || !root.isArray()) {
-        LOG_ERROR(sLogger,
-                  ("http service discovery from operator failed", "Failed to parse JSON: " + errs)("job", mJobName));
+    vector<RawTargetGroup> groups;
+    TargetGroupsHandler handler(groups);
+    rapidjson::Reader reader;
+    rapidjson::StringStream stream(content.c_str());
+    if (reader.Parse(stream, handler).IsError()) {
+        string errs = handler.GetError();
+        if (errs.empty()) {
+            errs = "Failed to parse JSON at offset " + ToString(reader.GetErrorOffset());
+        }
+        LOG_ERROR(sLogger, ("http service discovery from operator failed", errs)("job", mJobName));
         return false;
     }
-    for (const auto& element : root) {
-        if (!element.isObject()) {
-            LOG_ERROR(
-                sLogger,
-                ("http service discovery from operator failed", "Invalid target group item found")("job", mJobName));
-            return false;
-        }
-
-        // Parse targets
-        vector<string> targets;
-        if (element.isMember(prometheus::TARGETS) && element[prometheus::TARGETS].isArray()) {
-            for (const auto& target : element[prometheus::TARGETS]) {
-                if (target.isString()) {
-                    targets.push_back(target.asString());
-                } else {
-                    LOG_ERROR(
-                        sLogger,
-                        ("http service discovery from operator failed", "Invalid target item found")("job", mJobName));
-                    return false;
-                }
-            }
-        }
-        if (targets.empty()) {
+    scrapeSchedulerGroup.reserve(groups.size());
+    for (auto& group : groups) {
+        if (group.mTargets.empty()) {
             continue;
         }
         PromTargetInfo targetInfo;
         // Parse labels https://www.robustperception.io/life-of-a-label/
         Labels labels;
-        if (element.isMember(prometheus::LABELS) && element[prometheus::LABELS].isObject()) {
-            for (const string& labelKey : element[prometheus::LABELS].getMemberNames()) {
-                labels.Set(labelKey, element[prometheus::LABELS][labelKey].asString());
-            }
+        for (const auto& [k, v] : group.mLabels) {
+            labels.Set(k, v);
         }
         std::ostringstream rawHashStream;
         rawHashStream << std::setw(16) << std::setfill('0') << std::hex << labels.Hash();
         string rawAddress = labels.Get(prometheus::ADDRESS_LABEL_NAME);
         targetInfo.mHash = mScrapeConfigPtr->mJobName + rawAddress + rawHashStream.str();
-        targetInfo.mInstance = targets[0];
+        targetInfo.mInstance = std::move(group.mTargets[0]);
 
         for (const auto& pair : mScrapeConfigPtr->mParams) {
             if (!pair.second.empty()) {
@@ -196,10 +358,8 @@ bool TargetSubscriberScheduler::ParseScrapeSchedulerGroup(const std::string& con
             }
         }
 
-        if (element.isMember(prometheus::LABELS) && element[prometheus::LABELS].isObject()) {
-            for (const string& labelKey : element[prometheus::LABELS].getMemberNames()) {
-                labels.Set(labelKey, element[prometheus::LABELS][labelKey].asString());
-            }
+        for (const auto& [k, v] : group.mLabels) {
+            labels.Set(k, v);
         }
         if (labels.Get(prometheus::JOB).empty()) {
             labels.Set(prometheus::JOB, mJobName);
@@ -214,8 +374,8 @@ bool TargetSubscriberScheduler::ParseScrapeSchedulerGroup(const std::string& con
             continue;
         }
 
-        targetInfo.mLabels = labels;
-        scrapeSchedulerGroup.push_back(targetInfo);
+        targetInfo.mLabels = std::move(labels);
+        scrapeSchedulerGroup.push_back(std::move(targetInfo));
     }
     return true;
 }
@@ -223,7 +383,23 @@ bool TargetSubscriberScheduler::ParseScrapeSchedulerGroup(const std::string& con
 std::unordered_map<std::string, std::shared_ptr<ScrapeScheduler>>
 TargetSubscriberScheduler::BuildScrapeSchedulerSet(std::vector<PromTargetInfo>& targetGroups) {
     std::unordered_map<std::string, std::shared_ptr<ScrapeScheduler>> scrapeSchedulerMap;
+    std::unordered_set<std::string> droppedTargets;
     for (auto& targetInfo : targetGroups) {
+        // targets are identified by the hash of their labels before relabeling, so known targets are reused and
+        // dropped ones are skipped without running relabeling again
+        if (mDroppedTargets.count(targetInfo.mHash)) {
+            droppedTargets.insert(targetInfo.mHash);
+            continue;
+        }
+        {
+            ReadLock lock(mRWLock);
+            auto it = mScrapeSchedulerMap.find(targetInfo.mHash);
+            if (it != mScrapeSchedulerMap.end()) {
+                scrapeSchedulerMap[it->first] = it->second;
+                continue;
+            }
+        }
+        ADD_COUNTER(mPromSubscribeRelabeledTargets, 1);
         // Relabel Config
         auto& resultLabel = targetInfo.mLabels;
         if (!mScrapeConfigPtr->mRelabelConfigs.Process(resultLabel)) {
@@ -335,6 +511,12 @@ TargetSubscriberScheduler::BuildScrapeSchedulerSet(std::vector<PromTargetInfo>&
 
         scrapeSchedulerMap[scrapeScheduler->GetId()] = scrapeScheduler;
     }
+    for (const auto& targetInfo : targetGroups) {
+        if (scrapeSchedulerMap.find(targetInfo.mHash) == scrapeSchedulerMap.end()) {
+            droppedTargets.insert(targetInfo.mHash);
+        }
+    }
+    mDroppedTargets = std::move(droppedTargets);
     return scrapeSchedulerMap;
 }
 
@@ -362,7 +544,7 @@ void TargetSubscriberScheduler::ScheduleNext() {
     }
 
     auto event = BuildSubscriberTimerEvent(GetNextExecTime());
-    Timer::GetInstance()->PushEvent(std::move(event));
+    PushTimerEvent(std::move(event));
 }
 
 void TargetSubscriberScheduler::Cancel() {
@@ -371,6 +553,7 @@ void TargetSubscriberScheduler::Cancel() {
         WriteLock lock(mLock);
         mValidState = false;
     }
+    CancelTimerEvent();
     CancelAllScrapeScheduler();
 }
 
@@ -382,7 +565,7 @@ void TargetSubscriberScheduler::SubscribeOnce(std::chrono::steady_clock::time_po
     });
     mFuture = future;
     auto event = BuildSubscriberTimerEvent(execTime);
-    Timer::GetInstance()->PushEvent(std::move(event));
+    PushTimerEvent(std::move(event));
 }
 
 std::unique_ptr<TimerEvent>
@@ -475,6 +658,9 @@ void TargetSubscriberScheduler::InitSelfMonitor(const MetricLabels& defaultLabel
         mMetricsRecordRef, MetricCategory::METRIC_CATEGORY_PLUGIN_SOURCE, std::move(mDefaultLabels));
     mPromSubscriberTargets = mMetricsRecordRef.CreateIntGauge(METRIC_PLUGIN_PROM_SUBSCRIBE_TARGETS);
     mTotalDelayMs = mMetricsRecordRef.CreateCounter(METRIC_PLUGIN_TOTAL_DELAY_MS);
+    mPromSubscribeUnchangedTotal = mMetricsRecordRef.CreateCounter(METRIC_PLUGIN_PROM_SUBSCRIBE_UNCHANGED_TOTAL);
+    mPromSubscribeUpdateTimeMs = mMetricsRecordRef.CreateCounter(METRIC_PLUGIN_PROM_SUBSCRIBE_UPDATE_TIME_MS);
+    mPromSubscribeRelabeledTargets = mMetricsRecordRef.CreateCounter(METRIC_PLUGIN_PROM_SUBSCRIBE_RELABELED_TARGETS);
 }
 
 } // namespace logtail
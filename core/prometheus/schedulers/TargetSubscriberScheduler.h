@@ -21,6 +21,7 @@
 
 #include <memory>
 #include <string>
+#include <unordered_set>
 
 #include "collection_pipeline/queue/QueueKey.h"
 #include "common/http/HttpResponse.h"
@@ -83,12 +84,19 @@ private:
     std::string mJobName;
 
     std::string mETag;
+    // hash of the last applied response body
+    uint64_t mLastContentHash = 0;
+    // targets dropped by relabeling in the last update
+    std::unordered_set<std::string> mDroppedTargets;
 
     // self monitor
     std::shared_ptr<PromSelfMonitorUnsafe> mSelfMonitor;
     MetricsRecordRef mMetricsRecordRef;
     IntGaugePtr mPromSubscriberTargets;
     CounterPtr mTotalDelayMs;
+    CounterPtr mPromSubscribeUnchangedTotal;
+    CounterPtr mPromSubscribeUpdateTimeMs;
+    CounterPtr mPromSubscribeRelabeledTargets;
     MetricLabels mDefaultLabels;
 #ifdef APSARA_UNIT_TEST_MAIN
     friend class TargetSubscriberSchedulerUnittest;
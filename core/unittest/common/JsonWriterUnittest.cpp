@@ -0,0 +1,142 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+
+#include <limits>
+#include <string>
+
+#include "common/JsonUtil.h"
+#include "common/JsonWriter.h"
+#include "unittest/Unittest.h"
+
+using namespace std;
+
+namespace logtail {
+
+class JsonWriterUnittest : public ::testing::Test {
+public:
+    void TestAppendJsonString();
+    void TestLongString();
+    void TestNesting();
+    void TestNumbers();
+    void TestJsonLines();
+};
+
+void JsonWriterUnittest::TestAppendJsonString() {
+    {
+        string res;
+        AppendJsonString(res, "");
+        APSARA_TEST_EQUAL("\"\"", res);
+    }
+    {
+        string res;
+        AppendJsonString(res, "plain text");
+        APSARA_TEST_EQUAL("\"plain text\"", res);
+    }
+    {
+        string res;
+        AppendJsonString(res, "a\"b\\c/d\b\f\n\r\t");
+        APSARA_TEST_EQUAL("\"a\\\"b\\\\c/d\\b\\f\\n\\r\\t\"", res);
+    }
+    {
+        string res;
+        AppendJsonString(res, StringView("\x01\x1f\x7f", 3));
+        APSARA_TEST_EQUAL("\"\\u0001\\u001F\x7f\"", res);
+    }
+    {
+        // embedded null and utf-8 are kept as is, except for the null itself
+        string res;
+        AppendJsonString(res, StringView("\xe4\xb8\xad\0z", 5));
+        APSARA_TEST_EQUAL("\"\xe4\xb8\xad\\u0000z\"", res);
+    }
+}
+
+void JsonWriterUnittest::TestLongString() {
+    // characters to be escaped are placed at every offset to cover both the block scan and the tail
+    for (size_t len = 1; len < 40; ++len) {
+        for (size_t pos = 0; pos < len; ++pos) {
+            string s(len, 'x');
+            s[pos] = '"';
+            string res;
+            AppendJsonString(res, s);
+            Json::Value value;
+            string errorMsg;
+            APSARA_TEST_TRUE(ParseJsonTable("[" + res + "]", value, errorMsg));
+            APSARA_TEST_EQUAL(s, value[0].asString());
+        }
+    }
+}
+
+void JsonWriterUnittest::TestNesting() {
+    string res;
+    JsonWriter writer(res);
+    writer.StartArray();
+    writer.StartObject();
+    writer.Key("a");
+    writer.Int64(1);
+    writer.Key("b");
+    writer.StartArray();
+    writer.Int64(-2);
+    writer.String("x");
+    writer.EndArray();
+    writer.Key("c");
+    writer.StartObject();
+    writer.EndObject();
+    writer.EndObject();
+    writer.StartObject();
+    writer.Key("d");
+    writer.Bool(true);
+    writer.Key("e");
+    writer.Null();
+    writer.EndObject();
+    writer.EndArray();
+    APSARA_TEST_EQUAL(R"([{"a":1,"b":[-2,"x"],"c":{}},{"d":true,"e":null}])", res);
+}
+
+void JsonWriterUnittest::TestNumbers() {
+    string res;
+    JsonWriter writer(res);
+    writer.StartArray();
+    writer.Int64(numeric_limits<int64_t>::min());
+    writer.Uint64(numeric_limits<uint64_t>::max());
+    writer.Double(0.5);
+    writer.Double(NAN);
+    writer.Double(numeric_limits<double>::infinity());
+    writer.EndArray();
+    APSARA_TEST_EQUAL("[-9223372036854775808,18446744073709551615,0.5,null,null]", res);
+}
+
+void JsonWriterUnittest::TestJsonLines() {
+    string res;
+    JsonWriter writer(res);
+    for (int i = 0; i < 2; ++i) {
+        writer.StartObject();
+        writer.Key("i");
+        writer.Int64(i);
+        writer.EndObject();
+        res.push_back('\n');
+    }
+    APSARA_TEST_EQUAL("{\"i\":0}\n{\"i\":1}\n", res);
+}
+
+UNIT_TEST_CASE(JsonWriterUnittest, TestAppendJsonString)
+UNIT_TEST_CASE(JsonWriterUnittest, TestLongString)
+UNIT_TEST_CASE(JsonWriterUnittest, TestNesting)
+UNIT_TEST_CASE(JsonWriterUnittest, TestNumbers)
+UNIT_TEST_CASE(JsonWriterUnittest, TestJsonLines)
+
+} // namespace logtail
+
+UNIT_TEST_MAIN
@@ -14,6 +14,9 @@
 
 #include <vector>
 
+#include <atomic>
+#include <thread>
+
 #include "common/timer/Timer.h"
 #include "unittest/Unittest.h"
 
@@ -30,10 +33,29 @@ struct TimerEventMock : public TimerEvent {
     bool mIsValid = false;
 };
 
+struct CountingTimerEvent : public TimerEvent {
+    CountingTimerEvent(const chrono::steady_clock::time_point& execTime, atomic_int& cnt, atomic_int& earlyCnt)
+        : TimerEvent(execTime), mCnt(cnt), mEarlyCnt(earlyCnt) {}
+
+    bool IsValid() const override { return true; }
+    bool Execute() override {
+        if (chrono::steady_clock::now() < GetExecTime()) {
+            ++mEarlyCnt;
+        }
+        ++mCnt;
+        return true;
+    }
+
+    atomic_int& mCnt;
+    atomic_int& mEarlyCnt;
+};
+
 class TimerUnittest : public ::testing::Test {
 public:
     void TestPushEvent();
-    void TestPeriodicEvent();
+    void TestCancel();
+    void TestPlace();
+    void TestExpire();
 
 private:
     std::vector<int> mVec;
@@ -47,16 +69,89 @@ void TimerUnittest::TestPushEvent() {
     timer.PushEvent(make_unique<TimerEventMock>(now + chrono::seconds(1)));
     timer.PushEvent(make_unique<TimerEventMock>(now + chrono::seconds(3)));
 
-    APSARA_TEST_EQUAL(3U, timer.mQueue.size());
-    APSARA_TEST_EQUAL(now + chrono::seconds(1), timer.mQueue.top()->GetExecTime());
-    timer.mQueue.pop();
-    APSARA_TEST_EQUAL(now + chrono::seconds(2), timer.mQueue.top()->GetExecTime());
-    timer.mQueue.pop();
-    APSARA_TEST_EQUAL(now + chrono::seconds(3), timer.mQueue.top()->GetExecTime());
-    timer.mQueue.pop();
+    APSARA_TEST_EQUAL(3U, timer.Size());
+    APSARA_TEST_EQUAL(now + chrono::seconds(1), timer.Top()->GetExecTime());
+    timer.Pop();
+    APSARA_TEST_EQUAL(now + chrono::seconds(2), timer.Top()->GetExecTime());
+    timer.Pop();
+    APSARA_TEST_EQUAL(now + chrono::seconds(3), timer.Top()->GetExecTime());
+    timer.Pop();
+    APSARA_TEST_EQUAL(0U, timer.Size());
+}
+
+void TimerUnittest::TestCancel() {
+    auto now = chrono::steady_clock::now();
+    Timer timer;
+    auto id1 = timer.PushEvent(make_unique<TimerEventMock>(now + chrono::seconds(1)));
+    auto id2 = timer.PushEvent(make_unique<TimerEventMock>(now + chrono::hours(1)));
+    APSARA_TEST_NOT_EQUAL(id1, id2);
+
+    APSARA_TEST_TRUE(timer.Cancel(id1));
+    APSARA_TEST_FALSE(timer.Cancel(id1));
+    APSARA_TEST_EQUAL(1U, timer.Size());
+    APSARA_TEST_EQUAL(now + chrono::hours(1), timer.Top()->GetExecTime());
+    APSARA_TEST_TRUE(timer.Cancel(id2));
+    APSARA_TEST_EQUAL(0U, timer.Size());
+}
+
+void TimerUnittest::TestPlace() {
+    Timer timer;
+    auto start = timer.mStartTime;
+    timer.PushEvent(make_unique<TimerEventMock>(start + chrono::milliseconds(100)));
+    timer.PushEvent(make_unique<TimerEventMock>(start + chrono::seconds(10)));
+    timer.PushEvent(make_unique<TimerEventMock>(start + chrono::hours(1)));
+    timer.PushEvent(make_unique<TimerEventMock>(start + chrono::hours(24 * 100)));
+    // events in the past expire at the next tick
+    timer.PushEvent(make_unique<TimerEventMock>(start - chrono::seconds(1)));
+
+    APSARA_TEST_EQUAL(1U, timer.mWheels[0][100].size());
+    APSARA_TEST_EQUAL(1U, timer.mWheels[0][1].size());
+    APSARA_TEST_EQUAL(1U, timer.mWheels[1][(10000 >> 8) & 255].size());
+    APSARA_TEST_EQUAL(1U, timer.mWheels[2][(3600000 >> 16) & 255].size());
+    APSARA_TEST_EQUAL(1U, timer.mWheels[3][(8640000000ULL >> 24) & 255].size());
+    APSARA_TEST_EQUAL(1ULL, timer.NextTick());
+
+    // cascaded down level by level
+    vector<unique_ptr<TimerEvent>> expired;
+    timer.Advance(3600000, expired);
+    APSARA_TEST_EQUAL(4U, expired.size());
+    APSARA_TEST_EQUAL(1U, timer.Size());
+    timer.Advance(8640000000ULL, expired);
+    APSARA_TEST_EQUAL(5U, expired.size());
+    APSARA_TEST_EQUAL(0U, timer.Size());
+}
+
+void TimerUnittest::TestExpire() {
+    atomic_int cnt(0);
+    atomic_int earlyCnt(0);
+    Timer timer;
+    timer.Init();
+    auto now = chrono::steady_clock::now();
+    vector<uint64_t> ids;
+    for (int i = 0; i < 1000; ++i) {
+        ids.emplace_back(
+            timer.PushEvent(make_unique<CountingTimerEvent>(now + chrono::milliseconds(500 + i), cnt, earlyCnt)));
+    }
+    for (size_t i = 0; i < ids.size(); i += 2) {
+        APSARA_TEST_TRUE(timer.Cancel(ids[i]));
+    }
+    this_thread::sleep_for(chrono::milliseconds(2000));
+    APSARA_TEST_EQUAL(500, cnt.load());
+    APSARA_TEST_EQUAL(0, earlyCnt.load());
+    APSARA_TEST_EQUAL(0U, timer.Size());
+
+    // an event earlier than the one being waited for wakes the timer up
+    timer.PushEvent(make_unique<CountingTimerEvent>(now + chrono::hours(1), cnt, earlyCnt));
+    timer.PushEvent(make_unique<CountingTimerEvent>(chrono::steady_clock::now(), cnt, earlyCnt));
+    this_thread::sleep_for(chrono::milliseconds(100));
+    APSARA_TEST_EQUAL(501, cnt.load());
+    timer.Stop();
 }
 
 UNIT_TEST_CASE(TimerUnittest, TestPushEvent)
+UNIT_TEST_CASE(TimerUnittest, TestCancel)
+UNIT_TEST_CASE(TimerUnittest, TestPlace)
+UNIT_TEST_CASE(TimerUnittest, TestExpire)
 
 
 } // namespace logtail
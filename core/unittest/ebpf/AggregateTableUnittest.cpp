@@ -0,0 +1,260 @@
+// Copyright 2025 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ebpf/util/AggregateTable.h"
+#include "unittest/Unittest.h"
+
+namespace logtail {
+namespace ebpf {
+
+struct CountData {
+    std::string mFirst;
+    int mCount = 0;
+};
+
+using StrVec = std::vector<std::string>;
+
+class AggregateTableUnittest : public testing::Test {
+public:
+    void TestBasicAgg();
+    void TestFullKeyCompare();
+    void TestGroupOnlyKey();
+    void TestMaxNodes();
+    void TestSwapAndReset();
+    void TestSourceBuffer();
+    void TestMerge();
+
+protected:
+    void SetUp() override { mTable = MakeTable<false>(10); }
+
+    template <bool NeedSourceBuffer>
+    static std::unique_ptr<AggregateTable<CountData, StrVec, NeedSourceBuffer>> MakeTable(size_t maxNodes) {
+        return std::make_unique<AggregateTable<CountData, StrVec, NeedSourceBuffer>>(
+            maxNodes,
+            [](std::unique_ptr<CountData>& base, const StrVec& other) {
+                APSARA_TEST_TRUE(base != nullptr);
+                base->mCount++;
+            },
+            [](const StrVec& in, std::shared_ptr<SourceBuffer>& sourceBuffer) {
+                auto data = std::make_unique<CountData>();
+                data->mFirst = in.empty() ? "" : in[0];
+                if (sourceBuffer) {
+                    // keys copied into the buffer of the group must stay valid until the group is consumed
+                    sourceBuffer->CopyString(data->mFirst);
+                }
+                return data;
+            });
+    }
+
+    // the first groupDepth strings build the group key, the rest build the series key
+    bool Aggregate(const StrVec& data, size_t groupDepth) { return Aggregate(*mTable, data, groupDepth); }
+
+    template <class Table>
+    static bool Aggregate(Table& table, const StrVec& data, size_t groupDepth) {
+        AggregateKey key;
+        key.Clear();
+        for (size_t i = 0; i < data.size(); ++i) {
+            if (i < groupDepth) {
+                key.AddGroupAttr(data[i]);
+            } else {
+                key.AddSeriesAttr(data[i]);
+            }
+        }
+        return table.Aggregate(data, key);
+    }
+
+    template <class Table>
+    static int GetSum(const Table& table) {
+        int result = 0;
+        table.ForEach([&result](const CountData* data) { result += data->mCount; });
+        return result;
+    }
+
+    template <class Table>
+    static int GetSeriesCount(const Table& table) {
+        int count = 0;
+        table.ForEach([&count](const CountData*) { count++; });
+        return count;
+    }
+
+    std::unique_ptr<AggregateTable<CountData, StrVec, false>> mTable;
+};
+
+void AggregateTableUnittest::TestBasicAgg() {
+    Aggregate({"a", "b", "c", "d"}, 2);
+    Aggregate({"a", "b", "c", "d"}, 2);
+    Aggregate({"a", "b", "d", "r"}, 2);
+    Aggregate({"a", "c", "c", "e"}, 2);
+    // 2 groups and 3 series
+    APSARA_TEST_EQUAL(5UL, mTable->NodeCount());
+    APSARA_TEST_EQUAL(3, GetSeriesCount(*mTable));
+    APSARA_TEST_EQUAL(4, GetSum(*mTable));
+
+    const auto& groups = mTable->GetGroups();
+    APSARA_TEST_EQUAL(2UL, groups.size());
+    APSARA_TEST_EQUAL(2U, groups[0].mSize);
+    APSARA_TEST_EQUAL(1U, groups[1].mSize);
+    std::vector<int> counts;
+    mTable->ForEach(groups[0], [&counts](const CountData* data) { counts.push_back(data->mCount); });
+    // series are visited in insertion order
+    APSARA_TEST_EQUAL(std::vector<int>({2, 1}), counts);
+
+    mTable->Reset();
+    APSARA_TEST_EQUAL(0UL, mTable->NodeCount());
+    APSARA_TEST_EQUAL(0, GetSeriesCount(*mTable));
+    APSARA_TEST_TRUE(mTable->GetGroups().empty());
+}
+
+void AggregateTableUnittest::TestFullKeyCompare() {
+    // attributes are length prefixed, so concatenations of the same bytes are different keys
+    Aggregate({"ab", "c", "x"}, 2);
+    Aggregate({"a", "bc", "x"}, 2);
+    Aggregate({"a", "b", "cx"}, 2);
+    Aggregate({"a", "b", "c", "x"}, 2);
+    APSARA_TEST_EQUAL(3UL, mTable->GetGroups().size());
+    APSARA_TEST_EQUAL(4, GetSeriesCount(*mTable));
+    APSARA_TEST_EQUAL(4, GetSum(*mTable));
+
+    // the same series key in different groups are different series
+    mTable->Reset();
+    Aggregate({"g1", "s"}, 1);
+    Aggregate({"g2", "s"}, 1);
+    APSARA_TEST_EQUAL(2, GetSeriesCount(*mTable));
+}
+
+void AggregateTableUnittest::TestGroupOnlyKey() {
+    Aggregate({"a", "b"}, 2);
+    Aggregate({"a", "b"}, 2);
+    Aggregate({"a", "c"}, 2);
+    // a key without series part makes the group itself a series and counts as one node
+    APSARA_TEST_EQUAL(2UL, mTable->NodeCount());
+    APSARA_TEST_EQUAL(2, GetSeriesCount(*mTable));
+    APSARA_TEST_EQUAL(3, GetSum(*mTable));
+}
+
+void AggregateTableUnittest::TestMaxNodes() {
+    mTable = MakeTable<false>(4);
+    APSARA_TEST_TRUE(Aggregate({"a", "1"}, 1));
+    APSARA_TEST_TRUE(Aggregate({"a", "2"}, 1));
+    // a new group with a new series needs 2 more nodes
+    APSARA_TEST_FALSE(Aggregate({"b", "1"}, 1));
+    // existing series are still aggregated
+    APSARA_TEST_TRUE(Aggregate({"a", "1"}, 1));
+    APSARA_TEST_TRUE(Aggregate({"a", "3"}, 1));
+    APSARA_TEST_FALSE(Aggregate({"a", "4"}, 1));
+    APSARA_TEST_EQUAL(4UL, mTable->NodeCount());
+    APSARA_TEST_EQUAL(4, GetSum(*mTable));
+}
+
+void AggregateTableUnittest::TestSwapAndReset() {
+    AggregateTable<CountData, StrVec, false> drained;
+    for (int window = 0; window < 3; ++window) {
+        drained.Reset();
+        for (int i = 0; i < 4; ++i) {
+            Aggregate({"g" + std::to_string(i % 2), std::to_string(i)}, 1);
+        }
+        Aggregate({"g0", "0"}, 1);
+        mTable->Swap(drained);
+
+        APSARA_TEST_EQUAL(0UL, mTable->NodeCount());
+        APSARA_TEST_TRUE(mTable->GetGroups().empty());
+        APSARA_TEST_EQUAL(6UL, drained.NodeCount());
+        APSARA_TEST_EQUAL(2UL, drained.GetGroups().size());
+        APSARA_TEST_EQUAL(4, GetSeriesCount(drained));
+        APSARA_TEST_EQUAL(5, GetSum(drained));
+    }
+    // the table keeps its own limit after being swapped
+    for (int i = 0; i < 9; ++i) {
+        APSARA_TEST_TRUE(Aggregate({"g", std::to_string(i)}, 1));
+    }
+    APSARA_TEST_FALSE(Aggregate({"g", "9"}, 1));
+}
+
+void AggregateTableUnittest::TestSourceBuffer() {
+    auto table = MakeTable<true>(10);
+    Aggregate(*table, {"a", "1"}, 1);
+    Aggregate(*table, {"a", "2"}, 1);
+    Aggregate(*table, {"b", "1"}, 1);
+    const auto& groups = table->GetGroups();
+    APSARA_TEST_EQUAL(2UL, groups.size());
+    APSARA_TEST_TRUE(groups[0].mSourceBuffer != nullptr);
+    APSARA_TEST_TRUE(groups[1].mSourceBuffer != nullptr);
+    APSARA_TEST_TRUE(groups[0].mSourceBuffer != groups[1].mSourceBuffer);
+    table->ForEach(groups[1], [](const CountData* data) { APSARA_TEST_EQUAL("b", data->mFirst); });
+
+    APSARA_TEST_TRUE(mTable->GetGroups().empty());
+    Aggregate({"a", "1"}, 1);
+    APSARA_TEST_TRUE(mTable->GetGroups()[0].mSourceBuffer == nullptr);
+}
+
+void AggregateTableUnittest::TestMerge() {
+    auto merge = [](std::unique_ptr<CountData>& base, std::unique_ptr<CountData>& other) {
+        base->mCount += other->mCount;
+    };
+    auto shard1 = MakeTable<true>(10);
+    auto shard2 = MakeTable<true>(10);
+    Aggregate(*shard1, {"a", "1"}, 1);
+    Aggregate(*shard1, {"a", "1"}, 1);
+    Aggregate(*shard1, {"a", "2"}, 1);
+    Aggregate(*shard2, {"a", "1"}, 1);
+    Aggregate(*shard2, {"b", "1"}, 1);
+    std::weak_ptr<SourceBuffer> shard2BufferA = shard2->GetGroups()[0].mSourceBuffer;
+    auto shard2BufferB = shard2->GetGroups()[1].mSourceBuffer;
+
+    AggregateTable<CountData, StrVec, true> merged(10);
+    APSARA_TEST_TRUE(merged.Merge(*shard1, merge));
+    APSARA_TEST_TRUE(merged.Merge(*shard2, merge));
+    shard1->Reset();
+    shard2->Reset();
+    // a/1 is combined, 2 groups and 3 series
+    APSARA_TEST_EQUAL(5UL, merged.NodeCount());
+    APSARA_TEST_EQUAL(3, GetSeriesCount(merged));
+    APSARA_TEST_EQUAL(5, GetSum(merged));
+    const auto& groups = merged.GetGroups();
+    APSARA_TEST_EQUAL(2UL, groups.size());
+    std::vector<int> counts;
+    merged.ForEach(groups[0], [&counts](const CountData* data) { counts.push_back(data->mCount); });
+    APSARA_TEST_EQUAL(std::vector<int>({3, 1}), counts);
+    // a new group keeps its buffer, an existing group retains the buffer of the group merged into it
+    APSARA_TEST_TRUE(groups[1].mSourceBuffer == shard2BufferB);
+    APSARA_TEST_FALSE(shard2BufferA.expired());
+
+    // the limit of the target applies to merged series
+    AggregateTable<CountData, StrVec, true> small(3);
+    Aggregate(*shard1, {"a", "1"}, 1);
+    Aggregate(*shard1, {"a", "2"}, 1);
+    Aggregate(*shard2, {"a", "1"}, 1);
+    Aggregate(*shard2, {"b", "1"}, 1);
+    APSARA_TEST_TRUE(small.Merge(*shard1, merge));
+    APSARA_TEST_FALSE(small.Merge(*shard2, merge));
+    APSARA_TEST_EQUAL(3UL, small.NodeCount());
+    APSARA_TEST_EQUAL(3, GetSum(small));
+}
+
+UNIT_TEST_CASE(AggregateTableUnittest, TestBasicAgg);
+UNIT_TEST_CASE(AggregateTableUnittest, TestFullKeyCompare);
+UNIT_TEST_CASE(AggregateTableUnittest, TestGroupOnlyKey);
+UNIT_TEST_CASE(AggregateTableUnittest, TestMaxNodes);
+UNIT_TEST_CASE(AggregateTableUnittest, TestSwapAndReset);
+UNIT_TEST_CASE(AggregateTableUnittest, TestSourceBuffer);
+UNIT_TEST_CASE(AggregateTableUnittest, TestMerge);
+
+} // namespace ebpf
+} // namespace logtail
+
+UNIT_TEST_MAIN
@@ -15,6 +15,7 @@
 #include <gtest/gtest.h>
 
 #include <chrono>
+#include <iostream>
 #include <memory>
 #include <thread>
 
@@ -35,6 +36,7 @@ public:
     void TestProtocolDetection();
     void TestResourceManagement();
     void TestErrorHandling();
+    void TestIterationsBenchmark();
 
 protected:
     void SetUp() override {}
@@ -243,6 +245,47 @@ void ConnectionManagerUnittest::TestErrorHandling() {
     manager->deleteConnection(connId);
 }
 
+/*
+20000 connections, 100 iterations:
+before (visit every connection per iteration): 1.27 ms per iteration
+after (timing wheel): 0.24 ms per iteration
+*/
+void ConnectionManagerUnittest::TestIterationsBenchmark() {
+    const int connectionCount = 20000;
+    const int iterationCount = 100;
+    auto manager = ConnectionManager::Create(connectionCount);
+    manager->SetConnStatsStatus(true);
+
+    for (int i = 0; i < connectionCount; ++i) {
+        auto connId = CreateTestConnId(i);
+        struct conn_stats_event_t statsEvent = {};
+        statsEvent.conn_id.fd = connId.fd;
+        statsEvent.conn_id.tgid = connId.tgid;
+        statsEvent.conn_id.start = connId.start;
+        statsEvent.si.family = AF_INET;
+        statsEvent.si.netns = 12345;
+        statsEvent.si.ap.saddr = 0x0100007F; // 127.0.0.1
+        statsEvent.si.ap.daddr = 0x0101A8C0; // 192.168.1.1
+        statsEvent.si.ap.sport = htons(8080);
+        statsEvent.si.ap.dport = htons(80);
+        statsEvent.protocol = support_proto_e::ProtoHTTP;
+        statsEvent.role = support_role_e::IsClient;
+        statsEvent.ts = 1;
+        manager->AcceptNetStatsEvent(&statsEvent);
+    }
+    // the first check of every connection happens in the first iteration
+    manager->Iterations();
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterationCount; ++i) {
+        manager->Iterations();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double, std::milli> elapsed = end - start;
+    std::cout << "Iterations elapsed: " << elapsed.count() / iterationCount << " ms per iteration" << std::endl;
+    APSARA_TEST_EQUAL(static_cast<int64_t>(connectionCount), manager->ConnectionTotal());
+}
+
 UNIT_TEST_CASE(ConnectionManagerUnittest, TestBasicOperations);
 UNIT_TEST_CASE(ConnectionManagerUnittest, TestEventHandling);
 UNIT_TEST_CASE(ConnectionManagerUnittest, TestTimeoutMechanism);
@@ -250,6 +293,7 @@ UNIT_TEST_CASE(ConnectionManagerUnittest, TestMetadataHandling);
 UNIT_TEST_CASE(ConnectionManagerUnittest, TestProtocolDetection);
 UNIT_TEST_CASE(ConnectionManagerUnittest, TestResourceManagement);
 UNIT_TEST_CASE(ConnectionManagerUnittest, TestErrorHandling);
+UNIT_TEST_CASE(ConnectionManagerUnittest, TestIterationsBenchmark);
 
 } // namespace ebpf
 } // namespace logtail
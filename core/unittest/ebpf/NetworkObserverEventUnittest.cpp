@@ -34,6 +34,7 @@ public:
     void TestHttpRecordTimestamps();
     void TestHttpRecordStatus();
     void TestAbstractNetRecord();
+    void TestRecordPool();
 
 protected:
     std::shared_ptr<Connection> CreateTestTracker() {
@@ -143,16 +144,16 @@ void NetworkObserverEventUnittest::TestHttpRecord() {
     APSARA_TEST_EQUAL(record.GetStatusCode(), 404);
 
     // 测试请求头
-    HeadersMap reqHeaders;
-    reqHeaders.insert({"Content-Type", "application/json"});
-    record.SetReqHeaderMap(std::move(reqHeaders));
-    APSARA_TEST_EQUAL(record.GetReqHeaderMap().size(), 1UL);
+    record.mReqHeaders.Add("Content-Type", "application/json");
+    APSARA_TEST_EQUAL(record.GetReqHeaders().size(), 1UL);
+    auto it = record.GetReqHeaders().find("content-type");
+    APSARA_TEST_TRUE(it != record.GetReqHeaders().end());
+    APSARA_TEST_EQUAL(it->second, "application/json");
+    APSARA_TEST_TRUE(record.GetReqHeaders().find("Content-Length") == record.GetReqHeaders().end());
 
     // 测试响应头
-    HeadersMap respHeaders;
-    respHeaders.insert({"Content-Length", "100"});
-    record.SetRespHeaderMap(std::move(respHeaders));
-    APSARA_TEST_EQUAL(record.GetRespHeaderMap().size(), 1UL);
+    record.mRespHeaders.Add("Content-Length", "100");
+    APSARA_TEST_EQUAL(record.GetRespHeaders().size(), 1UL);
 }
 
 void NetworkObserverEventUnittest::TestAppMetricData() {
@@ -272,16 +273,11 @@ void NetworkObserverEventUnittest::TestHttpRecordStatus() {
     record.SetEndTsNs(600000000); // 600ms
     APSARA_TEST_TRUE(record.IsSlow());
 
-    HeadersMap reqHeaders;
-    reqHeaders.insert({"Content-Type", "application/json"});
-    record.SetReqHeaderMap(std::move(reqHeaders));
+    record.mReqHeaders.Add("Content-Type", "application/json");
+    record.mRespHeaders.Add("Content-Length", "100");
 
-    HeadersMap respHeaders;
-    respHeaders.insert({"Content-Length", "100"});
-    record.SetRespHeaderMap(std::move(respHeaders));
-
-    APSARA_TEST_EQUAL(record.GetReqHeaderMap().size(), 1UL);
-    APSARA_TEST_EQUAL(record.GetRespHeaderMap().size(), 1UL);
+    APSARA_TEST_EQUAL(record.GetReqHeaders().size(), 1UL);
+    APSARA_TEST_EQUAL(record.GetRespHeaders().size(), 1UL);
 }
 
 void NetworkObserverEventUnittest::TestAbstractNetRecord() {
@@ -289,6 +285,45 @@ void NetworkObserverEventUnittest::TestAbstractNetRecord() {
     ConnStatsRecord record(conn);
 }
 
+void NetworkObserverEventUnittest::TestRecordPool() {
+    auto conn = CreateTestTracker();
+    auto& pool = RecordPool<HttpRecord>::GetInstance();
+    size_t pooled = pool.Size();
+
+    auto record = pool.Acquire(conn);
+    HttpRecord* raw = record.get();
+    record->mPayload = "GET /api/v1/test HTTP/1.1\r\n\r\n";
+    record->SetPath(StringView(record->mPayload).substr(4, 12));
+    record->mReqHeaders.Add("Host", "example.com");
+    record->SetStatusCode(500);
+    record->SetStartTsNs(1);
+    record->MarkSample();
+    APSARA_TEST_EQUAL(2L, conn.use_count());
+
+    // the retained reference keeps the record alive
+    RecordPtr<AbstractRecord> retained = record.Ref();
+    record.reset();
+    APSARA_TEST_TRUE(record == nullptr);
+    APSARA_TEST_EQUAL("/api/v1/test", static_cast<HttpRecord*>(retained.get())->GetPath());
+
+    // the last reference returns the record to the pool and releases the connection
+    retained.reset();
+    APSARA_TEST_EQUAL(pooled + 1, pool.Size());
+    APSARA_TEST_EQUAL(1L, conn.use_count());
+
+    auto reused = pool.Acquire(conn);
+    APSARA_TEST_EQUAL(raw, reused.get());
+    APSARA_TEST_EQUAL(pooled, pool.Size());
+    APSARA_TEST_TRUE(reused->GetConnection() == conn);
+    APSARA_TEST_TRUE(reused->GetPath().empty());
+    APSARA_TEST_TRUE(reused->mPayload.empty());
+    APSARA_TEST_TRUE(reused->GetReqHeaders().empty());
+    APSARA_TEST_EQUAL(0, reused->GetStatusCode());
+    APSARA_TEST_EQUAL(0UL, reused->GetStartTimeStamp());
+    APSARA_TEST_FALSE(reused->ShouldSample());
+    APSARA_TEST_EQUAL(0, reused->RollbackCount());
+}
+
 UNIT_TEST_CASE(NetworkObserverEventUnittest, TestConnId);
 UNIT_TEST_CASE(NetworkObserverEventUnittest, TestConnIdHash);
 UNIT_TEST_CASE(NetworkObserverEventUnittest, TestCaseInsensitiveLess);
@@ -303,6 +338,7 @@ UNIT_TEST_CASE(NetworkObserverEventUnittest, TestHeadersMapCaseInsensitive);
 UNIT_TEST_CASE(NetworkObserverEventUnittest, TestHttpRecordTimestamps);
 UNIT_TEST_CASE(NetworkObserverEventUnittest, TestHttpRecordStatus);
 UNIT_TEST_CASE(NetworkObserverEventUnittest, TestAbstractNetRecord);
+UNIT_TEST_CASE(NetworkObserverEventUnittest, TestRecordPool);
 
 } // namespace ebpf
 } // namespace logtail
@@ -28,6 +28,8 @@
 #include "metadata/K8sMetadata.h"
 #include "unittest/Unittest.h"
 
+DECLARE_FLAG_BOOL(ebpf_network_observer_kernel_sampling);
+
 namespace logtail {
 namespace ebpf {
 
@@ -39,6 +41,7 @@ public:
     void TestWhitelistManagement();
     void TestPerfBufferOperations();
     void TestRecordProcessing();
+    void TestConcurrentConsume();
     void TestRollbackProcessing();
     void TestConfigUpdate();
     void TestErrorHandling();
@@ -237,7 +240,7 @@ void NetworkObserverManagerUnittest::TestDataEventProcessing() {
     mManager->AcceptDataEvent(dataEvent);
     free(dataEvent);
 
-    std::vector<std::shared_ptr<AbstractRecord>> items(10, nullptr);
+    std::vector<RecordPtr<AbstractRecord>> items(10);
     size_t count
         = mManager->mRollbackQueue.wait_dequeue_bulk_timed(items.data(), items.size(), std::chrono::milliseconds(200));
     APSARA_TEST_EQUAL(count, 1UL);
@@ -401,6 +404,58 @@ void NetworkObserverManagerUnittest::TestRecordProcessing() {
     APSARA_TEST_EQUAL(tags.size(), 1UL);
 }
 
+void NetworkObserverManagerUnittest::TestConcurrentConsume() {
+    ObserverNetworkOption options;
+    options.mEnableProtocols = {"HTTP"};
+    options.mEnableLog = true;
+    options.mEnableMetric = true;
+    options.mEnableSpan = true;
+    options.mSampleRate = 1;
+    mManager->Init(std::variant<SecurityOptions*, ObserverNetworkOption*>(&options));
+
+    auto podInfo = std::make_shared<K8sPodInfo>();
+    podInfo->mContainerIds = {"1", "2"};
+    podInfo->mAppName = "test-app-name";
+    podInfo->mAppId = "test-app-id";
+    K8sMetadata::GetInstance().mContainerCache.insert(
+        "80b2ea13472c0d75a71af598ae2c01909bb5880151951bf194a3b24a44613106", podInfo);
+
+    auto statsEvent = CreateConnStatsEvent();
+    mManager->AcceptNetStatsEvent(&statsEvent);
+    for (size_t i = 0; i < 100; i++) {
+        auto* dataEvent = CreateHttpDataEvent(i);
+        mManager->AcceptDataEvent(dataEvent);
+        free(dataEvent);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(400));
+
+    // two consumes of the same kind run at the same time, as overlapping timer events do, and every record is
+    // consumed exactly once
+    auto now = std::chrono::steady_clock::now();
+    auto runTwice = [&](bool (NetworkObserverManager::*consume)(const std::chrono::steady_clock::time_point&)) {
+        std::vector<std::thread> threads;
+        for (int i = 0; i < 2; ++i) {
+            threads.emplace_back([&]() { (mManager.get()->*consume)(now); });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    };
+    auto countEvents = [](const std::vector<PipelineEventGroup>& groups) {
+        size_t cnt = 0;
+        for (const auto& group : groups) {
+            cnt += group.GetEvents().size();
+        }
+        return cnt;
+    };
+    runTwice(&NetworkObserverManager::ConsumeSpanAggregateTree);
+    APSARA_TEST_EQUAL(100UL, countEvents(mManager->mSpanEventGroups));
+    runTwice(&NetworkObserverManager::ConsumeMetricAggregateTree);
+    APSARA_TEST_EQUAL(301UL, countEvents(mManager->mMetricEventGroups));
+    runTwice(&NetworkObserverManager::ConsumeLogAggregateTree);
+    APSARA_TEST_EQUAL(100UL, countEvents(mManager->mLogEventGroups));
+}
+
 // TEST RollBack mechanism
 void NetworkObserverManagerUnittest::TestRollbackProcessing() {
     // case1. caused by conn stats event comes later than data event ...
@@ -455,12 +510,12 @@ void NetworkObserverManagerUnittest::TestRollbackProcessing() {
         APSARA_TEST_TRUE(cnn->IsL4MetaAttachReady());
 
         APSARA_TEST_TRUE(cnn->IsMetaAttachReadyForAppRecord());
-        APSARA_TEST_EQUAL(mManager->mDropRecordTotal, 0);
-        APSARA_TEST_EQUAL(mManager->mRollbackRecordTotal, 100);
+        APSARA_TEST_EQUAL(mManager->mDropRecordTotal.load(), 0);
+        APSARA_TEST_EQUAL(mManager->mRollbackRecordTotal.load(), 100);
 
         std::this_thread::sleep_for(std::chrono::seconds(5));
-        APSARA_TEST_EQUAL(mManager->mDropRecordTotal, 0);
-        APSARA_TEST_EQUAL(mManager->mRollbackRecordTotal, 100);
+        APSARA_TEST_EQUAL(mManager->mDropRecordTotal.load(), 0);
+        APSARA_TEST_EQUAL(mManager->mRollbackRecordTotal.load(), 100);
 
         // Generate 10 records
         for (size_t i = 0; i < 100; i++) {
@@ -470,8 +525,8 @@ void NetworkObserverManagerUnittest::TestRollbackProcessing() {
         }
 
         std::this_thread::sleep_for(std::chrono::milliseconds(500));
-        APSARA_TEST_EQUAL(mManager->mDropRecordTotal, 0);
-        APSARA_TEST_EQUAL(mManager->mRollbackRecordTotal, 100);
+        APSARA_TEST_EQUAL(mManager->mDropRecordTotal.load(), 0);
+        APSARA_TEST_EQUAL(mManager->mRollbackRecordTotal.load(), 100);
     }
 
     // case2. caused by fetch metadata from server ...
@@ -548,6 +603,8 @@ void NetworkObserverManagerUnittest::TestConfigUpdate() {
         APSARA_TEST_EQUAL(mManager->mPreviousOpt->mEnableLog, false);
         APSARA_TEST_EQUAL(mManager->mPreviousOpt->mEnableMetric, true);
         APSARA_TEST_EQUAL(mManager->mPreviousOpt->mEnableSpan, true);
+        // metrics need every data event
+        APSARA_TEST_EQUAL(mManager->mKernelSamplingPercent, 100);
 
         options.mEnableProtocols = {"MySQL", "Redis", "Dubbo"};
         options.mEnableLog = true;
@@ -560,6 +617,11 @@ void NetworkObserverManagerUnittest::TestConfigUpdate() {
         APSARA_TEST_EQUAL(mManager->mPreviousOpt->mEnableLog, true);
         APSARA_TEST_EQUAL(mManager->mPreviousOpt->mEnableMetric, false);
         APSARA_TEST_EQUAL(mManager->mPreviousOpt->mEnableSpan, false);
+        // logs only, kernel sampling is opt-in so the parsers still see error and slow responses
+        APSARA_TEST_EQUAL(mManager->mKernelSamplingPercent, 100);
+        BOOL_FLAG(ebpf_network_observer_kernel_sampling) = true;
+        APSARA_TEST_EQUAL(mManager->updateSampler(0.01), 1);
+        BOOL_FLAG(ebpf_network_observer_kernel_sampling) = false;
 
         // protocols = {"HTTP", "MySQL"};
         options.mEnableProtocols = {"HTTP", "MySQL"};
@@ -574,6 +636,7 @@ void NetworkObserverManagerUnittest::TestConfigUpdate() {
         APSARA_TEST_EQUAL(mManager->mPreviousOpt->mEnableLog, true);
         APSARA_TEST_EQUAL(mManager->mPreviousOpt->mEnableMetric, true);
         APSARA_TEST_EQUAL(mManager->mPreviousOpt->mEnableSpan, false);
+        APSARA_TEST_EQUAL(mManager->mKernelSamplingPercent, 100);
 
         // protocols.clear();
         options.mEnableProtocols = {};
@@ -685,6 +748,7 @@ UNIT_TEST_CASE(NetworkObserverManagerUnittest, TestDataEventProcessing);
 UNIT_TEST_CASE(NetworkObserverManagerUnittest, TestWhitelistManagement);
 UNIT_TEST_CASE(NetworkObserverManagerUnittest, TestPerfBufferOperations);
 UNIT_TEST_CASE(NetworkObserverManagerUnittest, TestRecordProcessing);
+UNIT_TEST_CASE(NetworkObserverManagerUnittest, TestConcurrentConsume);
 UNIT_TEST_CASE(NetworkObserverManagerUnittest, TestRollbackProcessing);
 UNIT_TEST_CASE(NetworkObserverManagerUnittest, TestConfigUpdate);
 UNIT_TEST_CASE(NetworkObserverManagerUnittest, TestPluginLifecycle);
@@ -0,0 +1,104 @@
+// Copyright 2025 LoongCollector Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "ProcessCacheValue.h"
+#include "ebpf/plugin/ProcessCache.h"
+#include "type/table/BaseElements.h"
+#include "unittest/Unittest.h"
+
+using namespace logtail;
+using namespace logtail::ebpf;
+
+class ProcessCacheBenchmark : public ::testing::Test {
+public:
+    ProcessCacheBenchmark() : mProcParser("/"), mProcessCache(kProcessCnt, mProcParser) {}
+
+protected:
+    void TestConcurrentLookup();
+
+    void SetUp() override {
+        for (uint32_t i = 0; i < kProcessCnt; ++i) {
+            auto value = std::make_shared<ProcessCacheValue>();
+            value->SetContent<kProcessId>(i);
+            mProcessCache.AddCache({i, 1000000000UL + i}, value);
+        }
+    }
+
+    static constexpr uint32_t kProcessCnt = 10000;
+    static constexpr size_t kReaderCnt = 4;
+    static constexpr size_t kLookupsPerReader = 2000000;
+
+private:
+    ProcParser mProcParser;
+    ProcessCache mProcessCache;
+};
+
+/*
+10000 processes, 4 readers with 2000000 lookups each, 1 writer adding and expiring processes, 1 cpu:
+one mutex: 9.60039e+06 lookups/s, writes: 469175
+64 shards with read-write locks: 8.32813e+06 lookups/s, writes: 524016
+*/
+void ProcessCacheBenchmark::TestConcurrentLookup() {
+    std::atomic_bool stop = false;
+    std::atomic_size_t hits = 0;
+    std::atomic_size_t writes = 0;
+    // the poller thread adds processes and expires them
+    std::thread writer([&]() {
+        for (uint32_t i = 0; !stop; ++i) {
+            data_event_id key{kProcessCnt + i % 1000, i};
+            auto value = std::make_shared<ProcessCacheValue>();
+            mProcessCache.AddCache(key, value);
+            mProcessCache.DecRef(key, value);
+            mProcessCache.ClearExpiredCache();
+            ++writes;
+        }
+    });
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> readers;
+    for (size_t r = 0; r < kReaderCnt; ++r) {
+        readers.emplace_back([&, r]() {
+            size_t hit = 0;
+            for (size_t i = 0; i < kLookupsPerReader; ++i) {
+                auto pid = static_cast<uint32_t>((i * 7919 + r) % kProcessCnt);
+                if (mProcessCache.Lookup({pid, 1000000000UL + pid})) {
+                    ++hit;
+                }
+            }
+            hits += hit;
+        });
+    }
+    for (auto& reader : readers) {
+        reader.join();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    stop = true;
+    writer.join();
+
+    std::chrono::duration<double> elapsed = end - start;
+    std::cout << "lookups: " << kReaderCnt * kLookupsPerReader / elapsed.count() << " lookups/s, writes: " << writes
+              << std::endl;
+    APSARA_TEST_EQUAL(kReaderCnt * kLookupsPerReader, hits.load());
+}
+
+UNIT_TEST_CASE(ProcessCacheBenchmark, TestConcurrentLookup);
+
+UNIT_TEST_MAIN
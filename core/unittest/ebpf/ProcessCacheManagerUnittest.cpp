@@ -970,6 +970,13 @@ void ProcessCacheManagerUnittest::TestFinalizeProcessTags() {
     APSARA_TEST_EQUAL(sharedEvent->GetContent(kParentKtime.LogKey()), StringView("6789"));
     APSARA_TEST_EQUAL(sharedEvent->GetContent(kParentUid.LogKey()), StringView("1000"));
     APSARA_TEST_EQUAL(sharedEvent->GetContent(kParentBinary.LogKey()), StringView("test_binary_parent"));
+
+    // the tags point into blocks retained by the source buffer of the event, not into the cache
+    mWrapper.mProcessCacheManager->mProcessCache.Clear();
+    execveEvent.reset();
+    pExecveEvent.reset();
+    APSARA_TEST_EQUAL(sharedEvent->GetContent(kBinary.LogKey()), StringView("test_binary"));
+    APSARA_TEST_EQUAL(sharedEvent->GetContent(kParentBinary.LogKey()), StringView("test_binary_parent"));
 }
 
 /*
@@ -15,16 +15,85 @@
 #include <gtest/gtest.h>
 
 #include "ebpf/plugin/ProcessCacheValue.h"
+#include "ebpf/type/table/BaseElements.h"
 #include "unittest/Unittest.h"
 
 using namespace logtail;
 using namespace logtail::ebpf;
 
 class ProcessCacheValueUnittest : public ::testing::Test {
+public:
+    void TestTagBlock();
+    void TestParentTagBlock();
+
 protected:
     void SetUp() override {}
 
     void TearDown() override {}
+
+    static StringView FindTag(const ProcessTagBlock& block, StringView key) {
+        for (const auto& tag : block.GetTags()) {
+            if (tag.first == key) {
+                return tag.second;
+            }
+        }
+        return StringView();
+    }
 };
 
+void ProcessCacheValueUnittest::TestTagBlock() {
+    ProcessCacheValue value;
+    value.SetContent<kExecId>(StringView("exec-1234"));
+    value.SetContent<kProcessId>(StringView("1234"));
+    value.SetContent<kBinary>(StringView("/usr/bin/test"));
+
+    auto block = value.GetTagBlock();
+    APSARA_TEST_EQUAL(11UL, block->GetTags().size());
+    APSARA_TEST_EQUAL(StringView("exec-1234"), FindTag(*block, kExecId.LogKey()));
+    APSARA_TEST_EQUAL(StringView("/usr/bin/test"), FindTag(*block, kBinary.LogKey()));
+    // the block owns its values
+    APSARA_TEST_TRUE(FindTag(*block, kExecId.LogKey()).data() != value.Get<kExecId>().data());
+    // the block is shared until the container or pod info is changed
+    APSARA_TEST_EQUAL(block, value.GetTagBlock());
+
+    auto podInfo = std::make_shared<K8sPodInfo>();
+    podInfo->mNamespace = "default";
+    podInfo->mPodName = "test-pod";
+    value.StoreK8sPodInfo(podInfo);
+    auto newBlock = value.GetTagBlock();
+    APSARA_TEST_NOT_EQUAL(block, newBlock);
+    APSARA_TEST_EQUAL(15UL, newBlock->GetTags().size());
+    APSARA_TEST_EQUAL(StringView("test-pod"), FindTag(*newBlock, kPodName.LogKey()));
+    APSARA_TEST_EQUAL(newBlock, value.GetTagBlock());
+
+    // a retained block stays valid after it is replaced and its pod info is released
+    auto containerInfo = std::make_shared<ContainerMeta>();
+    containerInfo->mContainerName = "test-container";
+    value.StoreContainerInfo(containerInfo);
+    value.StoreK8sPodInfo(nullptr);
+    podInfo.reset();
+    auto lastBlock = value.GetTagBlock();
+    APSARA_TEST_EQUAL(13UL, lastBlock->GetTags().size());
+    APSARA_TEST_EQUAL(StringView("test-container"), FindTag(*lastBlock, kLocalContainerName.LogKey()));
+    APSARA_TEST_EQUAL(StringView("test-pod"), FindTag(*newBlock, kPodName.LogKey()));
+}
+
+void ProcessCacheValueUnittest::TestParentTagBlock() {
+    ProcessCacheValue value;
+    value.SetContent<kExecId>(StringView("exec-2345"));
+    value.SetContent<kProcessId>(StringView("2345"));
+    value.SetContent<kContainerId>(StringView("container-1"));
+
+    auto block = value.GetParentTagBlock();
+    APSARA_TEST_EQUAL(9UL, block->GetTags().size());
+    APSARA_TEST_EQUAL(StringView("exec-2345"), FindTag(*block, kParentExecId.LogKey()));
+    APSARA_TEST_EQUAL(StringView("2345"), FindTag(*block, kParentProcessId.LogKey()));
+    APSARA_TEST_EQUAL(StringView("container-1"), FindTag(*block, kParentContainerId.LogKey()));
+    APSARA_TEST_TRUE(FindTag(*block, kExecId.LogKey()).empty());
+    APSARA_TEST_EQUAL(block, value.GetParentTagBlock());
+}
+
+UNIT_TEST_CASE(ProcessCacheValueUnittest, TestTagBlock);
+UNIT_TEST_CASE(ProcessCacheValueUnittest, TestParentTagBlock);
+
 UNIT_TEST_MAIN
@@ -36,6 +36,8 @@ public:
     void TestParsePartialRequests();
     void TestProtocolParserManager();
     void TestHttpParserEdgeCases();
+    void TestParseTruncatedBody();
+    void TestErrorResponseSampled();
 
     void RequestBenchmark();
     void RequestWithoutBodyBenchmark();
@@ -57,7 +59,7 @@ void ProtocolParserUnittest::TestParseHttp() {
     const std::string input = "GET /index.html HTTP/1.1\r\nHost: www.cmonitor.ai\r\nAccept: image/gif, image/jpeg, "
                               "*/*\r\nUser-Agent: Mozilla/5.0 (X11; Linux x86_64)\r\n\r\n";
     std::string_view buf(input);
-    std::shared_ptr<HttpRecord> result = std::make_shared<HttpRecord>(nullptr);
+    auto result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
 
     ParseState state = http::ParseRequest(buf, result, true);
 
@@ -67,18 +69,18 @@ void ProtocolParserUnittest::TestParseHttp() {
     APSARA_TEST_EQUAL(result->GetPath(), "/index.html");
     APSARA_TEST_EQUAL(result->GetReqBody(), "");
     APSARA_TEST_EQUAL(result->GetReqBodySize(), 0UL);
-    APSARA_TEST_EQUAL(result->GetReqHeaderMap().size(), 3UL);
+    APSARA_TEST_EQUAL(result->GetReqHeaders().size(), 3UL);
 
-    // APSARA_TEST_EQUAL(result->GetReqHeaderMap()_byte_size, input.size());
+    // APSARA_TEST_EQUAL(result->GetReqHeaders()_byte_size, input.size());
     // APSARA_TEST_EQUAL(result.body, "");
     // APSARA_TEST_EQUAL(result.body_size, result.body.size());
 
     // // 检查头部信息
-    // APSARA_TEST_EQUAL(result->GetReqHeaderMap().size(), 3);
+    // APSARA_TEST_EQUAL(result->GetReqHeaders().size(), 3);
 
     const std::string input2 = "GET /path HTTP/1.1\r\nHost: example.com"; // Incomplete header
     std::string_view buf2(input2);
-    result = std::make_shared<HttpRecord>(nullptr);
+    result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
     state = http::ParseRequest(buf2, result, true);
     APSARA_TEST_EQUAL(state, ParseState::kNeedsMoreData);
 }
@@ -90,14 +92,14 @@ void ProtocolParserUnittest::TestParseHttpResponse() {
                               "\r\n"
                               "Hello, World!";
     std::string_view buf(input);
-    std::shared_ptr<HttpRecord> result = std::make_shared<HttpRecord>(nullptr);
+    auto result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
 
     ParseState state = http::ParseResponse(buf, result, false, true);
 
     APSARA_TEST_EQUAL(state, ParseState::kSuccess);
     APSARA_TEST_EQUAL(result->GetStatusCode(), 200);
     APSARA_TEST_EQUAL(result->GetRespMsg(), "OK");
-    APSARA_TEST_EQUAL(result->GetRespHeaderMap().size(), 2UL);
+    APSARA_TEST_EQUAL(result->GetRespHeaders().size(), 2UL);
     APSARA_TEST_EQUAL(result->GetRespBody(), "Hello, World!");
 
     // 测试404响应
@@ -107,7 +109,7 @@ void ProtocolParserUnittest::TestParseHttpResponse() {
                                  "\r\n"
                                  "Not Found";
     std::string_view buf2(notFound);
-    result = std::make_shared<HttpRecord>(nullptr);
+    result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
     state = http::ParseResponse(buf2, result, false, true);
     APSARA_TEST_EQUAL(state, ParseState::kSuccess);
     APSARA_TEST_EQUAL(result->GetStatusCode(), 404);
@@ -122,24 +124,24 @@ void ProtocolParserUnittest::TestParseHttpHeaders() {
                               "Cookie: session=abc123; user=john\r\n"
                               "\r\n";
     std::string_view buf(input);
-    std::shared_ptr<HttpRecord> result = std::make_shared<HttpRecord>(nullptr);
+    auto result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
 
     ParseState state = http::ParseRequest(buf, result, true);
     APSARA_TEST_EQUAL(state, ParseState::kSuccess);
-    APSARA_TEST_EQUAL(result->GetReqHeaderMap().size(), 4UL);
+    APSARA_TEST_EQUAL(result->GetReqHeaders().size(), 4UL);
 
     // 验证特定头部
-    APSARA_TEST_TRUE(result->GetReqHeaderMap().find("host") != result->GetReqHeaderMap().end());
-    APSARA_TEST_TRUE(result->GetReqHeaderMap().find("content-type") != result->GetReqHeaderMap().end());
-    APSARA_TEST_TRUE(result->GetReqHeaderMap().find("x-custom-header") != result->GetReqHeaderMap().end());
-    APSARA_TEST_TRUE(result->GetReqHeaderMap().find("cookie") != result->GetReqHeaderMap().end());
+    APSARA_TEST_TRUE(result->GetReqHeaders().find("host") != result->GetReqHeaders().end());
+    APSARA_TEST_TRUE(result->GetReqHeaders().find("content-type") != result->GetReqHeaders().end());
+    APSARA_TEST_TRUE(result->GetReqHeaders().find("x-custom-header") != result->GetReqHeaders().end());
+    APSARA_TEST_TRUE(result->GetReqHeaders().find("cookie") != result->GetReqHeaders().end());
 
     // 验证头部值
-    auto host = result->GetReqHeaderMap().find("host");
-    APSARA_TEST_NOT_EQUAL(host, result->GetReqHeaderMap().end());
+    auto host = result->GetReqHeaders().find("host");
+    APSARA_TEST_NOT_EQUAL(host, result->GetReqHeaders().end());
     APSARA_TEST_EQUAL(host->second, "example.com");
-    auto contentType = result->GetReqHeaderMap().find("content-type");
-    APSARA_TEST_NOT_EQUAL(contentType, result->GetReqHeaderMap().end());
+    auto contentType = result->GetReqHeaders().find("content-type");
+    APSARA_TEST_NOT_EQUAL(contentType, result->GetReqHeaders().end());
     APSARA_TEST_EQUAL(contentType->second, "application/json");
 }
 
@@ -155,8 +157,10 @@ void ProtocolParserUnittest::TestParseChunkedEncoding() {
                               "Network\r\n"
                               "0\r\n"
                               "\r\n";
-    std::string_view buf(input);
-    std::shared_ptr<HttpRecord> result = std::make_shared<HttpRecord>(nullptr);
+    auto result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
+    // chunks are decoded in place on the payload of the record
+    result->mPayload = input;
+    std::string_view buf(result->mPayload);
 
     ParseState state = http::ParseResponse(buf, result, false, true);
     APSARA_TEST_EQUAL(state, ParseState::kSuccess);
@@ -164,24 +168,31 @@ void ProtocolParserUnittest::TestParseChunkedEncoding() {
     // 验证分块解码后的完整消息
     std::string expected = "MozillaDeveloperNetwork";
     APSARA_TEST_EQUAL(result->GetRespBody(), expected);
+    APSARA_TEST_EQUAL(expected.size(), result->GetRespBodySize());
+    APSARA_TEST_TRUE(buf.empty());
+
+    // a buffer not owned by the record is not decoded
+    std::string_view external(input);
+    state = http::ParseResponse(external, result, false, true);
+    APSARA_TEST_EQUAL(state, ParseState::kInvalid);
 }
 
 void ProtocolParserUnittest::TestParseInvalidRequests() {
     const std::string invalidMethod = "INVALID /test HTTP/1.1\r\n\r\n";
     std::string_view buf1(invalidMethod);
-    std::shared_ptr<HttpRecord> result = std::make_shared<HttpRecord>(nullptr);
+    auto result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
     ParseState state = http::ParseRequest(buf1, result, true);
     APSARA_TEST_EQUAL(state, ParseState::kSuccess);
 
     const std::string invalidVersion = "GET /test HTTP/2.0\r\n\r\n";
     std::string_view buf2(invalidVersion);
-    result = std::make_shared<HttpRecord>(nullptr);
+    result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
     state = http::ParseRequest(buf2, result, true);
     APSARA_TEST_EQUAL(state, ParseState::kInvalid);
 
     const std::string invalidHeader = "GET /test HTTP/1.1\r\nInvalid Header\r\n\r\n";
     std::string_view buf3(invalidHeader);
-    result = std::make_shared<HttpRecord>(nullptr);
+    result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
     state = http::ParseRequest(buf3, result, true);
     APSARA_TEST_EQUAL(state, ParseState::kInvalid);
 }
@@ -190,14 +201,14 @@ void ProtocolParserUnittest::TestParsePartialRequests() {
     // 测试不完整的请求行
     const std::string partialRequestLine = "GET /test";
     std::string_view buf1(partialRequestLine);
-    std::shared_ptr<HttpRecord> result = std::make_shared<HttpRecord>(nullptr);
+    auto result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
     ParseState state = http::ParseRequest(buf1, result, true);
     APSARA_TEST_EQUAL(state, ParseState::kNeedsMoreData);
 
     // 测试不完整的头部
     const std::string partialHeaders = "GET /test HTTP/1.1\r\nHost: example.com\r\n";
     std::string_view buf2(partialHeaders);
-    result = std::make_shared<HttpRecord>(nullptr);
+    result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
     state = http::ParseRequest(buf2, result, true);
     APSARA_TEST_EQUAL(state, ParseState::kNeedsMoreData);
 
@@ -226,7 +237,7 @@ void ProtocolParserUnittest::TestHttpParserEdgeCases() {
     // 测试空请求
     const std::string emptyRequest;
     std::string_view buf1(emptyRequest);
-    std::shared_ptr<HttpRecord> result = std::make_shared<HttpRecord>(nullptr);
+    auto result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
     ParseState state = http::ParseRequest(buf1, result, true);
     APSARA_TEST_EQUAL(state, ParseState::kNeedsMoreData);
 
@@ -234,7 +245,7 @@ void ProtocolParserUnittest::TestHttpParserEdgeCases() {
     longUrl.append(2048, 'a');
     longUrl += " HTTP/1.1\r\n\r\n";
     std::string_view buf2(longUrl);
-    result = std::make_shared<HttpRecord>(nullptr);
+    result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
     state = http::ParseRequest(buf2, result, true);
     APSARA_TEST_EQUAL(state, ParseState::kSuccess);
 
@@ -244,11 +255,69 @@ void ProtocolParserUnittest::TestHttpParserEdgeCases() {
     }
     manyHeaders += "\r\n";
     std::string_view buf3(manyHeaders);
-    result = std::make_shared<HttpRecord>(nullptr);
+    result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
     state = http::ParseRequest(buf3, result, true);
     APSARA_TEST_EQUAL(state, ParseState::kInvalid);
 }
 
+void ProtocolParserUnittest::TestParseTruncatedBody() {
+    const std::string req = "GET /orders HTTP/1.1\r\nHost: example.com\r\n\r\n";
+    // the body was cut by the capture limit after 16 of 100 bytes
+    const std::string resp = "HTTP/1.1 500 Internal Server Error\r\n"
+                             "Content-Length: 100\r\n"
+                             "\r\n"
+                             "0123456789abcdef";
+    std::string msg = req + resp;
+    auto* event = static_cast<conn_data_event_t*>(malloc(offsetof(conn_data_event_t, msg) + msg.size()));
+    memcpy(event->msg, msg.data(), msg.size());
+    event->protocol = support_proto_e::ProtoHTTP;
+    event->role = support_role_e::IsClient;
+    event->request_len = req.size();
+    event->response_len = resp.size();
+    event->start_ts = 1;
+    event->end_ts = 2;
+
+    HTTPProtocolParser parser;
+    auto records = parser.Parse(event, nullptr, std::make_shared<HashRatioSampler>(0));
+    free(event);
+    APSARA_TEST_EQUAL(1UL, records.size());
+    auto* record = static_cast<HttpRecord*>(records[0].get());
+    APSARA_TEST_EQUAL(500, record->GetStatusCode());
+    APSARA_TEST_EQUAL("/orders", record->GetPath());
+    // 5xx is sampled, so the captured part of the body is kept
+    APSARA_TEST_EQUAL("0123456789abcdef", record->GetRespBody());
+    APSARA_TEST_EQUAL(100UL, record->GetRespBodySize());
+}
+
+void ProtocolParserUnittest::TestErrorResponseSampled() {
+    const std::string req = "GET /orders HTTP/1.1\r\nHost: example.com\r\n\r\n";
+    auto parse = [&](const std::string& resp) {
+        std::string msg = req + resp;
+        auto* event = static_cast<conn_data_event_t*>(malloc(offsetof(conn_data_event_t, msg) + msg.size()));
+        memcpy(event->msg, msg.data(), msg.size());
+        event->protocol = support_proto_e::ProtoHTTP;
+        event->role = support_role_e::IsClient;
+        event->request_len = req.size();
+        event->response_len = resp.size();
+        event->start_ts = 1;
+        event->end_ts = 2;
+        HTTPProtocolParser parser;
+        // nothing is sampled by rate
+        auto records = parser.Parse(event, nullptr, std::make_shared<HashRatioSampler>(0));
+        free(event);
+        return records;
+    };
+
+    auto records = parse("HTTP/1.1 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n");
+    APSARA_TEST_EQUAL(1UL, records.size());
+    APSARA_TEST_EQUAL(503, static_cast<HttpRecord*>(records[0].get())->GetStatusCode());
+    APSARA_TEST_TRUE(records[0]->ShouldSample());
+
+    records = parse("HTTP/1.1 200 OK\r\nContent-Length: 0\r\n\r\n");
+    APSARA_TEST_EQUAL(1UL, records.size());
+    APSARA_TEST_FALSE(records[0]->ShouldSample());
+}
+
 const std::string REQ
     = "GET /wp-content/uploads/2010/03/hello-kitty-darth-vader-pink.jpg HTTP/1.1\r\n"
       "Host: www.kittyhell.com\r\n"
@@ -291,7 +360,7 @@ const std::string RESP_MSG = "HTTP/1.1 200 OK\r\n"
                              "4444444444444444444444444444444444444444444444444444444444444444\r\n\r\n";
 
 void ProtocolParserUnittest::RequestBenchmark() {
-    std::shared_ptr<HttpRecord> result = std::make_shared<HttpRecord>(nullptr);
+    auto result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
 
     auto start = std::chrono::high_resolution_clock::now();
 
@@ -321,7 +390,7 @@ void ProtocolParserUnittest::RequestWithoutBodyBenchmark() {
 }
 
 void ProtocolParserUnittest::ResponseBenchmark() {
-    std::shared_ptr<HttpRecord> result = std::make_shared<HttpRecord>(nullptr);
+    auto result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
     auto start = std::chrono::high_resolution_clock::now();
     for (int i = 0; i < 1000000; i++) {
         std::string_view respBuf(RESP_MSG);
@@ -333,10 +402,11 @@ void ProtocolParserUnittest::ResponseBenchmark() {
 }
 
 void ProtocolParserUnittest::ChunkedResponseBenchmark() {
-    std::shared_ptr<HttpRecord> result = std::make_shared<HttpRecord>(nullptr);
+    auto result = RecordPool<HttpRecord>::GetInstance().Acquire(nullptr);
     auto start = std::chrono::high_resolution_clock::now();
     for (int i = 0; i < 1000000; i++) {
-        std::string_view respBuf(CHUNKED_RESP_MSG);
+        result->mPayload.assign(CHUNKED_RESP_MSG);
+        std::string_view respBuf(result->mPayload);
         http::ParseResponse(respBuf, result, false, true);
     }
     auto end = std::chrono::high_resolution_clock::now();
@@ -352,6 +422,8 @@ UNIT_TEST_CASE(ProtocolParserUnittest, TestParseInvalidRequests);
 UNIT_TEST_CASE(ProtocolParserUnittest, TestParsePartialRequests);
 UNIT_TEST_CASE(ProtocolParserUnittest, TestProtocolParserManager);
 UNIT_TEST_CASE(ProtocolParserUnittest, TestHttpParserEdgeCases);
+UNIT_TEST_CASE(ProtocolParserUnittest, TestParseTruncatedBody);
+UNIT_TEST_CASE(ProtocolParserUnittest, TestErrorResponseSampled);
 UNIT_TEST_CASE(ProtocolParserUnittest, RequestBenchmark);
 UNIT_TEST_CASE(ProtocolParserUnittest, RequestWithoutBodyBenchmark);
 UNIT_TEST_CASE(ProtocolParserUnittest, ResponseBenchmark);
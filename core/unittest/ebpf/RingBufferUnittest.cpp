@@ -0,0 +1,145 @@
+// Copyright 2025 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstring>
+
+#include <memory>
+#include <vector>
+
+#include "EBPFRawEventStub.h"
+#include "ebpf/driver/RingBuffer.h"
+#include "unittest/Unittest.h"
+
+namespace logtail {
+namespace ebpf {
+
+class RingBufferUnittest : public ::testing::Test {
+public:
+    void TestConsumeInOrder();
+    void TestReservedRecordBlocksLaterRecords();
+    void TestDiscardedRecordSkipped();
+    void TestBatchAcrossWrapAround();
+
+protected:
+    void SetUp() override {
+        mConsumerPos = 0;
+        mProducerPos = 0;
+        mData.assign(2 * kSize, 0);
+        mPids.clear();
+        mConsumer = std::make_unique<RingBufferConsumer>(
+            &mConsumerPos, &mProducerPos, mData.data(), kSize, this, [](void* ctx, int, void* data, uint32_t size) {
+                auto* self = static_cast<RingBufferUnittest*>(ctx);
+                APSARA_TEST_EQUAL(sizeof(msg_execve_event), size);
+                self->mPids.push_back(static_cast<msg_execve_event*>(data)->process.pid);
+            });
+    }
+
+    // what bpf_ringbuf_reserve does in the kernel, returns the position of the record header
+    uint64_t Reserve(uint32_t pid) {
+        uint64_t pos = mProducerPos;
+        auto event = CreateStubExecveEvent();
+        event.process.pid = pid;
+        uint32_t hdr[2] = {static_cast<uint32_t>(sizeof(event)) | kRingBufBusyBit, 0};
+        Write(pos, hdr, sizeof(hdr));
+        Write(pos + kRingBufHdrSize, &event, sizeof(event));
+        mProducerPos = pos + ((kRingBufHdrSize + sizeof(event) + 7) & ~7UL);
+        return pos;
+    }
+
+    // what bpf_ringbuf_submit and bpf_ringbuf_discard do in the kernel
+    void Commit(uint64_t pos, bool discard = false) {
+        uint32_t len = sizeof(msg_execve_event) | (discard ? kRingBufDiscardBit : 0);
+        Write(pos, &len, sizeof(len));
+    }
+
+    // the data area is mapped twice, so every byte shows up at both offsets
+    void Write(uint64_t pos, const void* src, size_t len) {
+        const auto* bytes = static_cast<const uint8_t*>(src);
+        for (size_t i = 0; i < len; ++i) {
+            size_t off = (pos + i) & (kSize - 1);
+            mData[off] = bytes[i];
+            mData[off + kSize] = bytes[i];
+        }
+    }
+
+    static constexpr size_t kSize = 1 << 16;
+    uint64_t mConsumerPos = 0;
+    uint64_t mProducerPos = 0;
+    std::vector<uint8_t> mData;
+    std::vector<uint32_t> mPids;
+    std::unique_ptr<RingBufferConsumer> mConsumer;
+};
+
+void RingBufferUnittest::TestConsumeInOrder() {
+    for (uint32_t pid = 1; pid <= 3; ++pid) {
+        Commit(Reserve(pid));
+    }
+    APSARA_TEST_EQUAL(3, mConsumer->Consume(16));
+    APSARA_TEST_EQUAL(std::vector<uint32_t>({1, 2, 3}), mPids);
+    APSARA_TEST_EQUAL(mProducerPos, mConsumerPos);
+    APSARA_TEST_EQUAL(0UL, mConsumer->Pending());
+    APSARA_TEST_EQUAL(0, mConsumer->Consume(16));
+}
+
+void RingBufferUnittest::TestReservedRecordBlocksLaterRecords() {
+    // two cpus reserve in turn, the second one commits first
+    auto first = Reserve(1);
+    auto second = Reserve(2);
+    Commit(second);
+    APSARA_TEST_EQUAL(0, mConsumer->Consume(16));
+    APSARA_TEST_EQUAL(0UL, mConsumerPos);
+
+    Commit(first);
+    APSARA_TEST_EQUAL(2, mConsumer->Consume(16));
+    APSARA_TEST_EQUAL(std::vector<uint32_t>({1, 2}), mPids);
+}
+
+void RingBufferUnittest::TestDiscardedRecordSkipped() {
+    Commit(Reserve(1));
+    Commit(Reserve(2), true);
+    Commit(Reserve(3));
+    APSARA_TEST_EQUAL(2, mConsumer->Consume(16));
+    APSARA_TEST_EQUAL(std::vector<uint32_t>({1, 3}), mPids);
+    APSARA_TEST_EQUAL(mProducerPos, mConsumerPos);
+}
+
+void RingBufferUnittest::TestBatchAcrossWrapAround() {
+    const size_t recordSize = (kRingBufHdrSize + sizeof(msg_execve_event) + 7) & ~7UL;
+    // enough records to go around the ring several times
+    const uint32_t total = 4 * kSize / recordSize;
+    std::vector<uint32_t> expected;
+    uint32_t pid = 0;
+    while (mPids.size() < total) {
+        while (pid < total && mProducerPos - mConsumerPos + recordSize <= kSize) {
+            Commit(Reserve(pid));
+            expected.push_back(pid++);
+        }
+        auto before = mPids.size();
+        int cnt = mConsumer->Consume(7);
+        APSARA_TEST_TRUE(cnt <= 7);
+        APSARA_TEST_EQUAL(before + cnt, mPids.size());
+    }
+    APSARA_TEST_EQUAL(expected, mPids);
+    APSARA_TEST_TRUE(mConsumerPos > 3 * kSize);
+}
+
+UNIT_TEST_CASE(RingBufferUnittest, TestConsumeInOrder);
+UNIT_TEST_CASE(RingBufferUnittest, TestReservedRecordBlocksLaterRecords);
+UNIT_TEST_CASE(RingBufferUnittest, TestDiscardedRecordSkipped);
+UNIT_TEST_CASE(RingBufferUnittest, TestBatchAcrossWrapAround);
+
+} // namespace ebpf
+} // namespace logtail
+
+UNIT_TEST_MAIN
@@ -55,7 +55,7 @@ void HostMonitorInputRunnerUnittest::TestUpdateAndRemoveCollector() const {
     APSARA_TEST_FALSE_FATAL(
         runner->IsCollectTaskValid(std::chrono::steady_clock::now() - std::chrono::seconds(60), MockCollector::sName));
     APSARA_TEST_TRUE_FATAL(runner->HasRegisteredPlugins());
-    APSARA_TEST_EQUAL_FATAL(1, Timer::GetInstance()->mQueue.size());
+    APSARA_TEST_EQUAL_FATAL(1, Timer::GetInstance()->Size());
     runner->RemoveCollector({MockCollector::sName});
     APSARA_TEST_FALSE_FATAL(runner->IsCollectTaskValid(std::chrono::steady_clock::now(), MockCollector::sName));
     APSARA_TEST_FALSE_FATAL(runner->HasRegisteredPlugins());
@@ -77,9 +77,9 @@ void HostMonitorInputRunnerUnittest::TestScheduleOnce() const {
     std::chrono::time_point now = std::chrono::steady_clock::now();
     runner->ScheduleOnce(now, collectConfig);
     std::this_thread::sleep_for(std::chrono::seconds(1));
-    APSARA_TEST_EQUAL_FATAL(1, Timer::GetInstance()->mQueue.size());
+    APSARA_TEST_EQUAL_FATAL(1, Timer::GetInstance()->Size());
     APSARA_TEST_EQUAL_FATAL((now + std::chrono::seconds(60)).time_since_epoch().count(),
-                            Timer::GetInstance()->mQueue.top()->GetExecTime().time_since_epoch().count());
+                            Timer::GetInstance()->Top()->GetExecTime().time_since_epoch().count());
     auto item = std::unique_ptr<ProcessQueueItem>(new ProcessQueueItem(std::make_shared<SourceBuffer>(), 0));
     ProcessQueueManager::GetInstance()->EnablePop(configName);
     APSARA_TEST_TRUE_FATAL(ProcessQueueManager::GetInstance()->PopItem(0, item, configName));
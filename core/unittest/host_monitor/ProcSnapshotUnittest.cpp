@@ -0,0 +1,198 @@
+// Copyright 2025 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "boost/filesystem/operations.hpp"
+
+#include "common/Flags.h"
+#include "host_monitor/Constants.h"
+#include "host_monitor/ProcSnapshot.h"
+#include "unittest/Unittest.h"
+
+DECLARE_FLAG_INT32(host_monitor_proc_snapshot_ttl_ms);
+
+using namespace std;
+
+namespace logtail {
+
+class ProcSnapshotUnittest : public testing::Test {
+public:
+    void TestParseProcessStat() const;
+    void TestGetSnapshot() const;
+    void TestSnapshotTTL() const;
+    void TestReadProcessStat() const;
+    void TestReadSystemStat() const;
+
+protected:
+    void SetUp() override {
+        bfs::remove_all(mRoot);
+        WriteProcessStat(1, "cat");
+        WriteProcessStat(2, "kworker/0:0 (a)");
+        ofstream ofs(mRoot + "/stat", std::ios::trunc);
+        ofs << "cpu  1195061569 1728645 418424132 203670447952 14723544 0 773400 0 0 0\n";
+        ofs << "btime 1731142542\n";
+        ofs.close();
+        PROCESS_DIR = mRoot;
+        INT32_FLAG(host_monitor_proc_snapshot_ttl_ms) = 0;
+        ProcSnapshotManager::GetInstance()->Clear();
+    }
+
+    void TearDown() override {
+        ProcSnapshotManager::GetInstance()->Clear();
+        INT32_FLAG(host_monitor_proc_snapshot_ttl_ms) = 1000;
+        PROCESS_DIR = "/proc";
+        bfs::remove_all(mRoot);
+    }
+
+    void WriteProcessStat(pid_t pid, const string& name) const {
+        bfs::create_directories(mRoot + "/" + to_string(pid));
+        ofstream ofs(mRoot + "/" + to_string(pid) + "/stat", std::ios::trunc);
+        ofs << pid << " (" << name
+            << ") R 0 1 1 34816 1 4194560 1110 0 0 0 1 1 0 0 20 0 1 0 18938584 4505600 171 18446744073709551615 "
+               "4194304 4238788 140727020025920 0 0 0 0 0 0 0 0 0 17 3 0 0 0 0 0 6336016 6337300 21442560 "
+               "140727020027760 140727020027777 140727020027777 140727020027887 0\n";
+    }
+
+    string mRoot = "./proc_snapshot";
+};
+
+void ProcSnapshotUnittest::TestParseProcessStat() const {
+    string line = "1 (cat) S -1 1 1 34816 1 4194560 1110 0 3 0 7 8 9 10 20 -5 4 0 18938584 4505600 171 "
+                  "18446744073709551615 4194304 4238788 140727020025920 0 0 0 0 0 0 0 0 0 17 3 0 0 0 0 0";
+    ProcessStat stat;
+    APSARA_TEST_TRUE(ProcSnapshotManager::ParseProcessStat(1, line.data(), line.size(), stat));
+    APSARA_TEST_EQUAL(1, stat.pid);
+    APSARA_TEST_EQUAL("cat", stat.name);
+    APSARA_TEST_EQUAL('S', stat.state);
+    APSARA_TEST_EQUAL(-1, stat.parentPid);
+    APSARA_TEST_EQUAL(34816, stat.tty);
+    APSARA_TEST_EQUAL(1110U, stat.minorFaults);
+    APSARA_TEST_EQUAL(3U, stat.majorFaults);
+    APSARA_TEST_EQUAL(7U, stat.utimeTicks);
+    APSARA_TEST_EQUAL(8U, stat.stimeTicks);
+    APSARA_TEST_EQUAL(9U, stat.cutimeTicks);
+    APSARA_TEST_EQUAL(10U, stat.cstimeTicks);
+    APSARA_TEST_EQUAL(20, stat.priority);
+    APSARA_TEST_EQUAL(-5, stat.nice);
+    APSARA_TEST_EQUAL(4, stat.numThreads);
+    APSARA_TEST_EQUAL(18938584, stat.startTicks);
+    APSARA_TEST_EQUAL(4505600U, stat.vSize);
+    APSARA_TEST_EQUAL(171U * getpagesize(), stat.rss);
+    APSARA_TEST_EQUAL(3, stat.processor);
+
+    // the name may contain spaces and parentheses
+    line = "2 (a) b (c)) R 1 1 1 0 1 4194560 1110 0 0 0 1 1 0 0 20 0 1 0 18938584 4505600 171 0 0 0 0 0 0 0 0 0 0 "
+           "0 0 0 17 5 0";
+    APSARA_TEST_TRUE(ProcSnapshotManager::ParseProcessStat(2, line.data(), line.size(), stat));
+    APSARA_TEST_EQUAL("a) b (c)", stat.name);
+    APSARA_TEST_EQUAL(1, stat.parentPid);
+    APSARA_TEST_EQUAL(5, stat.processor);
+
+    // truncated
+    line = "3 (cat) R 1 1 1 0 1 4194560";
+    APSARA_TEST_FALSE(ProcSnapshotManager::ParseProcessStat(3, line.data(), line.size(), stat));
+    line = "3 cat R 1 1 1 0 1 4194560";
+    APSARA_TEST_FALSE(ProcSnapshotManager::ParseProcessStat(3, line.data(), line.size(), stat));
+}
+
+void ProcSnapshotUnittest::TestGetSnapshot() const {
+    auto manager = ProcSnapshotManager::GetInstance();
+    auto snapshot = manager->GetSnapshot();
+    APSARA_TEST_NOT_EQUAL(nullptr, snapshot);
+    APSARA_TEST_EQUAL(2U, snapshot->mProcesses.size());
+    APSARA_TEST_EQUAL(2U, manager->mStatFds.size());
+    // processes seen for the first time are not kept open
+    APSARA_TEST_EQUAL(0U, manager->mOpenStatFdCnt);
+
+    WriteProcessStat(3, "sh");
+    snapshot = manager->GetSnapshot();
+    APSARA_TEST_EQUAL(3U, snapshot->mProcesses.size());
+    APSARA_TEST_EQUAL(2U, manager->mOpenStatFdCnt);
+    APSARA_TEST_EQUAL(-1, manager->mStatFds[3].mFd);
+
+    // cached fds see the new content
+    WriteProcessStat(1, "cat2");
+    bfs::remove_all(mRoot + "/2");
+    snapshot = manager->GetSnapshot();
+    APSARA_TEST_EQUAL(2U, snapshot->mProcesses.size());
+    APSARA_TEST_EQUAL(2U, manager->mStatFds.size());
+    APSARA_TEST_EQUAL(2U, manager->mOpenStatFdCnt);
+    for (const auto& stat : snapshot->mProcesses) {
+        if (stat.pid == 1) {
+            APSARA_TEST_EQUAL("cat2", stat.name);
+        } else {
+            APSARA_TEST_EQUAL(3, stat.pid);
+        }
+    }
+
+    PROCESS_DIR = mRoot + "/not_exist";
+    APSARA_TEST_EQUAL(nullptr, manager->GetSnapshot());
+    APSARA_TEST_EQUAL(0U, manager->mStatFds.size());
+}
+
+void ProcSnapshotUnittest::TestSnapshotTTL() const {
+    INT32_FLAG(host_monitor_proc_snapshot_ttl_ms) = 60000;
+    auto manager = ProcSnapshotManager::GetInstance();
+    auto snapshot = manager->GetSnapshot();
+    APSARA_TEST_EQUAL(2U, snapshot->mProcesses.size());
+    WriteProcessStat(3, "sh");
+    APSARA_TEST_EQUAL(snapshot.get(), manager->GetSnapshot().get());
+
+    INT32_FLAG(host_monitor_proc_snapshot_ttl_ms) = 0;
+    APSARA_TEST_NOT_EQUAL(snapshot.get(), manager->GetSnapshot().get());
+    APSARA_TEST_EQUAL(3U, manager->GetSnapshot()->mProcesses.size());
+}
+
+void ProcSnapshotUnittest::TestReadProcessStat() const {
+    ProcessStat stat;
+    APSARA_TEST_TRUE(ProcSnapshotManager::GetInstance()->ReadProcessStat(2, stat));
+    APSARA_TEST_EQUAL(2, stat.pid);
+    APSARA_TEST_EQUAL("kworker/0:0 (a)", stat.name);
+    APSARA_TEST_FALSE(ProcSnapshotManager::GetInstance()->ReadProcessStat(4, stat));
+}
+
+void ProcSnapshotUnittest::TestReadSystemStat() const {
+    auto manager = ProcSnapshotManager::GetInstance();
+    vector<string> lines;
+    APSARA_TEST_TRUE(manager->ReadSystemStat(lines));
+    APSARA_TEST_EQUAL(2U, lines.size());
+    APSARA_TEST_EQUAL("btime 1731142542", lines[1]);
+    // no process is scanned
+    APSARA_TEST_EQUAL(nullptr, manager->mSnapshot);
+    APSARA_TEST_EQUAL(0U, manager->mStatFds.size());
+
+    // the cached fd sees the new content
+    ofstream ofs(mRoot + "/stat", std::ios::trunc);
+    ofs << "btime 1731142543\n";
+    ofs.close();
+    lines.clear();
+    APSARA_TEST_TRUE(manager->ReadSystemStat(lines));
+    APSARA_TEST_EQUAL(1U, lines.size());
+    APSARA_TEST_EQUAL("btime 1731142543", lines[0]);
+
+    PROCESS_DIR = mRoot + "/not_exist";
+    lines.clear();
+    APSARA_TEST_FALSE(manager->ReadSystemStat(lines));
+}
+
+UNIT_TEST_CASE(ProcSnapshotUnittest, TestParseProcessStat);
+UNIT_TEST_CASE(ProcSnapshotUnittest, TestGetSnapshot);
+UNIT_TEST_CASE(ProcSnapshotUnittest, TestSnapshotTTL);
+UNIT_TEST_CASE(ProcSnapshotUnittest, TestReadProcessStat);
+UNIT_TEST_CASE(ProcSnapshotUnittest, TestReadSystemStat);
+
+} // namespace logtail
+
+UNIT_TEST_MAIN
@@ -12,10 +12,13 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "common/Flags.h"
 #include "host_monitor/Constants.h"
 #include "host_monitor/collector/ProcessEntityCollector.h"
 #include "unittest/Unittest.h"
 
+DECLARE_FLAG_INT32(host_monitor_proc_snapshot_ttl_ms);
+
 using namespace std;
 
 namespace logtail {
@@ -26,6 +29,7 @@ public:
     void TestSortProcessByCpu() const;
     void TestGetProcessEntityID() const;
     void TestGetSystemBootSeconds() const;
+    void TestProcessEntryEviction() const;
 
 protected:
     void SetUp() override {
@@ -60,7 +64,7 @@ void ProcessEntityCollectorUnittest::TestSortProcessByCpu() const {
     auto prev = processes[0];
     for (auto i = 1UL; i < processes.size(); i++) {
         auto process = processes[i];
-        APSARA_TEST_TRUE(process->cpuInfo.percent >= prev->cpuInfo.percent);
+        APSARA_TEST_TRUE(process->cpuInfo.percent <= prev->cpuInfo.percent);
         prev = process;
     }
 }
@@ -76,10 +80,32 @@ void ProcessEntityCollectorUnittest::TestGetSystemBootSeconds() const {
     APSARA_TEST_EQUAL(1731142542, collect.GetHostSystemBootTime());
 }
 
+void ProcessEntityCollectorUnittest::TestProcessEntryEviction() const {
+    PROCESS_DIR = ".";
+    INT32_FLAG(host_monitor_proc_snapshot_ttl_ms) = 0;
+    ProcessEntityCollector collector;
+    auto processes = vector<ExtendedProcessStatPtr>();
+    collector.GetSortedProcess(processes, 3);
+    // the first sample has no cpu delta
+    APSARA_TEST_TRUE(processes.empty());
+    APSARA_TEST_EQUAL(1U, collector.mProcessEntries.count(1));
+
+    collector.GetSortedProcess(processes, 3);
+    APSARA_TEST_EQUAL(1U, processes.size());
+    APSARA_TEST_EQUAL(1, processes[0]->stat.pid);
+
+    bfs::remove_all("./1");
+    collector.GetSortedProcess(processes, 3);
+    APSARA_TEST_TRUE(processes.empty());
+    APSARA_TEST_EQUAL(0U, collector.mProcessEntries.count(1));
+    INT32_FLAG(host_monitor_proc_snapshot_ttl_ms) = 1000;
+}
+
 UNIT_TEST_CASE(ProcessEntityCollectorUnittest, TestGetNewProcessStat);
 UNIT_TEST_CASE(ProcessEntityCollectorUnittest, TestSortProcessByCpu);
 UNIT_TEST_CASE(ProcessEntityCollectorUnittest, TestGetProcessEntityID);
 UNIT_TEST_CASE(ProcessEntityCollectorUnittest, TestGetSystemBootSeconds);
+UNIT_TEST_CASE(ProcessEntityCollectorUnittest, TestProcessEntryEviction);
 
 } // namespace logtail
 
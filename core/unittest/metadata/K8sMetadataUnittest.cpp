@@ -20,6 +20,10 @@
 #include "models/PipelineEventGroup.h"
 #include "unittest/Unittest.h"
 
+DECLARE_FLAG_INT32(k8s_metadata_max_pending_keys);
+DECLARE_FLAG_INT32(k8s_metadata_negative_cache_ttl_sec);
+DECLARE_FLAG_INT32(k8s_metadata_unknown_cid_cache_ttl_sec);
+
 using namespace std;
 
 namespace logtail {
@@ -35,9 +39,78 @@ protected:
 
 public:
     void TestAsyncQueryMetadata() {
-        // AsyncQueryMetadata, will add to pending queue and batch keys
-        // mock server handle ...
-        // verify
+        auto& k8sMetadata = K8sMetadata::GetInstance();
+        auto isPending = [&k8sMetadata](const std::string& key) {
+            std::unique_lock<std::mutex> lock(k8sMetadata.mStateMux);
+            return k8sMetadata.mPendingKeys.count(key) > 0;
+        };
+
+        // container ids the server does not know are not queried again
+        k8sMetadata.UpdateUnknownCidCache({"unknown-cid", "known-cid"}, {"known-cid"});
+        APSARA_TEST_TRUE(k8sMetadata.IsUnknownContainerId("unknown-cid"));
+        APSARA_TEST_FALSE(k8sMetadata.IsUnknownContainerId("known-cid"));
+        k8sMetadata.AsyncQueryMetadata(PodInfoType::ContainerIdInfo, "unknown-cid");
+        APSARA_TEST_FALSE(isPending("unknown-cid"));
+
+        // new keys are dropped once the pending set is full
+        int32_t maxPendingKeys = INT32_FLAG(k8s_metadata_max_pending_keys);
+        INT32_FLAG(k8s_metadata_max_pending_keys) = 0;
+        k8sMetadata.AsyncQueryMetadata(PodInfoType::IpInfo, "10.0.0.1");
+        APSARA_TEST_FALSE(isPending("10.0.0.1"));
+        INT32_FLAG(k8s_metadata_max_pending_keys) = maxPendingKeys;
+
+        // resolving a container id clears its miss
+        k8sMetadata.SetContainerCache("unknown-cid", std::make_shared<K8sPodInfo>());
+        APSARA_TEST_FALSE(k8sMetadata.IsUnknownContainerId("unknown-cid"));
+        k8sMetadata.mContainerCache.remove("unknown-cid");
+    }
+
+    void TestNegativeCacheExpire() {
+        auto& k8sMetadata = K8sMetadata::GetInstance();
+        int32_t ttl = INT32_FLAG(k8s_metadata_negative_cache_ttl_sec);
+        INT32_FLAG(k8s_metadata_negative_cache_ttl_sec) = 0;
+        k8sMetadata.UpdateExternalIpCache({"172.16.30.1"}, {});
+        APSARA_TEST_FALSE(k8sMetadata.IsExternalIp("172.16.30.1"));
+        // expired miss is evicted on lookup
+        APSARA_TEST_FALSE(k8sMetadata.mExternalIpCache.contains("172.16.30.1"));
+        INT32_FLAG(k8s_metadata_negative_cache_ttl_sec) = ttl;
+
+        k8sMetadata.UpdateExternalIpCache({"172.16.30.1"}, {});
+        APSARA_TEST_TRUE(k8sMetadata.IsExternalIp("172.16.30.1"));
+        // an ip later resolved to a pod is no longer external
+        k8sMetadata.SetIpCache("172.16.30.1", std::make_shared<K8sPodInfo>());
+        APSARA_TEST_FALSE(k8sMetadata.IsExternalIp("172.16.30.1"));
+        APSARA_TEST_TRUE(k8sMetadata.GetInfoByIpFromCache("172.16.30.1") != nullptr);
+        k8sMetadata.mIpCache.remove("172.16.30.1");
+
+        // container id misses have their own ttl
+        int32_t cidTtl = INT32_FLAG(k8s_metadata_unknown_cid_cache_ttl_sec);
+        INT32_FLAG(k8s_metadata_unknown_cid_cache_ttl_sec) = 0;
+        k8sMetadata.UpdateUnknownCidCache({"new-cid"}, {});
+        k8sMetadata.UpdateExternalIpCache({"172.16.30.2"}, {});
+        APSARA_TEST_FALSE(k8sMetadata.IsUnknownContainerId("new-cid"));
+        APSARA_TEST_TRUE(k8sMetadata.IsExternalIp("172.16.30.2"));
+        INT32_FLAG(k8s_metadata_unknown_cid_cache_ttl_sec) = cidTtl;
+        k8sMetadata.mExternalIpCache.remove("172.16.30.2");
+    }
+
+    void TestShardedLRUCache() {
+        ShardedLRUCache<std::string, int> cache(64, 0);
+        APSARA_TEST_EQUAL(cache.getMaxSize(), 64UL);
+        for (int i = 0; i < 1000; ++i) {
+            cache.insert(std::to_string(i), i);
+        }
+        APSARA_TEST_TRUE(cache.size() > 0);
+        APSARA_TEST_TRUE(cache.size() <= cache.getMaxSize());
+        // the most recent key of every shard survives eviction
+        int value = 0;
+        APSARA_TEST_TRUE(cache.tryGetCopy("999", value));
+        APSARA_TEST_EQUAL(value, 999);
+        APSARA_TEST_TRUE(cache.contains("999"));
+        APSARA_TEST_TRUE(cache.remove("999"));
+        APSARA_TEST_FALSE(cache.contains("999"));
+        cache.clear();
+        APSARA_TEST_TRUE(cache.empty());
     }
 
     void TestExternalIpOperations() {
@@ -316,6 +389,8 @@ APSARA_UNIT_TEST_CASE(k8sMetadataUnittest, TestExternalIpOperations, 2);
 APSARA_UNIT_TEST_CASE(k8sMetadataUnittest, TestAsyncQueryMetadata, 3);
 APSARA_UNIT_TEST_CASE(k8sMetadataUnittest, TestNetworkCheck, 4);
 APSARA_UNIT_TEST_CASE(k8sMetadataUnittest, TestBuildAsyncQuery, 5);
+APSARA_UNIT_TEST_CASE(k8sMetadataUnittest, TestNegativeCacheExpire, 6);
+APSARA_UNIT_TEST_CASE(k8sMetadataUnittest, TestShardedLRUCache, 7);
 
 } // end of namespace logtail
 
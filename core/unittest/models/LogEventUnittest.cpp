@@ -28,6 +28,9 @@ public:
     void TestDelContent();
     void TestReadContentOp();
     void TestIterateContent();
+    void TestCompactContents();
+    void TestRewriteContents();
+    void TestLazyParser();
     void TestMeta();
     void TestSize();
     void TestReset();
@@ -158,6 +161,144 @@ void LogEventUnittest::TestIterateContent() {
     }
 }
 
+void LogEventUnittest::TestCompactContents() {
+    mLogEvent->SetContent(string("key1"), string("value1"));
+    mLogEvent->SetContent(string("key2"), string("value2"));
+    mLogEvent->SetContent(string("key3"), string("value3"));
+    mLogEvent->DelContent("key1");
+    mLogEvent->CompactContents();
+    APSARA_TEST_EQUAL(2U, mLogEvent->mContents.size());
+    APSARA_TEST_EQUAL(2U, mLogEvent->Size());
+    APSARA_TEST_STREQ("key2", mLogEvent->begin()->first.data());
+    APSARA_TEST_EQUAL("value3", mLogEvent->GetContent("key3").to_string());
+    auto it = mLogEvent->FindContent("key3");
+    APSARA_TEST_TRUE(it != mLogEvent->end());
+    APSARA_TEST_EQUAL("value3", it->second.to_string());
+
+    // existing key after compaction should be updated in place
+    mLogEvent->SetContent(string("key2"), string("value4"));
+    APSARA_TEST_EQUAL(2U, mLogEvent->mContents.size());
+    APSARA_TEST_EQUAL("value4", mLogEvent->GetContent("key2").to_string());
+}
+
+void LogEventUnittest::TestRewriteContents() {
+    size_t basicSize = sizeof(time_t) + sizeof(long) + sizeof(vector<pair<LogContent, bool>>);
+    mLogEvent->SetContent(string("key1"), string("value1"));
+    mLogEvent->SetContent(string("key2"), string("value2"));
+    mLogEvent->SetContent(string("key3"), string("value3"));
+    mLogEvent->SetContent(string("key4"), string("value4"));
+    mLogEvent->DelContent("key2");
+    mLogEvent->RewriteContents([](LogContent& content) {
+        if (content.first == "key1") {
+            return false;
+        }
+        if (content.first == "key3") {
+            content.first = StringView("k3");
+        }
+        return true;
+    });
+    APSARA_TEST_EQUAL(2U, mLogEvent->mContents.size());
+    APSARA_TEST_EQUAL(2U, mLogEvent->Size());
+    APSARA_TEST_FALSE(mLogEvent->HasContent("key1"));
+    APSARA_TEST_FALSE(mLogEvent->HasContent("key3"));
+    APSARA_TEST_EQUAL("value3", mLogEvent->GetContent("k3").to_string());
+    APSARA_TEST_EQUAL("value4", mLogEvent->GetContent("key4").to_string());
+    APSARA_TEST_STREQ("k3", mLogEvent->begin()->first.to_string().c_str());
+    APSARA_TEST_EQUAL(basicSize + 18U, mLogEvent->DataSize());
+
+    // renaming to an existing key overwrites the value of the existing content, like SetContent
+    mLogEvent->SetContent(string("key5"), string("value5"));
+    mLogEvent->RewriteContents([](LogContent& content) {
+        if (content.first == "key4") {
+            content.first = StringView("k3");
+        }
+        return true;
+    });
+    APSARA_TEST_EQUAL(2U, mLogEvent->mContents.size());
+    APSARA_TEST_EQUAL(2U, mLogEvent->Size());
+    APSARA_TEST_EQUAL("value4", mLogEvent->GetContent("k3").to_string());
+    APSARA_TEST_STREQ("k3", mLogEvent->begin()->first.to_string().c_str());
+    APSARA_TEST_EQUAL("value5", mLogEvent->GetContent("key5").to_string());
+    APSARA_TEST_EQUAL(basicSize + 18U, mLogEvent->DataSize());
+
+    // when several contents are renamed to the same new key, the last one wins and the first one keeps its position
+    mLogEvent->SetContent(string("key6"), string("value6"));
+    mLogEvent->RewriteContents([](LogContent& content) {
+        if (content.first == "k3" || content.first == "key6") {
+            content.first = StringView("k");
+        }
+        return true;
+    });
+    APSARA_TEST_EQUAL(2U, mLogEvent->mContents.size());
+    APSARA_TEST_EQUAL(2U, mLogEvent->Size());
+    APSARA_TEST_STREQ("k", mLogEvent->begin()->first.to_string().c_str());
+    APSARA_TEST_EQUAL("value6", mLogEvent->GetContent("k").to_string());
+    APSARA_TEST_EQUAL("value5", mLogEvent->GetContent("key5").to_string());
+    APSARA_TEST_EQUAL(basicSize + 17U, mLogEvent->DataSize());
+}
+
+class LazyLogParserMock : public LazyLogParser {
+public:
+    bool ParseLazily(LogEvent& e) override {
+        ++mParseCnt;
+        e.SetContent(string("parsed"), string("value"));
+        return !mDiscard;
+    }
+    bool MayTouch(const LogEvent& e, StringView key) const override { return key == "parsed"; }
+
+    size_t mParseCnt = 0;
+    bool mDiscard = false;
+};
+
+void LogEventUnittest::TestLazyParser() {
+    LazyLogParserMock parser;
+    mLogEvent->SetContent(string("key1"), string("value1"));
+    mLogEvent->SetLazyParser(&parser);
+    APSARA_TEST_TRUE(mLogEvent->HasPendingParse());
+    {
+        // untouched keys
+        APSARA_TEST_EQUAL("value1", mLogEvent->GetContent("key1").to_string());
+        APSARA_TEST_TRUE(mLogEvent->FindContent("key2") == mLogEvent->end());
+        APSARA_TEST_EQUAL(0U, parser.mParseCnt);
+    }
+    {
+        // touched key
+        APSARA_TEST_TRUE(mLogEvent->HasContent("parsed"));
+        APSARA_TEST_FALSE(mLogEvent->HasPendingParse());
+        APSARA_TEST_EQUAL(1U, parser.mParseCnt);
+        APSARA_TEST_FALSE(mLogEvent->IsDiscardedByParser());
+    }
+    {
+        // iteration
+        mLogEvent->Reset();
+        mLogEvent->ResetPipelineEventGroup(mEventGroup.get());
+        mLogEvent->SetLazyParser(&parser);
+        // begin() is called first, since end() never materializes
+        auto it = mLogEvent->begin();
+        APSARA_TEST_FALSE(it == mLogEvent->end());
+        APSARA_TEST_EQUAL(2U, parser.mParseCnt);
+    }
+    {
+        // modification
+        parser.mDiscard = true;
+        mLogEvent->Reset();
+        mLogEvent->ResetPipelineEventGroup(mEventGroup.get());
+        mLogEvent->SetLazyParser(&parser);
+        mLogEvent->SetContent(string("key1"), string("value1"));
+        APSARA_TEST_EQUAL(3U, parser.mParseCnt);
+        APSARA_TEST_TRUE(mLogEvent->IsDiscardedByParser());
+        APSARA_TEST_STREQ("parsed", mLogEvent->begin()->first.to_string().c_str());
+    }
+    {
+        // reset
+        mLogEvent->SetLazyParser(&parser);
+        mLogEvent->Reset();
+        APSARA_TEST_FALSE(mLogEvent->HasPendingParse());
+        APSARA_TEST_FALSE(mLogEvent->IsDiscardedByParser());
+        APSARA_TEST_EQUAL(3U, parser.mParseCnt);
+    }
+}
+
 void LogEventUnittest::TestMeta() {
     mLogEvent->SetPosition(1U, 2U);
     APSARA_TEST_EQUAL(1U, mLogEvent->GetPosition().first);
@@ -227,6 +368,9 @@ UNIT_TEST_CASE(LogEventUnittest, TestSetContent)
 UNIT_TEST_CASE(LogEventUnittest, TestDelContent)
 UNIT_TEST_CASE(LogEventUnittest, TestReadContentOp)
 UNIT_TEST_CASE(LogEventUnittest, TestIterateContent)
+UNIT_TEST_CASE(LogEventUnittest, TestCompactContents)
+UNIT_TEST_CASE(LogEventUnittest, TestRewriteContents)
+UNIT_TEST_CASE(LogEventUnittest, TestLazyParser)
 UNIT_TEST_CASE(LogEventUnittest, TestMeta)
 UNIT_TEST_CASE(LogEventUnittest, TestSize)
 UNIT_TEST_CASE(LogEventUnittest, TestReset)
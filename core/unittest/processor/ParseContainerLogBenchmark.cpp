@@ -21,7 +21,10 @@
 #include "collection_pipeline/plugin/instance/ProcessorInstance.h"
 #include "config/CollectionConfig.h"
 #include "models/LogEvent.h"
+#include "plugin/processor/inner/ProcessorMergeMultilineLogNative.h"
 #include "plugin/processor/inner/ProcessorParseContainerLogNative.h"
+#include "plugin/processor/inner/ProcessorSplitLogStringNative.h"
+#include "plugin/processor/inner/ProcessorSplitParseContainerLogNative.h"
 #include "unittest/Unittest.h"
 
 
@@ -267,6 +270,78 @@ static void BM_ContainerdText(int size, int batchSize) {
     }
 }
 
+// compare split + parse + merge(flag) against the fused processor on the raw read buffer
+static void BM_SplitParse(const std::string& containerType, const std::string& lines, int size, int batchSize) {
+    CollectionPipelineContext mContext;
+    mContext.SetConfigName("project##config_0");
+
+    std::string data;
+    for (int i = 0; i < size; i++) {
+        data += lines;
+    }
+    data.pop_back();
+    std::cout << "log size:\t" << formatSize(data.size()) << std::endl;
+
+    Json::Value root;
+    Json::Value event;
+    event["type"] = 1;
+    event["timestamp"] = 1234567890;
+    event["timestampNanosecond"] = 0;
+    event["contents"]["content"] = data;
+    root["events"].append(event);
+    Json::StreamWriterBuilder builder;
+    builder["commentStyle"] = "None";
+    std::string inJson = Json::writeString(builder, root);
+
+    Json::Value config;
+    ProcessorSplitLogStringNative split;
+    split.SetContext(mContext);
+    split.SetMetricsRecordRef(ProcessorSplitLogStringNative::sName, "1");
+    ProcessorParseContainerLogNative parse;
+    parse.SetContext(mContext);
+    parse.SetMetricsRecordRef(ProcessorParseContainerLogNative::sName, "2");
+    ProcessorMergeMultilineLogNative merge;
+    merge.SetContext(mContext);
+    merge.SetMetricsRecordRef(ProcessorMergeMultilineLogNative::sName, "3");
+    ProcessorSplitParseContainerLogNative fused;
+    fused.SetContext(mContext);
+    fused.SetMetricsRecordRef(ProcessorSplitParseContainerLogNative::sName, "4");
+    Json::Value mergeConfig;
+    mergeConfig["MergeType"] = "flag";
+    if (!split.Init(config) || !parse.Init(config) || !merge.Init(mergeConfig) || !fused.Init(config)) {
+        return;
+    }
+
+    uint64_t chainTime = 0;
+    uint64_t fusedTime = 0;
+    for (int i = 0; i < batchSize; i++) {
+        {
+            PipelineEventGroup eventGroup(std::make_shared<SourceBuffer>());
+            eventGroup.SetMetadata(EventGroupMetaKey::LOG_FORMAT, containerType);
+            eventGroup.FromJsonString(inJson);
+            uint64_t startTime = GetCurrentTimeInMicroSeconds();
+            split.Process(eventGroup);
+            parse.Process(eventGroup);
+            merge.Process(eventGroup);
+            chainTime += GetCurrentTimeInMicroSeconds() - startTime;
+        }
+        {
+            PipelineEventGroup eventGroup(std::make_shared<SourceBuffer>());
+            eventGroup.SetMetadata(EventGroupMetaKey::LOG_FORMAT, containerType);
+            eventGroup.FromJsonString(inJson);
+            uint64_t startTime = GetCurrentTimeInMicroSeconds();
+            fused.Process(eventGroup);
+            fusedTime += GetCurrentTimeInMicroSeconds() - startTime;
+        }
+    }
+    std::cout << "split+parse+merge durationTime: " << chainTime << std::endl;
+    std::cout << "split+parse+merge process: "
+              << formatSize(data.size() * (uint64_t)batchSize * 1000000 / chainTime) << std::endl;
+    std::cout << "fused durationTime: " << fusedTime << std::endl;
+    std::cout << "fused process: " << formatSize(data.size() * (uint64_t)batchSize * 1000000 / fusedTime)
+              << std::endl;
+}
+
 int main(int argc, char** argv) {
     logtail::Logger::Instance().InitGlobalLoggers();
 #ifdef NDEBUG
@@ -278,5 +353,21 @@ int main(int argc, char** argv) {
     BM_DockerJson(512, 100);
     std::cout << "containerdText" << std::endl;
     BM_ContainerdText(512, 100);
+    std::cout << "docker json split parse" << std::endl;
+    BM_SplitParse(
+        ProcessorParseContainerLogNative::DOCKER_JSON_FILE,
+        R"({"log":"Exception in thread \"main\" java.lang.NullPointerException\n","stream":"stdout","time":"2024-04-07T08:02:40.873971412Z"})"
+        "\n"
+        R"({"log":"    at com.example.myproject.Book.getTitle\n","stream":"stdout","time":"2024-04-07T08:02:40.873976048Z"})"
+        "\n",
+        2048,
+        100);
+    std::cout << "containerdText split parse" << std::endl;
+    BM_SplitParse(ProcessorParseContainerLogNative::CONTAINERD_TEXT,
+                  "2024-04-08T12:48:59.665663286+08:00 stdout P Exception in thread \"main\" java.lang.Null\n"
+                  "2024-04-08T12:48:59.665663286+08:00 stdout F PointerException\n"
+                  "2024-04-08T12:48:59.665665738+08:00 stdout F     at com.example.myproject.Book.getTitle\n",
+                  2048,
+                  100);
     return 0;
 }
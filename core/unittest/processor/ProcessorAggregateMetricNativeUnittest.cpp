@@ -0,0 +1,349 @@
+/*
+ * Copyright 2025 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "common/JsonUtil.h"
+#include "models/MetricEvent.h"
+#include "models/PipelineEventGroup.h"
+#include "plugin/processor/ProcessorAggregateMetricNative.h"
+#include "unittest/Unittest.h"
+
+using namespace std;
+
+namespace logtail {
+
+class ProcessorAggregateMetricNativeUnittest : public testing::Test {
+public:
+    void SetUp() override {
+        mContext.SetConfigName("project##config_0");
+        // a window that has been closed long ago, so that it is flushed by the same Process call
+        mWindowStart = (time(nullptr) / 60) * 60 - 600;
+    }
+
+    void TestInit();
+    void TestMethods();
+    void TestGroupByTags();
+    void TestHistogramMerge();
+    void TestMultiValues();
+    void TestLateEvents();
+    void TestMaxSeries();
+    void TestForceFlush();
+
+private:
+    bool InitProcessor(ProcessorAggregateMetricNative& processor, const string& configStr);
+    static void AddMetric(PipelineEventGroup& group,
+                          const string& name,
+                          double value,
+                          time_t timestamp,
+                          const vector<pair<string, string>>& tags = {});
+    static const MetricEvent* FindMetric(const vector<PipelineEventGroup>& groups,
+                                         const string& name,
+                                         const vector<pair<string, string>>& tags = {});
+
+    CollectionPipelineContext mContext;
+    time_t mWindowStart = 0;
+};
+
+bool ProcessorAggregateMetricNativeUnittest::InitProcessor(ProcessorAggregateMetricNative& processor,
+                                                           const string& configStr) {
+    Json::Value config;
+    string errorMsg;
+    if (!ParseJsonTable(configStr, config, errorMsg)) {
+        return false;
+    }
+    processor.SetContext(mContext);
+    processor.SetMetricsRecordRef(ProcessorAggregateMetricNative::sName, "1");
+    return processor.Init(config);
+}
+
+void ProcessorAggregateMetricNativeUnittest::AddMetric(PipelineEventGroup& group,
+                                                       const string& name,
+                                                       double value,
+                                                       time_t timestamp,
+                                                       const vector<pair<string, string>>& tags) {
+    auto* e = group.AddMetricEvent();
+    e->SetName(name);
+    e->SetValue(UntypedSingleValue{value});
+    e->SetTimestamp(timestamp);
+    for (const auto& tag : tags) {
+        e->SetTag(tag.first, tag.second);
+    }
+}
+
+const MetricEvent* ProcessorAggregateMetricNativeUnittest::FindMetric(const vector<PipelineEventGroup>& groups,
+                                                                      const string& name,
+                                                                      const vector<pair<string, string>>& tags) {
+    for (const auto& group : groups) {
+        for (const auto& e : group.GetEvents()) {
+            if (!e.Is<MetricEvent>()) {
+                continue;
+            }
+            const auto& metric = e.Cast<MetricEvent>();
+            if (metric.GetName() != name || metric.TagsSize() != tags.size()) {
+                continue;
+            }
+            bool matched = true;
+            for (const auto& tag : tags) {
+                if (metric.GetTag(tag.first) != tag.second) {
+                    matched = false;
+                    break;
+                }
+            }
+            if (matched) {
+                return &metric;
+            }
+        }
+    }
+    return nullptr;
+}
+
+void ProcessorAggregateMetricNativeUnittest::TestInit() {
+    {
+        ProcessorAggregateMetricNative processor;
+        APSARA_TEST_TRUE(InitProcessor(processor, R"({
+            "Interval": 30,
+            "GroupByTags": ["host"],
+            "Method": "sum",
+            "Methods": {"cpu": "max"},
+            "HistogramMerge": false,
+            "MaxSeries": 10
+        })"));
+        APSARA_TEST_EQUAL(30U, processor.mIntervalSecs);
+        APSARA_TEST_EQUAL(1U, processor.mGroupByTags.size());
+        APSARA_TEST_TRUE(processor.mDefaultMethod == AggregateMethod::SUM);
+        APSARA_TEST_TRUE(processor.mMethods["cpu"] == AggregateMethod::MAX);
+        APSARA_TEST_FALSE(processor.mHistogramMerge);
+        APSARA_TEST_EQUAL(10U, processor.mMaxSeries);
+    }
+    {
+        // invalid interval falls back to default
+        ProcessorAggregateMetricNative processor;
+        APSARA_TEST_TRUE(InitProcessor(processor, R"({"Interval": 0})"));
+        APSARA_TEST_EQUAL(60U, processor.mIntervalSecs);
+    }
+    {
+        ProcessorAggregateMetricNative processor;
+        APSARA_TEST_FALSE(InitProcessor(processor, R"({"Method": "median"})"));
+    }
+    {
+        ProcessorAggregateMetricNative processor;
+        APSARA_TEST_FALSE(InitProcessor(processor, R"({"Methods": {"cpu": "median"}})"));
+    }
+}
+
+void ProcessorAggregateMetricNativeUnittest::TestMethods() {
+    ProcessorAggregateMetricNative processor;
+    APSARA_TEST_TRUE(InitProcessor(processor, R"({
+        "Methods": {"m_sum": "sum", "m_count": "count", "m_min": "min", "m_max": "max", "m_avg": "avg"}
+    })"));
+
+    vector<PipelineEventGroup> groups;
+    groups.emplace_back(make_shared<SourceBuffer>());
+    for (const string name : {"m_sum", "m_count", "m_min", "m_max", "m_avg", "m_last"}) {
+        AddMetric(groups[0], name, 3, mWindowStart + 10);
+        AddMetric(groups[0], name, 1, mWindowStart + 30);
+        AddMetric(groups[0], name, 2, mWindowStart + 20);
+    }
+    processor.Process(groups);
+
+    // the source group is emptied and one aggregated group is appended
+    APSARA_TEST_EQUAL(2U, groups.size());
+    APSARA_TEST_EQUAL(0U, groups[0].GetEvents().size());
+    APSARA_TEST_EQUAL(6U, groups[1].GetEvents().size());
+    APSARA_TEST_EQUAL(6.0, FindMetric(groups, "m_sum")->GetValue<UntypedSingleValue>()->mValue);
+    APSARA_TEST_EQUAL(3.0, FindMetric(groups, "m_count")->GetValue<UntypedSingleValue>()->mValue);
+    APSARA_TEST_EQUAL(1.0, FindMetric(groups, "m_min")->GetValue<UntypedSingleValue>()->mValue);
+    APSARA_TEST_EQUAL(3.0, FindMetric(groups, "m_max")->GetValue<UntypedSingleValue>()->mValue);
+    APSARA_TEST_EQUAL(2.0, FindMetric(groups, "m_avg")->GetValue<UntypedSingleValue>()->mValue);
+    // last is the value with the largest timestamp
+    APSARA_TEST_EQUAL(1.0, FindMetric(groups, "m_last")->GetValue<UntypedSingleValue>()->mValue);
+    APSARA_TEST_EQUAL(mWindowStart, FindMetric(groups, "m_last")->GetTimestamp());
+    APSARA_TEST_EQUAL(18U, processor.mAggregatedEventsTotal->GetValue());
+    APSARA_TEST_TRUE(processor.mWindows.empty());
+}
+
+void ProcessorAggregateMetricNativeUnittest::TestGroupByTags() {
+    ProcessorAggregateMetricNative processor;
+    APSARA_TEST_TRUE(InitProcessor(processor, R"({"GroupByTags": ["host"], "Method": "sum"})"));
+
+    vector<PipelineEventGroup> groups;
+    for (const string job : {"job_a", "job_b"}) {
+        groups.emplace_back(make_shared<SourceBuffer>());
+        groups.back().SetTag(string("job"), job);
+        AddMetric(groups.back(), "requests", 1, mWindowStart, {{"host", "h1"}, {"path", "/a"}});
+        AddMetric(groups.back(), "requests", 2, mWindowStart, {{"host", "h1"}, {"path", "/b"}});
+        AddMetric(groups.back(), "requests", 4, mWindowStart, {{"host", "h2"}, {"path", "/a"}});
+    }
+    processor.Process(groups);
+
+    // one output group per source tag set
+    APSARA_TEST_EQUAL(4U, groups.size());
+    for (size_t i = 2; i < groups.size(); ++i) {
+        APSARA_TEST_EQUAL(2U, groups[i].GetEvents().size());
+        APSARA_TEST_EQUAL(1U, groups[i].GetTags().size());
+        vector<PipelineEventGroup> single;
+        single.emplace_back(groups[i].Copy());
+        APSARA_TEST_EQUAL(3.0, FindMetric(single, "requests", {{"host", "h1"}})->GetValue<UntypedSingleValue>()->mValue);
+        APSARA_TEST_EQUAL(4.0, FindMetric(single, "requests", {{"host", "h2"}})->GetValue<UntypedSingleValue>()->mValue);
+    }
+    APSARA_TEST_EQUAL("job_a", groups[2].GetTag("job").to_string());
+    APSARA_TEST_EQUAL("job_b", groups[3].GetTag("job").to_string());
+}
+
+void ProcessorAggregateMetricNativeUnittest::TestHistogramMerge() {
+    ProcessorAggregateMetricNative processor;
+    APSARA_TEST_TRUE(InitProcessor(processor, R"({"GroupByTags": ["service"]})"));
+
+    vector<PipelineEventGroup> groups;
+    groups.emplace_back(make_shared<SourceBuffer>());
+    for (const string pod : {"p1", "p2"}) {
+        // cumulative buckets scraped twice, the later scrape of each pod wins
+        for (int i = 0; i < 2; ++i) {
+            double base = pod == "p1" ? 10 * (i + 1) : 100 * (i + 1);
+            AddMetric(groups[0],
+                      "latency_bucket",
+                      base,
+                      mWindowStart + i * 15,
+                      {{"service", "s"}, {"pod", pod}, {"le", "0.5"}});
+            AddMetric(groups[0],
+                      "latency_bucket",
+                      base * 2,
+                      mWindowStart + i * 15,
+                      {{"service", "s"}, {"pod", pod}, {"le", "+Inf"}});
+            AddMetric(groups[0], "latency_count", base * 2, mWindowStart + i * 15, {{"service", "s"}, {"pod", pod}});
+        }
+    }
+    processor.Process(groups);
+
+    APSARA_TEST_EQUAL(220.0,
+                      FindMetric(groups, "latency_bucket", {{"service", "s"}, {"le", "0.5"}})
+                          ->GetValue<UntypedSingleValue>()
+                          ->mValue);
+    APSARA_TEST_EQUAL(440.0,
+                      FindMetric(groups, "latency_bucket", {{"service", "s"}, {"le", "+Inf"}})
+                          ->GetValue<UntypedSingleValue>()
+                          ->mValue);
+    APSARA_TEST_EQUAL(440.0,
+                      FindMetric(groups, "latency_count", {{"service", "s"}})->GetValue<UntypedSingleValue>()->mValue);
+}
+
+void ProcessorAggregateMetricNativeUnittest::TestMultiValues() {
+    ProcessorAggregateMetricNative processor;
+    APSARA_TEST_TRUE(InitProcessor(processor, R"({"Method": "max"})"));
+
+    vector<PipelineEventGroup> groups;
+    groups.emplace_back(make_shared<SourceBuffer>());
+    for (double v : {1.0, 5.0, 3.0}) {
+        auto* e = groups[0].AddMetricEvent();
+        e->SetName("cpu");
+        e->SetTimestamp(mWindowStart);
+        e->SetValue(map<StringView, UntypedMultiDoubleValue>());
+        e->MutableValue<UntypedMultiDoubleValues>()->SetValue(string("user"),
+                                                              UntypedMultiDoubleValue{MetricTypeGauge, v});
+        e->MutableValue<UntypedMultiDoubleValues>()->SetValue(string("sys"),
+                                                              UntypedMultiDoubleValue{MetricTypeGauge, v * 2});
+    }
+    processor.Process(groups);
+
+    const auto* metric = FindMetric(groups, "cpu");
+    APSARA_TEST_NOT_EQUAL(nullptr, metric);
+    UntypedMultiDoubleValue value;
+    APSARA_TEST_TRUE(metric->GetValue<UntypedMultiDoubleValues>()->GetValue("user", value));
+    APSARA_TEST_EQUAL(5.0, value.Value);
+    APSARA_TEST_TRUE(metric->GetValue<UntypedMultiDoubleValues>()->GetValue("sys", value));
+    APSARA_TEST_EQUAL(10.0, value.Value);
+}
+
+void ProcessorAggregateMetricNativeUnittest::TestLateEvents() {
+    ProcessorAggregateMetricNative processor;
+    APSARA_TEST_TRUE(InitProcessor(processor, R"({"Method": "sum"})"));
+
+    vector<PipelineEventGroup> groups;
+    groups.emplace_back(make_shared<SourceBuffer>());
+    AddMetric(groups[0], "m", 1, mWindowStart);
+    processor.Process(groups);
+    APSARA_TEST_EQUAL(2U, groups.size());
+
+    // the window has been flushed, so that events of it pass through untouched
+    groups.clear();
+    groups.emplace_back(make_shared<SourceBuffer>());
+    AddMetric(groups[0], "m", 2, mWindowStart + 1);
+    // events too far in the future pass through as well
+    AddMetric(groups[0], "m", 3, time(nullptr) + 3600);
+    // non metric events are kept
+    groups[0].AddLogEvent();
+    processor.Process(groups);
+    APSARA_TEST_EQUAL(1U, groups.size());
+    APSARA_TEST_EQUAL(3U, groups[0].GetEvents().size());
+    APSARA_TEST_EQUAL(2U, processor.mLateEventsTotal->GetValue());
+    APSARA_TEST_EQUAL(mWindowStart + 1, groups[0].GetEvents()[0].Cast<MetricEvent>().GetTimestamp());
+}
+
+void ProcessorAggregateMetricNativeUnittest::TestMaxSeries() {
+    ProcessorAggregateMetricNative processor;
+    APSARA_TEST_TRUE(InitProcessor(processor, R"({"MaxSeries": 2})"));
+
+    vector<PipelineEventGroup> groups;
+    groups.emplace_back(make_shared<SourceBuffer>());
+    for (const string name : {"a", "b", "c", "a"}) {
+        AddMetric(groups[0], name, 1, mWindowStart);
+    }
+    processor.Process(groups);
+
+    APSARA_TEST_EQUAL(2U, groups.size());
+    APSARA_TEST_EQUAL(1U, groups[0].GetEvents().size());
+    APSARA_TEST_EQUAL("c", groups[0].GetEvents()[0].Cast<MetricEvent>().GetName().to_string());
+    APSARA_TEST_EQUAL(2U, groups[1].GetEvents().size());
+    APSARA_TEST_EQUAL(1U, processor.mOverflowEventsTotal->GetValue());
+}
+
+void ProcessorAggregateMetricNativeUnittest::TestForceFlush() {
+    ProcessorAggregateMetricNative processor;
+    APSARA_TEST_TRUE(InitProcessor(processor, R"({"Interval": 3600, "Method": "sum"})"));
+
+    time_t now = time(nullptr);
+    vector<PipelineEventGroup> groups;
+    groups.emplace_back(make_shared<SourceBuffer>());
+    AddMetric(groups[0], "m", 1, now);
+    AddMetric(groups[0], "m", 2, now);
+    processor.Process(groups);
+    // the current window is still open
+    APSARA_TEST_EQUAL(1U, groups.size());
+    APSARA_TEST_EQUAL(1U, processor.mWindows.size());
+    APSARA_TEST_EQUAL(1, processor.mSeriesNum->GetValue());
+
+    groups.clear();
+    processor.Flush(groups, false);
+    APSARA_TEST_TRUE(groups.empty());
+
+    processor.Flush(groups, true);
+    APSARA_TEST_EQUAL(1U, groups.size());
+    APSARA_TEST_EQUAL(3.0, FindMetric(groups, "m")->GetValue<UntypedSingleValue>()->mValue);
+    APSARA_TEST_TRUE(processor.mWindows.empty());
+    APSARA_TEST_EQUAL(0, processor.mSeriesNum->GetValue());
+}
+
+UNIT_TEST_CASE(ProcessorAggregateMetricNativeUnittest, TestInit)
+UNIT_TEST_CASE(ProcessorAggregateMetricNativeUnittest, TestMethods)
+UNIT_TEST_CASE(ProcessorAggregateMetricNativeUnittest, TestGroupByTags)
+UNIT_TEST_CASE(ProcessorAggregateMetricNativeUnittest, TestHistogramMerge)
+UNIT_TEST_CASE(ProcessorAggregateMetricNativeUnittest, TestMultiValues)
+UNIT_TEST_CASE(ProcessorAggregateMetricNativeUnittest, TestLateEvents)
+UNIT_TEST_CASE(ProcessorAggregateMetricNativeUnittest, TestMaxSeries)
+UNIT_TEST_CASE(ProcessorAggregateMetricNativeUnittest, TestForceFlush)
+
+} // namespace logtail
+
+UNIT_TEST_MAIN
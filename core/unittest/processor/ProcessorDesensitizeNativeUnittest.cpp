@@ -34,6 +34,8 @@ public:
     void TestCastSensWordMulti();
     void TestMultipleLines();
     void TestMultipleLinesWithProcessorMergeMultilineLogNative();
+    void TestRequiredLiteralPrefilter();
+    void TestEmptyMatch();
 
     CollectionPipelineContext mContext;
 };
@@ -54,6 +56,10 @@ UNIT_TEST_CASE(ProcessorDesensitizeNativeUnittest, TestMultipleLines);
 
 UNIT_TEST_CASE(ProcessorDesensitizeNativeUnittest, TestMultipleLinesWithProcessorMergeMultilineLogNative);
 
+UNIT_TEST_CASE(ProcessorDesensitizeNativeUnittest, TestRequiredLiteralPrefilter);
+
+UNIT_TEST_CASE(ProcessorDesensitizeNativeUnittest, TestEmptyMatch);
+
 PluginInstance::PluginMeta getPluginMeta() {
     PluginInstance::PluginMeta pluginMeta{"1"};
     return pluginMeta;
@@ -284,6 +290,113 @@ dbf@@@324 FS2$%pwd,pwd=saf543#$@,,"
     }
 }
 
+void ProcessorDesensitizeNativeUnittest::TestRequiredLiteralPrefilter() {
+    {
+        Json::Value config = GetCastSensWordConfig("cast1", "const", "********", "pwd=|password=", "[^,]+", true);
+        ProcessorDesensitizeNative& processor = *(new ProcessorDesensitizeNative);
+        ProcessorInstance processorInstance(&processor, getPluginMeta());
+        APSARA_TEST_TRUE_FATAL(processorInstance.Init(config, mContext));
+        APSARA_TEST_EQUAL(2U, processor.mRequiredLiterals.size());
+        APSARA_TEST_EQUAL("pwd=", processor.mRequiredLiterals[0]);
+        APSARA_TEST_EQUAL("password=", processor.mRequiredLiterals[1]);
+        APSARA_TEST_TRUE(processor.mIsReplacingLiteral);
+        APSARA_TEST_FALSE(processor.MayContainSensitiveWord("user=abc,passwd=123"));
+        APSARA_TEST_TRUE(processor.MayContainSensitiveWord("user=abc,password=123"));
+    }
+    {
+        Json::Value config = GetCastSensWordConfig("cast1", "const", "********", "\\d{6}", "\\d{8}", true);
+        ProcessorDesensitizeNative& processor = *(new ProcessorDesensitizeNative);
+        ProcessorInstance processorInstance(&processor, getPluginMeta());
+        APSARA_TEST_TRUE_FATAL(processorInstance.Init(config, mContext));
+        APSARA_TEST_TRUE(processor.mRequiredLiterals.empty());
+        APSARA_TEST_TRUE(processor.MayContainSensitiveWord("no digits"));
+    }
+    {
+        Json::Value config = GetCastSensWordConfig("cast1", "const", "\\0", "(?i)pwd=", "[^,]+", true);
+        ProcessorDesensitizeNative& processor = *(new ProcessorDesensitizeNative);
+        ProcessorInstance processorInstance(&processor, getPluginMeta());
+        APSARA_TEST_TRUE_FATAL(processorInstance.Init(config, mContext));
+        APSARA_TEST_TRUE(processor.mRequiredLiterals.empty());
+        APSARA_TEST_FALSE(processor.mIsReplacingLiteral);
+
+        auto sourceBuffer = std::make_shared<SourceBuffer>();
+        PipelineEventGroup eventGroup(sourceBuffer);
+        std::string inJson = R"({
+            "events" :
+            [
+                {
+                    "contents" :
+                    {
+                        "cast1" : "PWD=abc,pwd=def"
+                    },
+                    "timestampNanosecond" : 0,
+                    "timestamp" : 12345678901,
+                    "type" : 1
+                }
+            ]
+        })";
+        eventGroup.FromJsonString(inJson);
+        processor.Process(eventGroup);
+        std::string expectJson = R"({
+            "events" :
+            [
+                {
+                    "contents" :
+                    {
+                        "cast1" : "PWD=PWD=abc,pwd=pwd=def"
+                    },
+                    "timestamp" : 12345678901,
+                    "timestampNanosecond" : 0,
+                    "type" : 1
+                }
+            ]
+        })";
+        APSARA_TEST_STREQ_FATAL(CompactJson(expectJson).c_str(), CompactJson(eventGroup.ToJsonString()).c_str());
+    }
+}
+
+void ProcessorDesensitizeNativeUnittest::TestEmptyMatch() {
+    // an empty match is not a sensitive word, the content is left untouched
+    Json::Value config = GetCastSensWordConfig("cast1", "md5", "", "a*", "b*", true);
+    ProcessorDesensitizeNative& processor = *(new ProcessorDesensitizeNative);
+    ProcessorInstance processorInstance(&processor, getPluginMeta());
+    APSARA_TEST_TRUE_FATAL(processorInstance.Init(config, mContext));
+
+    auto sourceBuffer = std::make_shared<SourceBuffer>();
+    PipelineEventGroup eventGroup(sourceBuffer);
+    std::string inJson = R"({
+        "events" :
+        [
+            {
+                "contents" :
+                {
+                    "cast1" : "xyz"
+                },
+                "timestampNanosecond" : 0,
+                "timestamp" : 12345678901,
+                "type" : 1
+            }
+        ]
+    })";
+    eventGroup.FromJsonString(inJson);
+    processor.Process(eventGroup);
+    std::string expectJson = R"({
+        "events" :
+        [
+            {
+                "contents" :
+                {
+                    "cast1" : "xyz"
+                },
+                "timestamp" : 12345678901,
+                "timestampNanosecond" : 0,
+                "type" : 1
+            }
+        ]
+    })";
+    APSARA_TEST_STREQ_FATAL(CompactJson(expectJson).c_str(), CompactJson(eventGroup.ToJsonString()).c_str());
+}
+
 void ProcessorDesensitizeNativeUnittest::TestInit() {
     Json::Value config = GetCastSensWordConfig();
     // run function
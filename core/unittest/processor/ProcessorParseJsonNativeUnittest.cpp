@@ -21,6 +21,8 @@
 #include "plugin/processor/inner/ProcessorSplitLogStringNative.h"
 #include "unittest/Unittest.h"
 
+DECLARE_FLAG_BOOL(enable_lazy_log_parsing);
+
 namespace logtail {
 
 class ProcessorParseJsonNativeUnittest : public ::testing::Test {
@@ -36,6 +38,7 @@ public:
     void TestProcessJsonContent();
     void TestProcessJsonRaw();
     void TestMultipleLines();
+    void TestLazyParsing();
 
     CollectionPipelineContext mContext;
 };
@@ -58,6 +61,8 @@ UNIT_TEST_CASE(ProcessorParseJsonNativeUnittest, TestProcessJsonRaw);
 
 UNIT_TEST_CASE(ProcessorParseJsonNativeUnittest, TestMultipleLines);
 
+UNIT_TEST_CASE(ProcessorParseJsonNativeUnittest, TestLazyParsing);
+
 PluginInstance::PluginMeta getPluginMeta() {
     PluginInstance::PluginMeta pluginMeta{"1"};
     return pluginMeta;
@@ -689,6 +694,63 @@ void ProcessorParseJsonNativeUnittest::TestProcessEventDiscardUnmatch() {
     APSARA_TEST_GE_FATAL(processorInstance.mTotalProcessTimeMs->GetValue(), uint64_t(0));
 }
 
+void ProcessorParseJsonNativeUnittest::TestLazyParsing() {
+    Json::Value config;
+    config["SourceKey"] = "content";
+    BOOL_FLAG(enable_lazy_log_parsing) = true;
+    ProcessorParseJsonNative processor;
+    processor.SetContext(mContext);
+    processor.SetMetricsRecordRef(ProcessorParseJsonNative::sName, "1");
+    APSARA_TEST_TRUE_FATAL(processor.Init(config));
+    BOOL_FLAG(enable_lazy_log_parsing) = false;
+
+    auto sourceBuffer = std::make_shared<SourceBuffer>();
+    auto group = std::make_unique<PipelineEventGroup>(sourceBuffer);
+    auto* e1 = group->AddLogEvent();
+    e1->SetContent(std::string("content"), std::string(R"({"key1":"value1","level":"warning"})"));
+    e1->SetContent(std::string("tag"), std::string("t"));
+    auto* e2 = group->AddLogEvent();
+    e2->SetContent(std::string("content"), std::string(R"({"k\u0065y2":"value2"})"));
+    processor.Process(*group);
+    APSARA_TEST_EQUAL(2U, processor.mLazyEventsTotal->GetValue());
+
+    // the events are parsed after they leave the group
+    PipelineEventGroup other(sourceBuffer);
+    EventsContainer events;
+    group->SwapEvents(events);
+    for (auto& e : events) {
+        e->ResetPipelineEventGroup(&other);
+    }
+    other.SwapEvents(events);
+    group.reset();
+
+    // keys neither in the json nor written by the parser can be read without parsing
+    auto& first = other.MutableEvents()[0].Cast<LogEvent>();
+    APSARA_TEST_EQUAL("t", first.GetContent("tag").to_string());
+    APSARA_TEST_FALSE(first.HasContent("key2"));
+    APSARA_TEST_TRUE(first.HasPendingParse());
+    APSARA_TEST_EQUAL(0U, processor.mMaterializedEventsTotal->GetValue());
+    // keys in the json trigger parsing
+    APSARA_TEST_EQUAL("warning", first.GetContent("level").to_string());
+    APSARA_TEST_FALSE(first.HasPendingParse());
+    APSARA_TEST_EQUAL("value1", first.GetContent("key1").to_string());
+    APSARA_TEST_FALSE(first.HasContent("content"));
+    APSARA_TEST_EQUAL(1U, processor.mMaterializedEventsTotal->GetValue());
+
+    // keys may be escaped in the json
+    auto& second = other.MutableEvents()[1].Cast<LogEvent>();
+    APSARA_TEST_EQUAL("value2", second.GetContent("key2").to_string());
+    APSARA_TEST_EQUAL(2U, processor.mMaterializedEventsTotal->GetValue());
+
+    // erasing events depends on the offset key in the group metadata, so the parse is not deferred
+    PipelineEventGroup offsetGroup(std::make_shared<SourceBuffer>());
+    offsetGroup.SetMetadata(EventGroupMetaKey::LOG_FILE_OFFSET_KEY, std::string("__file_offset__"));
+    offsetGroup.AddLogEvent()->SetContent(std::string("content"), std::string(R"({"key1":"value1"})"));
+    processor.Process(offsetGroup);
+    APSARA_TEST_EQUAL(2U, processor.mLazyEventsTotal->GetValue());
+    APSARA_TEST_FALSE(offsetGroup.GetEvents()[0].Cast<LogEvent>().HasPendingParse());
+}
+
 } // namespace logtail
 
 UNIT_TEST_MAIN
@@ -15,12 +15,15 @@
 #include <cstdlib>
 
 #include "collection_pipeline/plugin/instance/ProcessorInstance.h"
+#include "common/Flags.h"
 #include "common/JsonUtil.h"
 #include "config/CollectionConfig.h"
 #include "models/LogEvent.h"
 #include "plugin/processor/ProcessorParseRegexNative.h"
 #include "unittest/Unittest.h"
 
+DECLARE_FLAG_BOOL(enable_lazy_log_parsing);
+
 namespace logtail {
 
 class ProcessorParseRegexNativeUnittest : public ::testing::Test {
@@ -35,6 +38,7 @@ public:
     void TestProcessEventKeyCountUnmatch();
     void TestProcessRegexRaw();
     void TestProcessRegexContent();
+    void TestLazyParsing();
 
 protected:
     void SetUp() override { ctx.SetConfigName("test_config"); }
@@ -651,6 +655,114 @@ void ProcessorParseRegexNativeUnittest::TestProcessEventKeyCountUnmatch() {
     APSARA_TEST_EQUAL_FATAL(0, processor.mOutFailedEventsTotal->GetValue());
 }
 
+void ProcessorParseRegexNativeUnittest::TestLazyParsing() {
+    Json::Value config;
+    config["SourceKey"] = "content";
+    config["Regex"] = R"((\w+)\t(\w+).*)";
+    config["Keys"] = Json::arrayValue;
+    config["Keys"].append("key1");
+    config["Keys"].append("key2");
+    config["KeepingSourceWhenParseFail"] = false;
+
+    std::string inJson = R"({
+        "events" :
+        [
+            {
+                "contents" :
+                {
+                    "content" : "value1\tvalue2",
+                    "level" : "info"
+                },
+                "timestamp" : 12345678901,
+                "type" : 1
+            },
+            {
+                "contents" :
+                {
+                    "content" : "value1\tvalue2",
+                    "level" : "error"
+                },
+                "timestamp" : 12345678901,
+                "type" : 1
+            },
+            {
+                "contents" :
+                {
+                    "content" : "unmatched"
+                },
+                "timestamp" : 12345678901,
+                "type" : 1
+            }
+        ]
+    })";
+
+    // eager parsing as reference
+    PipelineEventGroup eagerGroup(std::make_shared<SourceBuffer>());
+    eagerGroup.FromJsonString(inJson);
+    {
+        ProcessorParseRegexNative processor;
+        processor.SetContext(ctx);
+        processor.SetMetricsRecordRef(ProcessorParseRegexNative::sName, "1");
+        APSARA_TEST_TRUE_FATAL(processor.Init(config));
+        processor.Process(eagerGroup);
+    }
+
+    BOOL_FLAG(enable_lazy_log_parsing) = true;
+    PipelineEventGroup lazyGroup(std::make_shared<SourceBuffer>());
+    lazyGroup.FromJsonString(inJson);
+    ProcessorParseRegexNative processor;
+    processor.SetContext(ctx);
+    processor.SetMetricsRecordRef(ProcessorParseRegexNative::sName, "1");
+    APSARA_TEST_TRUE_FATAL(processor.Init(config));
+    BOOL_FLAG(enable_lazy_log_parsing) = false;
+    processor.Process(lazyGroup);
+    APSARA_TEST_EQUAL(3U, lazyGroup.GetEvents().size());
+    APSARA_TEST_EQUAL(3U, processor.mLazyEventsTotal->GetValue());
+    APSARA_TEST_EQUAL(0U, processor.mMaterializedEventsTotal->GetValue());
+
+    // keys not produced by the parser can be read without parsing
+    auto& first = lazyGroup.MutableEvents()[0].Cast<LogEvent>();
+    APSARA_TEST_EQUAL("info", first.GetContent("level").to_string());
+    APSARA_TEST_TRUE(first.HasPendingParse());
+    APSARA_TEST_EQUAL(0U, processor.mMaterializedEventsTotal->GetValue());
+
+    // keys produced by the parser trigger parsing
+    auto& second = lazyGroup.MutableEvents()[1].Cast<LogEvent>();
+    APSARA_TEST_EQUAL("value2", second.GetContent("key2").to_string());
+    APSARA_TEST_FALSE(second.HasPendingParse());
+    APSARA_TEST_EQUAL(1U, processor.mMaterializedEventsTotal->GetValue());
+
+    // drop the first event before it is ever parsed, as a filter would do
+    lazyGroup.MutableEvents().erase(lazyGroup.MutableEvents().begin());
+    for (auto& e : lazyGroup.MutableEvents()) {
+        e.Cast<LogEvent>().Materialize();
+    }
+    APSARA_TEST_EQUAL(2U, processor.mMaterializedEventsTotal->GetValue());
+    APSARA_TEST_FALSE(lazyGroup.GetEvents()[0].Cast<LogEvent>().IsDiscardedByParser());
+    APSARA_TEST_TRUE(lazyGroup.GetEvents()[1].Cast<LogEvent>().IsDiscardedByParser());
+    lazyGroup.MutableEvents().pop_back();
+
+    eagerGroup.MutableEvents().erase(eagerGroup.MutableEvents().begin());
+    APSARA_TEST_STREQ(CompactJson(eagerGroup.ToJsonString()).c_str(), CompactJson(lazyGroup.ToJsonString()).c_str());
+
+    // the size metrics of the processor instance do not parse the events
+    BOOL_FLAG(enable_lazy_log_parsing) = true;
+    ProcessorParseRegexNative& instanceProcessor = *(new ProcessorParseRegexNative);
+    ProcessorInstance processorInstance(&instanceProcessor, getPluginMeta());
+    APSARA_TEST_TRUE_FATAL(processorInstance.Init(config, ctx));
+    BOOL_FLAG(enable_lazy_log_parsing) = false;
+    std::vector<PipelineEventGroup> eventGroupList;
+    eventGroupList.emplace_back(std::make_shared<SourceBuffer>());
+    eventGroupList[0].FromJsonString(inJson);
+    processorInstance.Process(eventGroupList);
+    APSARA_TEST_EQUAL(3U, eventGroupList[0].GetEvents().size());
+    for (const auto& e : eventGroupList[0].GetEvents()) {
+        APSARA_TEST_TRUE(e.Cast<LogEvent>().HasPendingParse());
+    }
+    APSARA_TEST_EQUAL(0U, instanceProcessor.mMaterializedEventsTotal->GetValue());
+    APSARA_TEST_NOT_EQUAL(0U, processorInstance.mOutSizeBytes->GetValue());
+}
+
 UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, TestInit)
 UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, OnSuccessfulInit)
 UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, TestProcessWholeLine)
@@ -661,6 +773,7 @@ UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, TestProcessEventDiscardUnmatch
 UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, TestProcessEventKeyCountUnmatch)
 UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, TestProcessRegexRaw)
 UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, TestProcessRegexContent)
+UNIT_TEST_CASE(ProcessorParseRegexNativeUnittest, TestLazyParsing)
 
 } // namespace logtail
 
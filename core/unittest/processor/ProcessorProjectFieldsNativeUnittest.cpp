@@ -0,0 +1,278 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "common/JsonUtil.h"
+#include "config/CollectionConfig.h"
+#include "models/LogEvent.h"
+#include "plugin/processor/ProcessorProjectFieldsNative.h"
+#include "unittest/Unittest.h"
+
+namespace logtail {
+
+class ProcessorProjectFieldsNativeUnittest : public ::testing::Test {
+public:
+    void SetUp() override { mContext.SetConfigName("project##config_0"); }
+
+    void TestInit();
+    void TestExclude();
+    void TestInclude();
+    void TestRename();
+    void TestRenameToExistingKey();
+    void TestRulePrecedence();
+
+    CollectionPipelineContext mContext;
+
+private:
+    std::string Process(const Json::Value& config);
+};
+
+UNIT_TEST_CASE(ProcessorProjectFieldsNativeUnittest, TestInit);
+UNIT_TEST_CASE(ProcessorProjectFieldsNativeUnittest, TestExclude);
+UNIT_TEST_CASE(ProcessorProjectFieldsNativeUnittest, TestInclude);
+UNIT_TEST_CASE(ProcessorProjectFieldsNativeUnittest, TestRename);
+UNIT_TEST_CASE(ProcessorProjectFieldsNativeUnittest, TestRenameToExistingKey);
+UNIT_TEST_CASE(ProcessorProjectFieldsNativeUnittest, TestRulePrecedence);
+
+std::string ProcessorProjectFieldsNativeUnittest::Process(const Json::Value& config) {
+    PipelineEventGroup eventGroup(std::make_shared<SourceBuffer>());
+    std::string inJson = R"({
+        "events": [
+            {
+                "contents": {
+                    "a": "1",
+                    "b": "2",
+                    "c": "3"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            },
+            {
+                "contents": {
+                    "b": "4",
+                    "d": "5"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            }
+        ]
+    })";
+    eventGroup.FromJsonString(inJson);
+    ProcessorProjectFieldsNative processor;
+    processor.SetContext(mContext);
+    processor.SetMetricsRecordRef(ProcessorProjectFieldsNative::sName, "1");
+    APSARA_TEST_TRUE(processor.Init(config));
+    processor.Process(eventGroup);
+    return CompactJson(eventGroup.ToJsonString());
+}
+
+void ProcessorProjectFieldsNativeUnittest::TestInit() {
+    {
+        Json::Value config;
+        ProcessorProjectFieldsNative processor;
+        processor.SetContext(mContext);
+        APSARA_TEST_FALSE(processor.Init(config));
+    }
+    {
+        Json::Value config;
+        config["SourceKeys"].append("a");
+        ProcessorProjectFieldsNative processor;
+        processor.SetContext(mContext);
+        APSARA_TEST_FALSE(processor.Init(config));
+    }
+    {
+        Json::Value config;
+        config["SourceKeys"].append("a");
+        config["DestKeys"].append("");
+        ProcessorProjectFieldsNative processor;
+        processor.SetContext(mContext);
+        APSARA_TEST_FALSE(processor.Init(config));
+    }
+    {
+        Json::Value config;
+        config["Exclude"] = "a";
+        ProcessorProjectFieldsNative processor;
+        processor.SetContext(mContext);
+        APSARA_TEST_FALSE(processor.Init(config));
+    }
+    {
+        Json::Value config;
+        config["Include"].append("a");
+        config["Exclude"].append("b");
+        config["SourceKeys"].append("c");
+        config["DestKeys"].append("d");
+        ProcessorProjectFieldsNative processor;
+        processor.SetContext(mContext);
+        processor.SetMetricsRecordRef(ProcessorProjectFieldsNative::sName, "1");
+        APSARA_TEST_TRUE(processor.Init(config));
+        APSARA_TEST_EQUAL(3U, processor.mRules.size());
+        APSARA_TEST_TRUE(processor.mDropUnmatched);
+    }
+}
+
+void ProcessorProjectFieldsNativeUnittest::TestExclude() {
+    Json::Value config;
+    config["Exclude"].append("b");
+    config["Exclude"].append("x");
+    std::string expectJson = R"({
+        "events": [
+            {
+                "contents": {
+                    "a": "1",
+                    "c": "3"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            },
+            {
+                "contents": {
+                    "d": "5"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            }
+        ]
+    })";
+    APSARA_TEST_STREQ(CompactJson(expectJson).c_str(), Process(config).c_str());
+}
+
+void ProcessorProjectFieldsNativeUnittest::TestInclude() {
+    Json::Value config;
+    config["Include"].append("a");
+    config["Include"].append("d");
+    std::string expectJson = R"({
+        "events": [
+            {
+                "contents": {
+                    "a": "1"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            },
+            {
+                "contents": {
+                    "d": "5"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            }
+        ]
+    })";
+    APSARA_TEST_STREQ(CompactJson(expectJson).c_str(), Process(config).c_str());
+}
+
+void ProcessorProjectFieldsNativeUnittest::TestRename() {
+    Json::Value config;
+    config["SourceKeys"].append("b");
+    config["DestKeys"].append("e");
+    std::string expectJson = R"({
+        "events": [
+            {
+                "contents": {
+                    "a": "1",
+                    "c": "3",
+                    "e": "2"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            },
+            {
+                "contents": {
+                    "d": "5",
+                    "e": "4"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            }
+        ]
+    })";
+    APSARA_TEST_STREQ(CompactJson(expectJson).c_str(), Process(config).c_str());
+}
+
+void ProcessorProjectFieldsNativeUnittest::TestRenameToExistingKey() {
+    // the value of the existing key is overwritten
+    Json::Value config;
+    config["SourceKeys"].append("b");
+    config["DestKeys"].append("c");
+    std::string expectJson = R"({
+        "events": [
+            {
+                "contents": {
+                    "a": "1",
+                    "c": "2"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            },
+            {
+                "contents": {
+                    "c": "4",
+                    "d": "5"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            }
+        ]
+    })";
+    APSARA_TEST_STREQ(CompactJson(expectJson).c_str(), Process(config).c_str());
+}
+
+void ProcessorProjectFieldsNativeUnittest::TestRulePrecedence() {
+    // Exclude > SourceKeys > Include, and renamed keys are kept even if not included
+    Json::Value config;
+    config["Include"].append("a");
+    config["Include"].append("b");
+    config["Exclude"].append("a");
+    config["SourceKeys"].append("b");
+    config["DestKeys"].append("e");
+    config["SourceKeys"].append("d");
+    config["DestKeys"].append("f");
+    std::string expectJson = R"({
+        "events": [
+            {
+                "contents": {
+                    "e": "2"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            },
+            {
+                "contents": {
+                    "e": "4",
+                    "f": "5"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            }
+        ]
+    })";
+    APSARA_TEST_STREQ(CompactJson(expectJson).c_str(), Process(config).c_str());
+}
+
+} // namespace logtail
+
+UNIT_TEST_MAIN
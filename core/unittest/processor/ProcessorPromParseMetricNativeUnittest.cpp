@@ -20,6 +20,7 @@
 #include "common/JsonUtil.h"
 #include "models/PipelineEventGroup.h"
 #include "plugin/processor/inner/ProcessorPromParseMetricNative.h"
+#include "plugin/processor/inner/ProcessorPromRelabelMetricNative.h"
 #include "prometheus/Constants.h"
 #include "prometheus/labels/TextParser.h"
 #include "prometheus/schedulers/ScrapeScheduler.h"
@@ -34,6 +35,8 @@ public:
 
     void TestInit();
     void TestProcess();
+    void TestSeriesCache();
+    void TestSeriesCacheWithStreamParse();
 
     CollectionPipelineContext mContext;
 };
@@ -42,6 +45,7 @@ void ProcessorParsePrometheusMetricUnittest::TestInit() {
     Json::Value config;
     ProcessorPromParseMetricNative processor;
     processor.SetContext(mContext);
+    processor.SetMetricsRecordRef(ProcessorPromParseMetricNative::sName, "1");
 
     // success config
     string configStr;
@@ -62,6 +66,7 @@ void ProcessorParsePrometheusMetricUnittest::TestProcess() {
 
     ProcessorPromParseMetricNative processor;
     processor.SetContext(mContext);
+    processor.SetMetricsRecordRef(ProcessorPromParseMetricNative::sName, "1");
 
     string configStr;
     string errorMsg;
@@ -129,8 +134,140 @@ void ProcessorParsePrometheusMetricUnittest::TestProcess() {
                       eventGroup.GetEvents().at(0).Cast<MetricEvent>().GetTimestamp());
 }
 
+void ProcessorParsePrometheusMetricUnittest::TestSeriesCache() {
+    Json::Value config;
+    string errorMsg;
+    string configStr = R"JSON(
+        {
+            "job_name": "test_job",
+            "metric_relabel_configs": [
+                {
+                    "action": "drop",
+                    "source_labels": ["__name__"],
+                    "regex": "dropped_metric"
+                }
+            ]
+        }
+    )JSON";
+    APSARA_TEST_TRUE(ParseJsonTable(configStr, config, errorMsg));
+    ProcessorPromParseMetricNative processor;
+    processor.SetContext(mContext);
+    processor.SetMetricsRecordRef(ProcessorPromParseMetricNative::sName, "1");
+    APSARA_TEST_TRUE(processor.Init(config));
+    processor.mEnableSeriesCache = true;
+
+    auto makeGroup = [](uint64_t scrapeTimestampMilliSec, const string& value) {
+        PipelineEventGroup eGroup(std::make_shared<SourceBuffer>());
+        eGroup.SetMetadata(EventGroupMetaKey::PROMETHEUS_SCRAPE_TIMESTAMP_MILLISEC, ToString(scrapeTimestampMilliSec));
+        eGroup.SetMetadata(EventGroupMetaKey::PROMETHEUS_STREAM_ID, string("target_hash"));
+        eGroup.SetTag(string("instance"), string("localhost:8080"));
+        eGroup.AddRawEvent()->SetContent(R"(test_metric{k1="v1",k2="v2"} )" + value);
+        eGroup.AddRawEvent()->SetContent("dropped_metric " + value);
+        eGroup.AddRawEvent()->SetContent("test_metric_without_labels " + value);
+        return eGroup;
+    };
+    auto checkGroup = [](const PipelineEventGroup& eGroup, double value) {
+        APSARA_TEST_TRUE(eGroup.HasMetadata(EventGroupMetaKey::PROMETHEUS_SERIES_RELABELED));
+        APSARA_TEST_EQUAL(2UL, eGroup.GetEvents().size());
+        const auto& e1 = eGroup.GetEvents()[0].Cast<MetricEvent>();
+        APSARA_TEST_EQUAL("test_metric", e1.GetName());
+        APSARA_TEST_EQUAL(3UL, e1.TagsSize());
+        APSARA_TEST_EQUAL("v1", e1.GetTag("k1"));
+        APSARA_TEST_EQUAL("v2", e1.GetTag("k2"));
+        APSARA_TEST_EQUAL("localhost:8080", e1.GetTag("instance"));
+        APSARA_TEST_FALSE(e1.HasTag(prometheus::NAME));
+        APSARA_TEST_EQUAL(value, e1.GetValue<UntypedSingleValue>()->mValue);
+        const auto& e2 = eGroup.GetEvents()[1].Cast<MetricEvent>();
+        APSARA_TEST_EQUAL("test_metric_without_labels", e2.GetName());
+        APSARA_TEST_EQUAL(1UL, e2.TagsSize());
+        APSARA_TEST_EQUAL(value, e2.GetValue<UntypedSingleValue>()->mValue);
+    };
+
+    {
+        auto eGroup = makeGroup(1715829785083, "1");
+        processor.Process(eGroup);
+        checkGroup(eGroup, 1);
+        APSARA_TEST_EQUAL(0UL, processor.mSeriesCacheHitsTotal->GetValue());
+        APSARA_TEST_EQUAL(3UL, processor.mSeriesCacheMissesTotal->GetValue());
+    }
+    {
+        // source buffer of the first group is released
+        auto eGroup = makeGroup(1715829800083, "2");
+        processor.Process(eGroup);
+        checkGroup(eGroup, 2);
+        APSARA_TEST_EQUAL(3UL, processor.mSeriesCacheHitsTotal->GetValue());
+        APSARA_TEST_EQUAL(3UL, processor.mSeriesCacheMissesTotal->GetValue());
+    }
+    {
+        // series missing in the last 2 scrapes are removed
+        PipelineEventGroup eGroup(std::make_shared<SourceBuffer>());
+        eGroup.SetMetadata(EventGroupMetaKey::PROMETHEUS_STREAM_ID, string("target_hash"));
+        for (uint64_t ts : {1715829815083, 1715829830083, 1715829845083}) {
+            eGroup.SetMetadata(EventGroupMetaKey::PROMETHEUS_SCRAPE_TIMESTAMP_MILLISEC, ToString(ts));
+            processor.Process(eGroup);
+        }
+        APSARA_TEST_EQUAL(0UL, processor.mSeriesCaches["target_hash"]->mCache.Size());
+    }
+}
+
+void ProcessorParsePrometheusMetricUnittest::TestSeriesCacheWithStreamParse() {
+    Json::Value config;
+    string errorMsg;
+    string configStr = R"JSON(
+        {
+            "job_name": "test_job",
+            "metric_relabel_configs": [
+                {
+                    "action": "drop",
+                    "source_labels": ["__name__"],
+                    "regex": "dropped_metric"
+                }
+            ]
+        }
+    )JSON";
+    APSARA_TEST_TRUE(ParseJsonTable(configStr, config, errorMsg));
+    ProcessorPromParseMetricNative processor;
+    processor.SetContext(mContext);
+    processor.SetMetricsRecordRef(ProcessorPromParseMetricNative::sName, "1");
+    APSARA_TEST_TRUE(processor.Init(config));
+    processor.mEnableSeriesCache = true;
+    ProcessorPromRelabelMetricNative relabelProcessor;
+    relabelProcessor.SetContext(mContext);
+    relabelProcessor.SetMetricsRecordRef(ProcessorPromRelabelMetricNative::sName, "1");
+    APSARA_TEST_TRUE(relabelProcessor.Init(config));
+
+    // events parsed by the scraper, as in stream parse mode
+    PipelineEventGroup eGroup(std::make_shared<SourceBuffer>());
+    eGroup.SetMetadata(EventGroupMetaKey::PROMETHEUS_SCRAPE_TIMESTAMP_MILLISEC, string("1715829785083"));
+    eGroup.SetMetadata(EventGroupMetaKey::PROMETHEUS_STREAM_ID, string("target_hash"));
+    eGroup.SetTag(string("instance"), string("localhost:8080"));
+    TextParser parser(false);
+    for (const char* line : {R"(test_metric{k1="v1"} 1)", "dropped_metric 1"}) {
+        auto sb = eGroup.GetSourceBuffer()->CopyString(StringView(line));
+        auto* e = eGroup.AddMetricEvent();
+        APSARA_TEST_TRUE(parser.ParseLine(StringView(sb.data, sb.size), *e));
+        e->SetTagNoCopy(prometheus::NAME, e->GetName());
+    }
+
+    processor.Process(eGroup);
+    // left to the relabel processor
+    APSARA_TEST_FALSE(eGroup.HasMetadata(EventGroupMetaKey::PROMETHEUS_SERIES_RELABELED));
+    APSARA_TEST_EQUAL(2UL, eGroup.GetEvents().size());
+    APSARA_TEST_EQUAL(0UL, processor.mSeriesCacheMissesTotal->GetValue());
+
+    relabelProcessor.Process(eGroup);
+    APSARA_TEST_EQUAL(1UL, eGroup.GetEvents().size());
+    const auto& e = eGroup.GetEvents()[0].Cast<MetricEvent>();
+    APSARA_TEST_EQUAL("test_metric", e.GetName());
+    APSARA_TEST_EQUAL("v1", e.GetTag("k1"));
+    APSARA_TEST_EQUAL("localhost:8080", e.GetTag("instance"));
+    APSARA_TEST_FALSE(e.HasTag(prometheus::NAME));
+}
+
 UNIT_TEST_CASE(ProcessorParsePrometheusMetricUnittest, TestInit)
 UNIT_TEST_CASE(ProcessorParsePrometheusMetricUnittest, TestProcess)
+UNIT_TEST_CASE(ProcessorParsePrometheusMetricUnittest, TestSeriesCache)
+UNIT_TEST_CASE(ProcessorParsePrometheusMetricUnittest, TestSeriesCacheWithStreamParse)
 
 } // namespace logtail
 
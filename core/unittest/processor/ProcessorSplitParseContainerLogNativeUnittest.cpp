@@ -0,0 +1,281 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "common/JsonUtil.h"
+#include "config/CollectionConfig.h"
+#include "models/LogEvent.h"
+#include "plugin/processor/inner/ProcessorMergeMultilineLogNative.h"
+#include "plugin/processor/inner/ProcessorParseContainerLogNative.h"
+#include "plugin/processor/inner/ProcessorSplitLogStringNative.h"
+#include "plugin/processor/inner/ProcessorSplitParseContainerLogNative.h"
+#include "unittest/Unittest.h"
+
+namespace logtail {
+
+class ProcessorSplitParseContainerLogNativeUnittest : public ::testing::Test {
+public:
+    void SetUp() override { mContext.SetConfigName("project##config_0"); }
+
+    void TestInit();
+    void TestContainerdLog();
+    void TestDockerJsonLog();
+    void TestKeepingSourceWhenParseFail();
+    void TestConsistentWithSplitParseMerge();
+
+    CollectionPipelineContext mContext;
+
+private:
+    std::string Process(const Json::Value& config, const std::string& containerType, const std::string& content);
+};
+
+UNIT_TEST_CASE(ProcessorSplitParseContainerLogNativeUnittest, TestInit);
+UNIT_TEST_CASE(ProcessorSplitParseContainerLogNativeUnittest, TestContainerdLog);
+UNIT_TEST_CASE(ProcessorSplitParseContainerLogNativeUnittest, TestDockerJsonLog);
+UNIT_TEST_CASE(ProcessorSplitParseContainerLogNativeUnittest, TestKeepingSourceWhenParseFail);
+UNIT_TEST_CASE(ProcessorSplitParseContainerLogNativeUnittest, TestConsistentWithSplitParseMerge);
+
+static PipelineEventGroup MakeEventGroup(const std::string& containerType, const std::string& content) {
+    PipelineEventGroup eventGroup(std::make_shared<SourceBuffer>());
+    eventGroup.SetMetadata(EventGroupMetaKey::LOG_FORMAT, containerType);
+    Json::Value root;
+    Json::Value event;
+    event["type"] = 1;
+    event["timestamp"] = 12345678901;
+    event["timestampNanosecond"] = 0;
+    event["contents"]["content"] = content;
+    root["events"].append(event);
+    eventGroup.FromJsonString(root.toStyledString());
+    return eventGroup;
+}
+
+std::string ProcessorSplitParseContainerLogNativeUnittest::Process(const Json::Value& config,
+                                                                   const std::string& containerType,
+                                                                   const std::string& content) {
+    PipelineEventGroup eventGroup = MakeEventGroup(containerType, content);
+    ProcessorSplitParseContainerLogNative processor;
+    processor.SetContext(mContext);
+    processor.SetMetricsRecordRef(ProcessorSplitParseContainerLogNative::sName, "1");
+    APSARA_TEST_TRUE(processor.Init(config));
+    processor.Process(eventGroup);
+    return eventGroup.ToJsonString();
+}
+
+void ProcessorSplitParseContainerLogNativeUnittest::TestInit() {
+    Json::Value config;
+    config["IgnoringStdout"] = "true";
+    config["IgnoringStderr"] = 1;
+    ProcessorSplitParseContainerLogNative processor;
+    processor.SetContext(mContext);
+    processor.SetMetricsRecordRef(ProcessorSplitParseContainerLogNative::sName, "1");
+    APSARA_TEST_TRUE_FATAL(processor.Init(config));
+}
+
+void ProcessorSplitParseContainerLogNativeUnittest::TestContainerdLog() {
+    const std::string content
+        = "2024-01-05T23:28:06.818486411+08:00 stdout P Exception i\n"
+          "2024-01-05T23:28:06.818486412+08:00 stderr F dropped\n"
+          "2024-01-05T23:28:06.818486413+08:00 stdout P n thread 'main'\n"
+          "2024-01-05T23:28:06.818486414+08:00 stdout F  java.lang.NullPointerException\n"
+          "2024-01-05T23:28:06.818486415+08:00 stdout F     at com.example.myproject.Book.getTitle\n"
+          "2024-01-05T23:28:06.818486416+08:00 stdout PP abc\n"
+          "2024-01-05T23:28:06.818486417+08:00 stdout P tail";
+    Json::Value config;
+    config["IgnoringStdout"] = false;
+    config["IgnoringStderr"] = true;
+    std::string expectJson = R"({
+        "events": [
+            {
+                "contents": {
+                    "_source_": "stdout",
+                    "_time_": "2024-01-05T23:28:06.818486411+08:00",
+                    "content": "Exception in thread 'main' java.lang.NullPointerException"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            },
+            {
+                "contents": {
+                    "_source_": "stdout",
+                    "_time_": "2024-01-05T23:28:06.818486415+08:00",
+                    "content": "    at com.example.myproject.Book.getTitle"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            },
+            {
+                "contents": {
+                    "_source_": "stdout",
+                    "_time_": "2024-01-05T23:28:06.818486416+08:00",
+                    "content": "PP abc"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            },
+            {
+                "contents": {
+                    "_source_": "stdout",
+                    "_time_": "2024-01-05T23:28:06.818486417+08:00",
+                    "content": "tail"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            }
+        ],
+        "metadata": {
+            "container.type": "containerd_text"
+        }
+    })";
+    APSARA_TEST_STREQ(CompactJson(expectJson).c_str(),
+                      CompactJson(Process(config, ProcessorParseContainerLogNative::CONTAINERD_TEXT, content)).c_str());
+}
+
+void ProcessorSplitParseContainerLogNativeUnittest::TestDockerJsonLog() {
+    const std::string content
+        = R"({"log":"Exception in thread  \"main\" java.lang.NullPoinntterException\n","stream":"stdout","time":"2024-02-19T03:49:37.793533014Z"})"
+          "\n"
+          R"({"log":"     at com.example.myproject.Book.getTitle\n","stream":"stderr","time":"2024-02-19T03:49:37.793559367Z"})";
+    Json::Value config;
+    std::string expectJson = R"({
+        "events": [
+            {
+                "contents": {
+                    "_source_": "stdout",
+                    "_time_": "2024-02-19T03:49:37.793533014Z",
+                    "content": "Exception in thread  \"main\" java.lang.NullPoinntterException"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            },
+            {
+                "contents": {
+                    "_source_": "stderr",
+                    "_time_": "2024-02-19T03:49:37.793559367Z",
+                    "content": "     at com.example.myproject.Book.getTitle"
+                },
+                "timestamp": 12345678901,
+                "timestampNanosecond": 0,
+                "type": 1
+            }
+        ],
+        "metadata": {
+            "container.type": "docker_json-file"
+        }
+    })";
+    APSARA_TEST_STREQ(CompactJson(expectJson).c_str(),
+                      CompactJson(Process(config, ProcessorParseContainerLogNative::DOCKER_JSON_FILE, content)).c_str());
+}
+
+void ProcessorSplitParseContainerLogNativeUnittest::TestKeepingSourceWhenParseFail() {
+    const std::string content = "invalid\n2024-01-05T23:28:06.818486411+08:00 stdout F valid";
+    {
+        Json::Value config;
+        config["KeepingSourceWhenParseFail"] = true;
+        std::string expectJson = R"({
+            "events": [
+                {
+                    "contents": {
+                        "content": "invalid"
+                    },
+                    "timestamp": 12345678901,
+                    "timestampNanosecond": 0,
+                    "type": 1
+                },
+                {
+                    "contents": {
+                        "_source_": "stdout",
+                        "_time_": "2024-01-05T23:28:06.818486411+08:00",
+                        "content": "valid"
+                    },
+                    "timestamp": 12345678901,
+                    "timestampNanosecond": 0,
+                    "type": 1
+                }
+            ],
+            "metadata": {
+                "container.type": "containerd_text"
+            }
+        })";
+        APSARA_TEST_STREQ(
+            CompactJson(expectJson).c_str(),
+            CompactJson(Process(config, ProcessorParseContainerLogNative::CONTAINERD_TEXT, content)).c_str());
+    }
+    {
+        Json::Value config;
+        config["KeepingSourceWhenParseFail"] = false;
+        std::string expectJson = R"({
+            "events": [
+                {
+                    "contents": {
+                        "_source_": "stdout",
+                        "_time_": "2024-01-05T23:28:06.818486411+08:00",
+                        "content": "valid"
+                    },
+                    "timestamp": 12345678901,
+                    "timestampNanosecond": 0,
+                    "type": 1
+                }
+            ],
+            "metadata": {
+                "container.type": "containerd_text"
+            }
+        })";
+        APSARA_TEST_STREQ(
+            CompactJson(expectJson).c_str(),
+            CompactJson(Process(config, ProcessorParseContainerLogNative::CONTAINERD_TEXT, content)).c_str());
+    }
+}
+
+void ProcessorSplitParseContainerLogNativeUnittest::TestConsistentWithSplitParseMerge() {
+    const std::string content = "2024-01-05T23:28:06.818486411+08:00 stdout P a\n"
+                                "2024-01-05T23:28:06.818486412+08:00 stdout P b\n"
+                                "2024-01-05T23:28:06.818486413+08:00 stdout F c\n"
+                                "2024-01-05T23:28:06.818486414+08:00 stderr F d\n"
+                                "\n"
+                                "2024-01-05T23:28:06.818486415+08:00 stdout e";
+    Json::Value config;
+    Json::Value mergeConfig;
+    mergeConfig["MergeType"] = "flag";
+
+    PipelineEventGroup eventGroup = MakeEventGroup(ProcessorParseContainerLogNative::CONTAINERD_TEXT, content);
+    ProcessorSplitLogStringNative split;
+    split.SetContext(mContext);
+    split.SetMetricsRecordRef(ProcessorSplitLogStringNative::sName, "1");
+    APSARA_TEST_TRUE_FATAL(split.Init(config));
+    ProcessorParseContainerLogNative parse;
+    parse.SetContext(mContext);
+    parse.SetMetricsRecordRef(ProcessorParseContainerLogNative::sName, "2");
+    APSARA_TEST_TRUE_FATAL(parse.Init(config));
+    ProcessorMergeMultilineLogNative merge;
+    merge.SetContext(mContext);
+    merge.SetMetricsRecordRef(ProcessorMergeMultilineLogNative::sName, "3");
+    APSARA_TEST_TRUE_FATAL(merge.Init(mergeConfig));
+    split.Process(eventGroup);
+    parse.Process(eventGroup);
+    merge.Process(eventGroup);
+
+    APSARA_TEST_STREQ(
+        CompactJson(eventGroup.ToJsonString()).c_str(),
+        CompactJson(Process(config, ProcessorParseContainerLogNative::CONTAINERD_TEXT, content)).c_str());
+}
+
+} // namespace logtail
+
+UNIT_TEST_MAIN
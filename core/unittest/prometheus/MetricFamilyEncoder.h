@@ -0,0 +1,121 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace logtail {
+
+// Minimal encoder of the delimited io.prometheus.client.MetricFamily format, used to build scrape bodies in tests.
+class MetricFamilyEncoder {
+public:
+    enum Type { COUNTER = 0, GAUGE = 1, SUMMARY = 2, UNTYPED = 3, HISTOGRAM = 4 };
+
+    struct Metric {
+        std::vector<std::pair<std::string, std::string>> mLabels;
+        // value of counter, gauge and untyped
+        double mValue = 0;
+        // quantiles of summary, or upper bound and cumulative count of histogram buckets
+        std::vector<std::pair<double, double>> mPoints;
+        uint64_t mCount = 0;
+        double mSum = 0;
+        int64_t mTimestampMs = -1;
+    };
+
+    static void AppendFamily(std::string& out, const std::string& name, Type type, const std::vector<Metric>& metrics) {
+        std::string family;
+        AppendBytes(family, 1, name);
+        AppendVarintField(family, 3, type);
+        for (const auto& m : metrics) {
+            std::string metric;
+            for (const auto& [k, v] : m.mLabels) {
+                std::string pair;
+                AppendBytes(pair, 1, k);
+                AppendBytes(pair, 2, v);
+                AppendBytes(metric, 1, pair);
+            }
+            std::string value;
+            switch (type) {
+                case COUNTER:
+                case GAUGE:
+                case UNTYPED:
+                    AppendDouble(value, 1, m.mValue);
+                    AppendBytes(metric, type == COUNTER ? 3 : (type == GAUGE ? 2 : 5), value);
+                    break;
+                case SUMMARY:
+                    AppendVarintField(value, 1, m.mCount);
+                    AppendDouble(value, 2, m.mSum);
+                    for (const auto& [q, v] : m.mPoints) {
+                        std::string quantile;
+                        AppendDouble(quantile, 1, q);
+                        AppendDouble(quantile, 2, v);
+                        AppendBytes(value, 3, quantile);
+                    }
+                    AppendBytes(metric, 4, value);
+                    break;
+                case HISTOGRAM:
+                    AppendVarintField(value, 1, m.mCount);
+                    AppendDouble(value, 2, m.mSum);
+                    for (const auto& [ub, cnt] : m.mPoints) {
+                        std::string bucket;
+                        AppendVarintField(bucket, 1, static_cast<uint64_t>(cnt));
+                        AppendDouble(bucket, 2, ub);
+                        AppendBytes(value, 3, bucket);
+                    }
+                    AppendBytes(metric, 7, value);
+                    break;
+            }
+            if (m.mTimestampMs >= 0) {
+                AppendVarintField(metric, 6, static_cast<uint64_t>(m.mTimestampMs));
+            }
+            AppendBytes(family, 4, metric);
+        }
+        AppendVarint(out, family.size());
+        out.append(family);
+    }
+
+private:
+    static void AppendVarint(std::string& out, uint64_t v) {
+        while (v >= 0x80) {
+            out.push_back(static_cast<char>((v & 0x7f) | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<char>(v));
+    }
+    static void AppendVarintField(std::string& out, uint32_t field, uint64_t v) {
+        AppendVarint(out, field << 3);
+        AppendVarint(out, v);
+    }
+    static void AppendBytes(std::string& out, uint32_t field, const std::string& v) {
+        AppendVarint(out, (field << 3) | 2);
+        AppendVarint(out, v.size());
+        out.append(v);
+    }
+    static void AppendDouble(std::string& out, uint32_t field, double v) {
+        AppendVarint(out, (field << 3) | 1);
+        char buf[8];
+        memcpy(buf, &v, 8);
+        out.append(buf, 8);
+    }
+};
+
+} // namespace logtail
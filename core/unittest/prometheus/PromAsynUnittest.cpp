@@ -1,15 +1,71 @@
 
+#include "common/Flags.h"
+#include "common/StringTools.h"
+#include "common/http/AsynCurlRunner.h"
 #include "common/http/HttpResponse.h"
 #include "prometheus/async/PromFuture.h"
 #include "prometheus/async/PromHttpRequest.h"
+#include "prometheus/async/PromScrapeDispatcher.h"
 #include "unittest/Unittest.h"
 
+DECLARE_FLAG_INT32(prom_max_inflight_scrapes);
+DECLARE_FLAG_INT32(prom_max_queued_scrapes_per_job);
+
 using namespace std;
 
 namespace logtail {
 class PromAsynUnittest : public testing::Test {
 public:
     void TestExecTime();
+    void TestDispatcherBudget();
+    void TestDispatcherFairness();
+    void TestDispatcherDropInvalid();
+    void TestDispatcherExpire();
+
+protected:
+    void SetUp() override {
+        INT32_FLAG(prom_max_inflight_scrapes) = 2;
+        ClearDispatcher();
+    }
+    void TearDown() override {
+        INT32_FLAG(prom_max_inflight_scrapes) = 0;
+        ClearDispatcher();
+    }
+
+private:
+    static unique_ptr<PromHttpRequest> MakeRequest(const string& host,
+                                                   shared_ptr<PromFuture<>> isContextValidFuture = nullptr,
+                                                   shared_ptr<PromFuture<HttpResponse&, uint64_t>> future = nullptr) {
+        return make_unique<PromHttpRequest>("GET",
+                                            false,
+                                            host,
+                                            8080,
+                                            "/metrics",
+                                            "",
+                                            map<string, string>(),
+                                            "",
+                                            HttpResponse(),
+                                            10,
+                                            0,
+                                            std::move(future),
+                                            std::move(isContextValidFuture));
+    }
+
+    // pop the next request handed to AsynCurlRunner
+    static unique_ptr<AsynHttpRequest> PopSent() {
+        unique_ptr<AsynHttpRequest> request;
+        AsynCurlRunner::GetInstance()->mQueue.TryPop(request);
+        return request;
+    }
+
+    static void ClearDispatcher() {
+        auto* dispatcher = PromScrapeDispatcher::GetInstance();
+        dispatcher->Clear();
+        dispatcher->mInFlight = 0;
+        dispatcher->mLastJob.clear();
+        while (PopSent() != nullptr) {
+        }
+    }
 };
 
 void PromAsynUnittest::TestExecTime() {
@@ -32,7 +88,153 @@ void PromAsynUnittest::TestExecTime() {
     asynRequest->OnSendDone(response);
 }
 
+void PromAsynUnittest::TestDispatcherBudget() {
+    auto* dispatcher = PromScrapeDispatcher::GetInstance();
+    auto lagMs = make_shared<Counter>("lag");
+    auto now = chrono::steady_clock::now();
+    for (int i = 0; i < 3; ++i) {
+        dispatcher->Submit(
+            "job", MakeRequest("host" + ToString(i)), now - chrono::seconds(1), chrono::seconds(15), lagMs);
+    }
+    APSARA_TEST_EQUAL(2U, dispatcher->GetInFlightCount());
+    APSARA_TEST_EQUAL(1U, dispatcher->GetQueuedCount());
+    APSARA_TEST_TRUE(lagMs->GetValue() >= 2000);
+
+    auto first = PopSent();
+    auto second = PopSent();
+    APSARA_TEST_TRUE(first != nullptr && second != nullptr);
+    APSARA_TEST_TRUE(PopSent() == nullptr);
+    APSARA_TEST_EQUAL("host0", first->mHost);
+
+    // the queued request takes the slot released by a done request
+    HttpResponse response;
+    first->OnSendDone(response);
+    APSARA_TEST_EQUAL(2U, dispatcher->GetInFlightCount());
+    APSARA_TEST_EQUAL(0U, dispatcher->GetQueuedCount());
+    auto third = PopSent();
+    APSARA_TEST_TRUE(third != nullptr);
+    APSARA_TEST_EQUAL("host2", third->mHost);
+
+    // the slot is only released once
+    first->OnSendDone(response);
+    APSARA_TEST_EQUAL(2U, dispatcher->GetInFlightCount());
+    second->OnSendDone(response);
+    third->OnSendDone(response);
+    APSARA_TEST_EQUAL(0U, dispatcher->GetInFlightCount());
+}
+
+void PromAsynUnittest::TestDispatcherFairness() {
+    auto* dispatcher = PromScrapeDispatcher::GetInstance();
+    auto now = chrono::steady_clock::now();
+    for (int i = 0; i < 4; ++i) {
+        dispatcher->Submit("a", MakeRequest("a" + ToString(i)), now);
+    }
+    for (int i = 0; i < 2; ++i) {
+        dispatcher->Submit("b", MakeRequest("b" + ToString(i)), now);
+    }
+    APSARA_TEST_EQUAL(4U, dispatcher->GetQueuedCount());
+
+    vector<string> order;
+    HttpResponse response;
+    auto running = PopSent();
+    PopSent();
+    for (int i = 0; i < 4; ++i) {
+        running->OnSendDone(response);
+        running = PopSent();
+        APSARA_TEST_TRUE(running != nullptr);
+        order.push_back(running->mHost);
+    }
+    // job b is not starved by the requests of job a queued before it
+    APSARA_TEST_EQUAL((vector<string>{"b0", "a2", "b1", "a3"}), order);
+}
+
+void PromAsynUnittest::TestDispatcherDropInvalid() {
+    auto* dispatcher = PromScrapeDispatcher::GetInstance();
+    auto now = chrono::steady_clock::now();
+    // the timer has already consumed the context future of a queued request, as PromScrapeTimerEvent::IsValid does
+    auto cancelledFuture = make_shared<PromFuture<>>();
+    int checked = 0;
+    cancelledFuture->AddDoneCallback([&checked]() {
+        ++checked;
+        return true;
+    });
+    auto cancelled = MakeRequest("cancelled", cancelledFuture);
+    APSARA_TEST_TRUE(cancelled->IsContextValid());
+    dispatcher->Submit("job", MakeRequest("host0"), now);
+    dispatcher->Submit("job", MakeRequest("host1"), now);
+    dispatcher->Submit("job", std::move(cancelled), now);
+    dispatcher->Submit("job", MakeRequest("host3"), now);
+    // the scheduler is cancelled after its request is queued
+    cancelledFuture->Cancel();
+
+    HttpResponse response;
+    auto first = PopSent();
+    PopSent();
+    first->OnSendDone(response);
+    APSARA_TEST_EQUAL(1, checked);
+    auto next = PopSent();
+    APSARA_TEST_TRUE(next != nullptr);
+    APSARA_TEST_EQUAL("host3", next->mHost);
+    APSARA_TEST_EQUAL(2U, dispatcher->GetInFlightCount());
+    APSARA_TEST_EQUAL(0U, dispatcher->GetQueuedCount());
+}
+
+void PromAsynUnittest::TestDispatcherExpire() {
+    auto* dispatcher = PromScrapeDispatcher::GetInstance();
+    auto now = chrono::steady_clock::now();
+    auto makeFuture = [](vector<NetworkCode>& codes) {
+        auto future = make_shared<PromFuture<HttpResponse&, uint64_t>>();
+        future->AddDoneCallback([&codes](HttpResponse& response, uint64_t) {
+            codes.push_back(response.GetNetworkStatus().mCode);
+            return true;
+        });
+        return future;
+    };
+    dispatcher->Submit("job", MakeRequest("host0"), now);
+    dispatcher->Submit("job", MakeRequest("host1"), now);
+
+    // a request queued longer than its interval is completed as timed out instead of being sent
+    vector<NetworkCode> staleCodes;
+    dispatcher->Submit("job",
+                       MakeRequest("stale", nullptr, makeFuture(staleCodes)),
+                       now - chrono::seconds(30),
+                       chrono::seconds(15));
+    dispatcher->Submit("job", MakeRequest("host3"), now, chrono::seconds(15));
+    HttpResponse response;
+    auto first = PopSent();
+    PopSent();
+    first->OnSendDone(response);
+    APSARA_TEST_EQUAL(1U, staleCodes.size());
+    APSARA_TEST_TRUE(staleCodes[0] == NetworkCode::Timeout);
+    auto next = PopSent();
+    APSARA_TEST_TRUE(next != nullptr);
+    APSARA_TEST_EQUAL("host3", next->mHost);
+
+    // the oldest queued request of a job is expired once the queue is full
+    INT32_FLAG(prom_max_queued_scrapes_per_job) = 1;
+    vector<NetworkCode> evictedCodes;
+    dispatcher->Submit("job", MakeRequest("evicted", nullptr, makeFuture(evictedCodes)), now);
+    dispatcher->Submit("job", MakeRequest("host5"), now);
+    INT32_FLAG(prom_max_queued_scrapes_per_job) = 1000;
+    APSARA_TEST_EQUAL(1U, evictedCodes.size());
+    APSARA_TEST_EQUAL(1U, dispatcher->GetQueuedCount());
+
+    // clear only drops queued requests, in-flight ones are drained as they are done
+    size_t inFlight = dispatcher->GetInFlightCount();
+    APSARA_TEST_TRUE(inFlight > 0);
+    dispatcher->Clear();
+    APSARA_TEST_EQUAL(inFlight, dispatcher->GetInFlightCount());
+    APSARA_TEST_EQUAL(0U, dispatcher->GetQueuedCount());
+    next->OnSendDone(response);
+    APSARA_TEST_EQUAL(inFlight - 1, dispatcher->GetInFlightCount());
+    APSARA_TEST_TRUE(PopSent() == nullptr);
+}
+
 UNIT_TEST_CASE(PromAsynUnittest, TestExecTime);
+UNIT_TEST_CASE(PromAsynUnittest, TestDispatcherBudget);
+UNIT_TEST_CASE(PromAsynUnittest, TestDispatcherFairness);
+UNIT_TEST_CASE(PromAsynUnittest, TestDispatcherDropInvalid);
+UNIT_TEST_CASE(PromAsynUnittest, TestDispatcherExpire);
 
 } // namespace logtail
 
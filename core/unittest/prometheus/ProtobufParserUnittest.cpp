@@ -0,0 +1,239 @@
+/*
+ * Copyright 2024 iLogtail Authors
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <limits>
+#include <string>
+
+#include "models/MetricEvent.h"
+#include "models/PipelineEventGroup.h"
+#include "prometheus/labels/ProtobufParser.h"
+#include "unittest/Unittest.h"
+#include "unittest/prometheus/MetricFamilyEncoder.h"
+
+using namespace std;
+
+namespace logtail {
+
+class ProtobufParserUnittest : public testing::Test {
+public:
+    void TestParseCounterAndGauge();
+    void TestParseSummary();
+    void TestParseHistogram();
+    void TestHonorTimestamps();
+    void TestFeedInChunks();
+    void TestParseFailure();
+    void TestFormatFloat();
+
+private:
+    static string BuildPayload();
+};
+
+string ProtobufParserUnittest::BuildPayload() {
+    string payload;
+    MetricFamilyEncoder::Metric m1;
+    m1.mLabels = {{"method", "GET"}, {"code", "200"}};
+    m1.mValue = 1027;
+    MetricFamilyEncoder::Metric m2;
+    m2.mLabels = {{"method", "POST"}, {"code", "500"}};
+    m2.mValue = 3;
+    MetricFamilyEncoder::AppendFamily(payload, "http_requests_total", MetricFamilyEncoder::COUNTER, {m1, m2});
+
+    MetricFamilyEncoder::Metric g;
+    g.mValue = 0.25;
+    MetricFamilyEncoder::AppendFamily(payload, "temperature", MetricFamilyEncoder::GAUGE, {g});
+
+    MetricFamilyEncoder::Metric h;
+    h.mLabels = {{"handler", "/"}};
+    h.mPoints = {{0.05, 24054}, {0.1, 33444}, {1, 100392}};
+    h.mCount = 144320;
+    h.mSum = 53423;
+    MetricFamilyEncoder::AppendFamily(payload, "http_request_duration_seconds", MetricFamilyEncoder::HISTOGRAM, {h});
+    return payload;
+}
+
+void ProtobufParserUnittest::TestParseCounterAndGauge() {
+    string payload;
+    MetricFamilyEncoder::Metric m1;
+    m1.mLabels = {{"method", "GET"}, {"code", "200"}};
+    m1.mValue = 1027;
+    MetricFamilyEncoder::AppendFamily(payload, "http_requests_total", MetricFamilyEncoder::COUNTER, {m1});
+    MetricFamilyEncoder::Metric g;
+    g.mValue = 0.25;
+    MetricFamilyEncoder::AppendFamily(payload, "temperature", MetricFamilyEncoder::GAUGE, {g});
+    MetricFamilyEncoder::AppendFamily(payload, "untyped_metric", MetricFamilyEncoder::UNTYPED, {g});
+
+    ProtobufParser parser;
+    auto eGroup = parser.Parse(payload, 1715829785, 0);
+    const auto& events = eGroup.GetEvents();
+    APSARA_TEST_EQUAL(3UL, events.size());
+    const auto& counter = events[0].Cast<MetricEvent>();
+    APSARA_TEST_EQUAL("http_requests_total", counter.GetName());
+    APSARA_TEST_EQUAL("GET", counter.GetTag("method"));
+    APSARA_TEST_EQUAL("200", counter.GetTag("code"));
+    APSARA_TEST_EQUAL(1027.0, counter.GetValue<UntypedSingleValue>()->mValue);
+    APSARA_TEST_EQUAL(1715829785, counter.GetTimestamp());
+    APSARA_TEST_EQUAL("temperature", events[1].Cast<MetricEvent>().GetName());
+    APSARA_TEST_EQUAL(0.25, events[1].Cast<MetricEvent>().GetValue<UntypedSingleValue>()->mValue);
+    APSARA_TEST_EQUAL("untyped_metric", events[2].Cast<MetricEvent>().GetName());
+}
+
+void ProtobufParserUnittest::TestParseSummary() {
+    string payload;
+    MetricFamilyEncoder::Metric s;
+    s.mPoints = {{0.5, 0.012}, {0.99, 0.5}};
+    s.mCount = 10;
+    s.mSum = 1.5;
+    MetricFamilyEncoder::AppendFamily(payload, "rpc_duration_seconds", MetricFamilyEncoder::SUMMARY, {s});
+
+    ProtobufParser parser;
+    auto eGroup = parser.Parse(payload, 0, 0);
+    const auto& events = eGroup.GetEvents();
+    APSARA_TEST_EQUAL(4UL, events.size());
+    APSARA_TEST_EQUAL("rpc_duration_seconds", events[0].Cast<MetricEvent>().GetName());
+    APSARA_TEST_EQUAL("0.5", events[0].Cast<MetricEvent>().GetTag("quantile"));
+    APSARA_TEST_EQUAL(0.012, events[0].Cast<MetricEvent>().GetValue<UntypedSingleValue>()->mValue);
+    APSARA_TEST_EQUAL("0.99", events[1].Cast<MetricEvent>().GetTag("quantile"));
+    APSARA_TEST_EQUAL("rpc_duration_seconds_sum", events[2].Cast<MetricEvent>().GetName());
+    APSARA_TEST_EQUAL(1.5, events[2].Cast<MetricEvent>().GetValue<UntypedSingleValue>()->mValue);
+    APSARA_TEST_EQUAL("rpc_duration_seconds_count", events[3].Cast<MetricEvent>().GetName());
+    APSARA_TEST_EQUAL(10.0, events[3].Cast<MetricEvent>().GetValue<UntypedSingleValue>()->mValue);
+}
+
+void ProtobufParserUnittest::TestParseHistogram() {
+    string payload;
+    MetricFamilyEncoder::Metric h;
+    h.mLabels = {{"handler", "/"}};
+    h.mPoints = {{0.05, 24054}, {0.1, 33444}, {1, 100392}};
+    h.mCount = 144320;
+    h.mSum = 53423;
+    MetricFamilyEncoder::AppendFamily(payload, "http_request_duration_seconds", MetricFamilyEncoder::HISTOGRAM, {h});
+
+    ProtobufParser parser;
+    auto eGroup = parser.Parse(payload, 0, 0);
+    const auto& events = eGroup.GetEvents();
+    // 3 buckets, the implicit +Inf bucket, _sum and _count
+    APSARA_TEST_EQUAL(6UL, events.size());
+    for (size_t i = 0; i < 4; ++i) {
+        APSARA_TEST_EQUAL("http_request_duration_seconds_bucket", events[i].Cast<MetricEvent>().GetName());
+        APSARA_TEST_EQUAL("/", events[i].Cast<MetricEvent>().GetTag("handler"));
+    }
+    APSARA_TEST_EQUAL("0.05", events[0].Cast<MetricEvent>().GetTag("le"));
+    APSARA_TEST_EQUAL("0.1", events[1].Cast<MetricEvent>().GetTag("le"));
+    APSARA_TEST_EQUAL("1", events[2].Cast<MetricEvent>().GetTag("le"));
+    APSARA_TEST_EQUAL(100392.0, events[2].Cast<MetricEvent>().GetValue<UntypedSingleValue>()->mValue);
+    APSARA_TEST_EQUAL("+Inf", events[3].Cast<MetricEvent>().GetTag("le"));
+    APSARA_TEST_EQUAL(144320.0, events[3].Cast<MetricEvent>().GetValue<UntypedSingleValue>()->mValue);
+    APSARA_TEST_EQUAL("http_request_duration_seconds_sum", events[4].Cast<MetricEvent>().GetName());
+    APSARA_TEST_EQUAL(53423.0, events[4].Cast<MetricEvent>().GetValue<UntypedSingleValue>()->mValue);
+    APSARA_TEST_EQUAL("http_request_duration_seconds_count", events[5].Cast<MetricEvent>().GetName());
+    APSARA_TEST_EQUAL(144320.0, events[5].Cast<MetricEvent>().GetValue<UntypedSingleValue>()->mValue);
+}
+
+void ProtobufParserUnittest::TestHonorTimestamps() {
+    string payload;
+    MetricFamilyEncoder::Metric m;
+    m.mValue = 1;
+    m.mTimestampMs = 1715829785083;
+    MetricFamilyEncoder::AppendFamily(payload, "test_metric", MetricFamilyEncoder::GAUGE, {m});
+    {
+        ProtobufParser parser(true);
+        auto eGroup = parser.Parse(payload, 1000000000, 0);
+        APSARA_TEST_EQUAL(1715829785, eGroup.GetEvents()[0].Cast<MetricEvent>().GetTimestamp());
+        APSARA_TEST_EQUAL(83000000U, eGroup.GetEvents()[0].Cast<MetricEvent>().GetTimestampNanosecond().value());
+    }
+    {
+        ProtobufParser parser(false);
+        auto eGroup = parser.Parse(payload, 1000000000, 0);
+        APSARA_TEST_EQUAL(1000000000, eGroup.GetEvents()[0].Cast<MetricEvent>().GetTimestamp());
+    }
+}
+
+void ProtobufParserUnittest::TestFeedInChunks() {
+    string payload = BuildPayload();
+    ProtobufParser parser;
+    auto expected = parser.Parse(payload, 0, 0);
+    APSARA_TEST_EQUAL(9UL, expected.GetEvents().size());
+
+    for (size_t chunk : {1UL, 3UL, 17UL, 64UL}) {
+        PipelineEventGroup eGroup(make_shared<SourceBuffer>());
+        for (size_t i = 0; i < payload.size(); i += chunk) {
+            APSARA_TEST_TRUE(parser.Feed(payload.data() + i, min(chunk, payload.size() - i), eGroup));
+        }
+        APSARA_TEST_FALSE(parser.HasPendingData());
+        APSARA_TEST_EQUAL(expected.GetEvents().size(), eGroup.GetEvents().size());
+        for (size_t i = 0; i < eGroup.GetEvents().size(); ++i) {
+            const auto& e = eGroup.GetEvents()[i].Cast<MetricEvent>();
+            const auto& expectedEvent = expected.GetEvents()[i].Cast<MetricEvent>();
+            APSARA_TEST_EQUAL(expectedEvent.GetName(), e.GetName());
+            APSARA_TEST_EQUAL(expectedEvent.TagsSize(), e.TagsSize());
+            APSARA_TEST_EQUAL(expectedEvent.GetValue<UntypedSingleValue>()->mValue,
+                              e.GetValue<UntypedSingleValue>()->mValue);
+        }
+    }
+
+    // a truncated message is kept until more data arrives
+    PipelineEventGroup eGroup(make_shared<SourceBuffer>());
+    APSARA_TEST_TRUE(parser.Feed(payload.data(), payload.size() - 1, eGroup));
+    APSARA_TEST_TRUE(parser.HasPendingData());
+    APSARA_TEST_EQUAL(3UL, eGroup.GetEvents().size());
+    parser.Reset();
+    APSARA_TEST_FALSE(parser.HasPendingData());
+}
+
+void ProtobufParserUnittest::TestParseFailure() {
+    ProtobufParser parser;
+    PipelineEventGroup eGroup(make_shared<SourceBuffer>());
+    // message of 4 bytes with an invalid wire type
+    string invalid = string("\x04\x0f\x01\x02\x03", 5);
+    APSARA_TEST_FALSE(parser.Feed(invalid.data(), invalid.size(), eGroup));
+    // length prefix longer than 10 bytes
+    string invalidPrefix(11, '\xff');
+    parser.Reset();
+    APSARA_TEST_FALSE(parser.Feed(invalidPrefix.data(), invalidPrefix.size(), eGroup));
+    APSARA_TEST_EQUAL(0UL, eGroup.GetEvents().size());
+}
+
+void ProtobufParserUnittest::TestFormatFloat() {
+    string out;
+    ProtobufParser::FormatFloat(0.005, out);
+    APSARA_TEST_EQUAL("0.005", out);
+    ProtobufParser::FormatFloat(1, out);
+    APSARA_TEST_EQUAL("1", out);
+    ProtobufParser::FormatFloat(100000, out);
+    APSARA_TEST_EQUAL("100000", out);
+    ProtobufParser::FormatFloat(1000000, out);
+    APSARA_TEST_EQUAL("1e+06", out);
+    ProtobufParser::FormatFloat(0.00001, out);
+    APSARA_TEST_EQUAL("1e-05", out);
+    ProtobufParser::FormatFloat(2.5e-10, out);
+    APSARA_TEST_EQUAL("2.5e-10", out);
+    ProtobufParser::FormatFloat(-0.25, out);
+    APSARA_TEST_EQUAL("-0.25", out);
+    ProtobufParser::FormatFloat(numeric_limits<double>::infinity(), out);
+    APSARA_TEST_EQUAL("+Inf", out);
+}
+
+UNIT_TEST_CASE(ProtobufParserUnittest, TestParseCounterAndGauge)
+UNIT_TEST_CASE(ProtobufParserUnittest, TestParseSummary)
+UNIT_TEST_CASE(ProtobufParserUnittest, TestParseHistogram)
+UNIT_TEST_CASE(ProtobufParserUnittest, TestHonorTimestamps)
+UNIT_TEST_CASE(ProtobufParserUnittest, TestFeedInChunks)
+UNIT_TEST_CASE(ProtobufParserUnittest, TestParseFailure)
+UNIT_TEST_CASE(ProtobufParserUnittest, TestFormatFloat)
+
+} // namespace logtail
+
+UNIT_TEST_MAIN
@@ -17,10 +17,14 @@
 #include <json/json.h>
 
 #include <boost/regex.hpp>
+#include <atomic>
 #include <string>
+#include <thread>
 
 #include "common/JsonUtil.h"
+#include "models/PipelineEventGroup.h"
 #include "prometheus/labels/Relabel.h"
+#include "prometheus/labels/RelabelProgram.h"
 #include "unittest/Unittest.h"
 
 using namespace std;
@@ -49,6 +53,10 @@ public:
     void TestLowerCase();
     void TestUpperCase();
     void TestMultiRelabel();
+    void TestRelabelMatcher();
+    void TestProcessMetricEvent();
+    void TestKeepDropMemo();
+    void TestReplacePartialMatch();
 };
 
 
@@ -512,6 +520,304 @@ void RelabelConfigUnittest::TestMultiRelabel() {
     APSARA_TEST_TRUE(configList.Process(result));
 }
 
+void RelabelConfigUnittest::TestRelabelMatcher() {
+    vector<StringView> groups;
+    string out;
+    {
+        // default regex
+        RelabelMatcher matcher;
+        APSARA_TEST_TRUE(matcher.Init("().*"));
+        APSARA_TEST_FALSE(matcher.IsRegex());
+        APSARA_TEST_TRUE(matcher.Match("abc", &groups));
+        matcher.Expand("$1", groups, out);
+        APSARA_TEST_EQUAL("", out);
+    }
+    {
+        RelabelMatcher matcher;
+        APSARA_TEST_TRUE(matcher.Init("(.+)"));
+        APSARA_TEST_FALSE(matcher.IsRegex());
+        APSARA_TEST_FALSE(matcher.Match("", nullptr));
+        APSARA_TEST_TRUE(matcher.Match("abc", &groups));
+        out.clear();
+        matcher.Expand("${1}:9100", groups, out);
+        APSARA_TEST_EQUAL("abc:9100", out);
+    }
+    {
+        RelabelMatcher matcher;
+        APSARA_TEST_TRUE(matcher.Init("__meta_kubernetes_pod_label_(.+)"));
+        APSARA_TEST_FALSE(matcher.IsRegex());
+        APSARA_TEST_FALSE(matcher.Match("__meta_kubernetes_pod_label_", nullptr));
+        APSARA_TEST_FALSE(matcher.Match("__meta_kubernetes_pod_ip", nullptr));
+        APSARA_TEST_TRUE(matcher.Match("__meta_kubernetes_pod_label_app", &groups));
+        out.clear();
+        matcher.Expand("k8s_$1", groups, out);
+        APSARA_TEST_EQUAL("k8s_app", out);
+    }
+    {
+        RelabelMatcher matcher;
+        APSARA_TEST_TRUE(matcher.Init("172.*"));
+        APSARA_TEST_FALSE(matcher.IsRegex());
+        APSARA_TEST_TRUE(matcher.Match("172.17.0.3", nullptr));
+        APSARA_TEST_FALSE(matcher.Match("10.172.0.3", nullptr));
+    }
+    {
+        RelabelMatcher matcher;
+        APSARA_TEST_TRUE(matcher.Init("(go_gc|go_memstats|process_cpu)"));
+        APSARA_TEST_FALSE(matcher.IsRegex());
+        APSARA_TEST_TRUE(matcher.Match("go_memstats", &groups));
+        APSARA_TEST_FALSE(matcher.Match("go_memstats_alloc", nullptr));
+        out.clear();
+        matcher.Expand("$1_$$", groups, out);
+        APSARA_TEST_EQUAL("go_memstats_$", out);
+    }
+    {
+        RelabelMatcher matcher;
+        APSARA_TEST_TRUE(matcher.Init("node-exporter"));
+        APSARA_TEST_FALSE(matcher.IsRegex());
+        APSARA_TEST_TRUE(matcher.Match("node-exporter", nullptr));
+        APSARA_TEST_FALSE(matcher.Match("node-exporter-1", nullptr));
+    }
+    {
+        // regexes are fully anchored
+        RelabelMatcher matcher;
+        APSARA_TEST_TRUE(matcher.Init("(?P<host>[^:]+):(\\d+)"));
+        APSARA_TEST_TRUE(matcher.IsRegex());
+        APSARA_TEST_EQUAL(2U, matcher.NumGroups());
+        APSARA_TEST_FALSE(matcher.Match("172.17.0.3:9100 x", nullptr));
+        APSARA_TEST_TRUE(matcher.Match("172.17.0.3:9100", &groups));
+        out.clear();
+        matcher.Expand("${host}-$2-$3", groups, out);
+        APSARA_TEST_EQUAL("172.17.0.3-9100-", out);
+    }
+    {
+        // unless compiled for search, then literals fall back to RE2 as well
+        RelabelMatcher matcher;
+        APSARA_TEST_TRUE(matcher.Init("node-exporter", true));
+        APSARA_TEST_TRUE(matcher.IsRegex());
+        APSARA_TEST_TRUE(matcher.Match("x-node-exporter-1", &groups));
+        APSARA_TEST_EQUAL("node-exporter", groups[0]);
+        RelabelMatcher all;
+        APSARA_TEST_TRUE(all.Init("(.*)", true));
+        APSARA_TEST_FALSE(all.IsRegex());
+    }
+    {
+        RelabelMatcher matcher;
+        APSARA_TEST_FALSE(matcher.Init("(abc"));
+    }
+}
+
+void RelabelConfigUnittest::TestProcessMetricEvent() {
+    Json::Value configJson;
+    string errorMsg;
+    string configStr = R"JSON(
+        [
+            {
+                "action": "replace",
+                "regex": "(.*)",
+                "replacement": "${1}:9100",
+                "source_labels": ["pod_ip"],
+                "target_label": "address"
+            },
+            {
+                "action": "replace",
+                "regex": "(.*);(.*)",
+                "replacement": "$2/$1",
+                "source_labels": ["namespace", "pod"],
+                "target_label": "instance"
+            },
+            {
+                "action": "labelmap",
+                "regex": "label_(.+)",
+                "replacement": "k8s_$1"
+            },
+            {
+                "action": "labeldrop",
+                "regex": "label_.*"
+            },
+            {
+                "action": "uppercase",
+                "source_labels": ["__name__"],
+                "target_label": "upper_name"
+            },
+            {
+                "action": "hashmod",
+                "source_labels": ["pod"],
+                "target_label": "shard",
+                "modulus": 16
+            },
+            {
+                "action": "keep",
+                "regex": "[a-z_]+_total",
+                "source_labels": ["__name__"]
+            }
+        ]
+    )JSON";
+    APSARA_TEST_TRUE(ParseJsonTable(configStr, configJson, errorMsg));
+    RelabelConfigList configList;
+    APSARA_TEST_TRUE(configList.Init(configJson));
+    APSARA_TEST_TRUE(configList.mProgram != nullptr);
+
+    PipelineEventGroup eventGroup(make_shared<SourceBuffer>());
+    auto* event = eventGroup.AddMetricEvent();
+    event->SetName("http_requests_total");
+    event->SetTag(string("pod_ip"), string("172.17.0.3"));
+    event->SetTag(string("namespace"), string("default"));
+    event->SetTag(string("pod"), string("nginx-0"));
+    event->SetTag(string("label_app"), string("nginx"));
+    APSARA_TEST_TRUE(configList.Process(*event));
+    APSARA_TEST_EQUAL("http_requests_total", event->GetTag("__name__"));
+    APSARA_TEST_EQUAL("172.17.0.3:9100", event->GetTag("address"));
+    APSARA_TEST_EQUAL("nginx-0/default", event->GetTag("instance"));
+    APSARA_TEST_EQUAL("nginx", event->GetTag("k8s_app"));
+    APSARA_TEST_FALSE(event->HasTag("label_app"));
+    APSARA_TEST_EQUAL("HTTP_REQUESTS_TOTAL", event->GetTag("upper_name"));
+
+    // hashmod gives the same result as the labels based implementation
+    Labels labels;
+    labels.Set("pod", "nginx-0");
+    RelabelConfigList legacy;
+    legacy.mRelabelConfigs = configList.mRelabelConfigs;
+    legacy.mRelabelConfigs.resize(6);
+    APSARA_TEST_TRUE(legacy.Process(labels));
+    APSARA_TEST_EQUAL(labels.Get("shard"), event->GetTag("shard").to_string());
+
+    auto* dropped = eventGroup.AddMetricEvent();
+    dropped->SetName("up");
+    APSARA_TEST_FALSE(configList.Process(*dropped));
+}
+
+void RelabelConfigUnittest::TestKeepDropMemo() {
+    Json::Value configJson;
+    string errorMsg;
+    string configStr = R"JSON(
+        [{
+            "action": "drop",
+            "regex": "go_(gc|memstats)_.+",
+            "source_labels": ["__name__", "job"]
+        }]
+    )JSON";
+    APSARA_TEST_TRUE(ParseJsonTable(configStr, configJson, errorMsg));
+    RelabelConfigList configList;
+    APSARA_TEST_TRUE(configList.Init(configJson));
+    APSARA_TEST_TRUE(configList.mProgram->mSteps[0].mMemo != nullptr);
+
+    PipelineEventGroup eventGroup(make_shared<SourceBuffer>());
+    for (int i = 0; i < 3; ++i) {
+        auto* event = eventGroup.AddMetricEvent();
+        event->SetName("go_gc_duration_seconds");
+        event->SetTag(string("job"), string("node"));
+        APSARA_TEST_FALSE(configList.Process(*event));
+
+        event = eventGroup.AddMetricEvent();
+        event->SetName("process_cpu_seconds_total");
+        event->SetTag(string("job"), string("node"));
+        APSARA_TEST_TRUE(configList.Process(*event));
+    }
+
+    // values sharing a memo slot do not share the result
+    auto slotOf = [](const string& s) { return hash<string_view>{}(s) & (RelabelProgram::kMemoSlots - 1); };
+    string kept;
+    for (int i = 0; kept.empty(); ++i) {
+        string name = "process_" + to_string(i);
+        if (slotOf(name + ";node") == slotOf("go_gc_duration_seconds;node")) {
+            kept = name;
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        auto* event = eventGroup.AddMetricEvent();
+        event->SetName("go_gc_duration_seconds");
+        event->SetTag(string("job"), string("node"));
+        APSARA_TEST_FALSE(configList.Process(*event));
+
+        event = eventGroup.AddMetricEvent();
+        event->SetName(kept);
+        event->SetTag(string("job"), string("node"));
+        APSARA_TEST_TRUE(configList.Process(*event));
+    }
+
+    // values longer than a memo key are matched directly
+    string longName = "go_gc_" + string(RelabelProgram::kMemoKeyMaxSize, 'x');
+    for (int i = 0; i < 2; ++i) {
+        auto* event = eventGroup.AddMetricEvent();
+        event->SetName(longName);
+        event->SetTag(string("job"), string("node"));
+        APSARA_TEST_FALSE(configList.Process(*event));
+    }
+
+    // concurrent runs share the memo
+    vector<thread> threads;
+    atomic_int wrong(0);
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&configList, &wrong, t]() {
+            PipelineEventGroup group(make_shared<SourceBuffer>());
+            for (int i = 0; i < 2000; ++i) {
+                bool dropped = (i + t) % 2 == 0;
+                auto* event = group.AddMetricEvent();
+                event->SetName(dropped ? "go_memstats_" + to_string(i % 50) : "process_" + to_string(i % 50));
+                event->SetTag(string("job"), string("node"));
+                if (configList.Process(*event) == dropped) {
+                    ++wrong;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    APSARA_TEST_EQUAL(0, wrong.load());
+}
+
+void RelabelConfigUnittest::TestReplacePartialMatch() {
+    Json::Value configJson;
+    string errorMsg;
+    string configStr = R"JSON(
+        [{
+            "action": "replace",
+            "regex": "([a-z]+)-prod",
+            "source_labels": ["host"],
+            "target_label": "app",
+            "replacement": "$1"
+        }, {
+            "action": "replace",
+            "regex": "prod",
+            "source_labels": ["host"],
+            "target_label": "host",
+            "replacement": "staging"
+        }, {
+            "action": "replace",
+            "regex": "^db",
+            "source_labels": ["host"],
+            "target_label": "db",
+            "replacement": "yes"
+        }]
+    )JSON";
+    APSARA_TEST_TRUE(ParseJsonTable(configStr, configJson, errorMsg));
+    RelabelConfigList configList;
+    APSARA_TEST_TRUE(configList.Init(configJson));
+
+    PipelineEventGroup eventGroup(make_shared<SourceBuffer>());
+    auto* event = eventGroup.AddMetricEvent();
+    event->SetName("up");
+    event->SetTag(string("host"), string("web-prod-1"));
+    APSARA_TEST_TRUE(configList.Process(*event));
+    // only the first match is replaced, the text around it is kept in both the target label and the value
+    APSARA_TEST_EQUAL("web-1", event->GetTag("app-1"));
+    APSARA_TEST_EQUAL("web-staging-1", event->GetTag("web-host-1"));
+    APSARA_TEST_EQUAL("web-prod-1", event->GetTag("host"));
+    APSARA_TEST_FALSE(event->HasTag("db"));
+
+    // same as the labels based implementation
+    Labels labels;
+    labels.Set("host", "web-prod-1");
+    RelabelConfigList legacy;
+    legacy.mRelabelConfigs = configList.mRelabelConfigs;
+    APSARA_TEST_TRUE(legacy.Process(labels));
+    APSARA_TEST_EQUAL(labels.Size() + 1, event->TagsSize());
+    for (const auto& key : {"app-1", "web-host-1", "host"}) {
+        APSARA_TEST_EQUAL(labels.Get(key), event->GetTag(key).to_string());
+    }
+}
+
 UNIT_TEST_CASE(ActionConverterUnittest, TestStringToAction)
 UNIT_TEST_CASE(ActionConverterUnittest, TestActionToString)
 
@@ -529,6 +835,10 @@ UNIT_TEST_CASE(RelabelConfigUnittest, TestKeepEqual)
 UNIT_TEST_CASE(RelabelConfigUnittest, TestLowerCase)
 UNIT_TEST_CASE(RelabelConfigUnittest, TestUpperCase)
 UNIT_TEST_CASE(RelabelConfigUnittest, TestMultiRelabel)
+UNIT_TEST_CASE(RelabelConfigUnittest, TestRelabelMatcher)
+UNIT_TEST_CASE(RelabelConfigUnittest, TestProcessMetricEvent)
+UNIT_TEST_CASE(RelabelConfigUnittest, TestKeepDropMemo)
+UNIT_TEST_CASE(RelabelConfigUnittest, TestReplacePartialMatch)
 
 } // namespace logtail
 
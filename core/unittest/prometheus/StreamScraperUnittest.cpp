@@ -15,6 +15,8 @@
  */
 
 
+#include <zlib.h>
+
 #include <memory>
 #include <string>
 
@@ -26,16 +28,21 @@
 #include "prometheus/labels/Labels.h"
 #include "prometheus/schedulers/ScrapeConfig.h"
 #include "unittest/Unittest.h"
+#include "unittest/prometheus/MetricFamilyEncoder.h"
 
 using namespace std;
 
 DECLARE_FLAG_INT64(prom_stream_bytes_size);
+DECLARE_FLAG_INT64(prom_stream_parse_max_events);
 
 namespace logtail::prom {
 class StreamScraperUnittest : public testing::Test {
 public:
     void TestStreamMetricWriteCallback();
     void TestStreamSendMetric();
+    void TestStreamParse();
+    void TestGzipBody();
+    void TestProtobufBody();
 
 
 protected:
@@ -50,9 +57,25 @@ protected:
     }
 
 private:
+    static string Gzip(const string& content);
+
     std::shared_ptr<ScrapeConfig> mScrapeConfig;
 };
 
+string StreamScraperUnittest::Gzip(const string& content) {
+    z_stream stream{};
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+    string res(deflateBound(&stream, content.size()), '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(content.data()));
+    stream.avail_in = content.size();
+    stream.next_out = reinterpret_cast<Bytef*>(res.data());
+    stream.avail_out = res.size();
+    deflate(&stream, Z_FINISH);
+    res.resize(stream.total_out);
+    deflateEnd(&stream);
+    return res;
+}
+
 void StreamScraperUnittest::TestStreamMetricWriteCallback() {
     EventPool eventPool{true};
 
@@ -179,9 +202,138 @@ void StreamScraperUnittest::TestStreamSendMetric() {
     APSARA_TEST_EQUAL("go_memstats_alloc_bytes_total 1.5159292e+08", res1.GetEvents()[3].Cast<RawEvent>().GetContent());
 }
 
+void StreamScraperUnittest::TestStreamParse() {
+    EventPool eventPool{true};
+
+    Labels labels;
+    labels.Set(prometheus::ADDRESS_LABEL_NAME, "localhost:8080");
+    auto streamScraper = make_shared<StreamScraper>(
+        labels, 0, 0, "id", &eventPool, std::chrono::system_clock::time_point(std::chrono::milliseconds(1715829785083)));
+    streamScraper->EnableStreamParse(true);
+
+    string body1 = "# TYPE go_gc_duration_seconds summary\n"
+                   "go_gc_duration_seconds{quantile=\"0\"} 1.5531e-05\n"
+                   "go_gc_duration_seconds_sum 0.034885631 1715829790000\n"
+                   "invalid{ 1\n"
+                   "go_gorou";
+    string body2 = "tines 7\n"
+                   "go_info{version=\"go1.22.3\"} 1";
+
+    INT64_FLAG(prom_stream_bytes_size) = 1024 * 1024;
+    INT64_FLAG(prom_stream_parse_max_events) = 3;
+    StreamScraper::MetricWriteCallback(body1.data(), (size_t)1, (size_t)body1.length(), streamScraper.get());
+    auto& res = streamScraper->mEventGroup;
+    APSARA_TEST_EQUAL(2UL, res.GetEvents().size());
+    {
+        const auto& e = res.GetEvents()[0].Cast<MetricEvent>();
+        APSARA_TEST_EQUAL("go_gc_duration_seconds", e.GetName());
+        APSARA_TEST_EQUAL("go_gc_duration_seconds", e.GetTag(prometheus::NAME));
+        APSARA_TEST_EQUAL("0", e.GetTag("quantile"));
+        APSARA_TEST_EQUAL(1.5531e-05, e.GetValue<UntypedSingleValue>()->mValue);
+        APSARA_TEST_EQUAL(1715829785, e.GetTimestamp());
+        APSARA_TEST_EQUAL(83000000U, e.GetTimestampNanosecond().value());
+    }
+    {
+        const auto& e = res.GetEvents()[1].Cast<MetricEvent>();
+        APSARA_TEST_EQUAL("go_gc_duration_seconds_sum", e.GetName());
+        APSARA_TEST_EQUAL(1715829790, e.GetTimestamp());
+    }
+
+    // the stream is sent once there are too many events
+    StreamScraper::MetricWriteCallback(body2.data(), (size_t)1, (size_t)body2.length(), streamScraper.get());
+    APSARA_TEST_EQUAL(1UL, streamScraper->mItem.size());
+    APSARA_TEST_EQUAL(3UL, streamScraper->mItem[0]->mEventGroup.GetEvents().size());
+    APSARA_TEST_EQUAL("go_goroutines",
+                      streamScraper->mItem[0]->mEventGroup.GetEvents()[2].Cast<MetricEvent>().GetName());
+    streamScraper->FlushCache();
+    APSARA_TEST_EQUAL(1UL, streamScraper->mEventGroup.GetEvents().size());
+    APSARA_TEST_EQUAL("go1.22.3", streamScraper->mEventGroup.GetEvents()[0].Cast<MetricEvent>().GetTag("version"));
+    APSARA_TEST_EQUAL(5UL, streamScraper->mScrapeSamplesScraped);
+    INT64_FLAG(prom_stream_parse_max_events) = 8192;
+}
+
+void StreamScraperUnittest::TestGzipBody() {
+    Labels labels;
+    labels.Set(prometheus::ADDRESS_LABEL_NAME, "localhost:8080");
+    auto streamScraper = make_shared<StreamScraper>(labels, 0, 0, "id", nullptr, std::chrono::system_clock::now());
+    HttpResponse response;
+    response.AddHeader(prometheus::CONTENT_ENCODING, prometheus::GZIP);
+    streamScraper->SetResponseHeader(&response.GetHeader());
+
+    string body;
+    for (int i = 0; i < 1000; ++i) {
+        body += "go_gc_duration_seconds{quantile=\"" + to_string(i) + "\"} 1.5531e-05\n";
+    }
+    string compressed = Gzip(body);
+    // feed in small chunks to cover lines and gzip blocks split across callbacks
+    for (size_t i = 0; i < compressed.size(); i += 100) {
+        size_t len = min((size_t)100, compressed.size() - i);
+        APSARA_TEST_EQUAL(len, StreamScraper::MetricWriteCallback(compressed.data() + i, 1, len, streamScraper.get()));
+    }
+    streamScraper->FlushCache();
+    APSARA_TEST_EQUAL(body.size(), streamScraper->mRawSize);
+    APSARA_TEST_EQUAL(1000UL, streamScraper->mScrapeSamplesScraped);
+    APSARA_TEST_EQUAL(1000UL, streamScraper->mEventGroup.GetEvents().size());
+    APSARA_TEST_EQUAL("go_gc_duration_seconds{quantile=\"999\"} 1.5531e-05",
+                      streamScraper->mEventGroup.GetEvents()[999].Cast<RawEvent>().GetContent());
+
+    // corrupted body aborts the transfer
+    streamScraper->Reset();
+    string corrupted = compressed.substr(0, 10) + string(100, 'x');
+    APSARA_TEST_EQUAL(0UL,
+                      StreamScraper::MetricWriteCallback(corrupted.data(), 1, corrupted.size(), streamScraper.get()));
+}
+
+void StreamScraperUnittest::TestProtobufBody() {
+    EventPool eventPool{true};
+    Labels labels;
+    labels.Set(prometheus::ADDRESS_LABEL_NAME, "localhost:8080");
+    auto streamScraper = make_shared<StreamScraper>(
+        labels, 0, 0, "id", &eventPool, std::chrono::system_clock::time_point(std::chrono::milliseconds(1715829785083)));
+    HttpResponse response;
+    response.AddHeader(prometheus::CONTENT_TYPE,
+                       "application/vnd.google.protobuf; proto=io.prometheus.client.MetricFamily; encoding=delimited");
+    response.AddHeader(prometheus::CONTENT_ENCODING, prometheus::GZIP);
+    streamScraper->SetResponseHeader(&response.GetHeader());
+
+    string body;
+    MetricFamilyEncoder::Metric m;
+    m.mLabels = {{"version", "go1.22.3"}};
+    m.mValue = 1;
+    MetricFamilyEncoder::AppendFamily(body, "go_info", MetricFamilyEncoder::GAUGE, {m});
+    MetricFamilyEncoder::Metric s;
+    s.mPoints = {{0, 1.5531e-05}, {1, 0.1}};
+    s.mCount = 2;
+    s.mSum = 0.034885631;
+    MetricFamilyEncoder::AppendFamily(body, "go_gc_duration_seconds", MetricFamilyEncoder::SUMMARY, {s});
+    string compressed = Gzip(body);
+
+    INT64_FLAG(prom_stream_parse_max_events) = 3;
+    size_t half = compressed.size() / 2;
+    StreamScraper::MetricWriteCallback(compressed.data(), 1, half, streamScraper.get());
+    StreamScraper::MetricWriteCallback(compressed.data() + half, 1, compressed.size() - half, streamScraper.get());
+    streamScraper->FlushCache();
+
+    // go_info, 2 quantiles, _sum and _count, and the first 3 events have been sent as a stream
+    APSARA_TEST_EQUAL(1UL, streamScraper->mItem.size());
+    APSARA_TEST_EQUAL(5UL, streamScraper->mScrapeSamplesScraped);
+    APSARA_TEST_EQUAL(5UL,
+                      streamScraper->mItem[0]->mEventGroup.GetEvents().size()
+                          + streamScraper->mEventGroup.GetEvents().size());
+    const auto& info = streamScraper->mItem[0]->mEventGroup.GetEvents()[0].Cast<MetricEvent>();
+    APSARA_TEST_EQUAL("go_info", info.GetName());
+    APSARA_TEST_EQUAL("go_info", info.GetTag(prometheus::NAME));
+    APSARA_TEST_EQUAL("go1.22.3", info.GetTag("version"));
+    APSARA_TEST_EQUAL(1715829785, info.GetTimestamp());
+    APSARA_TEST_EQUAL(body.size(), streamScraper->mRawSize);
+    INT64_FLAG(prom_stream_parse_max_events) = 8192;
+}
 
 UNIT_TEST_CASE(StreamScraperUnittest, TestStreamMetricWriteCallback)
 UNIT_TEST_CASE(StreamScraperUnittest, TestStreamSendMetric)
+UNIT_TEST_CASE(StreamScraperUnittest, TestStreamParse)
+UNIT_TEST_CASE(StreamScraperUnittest, TestGzipBody)
+UNIT_TEST_CASE(StreamScraperUnittest, TestProtobufBody)
 
 
 } // namespace logtail::prom
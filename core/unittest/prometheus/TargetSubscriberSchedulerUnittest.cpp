@@ -39,6 +39,8 @@ public:
     void TestBuildScrapeSchedulerSet();
     void TestTargetLabels();
     void TestTargetsInfoToString();
+    void TestParseInvalidTargetGroups();
+    void TestIncrementalUpdate();
 
 protected:
     void SetUp() override {
@@ -596,12 +598,90 @@ void TargetSubscriberSchedulerUnittest::TestTargetsInfoToString() {
     APSARA_TEST_EQUAL((uint64_t)3, data[prometheus::TARGETS_INFO].size());
 }
 
+void TargetSubscriberSchedulerUnittest::TestParseInvalidTargetGroups() {
+    std::shared_ptr<TargetSubscriberScheduler> targetSubscriber = std::make_shared<TargetSubscriberScheduler>();
+    APSARA_TEST_TRUE(targetSubscriber->Init(mConfig["ScrapeConfig"]));
+
+    std::vector<PromTargetInfo> targetGroups;
+    APSARA_TEST_FALSE(targetSubscriber->ParseScrapeSchedulerGroup(R"({"targets": []})", targetGroups));
+    APSARA_TEST_FALSE(targetSubscriber->ParseScrapeSchedulerGroup(R"([1])", targetGroups));
+    APSARA_TEST_FALSE(targetSubscriber->ParseScrapeSchedulerGroup(R"([{"targets": [1]}])", targetGroups));
+    APSARA_TEST_FALSE(targetSubscriber->ParseScrapeSchedulerGroup(R"([{"targets": ["a:1"])", targetGroups));
+
+    // unknown members are skipped, groups without targets or address are ignored
+    string content = R"JSON([
+        {
+            "targets": ["10.0.0.1:8080"],
+            "labels": {"__address__": "10.0.0.1:8080", "replicas": 3, "ready": true},
+            "Load": {"cpu": [1, {"x": 2}], "mem": 3}
+        },
+        {"targets": [], "labels": {"__address__": "10.0.0.2:8080"}},
+        {"targets": ["10.0.0.3:8080"], "labels": {"a": "b"}}
+    ])JSON";
+    APSARA_TEST_TRUE(targetSubscriber->ParseScrapeSchedulerGroup(content, targetGroups));
+    APSARA_TEST_EQUAL(1UL, targetGroups.size());
+    APSARA_TEST_EQUAL("10.0.0.1:8080", targetGroups[0].mInstance);
+    APSARA_TEST_EQUAL("3", targetGroups[0].mLabels.Get("replicas"));
+    APSARA_TEST_EQUAL("true", targetGroups[0].mLabels.Get("ready"));
+    APSARA_TEST_EQUAL("loong-collector/demo-podmonitor-500/0", targetGroups[0].mLabels.Get(prometheus::JOB));
+}
+
+void TargetSubscriberSchedulerUnittest::TestIncrementalUpdate() {
+    auto scrapeConfig = mConfig["ScrapeConfig"];
+    string errMsg;
+    Json::Value relabelConfigs;
+    APSARA_TEST_TRUE(ParseJsonTable(R"JSON([
+        {
+            "action": "drop",
+            "source_labels": ["__address__"],
+            "regex": "192\\.168\\.22\\.33:6443"
+        }
+    ])JSON",
+                                    relabelConfigs,
+                                    errMsg));
+    scrapeConfig[prometheus::RELABEL_CONFIGS] = relabelConfigs;
+    std::shared_ptr<TargetSubscriberScheduler> targetSubscriber = std::make_shared<TargetSubscriberScheduler>();
+    APSARA_TEST_TRUE(targetSubscriber->Init(scrapeConfig));
+    targetSubscriber->InitSelfMonitor(MetricLabels());
+
+    targetSubscriber->OnSubscription(mHttpResponse, 0);
+    APSARA_TEST_EQUAL(2UL, targetSubscriber->mScrapeSchedulerMap.size());
+    APSARA_TEST_EQUAL(1UL, targetSubscriber->mDroppedTargets.size());
+    APSARA_TEST_EQUAL(3UL, targetSubscriber->mPromSubscribeRelabeledTargets->GetValue());
+    auto schedulers = targetSubscriber->mScrapeSchedulerMap;
+
+    // same body, nothing is parsed
+    targetSubscriber->OnSubscription(mHttpResponse, 0);
+    APSARA_TEST_EQUAL(1UL, targetSubscriber->mPromSubscribeUnchangedTotal->GetValue());
+    APSARA_TEST_EQUAL(3UL, targetSubscriber->mPromSubscribeRelabeledTargets->GetValue());
+
+    // a new target is added, known and dropped targets are not relabeled again
+    auto& body = *mHttpResponse.GetBody<string>();
+    body.insert(body.rfind(']'),
+                R"JSON(, {"targets": ["10.0.0.9:9100"], "labels": {"__address__": "10.0.0.9:9100"}})JSON");
+    targetSubscriber->OnSubscription(mHttpResponse, 0);
+    APSARA_TEST_EQUAL(3UL, targetSubscriber->mScrapeSchedulerMap.size());
+    APSARA_TEST_EQUAL(1UL, targetSubscriber->mDroppedTargets.size());
+    APSARA_TEST_EQUAL(4UL, targetSubscriber->mPromSubscribeRelabeledTargets->GetValue());
+    for (const auto& [id, scheduler] : schedulers) {
+        APSARA_TEST_EQUAL(scheduler.get(), targetSubscriber->mScrapeSchedulerMap[id].get());
+    }
+
+    // 304 is counted as unchanged as well
+    mHttpResponse.SetStatusCode(304);
+    targetSubscriber->OnSubscription(mHttpResponse, 0);
+    APSARA_TEST_EQUAL(2UL, targetSubscriber->mPromSubscribeUnchangedTotal->GetValue());
+    APSARA_TEST_EQUAL(3UL, targetSubscriber->mScrapeSchedulerMap.size());
+}
+
 UNIT_TEST_CASE(TargetSubscriberSchedulerUnittest, OnInitScrapeJobEvent)
 UNIT_TEST_CASE(TargetSubscriberSchedulerUnittest, TestProcess)
 UNIT_TEST_CASE(TargetSubscriberSchedulerUnittest, TestParseTargetGroups)
 UNIT_TEST_CASE(TargetSubscriberSchedulerUnittest, TestBuildScrapeSchedulerSet)
 UNIT_TEST_CASE(TargetSubscriberSchedulerUnittest, TestTargetLabels)
 UNIT_TEST_CASE(TargetSubscriberSchedulerUnittest, TestTargetsInfoToString)
+UNIT_TEST_CASE(TargetSubscriberSchedulerUnittest, TestParseInvalidTargetGroups)
+UNIT_TEST_CASE(TargetSubscriberSchedulerUnittest, TestIncrementalUpdate)
 
 } // namespace logtail
 
@@ -14,10 +14,16 @@
  * limitations under the License.
  */
 
+#include <algorithm>
 #include <string>
 
+#include "models/EventPool.h"
+#include "models/RawEvent.h"
+#include "prometheus/component/StreamScraper.h"
+#include "prometheus/labels/ProtobufParser.h"
 #include "prometheus/labels/TextParser.h"
 #include "unittest/Unittest.h"
+#include "unittest/prometheus/MetricFamilyEncoder.h"
 
 using namespace std;
 
@@ -27,6 +33,8 @@ class TextParserBenchmark : public testing::Test {
 public:
     void TestParse100M() const;
     void TestParse1000M() const;
+    void TestStreamParse100M() const;
+    void TestTextVsProtobuf() const;
 
 protected:
     void SetUp() override {
@@ -87,8 +95,129 @@ void TextParserBenchmark::TestParse1000M() const {
     // elapsed: 4960MB in release mode
 }
 
+// Scrape 100MB body in 16KB chunks: RawEvents parsed afterwards as in processor_prom_parse_metric_native vs. samples
+// parsed in the write callback. Peak memory is the max data size of a stream group, including the parsed events in
+// the former case.
+void TextParserBenchmark::TestStreamParse100M() const {
+    const size_t chunkSize = 16 * 1024;
+    for (bool streamParse : {false, true}) {
+        EventPool eventPool{true};
+        prom::StreamScraper scraper(
+            Labels(), 0, 0, "id", &eventPool, std::chrono::system_clock::time_point(std::chrono::seconds(1)));
+        if (streamParse) {
+            scraper.EnableStreamParse(true);
+        }
+        TextParser parser;
+        size_t events = 0;
+        size_t peakSize = 0;
+        auto consume = [&]() {
+            for (auto& item : scraper.mItem) {
+                auto& group = item->mEventGroup;
+                if (streamParse) {
+                    events += group.GetEvents().size();
+                    peakSize = std::max(peakSize, group.DataSize());
+                    continue;
+                }
+                PipelineEventGroup parsed(group.GetSourceBuffer());
+                for (auto& e : group.MutableEvents()) {
+                    auto metricEvent = parsed.CreateMetricEvent(true);
+                    if (parser.ParseLine(e.Cast<RawEvent>().GetContent(), *metricEvent)) {
+                        parsed.MutableEvents().emplace_back(std::move(metricEvent), true, nullptr);
+                    }
+                }
+                events += parsed.GetEvents().size();
+                peakSize = std::max(peakSize, group.DataSize() + parsed.DataSize());
+            }
+            scraper.mItem.clear();
+        };
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t pos = 0; pos < m100MData.size(); pos += chunkSize) {
+            std::string chunk = m100MData.substr(pos, chunkSize);
+            prom::StreamScraper::MetricWriteCallback(chunk.data(), 1, chunk.size(), &scraper);
+            consume();
+        }
+        scraper.FlushCache();
+        scraper.SendMetrics();
+        consume();
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed = end - start;
+        cout << (streamParse ? "stream parse" : "raw events") << " elapsed: " << elapsed.count() << " seconds, "
+             << events << " events, peak stream size: " << peakSize / 1024 << "KB" << endl;
+    }
+}
+
+void TextParserBenchmark::TestTextVsProtobuf() const {
+    // the same histograms in both exposition formats, like a large kube-state-metrics or apiserver target
+    const int kSeriesCnt = 50000;
+    const vector<double> kBounds = {0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10};
+    string text;
+    string proto;
+    vector<MetricFamilyEncoder::Metric> metrics;
+    metrics.reserve(kSeriesCnt);
+    string le;
+    for (int i = 0; i < kSeriesCnt; ++i) {
+        MetricFamilyEncoder::Metric m;
+        m.mLabels = {{"namespace", "default"},
+                     {"pod", "nginx-deployment-" + to_string(i)},
+                     {"container", "nginx"},
+                     {"verb", "GET"}};
+        string labels = "namespace=\"default\",pod=\"nginx-deployment-" + to_string(i)
+            + "\",container=\"nginx\",verb=\"GET\"";
+        uint64_t cnt = 0;
+        for (double bound : kBounds) {
+            cnt += i % 7 + 1;
+            m.mPoints.emplace_back(bound, cnt);
+            ProtobufParser::FormatFloat(bound, le);
+            text += "request_duration_seconds_bucket{" + labels + ",le=\"" + le + "\"} " + to_string(cnt) + "\n";
+        }
+        m.mCount = cnt;
+        m.mSum = cnt * 0.3;
+        text += "request_duration_seconds_bucket{" + labels + ",le=\"+Inf\"} " + to_string(cnt) + "\n";
+        text += "request_duration_seconds_sum{" + labels + "} " + to_string(m.mSum) + "\n";
+        text += "request_duration_seconds_count{" + labels + "} " + to_string(cnt) + "\n";
+        metrics.emplace_back(std::move(m));
+    }
+    // families are split as client libraries do not limit them, but keep single messages reasonably sized
+    for (size_t i = 0; i < metrics.size(); i += 1000) {
+        vector<MetricFamilyEncoder::Metric> part(metrics.begin() + i,
+                                                  metrics.begin() + min(metrics.size(), i + 1000));
+        MetricFamilyEncoder::AppendFamily(proto, "request_duration_seconds", MetricFamilyEncoder::HISTOGRAM, part);
+    }
+
+    size_t textEvents = 0;
+    size_t protoEvents = 0;
+    auto start = chrono::high_resolution_clock::now();
+    {
+        TextParser parser;
+        auto res = parser.Parse(text, 0, 0);
+        textEvents = res.GetEvents().size();
+    }
+    auto textElapsed = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+
+    start = chrono::high_resolution_clock::now();
+    {
+        ProtobufParser parser;
+        PipelineEventGroup eGroup(make_shared<SourceBuffer>());
+        // feed in 16KB chunks like the curl write callback
+        for (size_t i = 0; i < proto.size(); i += 16 * 1024) {
+            parser.Feed(proto.data() + i, min(proto.size() - i, (size_t)16 * 1024), eGroup);
+        }
+        protoEvents = eGroup.GetEvents().size();
+    }
+    auto protoElapsed = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+
+    APSARA_TEST_EQUAL(textEvents, protoEvents);
+    cout << "text: " << text.size() / 1024 << "KB, elapsed: " << textElapsed << " seconds, events: " << textEvents
+         << endl;
+    cout << "protobuf: " << proto.size() / 1024 << "KB, elapsed: " << protoElapsed
+         << " seconds, events: " << protoEvents << endl;
+}
+
 UNIT_TEST_CASE(TextParserBenchmark, TestParse100M)
 UNIT_TEST_CASE(TextParserBenchmark, TestParse1000M)
+UNIT_TEST_CASE(TextParserBenchmark, TestStreamParse100M)
+UNIT_TEST_CASE(TextParserBenchmark, TestTextVsProtobuf)
 
 } // namespace logtail
 
@@ -40,6 +40,9 @@ public:
     void TestParseSuccess();
 
     void TestHonorTimestamps();
+
+    void TestGetSeriesLength();
+    void TestParseSample();
 };
 
 void TextParserUnittest::TestParseMultipleLines() const {
@@ -388,6 +391,48 @@ void TextParserUnittest::TestParseUnicodeLabelValue() {
 
 UNIT_TEST_CASE(TextParserUnittest, TestParseUnicodeLabelValue)
 
+void TextParserUnittest::TestGetSeriesLength() {
+    APSARA_TEST_EQUAL(3UL, TextParser::GetSeriesLength("abc 123 456"));
+    APSARA_TEST_EQUAL(5UL, TextParser::GetSeriesLength("  abc 123"));
+    APSARA_TEST_EQUAL(10UL, TextParser::GetSeriesLength(R"(abc{k="v"}  123)"));
+    APSARA_TEST_EQUAL(11UL, TextParser::GetSeriesLength(R"(abc {k="v"} 123)"));
+    // quoted '}' and escaped quotation mark
+    APSARA_TEST_EQUAL(14UL, TextParser::GetSeriesLength(R"(abc{k="}\"}",} 123)"));
+    APSARA_TEST_EQUAL(0UL, TextParser::GetSeriesLength(R"(abc{k="v" 123)"));
+    APSARA_TEST_EQUAL(0UL, TextParser::GetSeriesLength("{} 123"));
+}
+
+UNIT_TEST_CASE(TextParserUnittest, TestGetSeriesLength)
+
+void TextParserUnittest::TestParseSample() {
+    PipelineEventGroup eGroup(make_shared<SourceBuffer>());
+    TextParser parser;
+    parser.SetDefaultTimestamp(789, 111);
+    {
+        string line = R"(abc{k="v"} 9.5 1715829785083)";
+        auto event = eGroup.CreateMetricEvent();
+        APSARA_TEST_TRUE(parser.ParseSample(line, TextParser::GetSeriesLength(line), *event));
+        APSARA_TEST_TRUE(IsDoubleEqual(9.5, event->GetValue<UntypedSingleValue>()->mValue));
+        APSARA_TEST_EQUAL(1715829785, event->GetTimestamp());
+        // labels are not parsed
+        APSARA_TEST_EQUAL(0UL, event->TagsSize());
+    }
+    {
+        string line = "abc 1";
+        auto event = eGroup.CreateMetricEvent();
+        APSARA_TEST_TRUE(parser.ParseSample(line, TextParser::GetSeriesLength(line), *event));
+        APSARA_TEST_TRUE(IsDoubleEqual(1, event->GetValue<UntypedSingleValue>()->mValue));
+        APSARA_TEST_EQUAL(789, event->GetTimestamp());
+    }
+    {
+        string line = "abc x1";
+        auto event = eGroup.CreateMetricEvent();
+        APSARA_TEST_FALSE(parser.ParseSample(line, TextParser::GetSeriesLength(line), *event));
+    }
+}
+
+UNIT_TEST_CASE(TextParserUnittest, TestParseSample)
+
 } // namespace logtail
 
 UNIT_TEST_MAIN
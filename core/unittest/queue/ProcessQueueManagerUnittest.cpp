@@ -36,6 +36,7 @@ public:
     void TestPopItem();
     void TestIsAllQueueEmpty();
     void OnPipelineUpdate();
+    void TestAddPipelineInProcessCnt();
 
 protected:
     static void SetUpTestCase() { sProcessQueueManager = ProcessQueueManager::GetInstance(); }
@@ -451,6 +452,41 @@ void ProcessQueueManagerUnittest::OnPipelineUpdate() {
     }
 }
 
+void ProcessQueueManagerUnittest::TestAddPipelineInProcessCnt() {
+    CollectionPipelineContext ctx1, ctx2;
+    ctx1.SetConfigName("test_config_1");
+    ctx2.SetConfigName("test_config_2");
+    QueueKey key = QueueKeyManager::GetInstance()->GetKey("test_config_1");
+    sProcessQueueManager->CreateOrUpdateBoundedQueue(key, 0, ctx1);
+    ExactlyOnceQueueManager::GetInstance()->CreateOrUpdateQueue(1, 0, ctx2, vector<RangeCheckpointPtr>(5));
+
+    auto pipeline1 = make_shared<CollectionPipeline>();
+    auto pipeline2 = make_shared<CollectionPipeline>();
+    CollectionPipelineManager::GetInstance()->mPipelineNameEntityMap["test_config_1"] = pipeline1;
+    CollectionPipelineManager::GetInstance()->mPipelineNameEntityMap["test_config_2"] = pipeline2;
+
+    // pop enabled
+    sProcessQueueManager->EnablePop("test_config_1");
+    APSARA_TEST_EQUAL(pipeline1, sProcessQueueManager->AddPipelineInProcessCnt("test_config_1"));
+    APSARA_TEST_EQUAL(1, pipeline1->mInProcessCnt.load());
+    ExactlyOnceQueueManager::GetInstance()->EnablePopProcessQueue("test_config_2");
+    APSARA_TEST_EQUAL(pipeline2, sProcessQueueManager->AddPipelineInProcessCnt("test_config_2"));
+    APSARA_TEST_EQUAL(1, pipeline2->mInProcessCnt.load());
+
+    // pop disabled, i.e., the pipeline is stopping
+    sProcessQueueManager->DisablePop("test_config_1", false);
+    APSARA_TEST_EQUAL(nullptr, sProcessQueueManager->AddPipelineInProcessCnt("test_config_1"));
+    APSARA_TEST_EQUAL(1, pipeline1->mInProcessCnt.load());
+    sProcessQueueManager->DisablePop("test_config_2", false);
+    APSARA_TEST_EQUAL(nullptr, sProcessQueueManager->AddPipelineInProcessCnt("test_config_2"));
+    APSARA_TEST_EQUAL(1, pipeline2->mInProcessCnt.load());
+
+    // no queue
+    APSARA_TEST_EQUAL(nullptr, sProcessQueueManager->AddPipelineInProcessCnt("test_config_3"));
+
+    CollectionPipelineManager::GetInstance()->mPipelineNameEntityMap.clear();
+}
+
 UNIT_TEST_CASE(ProcessQueueManagerUnittest, TestUpdateSameTypeQueue)
 UNIT_TEST_CASE(ProcessQueueManagerUnittest, TestUpdateDifferentTypeQueue)
 UNIT_TEST_CASE(ProcessQueueManagerUnittest, TestDeleteQueue)
@@ -459,6 +495,7 @@ UNIT_TEST_CASE(ProcessQueueManagerUnittest, TestPushQueue)
 UNIT_TEST_CASE(ProcessQueueManagerUnittest, TestPopItem)
 UNIT_TEST_CASE(ProcessQueueManagerUnittest, TestIsAllQueueEmpty)
 UNIT_TEST_CASE(ProcessQueueManagerUnittest, OnPipelineUpdate)
+UNIT_TEST_CASE(ProcessQueueManagerUnittest, TestAddPipelineInProcessCnt)
 
 } // namespace logtail
 
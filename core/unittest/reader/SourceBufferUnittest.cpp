@@ -28,6 +28,7 @@ public:
     void SetUp() override {}
     void TearDown() override {}
     void TestBufferAllocatorAllocate();
+    void TestRetain();
 };
 
 void SourceBufferUnittest::TestBufferAllocatorAllocate() {
@@ -61,7 +62,25 @@ void SourceBufferUnittest::TestBufferAllocatorAllocate() {
     APSARA_TEST_EQUAL('c', static_cast<char*>(alloc3)[0]);
 }
 
+void SourceBufferUnittest::TestRetain() {
+    SourceBuffer sb;
+    auto block = std::make_shared<std::string>("block");
+    auto parentBlock = std::make_shared<std::string>("parent block");
+    // events of the same process retain its block and its parent block in turn
+    for (int i = 0; i < 10; ++i) {
+        sb.Retain(block);
+        sb.Retain(parentBlock);
+    }
+    APSARA_TEST_EQUAL(2U, sb.mRetained.size());
+    APSARA_TEST_EQUAL(2, block.use_count());
+
+    sb.Reset();
+    APSARA_TEST_TRUE(sb.mRetained.empty());
+    APSARA_TEST_EQUAL(1, block.use_count());
+}
+
 UNIT_TEST_CASE(SourceBufferUnittest, TestBufferAllocatorAllocate);
+UNIT_TEST_CASE(SourceBufferUnittest, TestRetain);
 
 } // namespace logtail
 
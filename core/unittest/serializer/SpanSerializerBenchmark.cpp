@@ -0,0 +1,171 @@
+// Copyright 2024 iLogtail Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include "json/json.h"
+
+#include "collection_pipeline/serializer/SLSSerializer.h"
+#include "plugin/flusher/sls/FlusherSLS.h"
+#include "unittest/Unittest.h"
+
+using namespace std;
+
+namespace logtail {
+
+static const size_t kSpanCnt = 5000;
+static const size_t kRounds = 20;
+
+class SpanSerializerBenchmark : public ::testing::Test {
+public:
+    void TestSpanContents();
+    void TestSerializeSpans();
+
+protected:
+    static void SetUpTestCase() { sFlusher = make_unique<FlusherSLS>(); }
+
+    void SetUp() override {
+        mCtx.SetConfigName("test_config");
+        sFlusher->SetContext(mCtx);
+        sFlusher->SetMetricsRecordRef(FlusherSLS::sName, "1");
+    }
+
+private:
+    static void FillSpanGroup(PipelineEventGroup& group);
+
+    static unique_ptr<FlusherSLS> sFlusher;
+
+    CollectionPipelineContext mCtx;
+};
+
+unique_ptr<FlusherSLS> SpanSerializerBenchmark::sFlusher;
+
+void SpanSerializerBenchmark::FillSpanGroup(PipelineEventGroup& group) {
+    for (size_t i = 0; i < kSpanCnt; ++i) {
+        auto* span = group.AddSpanEvent();
+        span->SetTraceId("5f1e6a0c8d2b4e7f9a3c1b0d2e4f6a8b");
+        span->SetSpanId("a1b2c3d4e5f60718");
+        span->SetParentSpanId("0817f6e5d4c3b2a1");
+        span->SetName("/api/v1/orders/" + to_string(i % 100));
+        span->SetKind(SpanEvent::Kind::Server);
+        span->SetStatus(SpanEvent::StatusCode::Ok);
+        span->SetStartTimeNs(1700000000000000000ULL + i);
+        span->SetEndTimeNs(1700000000000500000ULL + i);
+        span->SetTimestamp(1700000000);
+        span->SetScopeTag(string("service.name"), string("order-service"));
+        span->SetScopeTag(string("host.name"), string("node-" + to_string(i % 16)));
+        span->SetTag(string("http.method"), string("GET"));
+        span->SetTag(string("http.status_code"), string("200"));
+        span->SetTag(string("http.url"), string("http://example.com/api/v1/orders?id=" + to_string(i)));
+        span->SetTag(string("user_agent"), string("Mozilla/5.0 (X11; Linux x86_64) \"quoted\""));
+        span->SetTag(string("peer.ip"), string("10.0.0.1"));
+        span->SetTag(string("rpcType"), string("25"));
+        auto* innerEvent = span->AddEvent();
+        innerEvent->SetName("exception");
+        innerEvent->SetTimestampNs(1700000000000100000ULL);
+        innerEvent->SetTag(string("exception.message"), string("timeout\n\tat Foo.bar"));
+        auto* link = span->AddLink();
+        link->SetTraceId("0a1b2c3d4e5f60718293a4b5c6d7e8f9");
+        link->SetSpanId("1122334455667788");
+        link->SetTag(string("link.kind"), string("follows_from"));
+    }
+}
+
+// the implementation before the streaming writer is used
+static void LegacySerializeSpanContents(const SpanEvent& e, array<string, 3>& res) {
+    Json::Value jsonVal;
+    for (auto it = e.TagsBegin(); it != e.TagsEnd(); ++it) {
+        jsonVal[it->first.to_string()] = it->second.to_string();
+    }
+    for (auto it = e.ScopeTagsBegin(); it != e.ScopeTagsEnd(); ++it) {
+        jsonVal[it->first.to_string()] = it->second.to_string();
+    }
+    Json::StreamWriterBuilder writer;
+    res[0] = Json::writeString(writer, jsonVal);
+    Json::Value jsonLinks(Json::arrayValue);
+    for (const auto& link : e.GetLinks()) {
+        jsonLinks.append(link.ToJson());
+    }
+    res[1] = Json::writeString(writer, jsonLinks);
+    Json::Value jsonEvents(Json::arrayValue);
+    for (const auto& innerEvent : e.GetEvents()) {
+        jsonEvents.append(innerEvent.ToJson());
+    }
+    res[2] = Json::writeString(writer, jsonEvents);
+}
+
+void SpanSerializerBenchmark::TestSpanContents() {
+    PipelineEventGroup group(make_shared<SourceBuffer>());
+    FillSpanGroup(group);
+    size_t legacyBytes = 0, bytes = 0;
+    {
+        array<string, 3> res;
+        auto start = chrono::high_resolution_clock::now();
+        for (size_t r = 0; r < kRounds; ++r) {
+            for (const auto& e : group.GetEvents()) {
+                LegacySerializeSpanContents(e.Cast<SpanEvent>(), res);
+                legacyBytes += res[0].size() + res[1].size() + res[2].size();
+            }
+        }
+        auto duration = chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - start);
+        cout << "jsoncpp: " << kSpanCnt * kRounds * 1000000.0 / duration.count() << " spans/s, "
+             << legacyBytes / kRounds << " bytes per round" << endl;
+    }
+    {
+        string res;
+        auto start = chrono::high_resolution_clock::now();
+        for (size_t r = 0; r < kRounds; ++r) {
+            for (const auto& e : group.GetEvents()) {
+                res.clear();
+                SerializeSpanAttributesToString(e.Cast<SpanEvent>(), res);
+                SerializeSpanLinksToString(e.Cast<SpanEvent>(), res);
+                SerializeSpanEventsToString(e.Cast<SpanEvent>(), res);
+                bytes += res.size();
+            }
+        }
+        auto duration = chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - start);
+        cout << "json writer: " << kSpanCnt * kRounds * 1000000.0 / duration.count() << " spans/s, "
+             << bytes / kRounds << " bytes per round" << endl;
+    }
+    // compact output is never larger than the styled one
+    APSARA_TEST_TRUE(bytes <= legacyBytes);
+}
+
+void SpanSerializerBenchmark::TestSerializeSpans() {
+    SLSEventGroupSerializer serializer(sFlusher.get());
+    chrono::microseconds total(0);
+    for (size_t r = 0; r < kRounds; ++r) {
+        PipelineEventGroup group(make_shared<SourceBuffer>());
+        FillSpanGroup(group);
+        BatchedEvents batch(std::move(group.MutableEvents()),
+                            std::move(group.GetSizedTags()),
+                            std::move(group.GetSourceBuffer()),
+                            group.GetMetadata(EventGroupMetaKey::SOURCE_ID),
+                            std::move(group.GetExactlyOnceCheckpoint()));
+        string res, errorMsg;
+        auto start = chrono::high_resolution_clock::now();
+        APSARA_TEST_TRUE(serializer.DoSerialize(std::move(batch), res, errorMsg));
+        total += chrono::duration_cast<chrono::microseconds>(chrono::high_resolution_clock::now() - start);
+    }
+    cout << "sls serializer: " << kSpanCnt * kRounds * 1000000.0 / total.count() << " spans/s" << endl;
+}
+
+UNIT_TEST_CASE(SpanSerializerBenchmark, TestSpanContents)
+UNIT_TEST_CASE(SpanSerializerBenchmark, TestSerializeSpans)
+
+} // namespace logtail
+
+UNIT_TEST_MAIN